@@ -0,0 +1,1222 @@
+//
+//  bench.cpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "bench.hpp"
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+// core
+#include "box.h"
+#include "fifo_list.h"
+#include "hash_uint32_int.h"
+#include "map_string_float3.h"
+#include "matrix4x4.h"
+#include "ray.h"
+#include "rtree.h"
+#include "scene.h"
+#include "transform.h"
+
+// xptools
+#include "Channel.hpp"
+#include "Connection.hpp"
+#include "OperationQueue.hpp"
+#include "PayloadBuffer.hpp"
+#include "ThreadPool.hpp"
+#include "TimerQueue.hpp"
+
+// Counts malloc calls (operator new included) to report allocations,
+// glibc only, and not when sanitizers already replace malloc
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__) && !defined(__SANITIZE_THREAD__)
+extern "C" void *__libc_malloc(size_t size);
+static std::atomic<uint64_t> nbMallocs(0);
+extern "C" void *malloc(size_t size) {
+    nbMallocs.fetch_add(1, std::memory_order_relaxed);
+    return __libc_malloc(size);
+}
+#define MALLOC_COUNT_AVAILABLE 1
+#else
+static std::atomic<uint64_t> nbMallocs(0);
+#define MALLOC_COUNT_AVAILABLE 0
+#endif
+
+namespace {
+
+typedef std::chrono::steady_clock Clock;
+
+double elapsedSeconds(const Clock::time_point& start) {
+    return std::chrono::duration<double>(Clock::now() - start).count();
+}
+
+/// Blocks until `count` calls to `done`
+class Countdown {
+public:
+    explicit Countdown(size_t count) : _count(count) {}
+
+    void done() {
+        std::lock_guard<std::mutex> locker(_lock);
+        if (--_count == 0) {
+            _cv.notify_all();
+        }
+    }
+
+    void wait() {
+        std::unique_lock<std::mutex> locker(_lock);
+        _cv.wait(locker, [this]() { return _count == 0; });
+    }
+
+private:
+    std::mutex _lock;
+    std::condition_variable _cv;
+    size_t _count;
+};
+
+void printQueueMetrics(const std::string& name,
+                       const vx::OperationQueue::Metrics& before,
+                       const vx::OperationQueue::Metrics& after,
+                       double seconds) {
+    const uint64_t executed = after.executed - before.executed;
+    const double avgLatencyUs = executed > 0 ? static_cast<double>(after.totalLatencyUs -
+                                                                   before.totalLatencyUs) /
+                                                   static_cast<double>(executed)
+                                             : 0.0;
+    std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(32) << name
+              << std::right << std::setw(12) << static_cast<double>(executed) / seconds
+              << " ops/s   avg latency " << std::setw(8) << avgLatencyUs << " us   max latency "
+              << std::setw(8) << after.maxLatencyUs << " us" << std::endl;
+}
+
+/// Throughput: empty operations dispatched as fast as possible by `producers` threads.
+/// Latency: single operations dispatched every millisecond, on an otherwise idle queue.
+void benchOperationQueue() {
+    const size_t nbOps = 200000;
+    const size_t nbSpacedOps = 200;
+
+    std::cout << "operation_queue (" << vx::ThreadPool::shared().getNbWorkers() << " workers)"
+              << std::endl;
+
+    vx::OperationQueue *queues[2] = {vx::OperationQueue::getBackground(),
+                                     vx::OperationQueue::getSlowBackground()};
+    const char *names[2] = {"background", "slow background"};
+
+    for (int q = 0; q < 2; ++q) {
+        for (size_t producers : {1, 4}) {
+            const vx::OperationQueue::Metrics before = queues[q]->getMetrics();
+            Countdown countdown(nbOps);
+            const Clock::time_point start = Clock::now();
+
+            std::vector<std::thread> threads;
+            for (size_t p = 0; p < producers; ++p) {
+                threads.emplace_back([&]() {
+                    for (size_t i = 0; i < nbOps / producers; ++i) {
+                        queues[q]->dispatch([&countdown]() { countdown.done(); });
+                    }
+                });
+            }
+            for (std::thread& t : threads) {
+                t.join();
+            }
+            countdown.wait();
+
+            printQueueMetrics(std::string(names[q]) + ", " + std::to_string(producers) +
+                                  " producer(s)",
+                              before,
+                              queues[q]->getMetrics(),
+                              elapsedSeconds(start));
+        }
+    }
+
+    const vx::OperationQueue::Metrics before = queues[0]->getMetrics();
+    Countdown countdown(nbSpacedOps);
+    const Clock::time_point start = Clock::now();
+    for (size_t i = 0; i < nbSpacedOps; ++i) {
+        queues[0]->dispatch([&countdown]() { countdown.done(); });
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    countdown.wait();
+    printQueueMetrics("background, idle queue", before, queues[0]->getMetrics(),
+                      elapsedSeconds(start));
+
+    // scheduled operations: 100k timers due in 1 to 1.5s, every other one cancelled
+    const size_t nbScheduled = 100000;
+    const size_t nbFired = nbScheduled / 2;
+    Countdown scheduled(nbFired);
+    std::atomic<int64_t> totalDelayUs(0);
+    std::atomic<int64_t> maxDelayUs(0);
+    std::atomic<size_t> cancelledFired(0);
+    std::vector<vx::TimerQueue::Handle> handles(nbScheduled);
+
+    const Clock::time_point scheduleStart = Clock::now();
+    for (size_t i = 0; i < nbScheduled; ++i) {
+        const int64_t ms = 1000 + static_cast<int64_t>(i % 500);
+        const Clock::time_point due = Clock::now() + std::chrono::milliseconds(ms);
+        const bool cancelled = i % 2 == 1;
+        handles[i] = queues[0]->schedule([&, due, cancelled]() {
+            if (cancelled) {
+                ++cancelledFired;
+                return;
+            }
+            const int64_t delay = std::chrono::duration_cast<std::chrono::microseconds>(
+                                      Clock::now() - due).count();
+            totalDelayUs += delay;
+            int64_t max = maxDelayUs;
+            while (delay > max && maxDelayUs.compare_exchange_weak(max, delay) == false) {}
+            scheduled.done();
+        }, ms);
+    }
+    for (size_t i = 1; i < nbScheduled; i += 2) {
+        queues[0]->cancelScheduled(handles[i]);
+    }
+    const double scheduleSeconds = elapsedSeconds(scheduleStart);
+    scheduled.wait();
+
+    std::cout << "  " << std::left << std::setw(32) << "background, 100k timers" << std::right
+              << std::setw(12) << static_cast<double>(nbScheduled) / scheduleSeconds
+              << " sch/s   avg delay   " << std::setw(8)
+              << static_cast<double>(totalDelayUs) / static_cast<double>(nbFired)
+              << " us   max delay   " << std::setw(8) << maxDelayUs << " us   "
+              << cancelledFired << " cancelled fired" << std::endl;
+}
+
+/// Channel implementation prior to the lock-free one, for comparison
+template <typename T>
+class MutexChannel {
+public:
+    void pushMove(T&& msg) {
+        const std::lock_guard<std::mutex> locker(_mutex);
+        _queue.push(std::move(msg));
+    }
+
+    bool pop(T& msgRef) {
+        const std::lock_guard<std::mutex> locker(_mutex);
+        if (_queue.empty()) {
+            return false;
+        }
+        msgRef = std::move(_queue.front());
+        _queue.pop();
+        return true;
+    }
+
+private:
+    std::mutex _mutex;
+    std::queue<T> _queue;
+};
+
+/// Returns messages per second, `producers` threads pushing while one thread pops
+template <typename C>
+double channelThroughput(size_t producers, size_t nbMessages) {
+    C channel;
+    const size_t perProducer = nbMessages / producers;
+    const size_t total = perProducer * producers;
+    std::atomic<bool> go(false);
+
+    std::vector<std::thread> threads;
+    for (size_t p = 0; p < producers; ++p) {
+        threads.emplace_back([&channel, &go, perProducer]() {
+            while (go == false) {
+                std::this_thread::yield();
+            }
+            for (size_t i = 0; i < perProducer; ++i) {
+                channel.pushMove(std::shared_ptr<size_t>(new size_t(i)));
+            }
+        });
+    }
+
+    const Clock::time_point start = Clock::now();
+    go = true;
+    std::shared_ptr<size_t> msg;
+    size_t received = 0;
+    while (received < total) {
+        if (channel.pop(msg)) {
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    const double seconds = elapsedSeconds(start);
+
+    for (std::thread& t : threads) {
+        t.join();
+    }
+    return static_cast<double>(total) / seconds;
+}
+
+/// Contention: 1 to 16 producers, one consumer, lock-free Channel vs mutex guarded queue.
+void benchChannel() {
+    const size_t nbMessages = 1000000;
+
+    std::cout << "channel (" << std::thread::hardware_concurrency() << " hardware threads)"
+              << std::endl;
+    for (size_t producers : {1, 2, 4, 8, 16}) {
+        const double lockFree = channelThroughput<vx::Channel<std::shared_ptr<size_t>>>(
+            producers, nbMessages);
+        const double mutex = channelThroughput<MutexChannel<std::shared_ptr<size_t>>>(
+            producers, nbMessages);
+        std::cout << std::fixed << std::setprecision(1) << "  " << std::setw(2) << producers
+                  << " producer(s)   lock-free " << std::setw(12) << lockFree
+                  << " msg/s   mutex " << std::setw(12) << mutex << " msg/s   x"
+                  << std::setprecision(2) << lockFree / mutex << std::endl;
+    }
+
+    // popAll & popWait
+    vx::Channel<std::shared_ptr<size_t>> channel;
+    std::thread producer([&channel]() {
+        for (size_t i = 0; i < 1000; ++i) {
+            channel.pushMove(std::shared_ptr<size_t>(new size_t(i)));
+            if (i % 100 == 0) {
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            }
+        }
+    });
+    std::vector<std::shared_ptr<size_t>> msgs;
+    std::shared_ptr<size_t> msg;
+    size_t received = 0;
+    size_t batches = 0;
+    while (received < 1000) {
+        if (channel.popWait(msg, std::chrono::milliseconds(100))) {
+            msgs.clear();
+            received += 1 + channel.popAll(msgs);
+            ++batches;
+        }
+    }
+    producer.join();
+    std::cout << "  popWait + popAll: 1000 messages in " << batches << " batches" << std::endl;
+}
+
+/// Writes payload the way connections do, metadata then content
+size_t writePayload(const vx::Connection::Payload_SharedPtr& p, char *out) {
+    if (p->createMetadataIfNull() == false) {
+        return 0;
+    }
+    memcpy(out, p->getMetadata(), p->metadataSize());
+    memcpy(out + p->metadataSize(), p->getContent(), p->contentSize());
+    return p->totalSize();
+}
+
+/// Allocations and time to broadcast one payload to 100 connections:
+/// - one copy per connection (Payload::copy, like before pooled buffers were introduced)
+/// - one shared payload, pushed as-is to all connections
+/// - a received payload, relayed to all connections
+void benchPayload() {
+    typedef vx::Connection::Payload Payload;
+    const size_t nbConnections = 100;
+    const size_t contentSize = 256;
+    const size_t nbBroadcasts = 1000;
+    const uint8_t includes = Payload::Includes::PayloadID | Payload::Includes::CreatedAt;
+
+    std::vector<char> out(contentSize + 64);
+    std::vector<vx::Connection::Payload_SharedPtr> queued(nbConnections);
+
+    std::cout << "payload (broadcast of " << contentSize << " bytes to " << nbConnections
+              << " connections)" << std::endl;
+    if (MALLOC_COUNT_AVAILABLE == 0) {
+        std::cout << "  (malloc calls can't be counted on this platform)" << std::endl;
+    }
+
+    for (int mode = 0; mode < 3; ++mode) {
+        const uint64_t mallocsBefore = nbMallocs;
+        const Clock::time_point start = Clock::now();
+
+        for (size_t b = 0; b < nbBroadcasts; ++b) {
+            vx::Connection::Payload_SharedPtr p;
+            if (mode == 0) {
+                char *content = static_cast<char *>(malloc(contentSize));
+                memset(content, static_cast<int>(b), contentSize);
+                p = Payload::create(content, contentSize, includes);
+            } else {
+                p = Payload::create(contentSize, includes);
+                memset(p->getContent(), static_cast<int>(b), contentSize);
+            }
+            if (mode == 2) {
+                // encoded then received in a pooled buffer, like WSServerConnection does
+                vx::PayloadBuffer *received = nullptr;
+                size_t len = 0;
+                const size_t n = writePayload(p, out.data());
+                vx::PayloadBuffer::append(received, len, out.data(), n);
+                p = Payload::decode(received, len);
+                received->release();
+            }
+
+            for (size_t c = 0; c < nbConnections; ++c) {
+                queued[c] = mode == 0 ? Payload::copy(p) : p;
+            }
+            for (size_t c = 0; c < nbConnections; ++c) {
+                writePayload(queued[c], out.data());
+                queued[c] = nullptr;
+            }
+        }
+
+        const double seconds = elapsedSeconds(start);
+        const char *names[3] = {"copy per connection", "shared payload", "relayed payload"};
+        std::cout << std::fixed << std::setprecision(1) << "  " << std::left << std::setw(24)
+                  << names[mode] << std::right << std::setw(8)
+                  << static_cast<double>(nbMallocs - mallocsBefore) /
+                         static_cast<double>(nbBroadcasts)
+                  << " allocs/broadcast  " << std::setw(8)
+                  << seconds * 1000000.0 / static_cast<double>(nbBroadcasts) << " us/broadcast"
+                  << std::endl;
+    }
+
+    const vx::PayloadBuffer::PoolStats stats = vx::PayloadBuffer::getPoolStats();
+    std::cout << "  pool: " << stats.allocations << " buffer allocations, " << stats.reuses
+              << " reuses" << std::endl;
+}
+
+/// Synthetic game event content: a batch of small records sharing field names
+std::string makeEventsContent(size_t size, std::mt19937& rng) {
+    const char *types[4] = {"move", "shoot", "chat", "spawn"};
+    std::uniform_int_distribution<int> dist(0, 999);
+    std::string s;
+    while (s.size() < size) {
+        s += "{\"type\":\"" + std::string(types[dist(rng) % 4]) +
+             "\",\"player\":" + std::to_string(dist(rng) % 16) +
+             ",\"pos\":[" + std::to_string(dist(rng)) + "," + std::to_string(dist(rng)) + "," +
+             std::to_string(dist(rng)) + "],\"t\":" + std::to_string(dist(rng)) + "}";
+    }
+    s.resize(size);
+    return s;
+}
+
+/// Compression ratio and time of Compressed payloads, for a few content sizes,
+/// with and without a preset dictionary. Payloads are encoded then decoded.
+void benchCompression() {
+    typedef vx::Connection::Payload Payload;
+    const size_t sizes[4] = {64, 256, 1024, 8192};
+    const size_t nbPayloads = 2000;
+    const uint8_t includes = Payload::Includes::PayloadID | Payload::Includes::Compressed;
+    const std::string dictionary =
+        "{\"type\":\"move\",\"player\":{\"type\":\"shoot\",\"player\":"
+        "{\"type\":\"chat\",\"player\":{\"type\":\"spawn\",\"player\":,\"pos\":[,\"t\":";
+
+    std::cout << "compression (" << nbPayloads << " event payloads per size)" << std::endl;
+
+    std::vector<char> out(16384);
+    for (int withDictionary = 0; withDictionary < 2; ++withDictionary) {
+        Payload::setCompressionDictionary(withDictionary ? dictionary : std::string());
+
+        for (const size_t size : sizes) {
+            std::mt19937 rng(42);
+            const Payload::CompressionStats before = Payload::getCompressionStats();
+            size_t bytesOnWire = 0;
+            bool roundTrip = true;
+
+            for (size_t i = 0; i < nbPayloads; ++i) {
+                const std::string content = makeEventsContent(size, rng);
+                vx::Connection::Payload_SharedPtr p = Payload::create(size, includes);
+                memcpy(p->getContent(), content.data(), size);
+
+                const size_t n = writePayload(p, out.data());
+                bytesOnWire += n;
+
+                vx::PayloadBuffer *received = nullptr;
+                size_t len = 0;
+                vx::PayloadBuffer::append(received, len, out.data(), n);
+                vx::Connection::Payload_SharedPtr decoded = Payload::decode(received, len);
+                received->release();
+                roundTrip = roundTrip && decoded != nullptr && decoded->contentSize() == size &&
+                            memcmp(decoded->getContent(), content.data(), size) == 0;
+            }
+
+            const Payload::CompressionStats after = Payload::getCompressionStats();
+            const uint64_t compressed = after.compressed - before.compressed;
+            const uint64_t bytesIn = after.bytesIn - before.bytesIn;
+            const uint64_t bytesOut = after.bytesOut - before.bytesOut;
+            const uint64_t decompressed = after.decompressed - before.decompressed;
+
+            std::cout << std::fixed << std::setprecision(2) << "  " << std::setw(5) << size
+                      << " bytes" << (withDictionary ? ", dictionary   " : ", no dictionary")
+                      << "  compressed: " << std::setw(4) << compressed << "  ratio: "
+                      << (bytesIn > 0 ? static_cast<double>(bytesOut) / static_cast<double>(bytesIn)
+                                      : 1.0)
+                      << "  wire: " << std::setw(5) << bytesOnWire / nbPayloads
+                      << " B/payload  deflate: " << std::setw(6)
+                      << (compressed > 0 ? static_cast<double>(after.compressionTimeUs -
+                                                               before.compressionTimeUs) /
+                                               static_cast<double>(compressed)
+                                         : 0.0)
+                      << " us  inflate: " << std::setw(6)
+                      << (decompressed > 0 ? static_cast<double>(after.decompressionTimeUs -
+                                                                 before.decompressionTimeUs) /
+                                                 static_cast<double>(decompressed)
+                                           : 0.0)
+                      << " us" << (roundTrip ? "" : "  ROUND TRIP FAILED") << std::endl;
+        }
+    }
+    Payload::setCompressionDictionary(std::string());
+}
+
+/// Refreshes `root` hierarchy one transform at a time, breadth-first,
+/// like scene_refresh did before batched hierarchy refresh
+size_t refreshTransformsOneByOne(Transform *root) {
+    size_t refreshed = 0;
+    FifoList *toExamine = fifo_list_new();
+    Transform *t = root;
+    while (t != nullptr) {
+        if (transform_is_hierarchy_dirty(t)) {
+            transform_refresh(t, true, false);
+            ++refreshed;
+        }
+        DoublyLinkedListNode *n = transform_get_children_iterator(t);
+        while (n != nullptr) {
+            Transform *child = static_cast<Transform *>(doubly_linked_list_node_pointer(n));
+            if (transform_is_hierarchy_dirty(t)) {
+                transform_set_children_dirty(child);
+            }
+            fifo_list_push(toExamine, child);
+            n = doubly_linked_list_node_next(n);
+        }
+        transform_reset_children_dirty(t);
+        t = static_cast<Transform *>(fifo_list_pop(toExamine));
+    }
+    fifo_list_free(toExamine, nullptr);
+    return refreshed;
+}
+
+/// Time to refresh world matrices of 10k and 100k transforms (4 children per transform),
+/// when all of them are dirty (root moved) or ~1% of them (random transforms moved),
+/// one transform at a time vs. transform_refresh_hierarchy
+void benchTransform() {
+    const size_t sizes[2] = {10000, 100000};
+    const int nbRefreshes = 20;
+
+    std::cout << "transform (world matrices refresh, average of " << nbRefreshes << ")"
+              << std::endl;
+
+    for (const size_t size : sizes) {
+        std::vector<Transform *> transforms;
+        transforms.reserve(size);
+        std::mt19937 rng(42);
+        std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+        for (size_t i = 0; i < size; ++i) {
+            Transform *t = transform_new(HierarchyTransform);
+            transform_set_local_position(t, dist(rng), dist(rng), dist(rng));
+            transform_set_local_rotation_euler(t, dist(rng), dist(rng), dist(rng));
+            if (i > 0) {
+                transform_set_parent(t, transforms[(i - 1) / 4], false);
+                transform_release(t); // retained by parent
+            }
+            transforms.push_back(t);
+        }
+        Transform *root = transforms[0];
+        transform_refresh_hierarchy(root, false);
+
+        for (int scenario = 0; scenario < 2; ++scenario) {
+            for (int batched = 0; batched < 2; ++batched) {
+                std::mt19937 moves(7); // same transforms are moved in both modes
+                double seconds = 0.0;
+                size_t refreshed = 0;
+                for (int r = 0; r < nbRefreshes; ++r) {
+                    if (scenario == 0) {
+                        transform_set_local_position(root, static_cast<float>(r), 0.0f, 0.0f);
+                    } else {
+                        for (size_t i = 0; i < size / 100; ++i) {
+                            Transform *t = transforms[moves() % size];
+                            transform_set_local_position(t, dist(moves), dist(moves), dist(moves));
+                        }
+                    }
+                    const Clock::time_point start = Clock::now();
+                    refreshed += batched ? transform_refresh_hierarchy(root, false)
+                                         : refreshTransformsOneByOne(root);
+                    seconds += elapsedSeconds(start);
+                }
+                std::cout << std::fixed << std::setprecision(3) << "  " << std::setw(6) << size
+                          << (scenario == 0 ? " all dirty " : " 1% moved  ")
+                          << (batched ? "batch       " : "one by one  ") << std::setw(8)
+                          << seconds * 1000.0 / nbRefreshes << " ms/refresh  " << std::setw(6)
+                          << refreshed / nbRefreshes << " refreshed" << std::endl;
+            }
+        }
+
+        transform_release(root);
+    }
+}
+
+// Scalar implementations math kernels had before vectorization, used as reference.
+// They're called through volatile pointers so that they're not inlined in benchmark loops,
+// like library functions they replaced.
+
+void refMatrixMultiply(const Matrix4x4 *m1, const Matrix4x4 *m2, Matrix4x4 *r) {
+    const float *a = reinterpret_cast<const float *>(m1);
+    const float *b = reinterpret_cast<const float *>(m2);
+    float *out = reinterpret_cast<float *>(r);
+    for (int c = 0; c < 4; ++c) {
+        for (int i = 0; i < 4; ++i) {
+            out[c * 4 + i] = a[i] * b[c * 4] + a[4 + i] * b[c * 4 + 1] + a[8 + i] * b[c * 4 + 2] +
+                             a[12 + i] * b[c * 4 + 3];
+        }
+    }
+}
+
+void refVecPoint(float3 *r, const float3 *v, const Matrix4x4 *m) {
+    r->x = v->x * m->x1y1 + v->y * m->x2y1 + v->z * m->x3y1 + m->x4y1;
+    r->y = v->x * m->x1y2 + v->y * m->x2y2 + v->z * m->x3y2 + m->x4y2;
+    r->z = v->x * m->x1y3 + v->y * m->x2y3 + v->z * m->x3y3 + m->x4y3;
+}
+
+void refBoxToAABox(const Box *b, Box *aab, const Matrix4x4 *m) {
+    float3 corner, p;
+    for (int i = 0; i < 8; ++i) {
+        corner.x = (i & 1) ? b->max.x : b->min.x;
+        corner.y = (i & 2) ? b->max.y : b->min.y;
+        corner.z = (i & 4) ? b->max.z : b->min.z;
+        refVecPoint(&p, &corner, m);
+        if (i == 0) {
+            aab->min = p;
+            aab->max = p;
+        } else {
+            aab->min = {std::min(aab->min.x, p.x), std::min(aab->min.y, p.y), std::min(aab->min.z, p.z)};
+            aab->max = {std::max(aab->max.x, p.x), std::max(aab->max.y, p.y), std::max(aab->max.z, p.z)};
+        }
+    }
+}
+
+void (*volatile refMatrixMultiplyFn)(const Matrix4x4 *,
+                                     const Matrix4x4 *,
+                                     Matrix4x4 *) = refMatrixMultiply;
+void (*volatile refVecPointFn)(float3 *, const float3 *, const Matrix4x4 *) = refVecPoint;
+void (*volatile refBoxToAABoxFn)(const Box *, Box *, const Matrix4x4 *) = refBoxToAABox;
+
+/// Largest difference between two float arrays, relative to values above 1
+float maxError(const float *a, const float *b, size_t count) {
+    float err = 0.0f;
+    for (size_t i = 0; i < count; ++i) {
+        err = std::max(err, std::fabs(a[i] - b[i]) / std::max(1.0f, std::fabs(b[i])));
+    }
+    return err;
+}
+
+void printMathResult(const char *name,
+                     const char *mode,
+                     double seconds,
+                     double refSeconds,
+                     size_t count,
+                     float error) {
+    std::cout << std::fixed << std::setprecision(2) << "  " << std::left << std::setw(16) << name
+              << std::setw(14) << mode << std::right << std::setw(8) << seconds * 1e9 / count
+              << " ns/op  x" << std::setw(5) << refSeconds / seconds
+              << std::setprecision(8) << "  max error: " << error
+              << (error <= EPSILON_ZERO ? "" : "  ABOVE EPSILON") << std::endl;
+}
+
+/// Vectorized math kernels vs. their previous scalar implementation: matrix product,
+/// point transform (one by one & batch) and box to axis-aligned box (one by one & batch),
+/// results are compared with EPSILON_ZERO
+void benchMath() {
+    const size_t count = 100000;
+    const int nbRuns = 20;
+
+    std::cout << "math (" << count << " operations, best of " << nbRuns << ")" << std::endl;
+
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<float> dist(-10.0f, 10.0f);
+    std::vector<Matrix4x4> matrices(count);
+    std::vector<float3> points(count);
+    std::vector<Box> boxes(count);
+    for (size_t i = 0; i < count; ++i) {
+        matrix4x4_set_from_euler_xyz(&matrices[i], dist(rng), dist(rng), dist(rng));
+        matrices[i].x4y1 = dist(rng);
+        matrices[i].x4y2 = dist(rng);
+        matrices[i].x4y3 = dist(rng);
+        points[i] = {dist(rng), dist(rng), dist(rng)};
+        boxes[i].min = points[i];
+        boxes[i].max = {points[i].x + 1.0f, points[i].y + 2.0f, points[i].z + 3.0f};
+    }
+    const Matrix4x4 &mtx = matrices[0];
+
+    // runs `f` nbRuns times, returns best time
+    auto best = [nbRuns](const std::function<void()>& f) {
+        double bestSeconds = 1e9;
+        for (int r = 0; r < nbRuns; ++r) {
+            const Clock::time_point start = Clock::now();
+            f();
+            bestSeconds = std::min(bestSeconds, elapsedSeconds(start));
+        }
+        return bestSeconds;
+    };
+
+    // matrix product
+    {
+        std::vector<Matrix4x4> expected(count), results(count);
+        const double ref = best([&]() {
+            void (*const f)(const Matrix4x4 *, const Matrix4x4 *, Matrix4x4 *) = refMatrixMultiplyFn;
+            for (size_t i = 1; i < count; ++i) {
+                f(&matrices[i - 1], &matrices[i], &expected[i]);
+            }
+        });
+        const double full = best([&]() {
+            for (size_t i = 1; i < count; ++i) {
+                results[i] = matrices[i];
+                matrix4x4_op_multiply_2(&matrices[i - 1], &results[i]);
+            }
+        });
+        const float fullError = maxError(reinterpret_cast<float *>(&results[1]),
+                                         reinterpret_cast<float *>(&expected[1]),
+                                         (count - 1) * 16);
+        const double affine = best([&]() {
+            for (size_t i = 1; i < count; ++i) {
+                matrix4x4_op_multiply_affine(&matrices[i - 1], &matrices[i], &results[i]);
+            }
+        });
+        printMathResult("matrix product", "scalar", ref, ref, count, 0.0f);
+        printMathResult("", "simd", full, ref, count, fullError);
+        printMathResult("",
+                        "simd affine",
+                        affine,
+                        ref,
+                        count,
+                        maxError(reinterpret_cast<float *>(&results[1]),
+                                 reinterpret_cast<float *>(&expected[1]),
+                                 (count - 1) * 16));
+    }
+
+    // point transform
+    {
+        std::vector<float3> expected(count), results(count);
+        const double ref = best([&]() {
+            void (*const f)(float3 *, const float3 *, const Matrix4x4 *) = refVecPointFn;
+            for (size_t i = 0; i < count; ++i) {
+                f(&expected[i], &points[i], &mtx);
+            }
+        });
+        const double single = best([&]() {
+            for (size_t i = 0; i < count; ++i) {
+                matrix4x4_op_multiply_vec_point(&results[i], &points[i], &mtx);
+            }
+        });
+        const float singleError = maxError(&results[0].x, &expected[0].x, count * 3);
+        const double batch = best([&]() {
+            matrix4x4_op_multiply_vec_points(results.data(), points.data(), count, &mtx);
+        });
+        printMathResult("point transform", "scalar", ref, ref, count, 0.0f);
+        printMathResult("", "simd", single, ref, count, singleError);
+        printMathResult("",
+                        "simd batch",
+                        batch,
+                        ref,
+                        count,
+                        maxError(&results[0].x, &expected[0].x, count * 3));
+    }
+
+    // box to axis-aligned box
+    {
+        std::vector<Box> expected(count), results(count);
+        float error = 0.0f;
+        const double ref = best([&]() {
+            void (*const f)(const Box *, Box *, const Matrix4x4 *) = refBoxToAABoxFn;
+            for (size_t i = 0; i < count; ++i) {
+                f(&boxes[i], &expected[i], &mtx);
+            }
+        });
+        const double single = best([&]() {
+            for (size_t i = 0; i < count; ++i) {
+                box_to_aabox2(&boxes[i], &results[i], &mtx, nullptr, NoSquarify);
+            }
+        });
+        for (size_t i = 0; i < count; ++i) {
+            error = std::max(error, maxError(&results[i].min.x, &expected[i].min.x, 3));
+            error = std::max(error, maxError(&results[i].max.x, &expected[i].max.x, 3));
+        }
+        const double batch = best([&]() {
+            box_to_aaboxes(boxes.data(), results.data(), count, &mtx, nullptr);
+        });
+        float batchError = 0.0f;
+        for (size_t i = 0; i < count; ++i) {
+            batchError = std::max(batchError, maxError(&results[i].min.x, &expected[i].min.x, 3));
+            batchError = std::max(batchError, maxError(&results[i].max.x, &expected[i].max.x, 3));
+        }
+        printMathResult("box to aabox", "scalar", ref, ref, count, 0.0f);
+        printMathResult("", "simd", single, ref, count, error);
+        printMathResult("", "simd batch", batch, ref, count, batchError);
+    }
+}
+
+/// Orders cast results like doubly_linked_list_sort_ascending did before, swapping pointers
+/// between compared nodes, O(n²)
+void sortCastResultsQuadratic(DoublyLinkedList *list) {
+    DoublyLinkedListNode *last = doubly_linked_list_last(list);
+    while (last != nullptr) {
+        DoublyLinkedListNode *current = doubly_linked_list_first(list);
+        while (current != last) {
+            RtreeCastResult *a = static_cast<RtreeCastResult *>(
+                doubly_linked_list_node_pointer(current));
+            RtreeCastResult *b = static_cast<RtreeCastResult *>(
+                doubly_linked_list_node_pointer(last));
+            if (a->distance > b->distance) {
+                std::swap(*a, *b);
+            }
+            current = doubly_linked_list_node_next(current);
+        }
+        last = doubly_linked_list_node_previous(last);
+    }
+}
+
+/// Ray cast through an R-tree where the ray crosses 16 to 5000 leaves, ordering all
+/// candidate hits: heap-allocated results in a list sorted in O(n²) (previous implementation),
+/// flat results sorted, flat results in a heap popping only the nearest hit
+void benchCast() {
+    const size_t sizes[4] = {16, 100, 1000, 5000};
+    const int nbRuns = 20;
+
+    std::cout << "cast (ray cast all + ordering, best of " << nbRuns << ")" << std::endl;
+
+    for (const size_t size : sizes) {
+        Rtree *r = rtree_new(2, 8);
+        std::vector<size_t> order(size);
+        for (size_t i = 0; i < size; ++i) {
+            order[i] = i;
+        }
+        std::shuffle(order.begin(), order.end(), std::mt19937(42));
+        for (const size_t i : order) {
+            const float x = static_cast<float>(i) * 2.0f;
+            Box b = {{x, 0.0f, 0.0f}, {x + 1.0f, 1.0f, 1.0f}};
+            rtree_create_and_insert(r, &b, 1, 1, reinterpret_cast<void *>(i + 1));
+        }
+        const float3 origin = {-1.0f, 0.5f, 0.5f};
+        Ray *ray = ray_new(&origin, &float3_right);
+
+        for (int mode = 0; mode < 3; ++mode) {
+            double best = 1e9;
+            float nearest = 0.0f;
+            for (int run = 0; run < nbRuns; ++run) {
+                const Clock::time_point start = Clock::now();
+                RtreeCastResults results;
+                rtree_cast_results_init(&results);
+                rtree_query_cast_all_ray(r, ray, 1, 1, nullptr, &results);
+                if (mode == 0) {
+                    DoublyLinkedList *list = doubly_linked_list_new();
+                    for (size_t i = 0; i < results.count; ++i) {
+                        RtreeCastResult *result = static_cast<RtreeCastResult *>(
+                            malloc(sizeof(RtreeCastResult)));
+                        *result = results.results[i];
+                        doubly_linked_list_push_last(list, result);
+                    }
+                    sortCastResultsQuadratic(list);
+                    nearest = static_cast<RtreeCastResult *>(
+                                  doubly_linked_list_node_pointer(doubly_linked_list_first(list)))
+                                  ->distance;
+                    doubly_linked_list_flush(list, free);
+                    doubly_linked_list_free(list);
+                } else if (mode == 1) {
+                    rtree_cast_results_sort(&results);
+                    nearest = results.results[0].distance;
+                } else {
+                    rtree_cast_results_make_heap(&results);
+                    RtreeCastResult hit;
+                    rtree_cast_results_pop_nearest(&results, &hit);
+                    nearest = hit.distance;
+                }
+                rtree_cast_results_dispose(&results);
+                best = std::min(best, elapsedSeconds(start));
+            }
+            const char *modes[3] = {"list O(n²)", "flat sort", "flat heap"};
+            std::cout << std::fixed << std::setprecision(2) << "  " << std::setw(5) << size
+                      << " hits  " << std::left << std::setw(12) << modes[mode] << std::right
+                      << std::setw(10) << best * 1e6 << " us  nearest: " << nearest << std::endl;
+        }
+
+        ray_free(ray);
+        rtree_free(r);
+    }
+}
+
+/// Cost of deterministic physics: 100 and 1000 bodies bouncing around over a floor of tiles,
+/// stepped at 60Hz, w/ contacts solved in r-tree order (default) or in deterministic order,
+/// and w/ a state hash computed every step like a replay does
+void benchPhysics() {
+    const size_t sizes[2] = {100, 1000};
+    const int nbSteps = 300;
+
+    std::cout << "physics (60Hz steps, average of " << nbSteps << ")" << std::endl;
+
+    for (const size_t size : sizes) {
+        for (int mode = 0; mode < 3; ++mode) {
+            Scene *sc = scene_new(nullptr);
+            const float gravity = PHYSICS_GRAVITY;
+            scene_set_constant_acceleration(sc, nullptr, &gravity, nullptr);
+            scene_set_fixed_timestep(sc, 60, 1);
+            scene_set_deterministic(sc, mode > 0);
+
+            // tiles and bodies are copies of a 1x1x1 static and dynamic rigidbody
+            const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+            Transform *models[2];
+            for (int i = 0; i < 2; ++i) {
+                RigidBody *rb = nullptr;
+                models[i] = transform_new(PointTransform);
+                transform_ensure_rigidbody(models[i],
+                                           i == 0 ? RigidbodyMode_Static : RigidbodyMode_Dynamic,
+                                           PHYSICS_GROUP_DEFAULT_OBJECT,
+                                           PHYSICS_COLLIDESWITH_DEFAULT_OBJECT,
+                                           &rb);
+                rigidbody_set_collider(rb, &cube, true);
+            }
+            auto add = [sc](const Transform *model, const float3 &pos) {
+                Transform *t = transform_new(PointTransform);
+                transform_ensure_rigidbody_copy(t, model);
+                transform_set_position_vec(t, &pos);
+                transform_set_parent(t, scene_get_root(sc), false);
+                transform_release(t); // retained by scene hierarchy
+                return t;
+            };
+
+            const int side = static_cast<int>(std::sqrt(static_cast<double>(size))) * 2;
+            for (int x = 0; x < side; ++x) {
+                for (int z = 0; z < side; ++z) {
+                    add(models[0], {static_cast<float>(x), -1.0f, static_cast<float>(z)});
+                }
+            }
+            std::mt19937 rng(42); // same bodies in all modes
+            std::uniform_real_distribution<float> dist(-8.0f, 8.0f);
+            for (size_t i = 0; i < size; ++i) {
+                const float3 pos = {static_cast<float>(i % (side / 2)) * 2.0f,
+                                    2.0f + static_cast<float>(i / (side / 2)) * 0.5f,
+                                    static_cast<float>(i / (side / 2)) * 2.0f};
+                Transform *t = add(models[1], pos);
+                const float3 velocity = {dist(rng), dist(rng), dist(rng)};
+                rigidbody_set_velocity(transform_get_rigidbody(t), &velocity);
+            }
+
+            uint32_t hash = 0;
+            const Clock::time_point start = Clock::now();
+            for (int step = 0; step < nbSteps; ++step) {
+                scene_refresh(sc, 1.0 / 60.0, nullptr);
+                if (mode == 2) {
+                    hash = scene_get_physics_hash(sc, hash);
+                }
+            }
+            const double seconds = elapsedSeconds(start);
+
+            const char *modes[3] = {"default", "deterministic", "determ. + hash"};
+            std::cout << std::fixed << std::setprecision(3) << "  " << std::setw(5) << size
+                      << " bodies  " << std::left << std::setw(16) << modes[mode] << std::right
+                      << std::setw(8) << seconds * 1000.0 / nbSteps << " ms/step  hash: "
+                      << std::hex << hash << std::dec << std::endl;
+
+            scene_free(sc);
+            transform_release(models[0]);
+            transform_release(models[1]);
+        }
+    }
+}
+
+/// HashUInt32Int implementation prior to open addressing, for comparison: a trie of 16-slot
+/// nodes walked 2 bits at a time, one allocation per node and per value
+class TrieHashUInt32Int {
+public:
+    ~TrieHashUInt32Int() {
+        freeNode(&_root, 1);
+    }
+
+    void set(uint32_t key, int value) {
+        Node *n = &_root;
+        for (int level = 1; level < LEVELS; ++level) {
+            void *& slot = n->slots[key & 15];
+            if (slot == nullptr) {
+                slot = new Node();
+            }
+            n = static_cast<Node *>(slot);
+            key >>= 2;
+        }
+        void *& slot = n->slots[key & 15];
+        if (slot == nullptr) {
+            slot = new int;
+        }
+        *static_cast<int *>(slot) = value;
+    }
+
+    bool get(uint32_t key, int *outValue) const {
+        const Node *n = &_root;
+        for (int level = 1; level < LEVELS; ++level) {
+            n = static_cast<const Node *>(n->slots[key & 15]);
+            if (n == nullptr) {
+                return false;
+            }
+            key >>= 2;
+        }
+        const int *v = static_cast<const int *>(n->slots[key & 15]);
+        if (v == nullptr) {
+            return false;
+        }
+        *outValue = *v;
+        return true;
+    }
+
+private:
+    static const int LEVELS = 14;
+
+    struct Node {
+        void *slots[16] = {};
+    };
+
+    void freeNode(Node *n, int level) {
+        for (void *slot : n->slots) {
+            if (slot == nullptr) {
+                continue;
+            }
+            if (level < LEVELS) {
+                freeNode(static_cast<Node *>(slot), level + 1);
+                delete static_cast<Node *>(slot);
+            } else {
+                delete static_cast<int *>(slot);
+            }
+        }
+    }
+
+    Node _root;
+};
+
+/// MapStringFloat3 implementation prior to open addressing, for comparison: a linked list,
+/// newest entry first, searched with strcmp
+class ListMapStringFloat3 {
+public:
+    ~ListMapStringFloat3() {
+        while (_list != nullptr) {
+            Node *next = _list->next;
+            float3_free(_list->value);
+            free(_list->key);
+            delete _list;
+            _list = next;
+        }
+    }
+
+    void set(const char *key, float3 *f3) {
+        for (Node *n = _list; n != nullptr; n = n->next) {
+            if (strcmp(key, n->key) == 0) {
+                float3_free(n->value);
+                n->value = f3;
+                return;
+            }
+        }
+        Node *n = new Node();
+        n->key = static_cast<char *>(malloc(strlen(key) + 1));
+        strcpy(n->key, key);
+        n->value = f3;
+        n->next = _list;
+        _list = n;
+    }
+
+    const float3 *get(const char *key) const {
+        for (const Node *n = _list; n != nullptr; n = n->next) {
+            if (strcmp(key, n->key) == 0) {
+                return n->value;
+            }
+        }
+        return nullptr;
+    }
+
+    float sumX() const {
+        float sum = 0.0f;
+        for (const Node *n = _list; n != nullptr; n = n->next) {
+            sum += n->value->x;
+        }
+        return sum;
+    }
+
+private:
+    struct Node {
+        char *key;
+        float3 *value;
+        Node *next;
+    };
+
+    Node *_list = nullptr;
+};
+
+/// Prints nanoseconds per operation for one map operation
+void printMapOp(const char *op, double seconds, size_t nbOps, uint64_t check) {
+    std::cout << "    " << std::left << std::setw(8) << op << std::right << std::fixed
+              << std::setprecision(1) << std::setw(10) << seconds * 1e9 / static_cast<double>(nbOps)
+              << " ns/op  (" << check << ")" << std::endl;
+}
+
+/// Insert, lookup & iterate (MapStringFloat3 only, HashUInt32Int can't be iterated, iterating
+/// includes MapStringFloat3Iterator allocation):
+/// - HashUInt32Int from palette sized to large sets of colors, trie (previous implementation)
+///   vs. open addressing
+/// - MapStringFloat3 w/ typical POI counts (inline storage) to large maps, linked list
+///   (previous implementation) vs. inline / open addressing, and shape_make_copy like copies
+void benchMaps() {
+    const size_t hashSizes[3] = {256, 10000, 100000};
+    const size_t mapSizes[4] = {4, 8, 64, 1000};
+    const size_t nbLookups = 1000000;
+
+    std::cout << "maps (ns per operation)" << std::endl;
+
+    for (const size_t size : hashSizes) {
+        std::vector<uint32_t> keys(size);
+        std::mt19937 rng(42);
+        for (uint32_t& key : keys) {
+            key = static_cast<uint32_t>(rng()) | 0xFF000000; // opaque colors
+        }
+
+        for (int mode = 0; mode < 2; ++mode) {
+            std::cout << "  HashUInt32Int  " << std::setw(6) << size << " keys  "
+                      << (mode == 0 ? "trie" : "open addressing") << std::endl;
+            TrieHashUInt32Int trie;
+            HashUInt32Int *h = mode == 1 ? hash_uint32_int_new() : nullptr;
+
+            Clock::time_point start = Clock::now();
+            for (size_t i = 0; i < size; ++i) {
+                if (mode == 0) {
+                    trie.set(keys[i], static_cast<int>(i));
+                } else {
+                    hash_uint32_int_set(h, keys[i], static_cast<int>(i));
+                }
+            }
+            printMapOp("insert", elapsedSeconds(start), size, size);
+
+            uint64_t sum = 0;
+            int v = 0;
+            start = Clock::now();
+            for (size_t i = 0; i < nbLookups; ++i) {
+                const uint32_t key = keys[(i * 7919) % size];
+                if (mode == 0 ? trie.get(key, &v) : hash_uint32_int_get(h, key, &v)) {
+                    sum += static_cast<uint64_t>(v);
+                }
+            }
+            printMapOp("lookup", elapsedSeconds(start), nbLookups, sum);
+
+            hash_uint32_int_free(h);
+        }
+    }
+
+    for (const size_t size : mapSizes) {
+        std::vector<std::string> keys(size);
+        for (size_t i = 0; i < size; ++i) {
+            keys[i] = "point_of_interest_" + std::to_string(i);
+        }
+        const size_t nbRuns = std::max(static_cast<size_t>(1), 100000 / size);
+
+        for (int mode = 0; mode < 2; ++mode) {
+            std::cout << "  MapStringFloat3  " << std::setw(4) << size << " keys  "
+                      << (mode == 0 ? "linked list" : "open addressing") << std::endl;
+            double insertSeconds = 0.0;
+            double lookupSeconds = 0.0;
+            double iterateSeconds = 0.0;
+            double copySeconds = 0.0;
+            uint64_t found = 0;
+            float sum = 0.0f;
+
+            for (size_t run = 0; run < nbRuns; ++run) {
+                ListMapStringFloat3 list;
+                MapStringFloat3 *m = mode == 1 ? map_string_float3_new() : nullptr;
+
+                Clock::time_point start = Clock::now();
+                for (size_t i = 0; i < size; ++i) {
+                    float3 *f3 = float3_new(static_cast<float>(i), 0.0f, 0.0f);
+                    if (mode == 0) {
+                        list.set(keys[i].c_str(), f3);
+                    } else {
+                        map_string_float3_set_key_value(m, keys[i].c_str(), f3);
+                    }
+                }
+                insertSeconds += elapsedSeconds(start);
+
+                start = Clock::now();
+                for (size_t i = 0; i < size; ++i) {
+                    const char *key = keys[(i * 7919) % size].c_str();
+                    if ((mode == 0 ? list.get(key) : map_string_float3_value_for_key(m, key)) !=
+                        nullptr) {
+                        ++found;
+                    }
+                }
+                lookupSeconds += elapsedSeconds(start);
+
+                start = Clock::now();
+                if (mode == 0) {
+                    sum += list.sumX();
+                } else {
+                    MapStringFloat3Iterator *it = map_string_float3_iterator_new(m);
+                    while (map_string_float3_iterator_is_done(it) == false) {
+                        sum += map_string_float3_iterator_current_value(it)->x;
+                        map_string_float3_iterator_next(it);
+                    }
+                    map_string_float3_iterator_free(it);
+                }
+                iterateSeconds += elapsedSeconds(start);
+
+                // copies like shape_make_copy: re-inserting each entry vs. map copy
+                start = Clock::now();
+                if (mode == 0) {
+                    ListMapStringFloat3 copy;
+                    for (size_t i = 0; i < size; ++i) {
+                        copy.set(keys[i].c_str(), float3_new_copy(list.get(keys[i].c_str())));
+                    }
+                } else {
+                    map_string_float3_free(map_string_float3_new_copy(m));
+                }
+                copySeconds += elapsedSeconds(start);
+
+                map_string_float3_free(m);
+            }
+
+            const size_t nbOps = size * nbRuns;
+            printMapOp("insert", insertSeconds, nbOps, nbOps);
+            printMapOp("lookup", lookupSeconds, nbOps, found);
+            printMapOp("iterate", iterateSeconds, nbOps, static_cast<uint64_t>(sum));
+            printMapOp("copy", copySeconds, nbOps, nbOps);
+        }
+    }
+}
+
+struct Bench {
+    const char *name;
+    void (*run)();
+};
+
+const Bench benches[] = {
+    {"operation_queue", benchOperationQueue},
+    {"channel", benchChannel},
+    {"payload", benchPayload},
+    {"compression", benchCompression},
+    {"transform", benchTransform},
+    {"math", benchMath},
+    {"cast", benchCast},
+    {"physics", benchPhysics},
+    {"maps", benchMaps},
+};
+
+} // namespace
+
+bool command_bench(cxxopts::ParseResult parseResult, std::string& err) {
+    std::vector<std::string> names;
+    if (parseResult.count("bench") > 0) {
+        names = parseResult["bench"].as<std::vector<std::string>>();
+    }
+
+    for (const std::string& name : names) {
+        bool found = false;
+        for (const Bench& b : benches) {
+            found = found || name == b.name;
+        }
+        if (found == false) {
+            err = "unknown benchmark: " + name;
+            return false;
+        }
+    }
+
+    for (const Bench& b : benches) {
+        if (names.empty() || std::find(names.begin(), names.end(), b.name) != names.end()) {
+            b.run();
+        }
+    }
+    return true;
+}
@@ -0,0 +1,20 @@
+//
+//  bench.hpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <string>
+
+// cxxopts
+#include <cxxopts.hpp>
+
+/// Runs micro benchmarks and prints their results.
+/// Benchmarks to run are listed with the `bench` option (all of them by default).
+/// Returns true on success, false otherwise.
+/// When an error occured, the `err` argument is filled with an error message.
+bool command_bench(cxxopts::ParseResult parseResult, std::string& err);
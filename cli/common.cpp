@@ -0,0 +1,39 @@
+//
+//  common.cpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "common.hpp"
+
+// C++
+#include <algorithm>
+#include <cctype>
+
+double elapsedMs(const Clock::time_point& start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+std::string lowercase(std::string s) {
+    std::transform(s.begin(), s.end(), s.begin(), [](unsigned char c) {
+        return static_cast<char>(std::tolower(c));
+    });
+    return s;
+}
+
+std::string lowercaseExtension(const std::filesystem::path& path) {
+    return lowercase(path.extension().string());
+}
+
+size_t bakeLighting(Shape *shape, bool onlyMissing) {
+    size_t baked = 0;
+    forEachShape(shape, 0, [onlyMissing, &baked](Shape *s, int) {
+        if (onlyMissing && shape_uses_baked_lighting(s)) {
+            return;
+        }
+        shape_compute_baked_lighting(s);
+        ++baked;
+    });
+    return baked;
+}
@@ -0,0 +1,49 @@
+//
+//  common.hpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <chrono>
+#include <filesystem>
+#include <string>
+
+// Cubzh Core
+#include "shape.h"
+#include "transform.h"
+
+typedef std::chrono::steady_clock Clock;
+
+/// Milliseconds elapsed since `start`
+double elapsedMs(const Clock::time_point& start);
+
+/// ASCII lowercase copy of `s`
+std::string lowercase(std::string s);
+
+/// Lowercase extension of `path`, dot included (e.g. ".3zh")
+std::string lowercaseExtension(const std::filesystem::path& path);
+
+/// Calls `f(shape, depth)` on given shape and all shapes in its hierarchy, depth first
+template <typename F>
+void forEachShape(Shape *shape, int depth, const F& f) {
+    f(shape, depth);
+
+    DoublyLinkedListNode *n = transform_get_children_iterator(shape_get_root_transform(shape));
+    while (n != nullptr) {
+        Shape *child = transform_utils_get_shape((Transform *)doubly_linked_list_node_pointer(n));
+        if (child != nullptr) {
+            forEachShape(child, depth + 1, f);
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+}
+
+/// Computes baked lighting for given shape and all shapes in its hierarchy.
+/// When `onlyMissing` is true, shapes that already have baked lighting (e.g. loaded from a
+/// .3zh file with lighting data) are left untouched.
+/// Returns the number of shapes that have been baked.
+size_t bakeLighting(Shape *shape, bool onlyMissing);
@@ -0,0 +1,429 @@
+//
+//  convert.cpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "convert.hpp"
+
+// C++
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// cli
+#include "common.hpp"
+
+// Cubzh Core
+#include "chunk.h"
+#include "color_atlas.h"
+#include "serialization.h"
+#include "serialization_vox.h"
+#include "shape.h"
+#include "stream.h"
+#include "transform.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+enum class AssetFormat {
+    Unknown,
+    Cubzh, // .3zh (or legacy .pcubes)
+    Vox    // .vox (MagicaVoxel)
+};
+
+struct ConvertJob {
+    std::string inputPath;
+    std::string outputPath;
+    std::string tmpPath; // unique per job, workers never share it
+    AssetFormat inputFormat;
+    AssetFormat outputFormat;
+};
+
+struct ConvertResult {
+    bool success = false;
+    std::string err;
+    double loadMs = 0.0;
+    double processMs = 0.0;
+    double saveMs = 0.0;
+    uintmax_t inputBytes = 0;
+    uintmax_t outputBytes = 0;
+};
+
+struct ConvertOptions {
+    bool bake = false;
+};
+
+AssetFormat formatFromExtension(const fs::path& path) {
+    const std::string ext = lowercaseExtension(path);
+    if (ext == ".3zh" || ext == ".pcubes") {
+        return AssetFormat::Cubzh;
+    } else if (ext == ".vox") {
+        return AssetFormat::Vox;
+    }
+    return AssetFormat::Unknown;
+}
+
+AssetFormat formatFromName(const std::string& name) {
+    const std::string n = lowercase(name);
+    if (n == "3zh") {
+        return AssetFormat::Cubzh;
+    } else if (n == "vox") {
+        return AssetFormat::Vox;
+    }
+    return AssetFormat::Unknown;
+}
+
+const char *extensionForFormat(const AssetFormat format) {
+    return format == AssetFormat::Vox ? ".vox" : ".3zh";
+}
+
+/// Loads, transforms and saves one file. `colorAtlas` belongs to the calling worker.
+ConvertResult convertFile(const ConvertJob& job, const ConvertOptions& options, ColorAtlas *colorAtlas) {
+    ConvertResult result;
+
+    std::error_code ec;
+    result.inputBytes = fs::file_size(job.inputPath, ec);
+
+    // load
+
+    Clock::time_point start = Clock::now();
+
+    FILE *fd = fopen(job.inputPath.c_str(), "rb");
+    if (fd == nullptr) {
+        result.err = "can't open input file";
+        return result;
+    }
+    // The file descriptor is owned by the stream, which will fclose it.
+    Stream *stream = stream_new_file_read(fd);
+
+    Shape *shape = nullptr;
+    if (job.inputFormat == AssetFormat::Cubzh) {
+        // keep existing baked lighting if writing a .3zh file again
+        ShapeSettings settings = {
+            .lighting = job.outputFormat == AssetFormat::Cubzh,
+            .isMutable = false
+        };
+        shape = serialization_load_shape(stream, // frees stream, closing fd
+                                         "",
+                                         colorAtlas,
+                                         &settings,
+                                         true); // allowLegacy
+    } else {
+        const enum serialization_vox_error error = serialization_vox_load(stream,
+                                                                          &shape,
+                                                                          false,
+                                                                          colorAtlas);
+        stream_free(stream);
+        if (error != no_error && shape != nullptr) {
+            shape_release(shape);
+            shape = nullptr;
+        }
+    }
+    result.loadMs = elapsedMs(start);
+
+    if (shape == nullptr) {
+        result.err = "can't parse input file";
+        return result;
+    }
+
+    // transform
+
+    start = Clock::now();
+    if (options.bake) {
+        bakeLighting(shape, false);
+    }
+    result.processMs = elapsedMs(start);
+
+    // save, in a temporary file first not to leave a truncated file behind on failure
+
+    start = Clock::now();
+
+    const fs::path outputPath(job.outputPath);
+    if (outputPath.has_parent_path()) {
+        fs::create_directories(outputPath.parent_path(), ec);
+    }
+    const std::string& tmpPath = job.tmpPath;
+
+    bool saved = false;
+    FILE *out = fopen(tmpPath.c_str(), "wb");
+    if (out == nullptr) {
+        result.err = "can't create output file";
+    } else if (job.outputFormat == AssetFormat::Cubzh) {
+        void *preview = nullptr;
+        uint32_t previewSize = 0;
+        if (job.inputFormat == AssetFormat::Cubzh) {
+            get_preview_data(job.inputPath.c_str(), &preview, &previewSize);
+        }
+        saved = serialization_save_shape(shape, preview, previewSize, out); // closes out
+        free_preview_data(&preview);
+    } else {
+        saved = serialization_vox_save(shape, out);
+        fclose(out);
+    }
+
+    shape_release(shape);
+
+    if (out != nullptr) {
+        if (saved) {
+            fs::rename(tmpPath, job.outputPath, ec);
+            if (ec) {
+                saved = false;
+                result.err = "can't write output file: " + ec.message();
+            }
+        } else {
+            result.err = "can't serialize output file";
+        }
+        if (saved == false) {
+            fs::remove(tmpPath, ec);
+        }
+    }
+    result.saveMs = elapsedMs(start);
+
+    if (saved) {
+        result.outputBytes = fs::file_size(job.outputPath, ec);
+        result.success = true;
+    }
+    return result;
+}
+
+/// Lists supported files in given directory and sub-directories, sorted by path
+void listDirectory(const fs::path& dir, std::vector<fs::path>& files) {
+    std::vector<fs::path> found;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, ec), end; it != end && !ec; it.increment(ec)) {
+        if (it->is_regular_file(ec) && formatFromExtension(it->path()) != AssetFormat::Unknown) {
+            found.push_back(it->path());
+        }
+    }
+    std::sort(found.begin(), found.end());
+    files.insert(files.end(), found.begin(), found.end());
+}
+
+} // namespace
+
+bool command_convert(cxxopts::ParseResult parseResult, std::string& err) {
+
+    // validation
+
+    if (parseResult.count("input") == 0 && parseResult.count("list") == 0) {
+        err.assign("no input files or directories");
+        return false;
+    }
+
+    if (parseResult.count("output") > 1) {
+        err.assign("only 1 output directory is allowed");
+        return false;
+    }
+
+    AssetFormat outputFormat = AssetFormat::Unknown; // same as input by default
+    if (parseResult.count("format") > 0) {
+        outputFormat = formatFromName(parseResult["format"].as<std::string>());
+        if (outputFormat == AssetFormat::Unknown) {
+            err.assign("unsupported output format (supported: 3zh, vox)");
+            return false;
+        }
+    }
+
+    ConvertOptions options;
+    options.bake = parseResult.count("bake") > 0 && parseResult["bake"].as<bool>();
+    if (options.bake && outputFormat == AssetFormat::Vox) {
+        err.assign("baked lighting can't be stored in .vox files");
+        return false;
+    }
+
+    unsigned int nbWorkers = std::max(1u, std::thread::hardware_concurrency());
+    if (parseResult.count("jobs") > 0) {
+        nbWorkers = parseResult["jobs"].as<unsigned int>();
+        if (nbWorkers == 0) {
+            err.assign("at least 1 worker is required");
+            return false;
+        }
+    }
+
+    // collect jobs, with paths relative to input directories
+    // to mirror the directory structure in the output directory
+
+    std::vector<std::pair<fs::path, fs::path>> inputs; // path, base directory
+    std::vector<std::string> inputArgs;
+    if (parseResult.count("input") > 0) {
+        inputArgs = parseResult["input"].as<std::vector<std::string>>();
+    }
+    if (parseResult.count("list") > 0) {
+        const std::string listPath = parseResult["list"].as<std::string>();
+        std::ifstream list(listPath);
+        if (list.is_open() == false) {
+            err.assign("can't open list file: " + listPath);
+            return false;
+        }
+        std::string line;
+        while (std::getline(list, line)) {
+            if (line.empty() == false && line.back() == '\r') {
+                line.pop_back();
+            }
+            if (line.empty() == false) {
+                inputArgs.push_back(line);
+            }
+        }
+    }
+
+    for (const std::string& arg : inputArgs) {
+        const fs::path path(arg);
+        std::error_code ec;
+        if (fs::is_directory(path, ec)) {
+            std::vector<fs::path> files;
+            listDirectory(path, files);
+            for (const fs::path& file : files) {
+                inputs.emplace_back(file, path);
+            }
+        } else if (fs::is_regular_file(path, ec)) {
+            inputs.emplace_back(path, path.parent_path());
+        } else {
+            err.assign("can't find input: " + arg);
+            return false;
+        }
+    }
+
+    std::vector<ConvertJob> jobs;
+    jobs.reserve(inputs.size());
+    std::map<fs::path, std::string> outputs; // output path -> input path, to detect collisions
+    for (const auto& input : inputs) {
+        ConvertJob job;
+        job.inputPath = input.first.string();
+        job.inputFormat = formatFromExtension(input.first);
+        if (job.inputFormat == AssetFormat::Unknown) {
+            err.assign("unsupported input file: " + job.inputPath);
+            return false;
+        }
+        job.outputFormat = outputFormat != AssetFormat::Unknown ? outputFormat : job.inputFormat;
+
+        // legacy .pcubes files are always written as .3zh
+        fs::path output = input.first;
+        if (parseResult.count("output") > 0) {
+            output = fs::path(parseResult["output"].as<std::string>()) /
+                     input.first.lexically_relative(input.second);
+        }
+        output.replace_extension(extensionForFormat(job.outputFormat));
+        job.outputPath = output.string();
+        job.tmpPath = job.outputPath + "." + std::to_string(jobs.size()) + ".tmp";
+
+        // inputs only differing by extension (a.vox, a.3zh) would overwrite each other
+        const auto inserted = outputs.emplace(output.lexically_normal(), job.inputPath);
+        if (inserted.second == false) {
+            err.assign("inputs " + inserted.first->second + " and " + job.inputPath +
+                       " would both be written to " + job.outputPath);
+            return false;
+        }
+
+        jobs.push_back(job);
+    }
+
+    if (jobs.empty()) {
+        err.assign("no .3zh or .vox files found");
+        return false;
+    }
+
+    nbWorkers = std::min(nbWorkers, static_cast<unsigned int>(jobs.size()));
+
+    std::cout << "* Converting " << jobs.size() << " file(s) using " << nbWorkers << " worker(s)"
+              << std::endl;
+
+    // processing
+
+    // Core globals lazily allocated on first use must exist before workers start
+    chunk_alloc_default_light();
+
+    std::vector<ConvertResult> results(jobs.size());
+    std::atomic<size_t> nextJob(0);
+    std::mutex printMutex;
+
+    const Clock::time_point start = Clock::now();
+
+    auto worker = [&]() {
+        // ColorAtlas is not thread-safe, each worker uses its own
+        ColorAtlas *colorAtlas = color_atlas_new();
+
+        size_t i;
+        while ((i = nextJob.fetch_add(1)) < jobs.size()) {
+            results[i] = convertFile(jobs[i], options, colorAtlas);
+
+            const ConvertResult& r = results[i];
+            std::lock_guard<std::mutex> lock(printMutex);
+            std::cout << (r.success ? "    [OK] " : "    [FAILED] ") << jobs[i].inputPath;
+            if (r.success) {
+                std::cout << " -> " << jobs[i].outputPath << std::fixed << std::setprecision(2)
+                          << " (load " << r.loadMs << "ms, process " << r.processMs << "ms, save "
+                          << r.saveMs << "ms, " << r.inputBytes << " -> " << r.outputBytes
+                          << " bytes)";
+            } else {
+                std::cout << ": " << r.err;
+            }
+            std::cout << std::endl;
+        }
+
+        color_atlas_free(colorAtlas);
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(nbWorkers);
+    for (unsigned int i = 0; i < nbWorkers; ++i) {
+        threads.emplace_back(worker);
+    }
+    for (std::thread& t : threads) {
+        t.join();
+    }
+
+    const double totalMs = elapsedMs(start);
+
+    // summary
+
+    size_t nbFailed = 0;
+    uintmax_t inputBytes = 0;
+    uintmax_t outputBytes = 0;
+    double cpuMs = 0.0;
+    for (const ConvertResult& r : results) {
+        if (r.success == false) {
+            ++nbFailed;
+        }
+        inputBytes += r.inputBytes;
+        outputBytes += r.outputBytes;
+        cpuMs += r.loadMs + r.processMs + r.saveMs;
+    }
+
+    const double seconds = totalMs / 1000.0;
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "* Done in " << totalMs << "ms" << std::endl;
+    std::cout << "  files: " << jobs.size() - nbFailed << " converted, " << nbFailed << " failed"
+              << std::endl;
+    std::cout << "  bytes: " << inputBytes << " read, " << outputBytes << " written" << std::endl;
+    if (seconds > 0.0) {
+        std::cout << "  throughput: " << static_cast<double>(jobs.size()) / seconds << " files/s, "
+                  << static_cast<double>(inputBytes) / (1024.0 * 1024.0) / seconds << " MB/s"
+                  << std::endl;
+    }
+    std::cout << "  average time per file: " << cpuMs / static_cast<double>(jobs.size()) << "ms"
+              << std::endl;
+
+    if (nbFailed > 0) {
+        std::cout << "  failures:" << std::endl;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            if (results[i].success == false) {
+                std::cout << "    - " << jobs[i].inputPath << ": " << results[i].err << std::endl;
+            }
+        }
+        err.assign(std::to_string(nbFailed) + " file(s) failed");
+        return false;
+    }
+
+    return true;
+}
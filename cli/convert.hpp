@@ -0,0 +1,20 @@
+//
+//  convert.hpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <string>
+
+// cxxopts
+#include <cxxopts.hpp>
+
+/// Converts, re-compresses and/or re-bakes a batch of .3zh/.vox files using several threads.
+/// Inputs can be files or directories (searched recursively), and/or a list file.
+/// Returns true if all files have been processed successfully, false otherwise.
+/// When an error occured, the `err` argument is filled with an error message.
+bool command_convert(cxxopts::ParseResult parseResult, std::string& err);
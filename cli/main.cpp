@@ -12,19 +12,28 @@
 #include <cxxopts.hpp>
 
 // cli
+#include "bench.hpp"
 #include "blocks.hpp"
 #include "combine.hpp"
+#include "convert.hpp"
 #include "shape_point.hpp"
+#include "stats.hpp"
 
 int main(int argc, const char * argv[]) {
 
     cxxopts::Options options("Cubzh", "Tools for voxels.");
 
     options.add_options()
-    ("command", "command to use: blocks,combine,setpoint", cxxopts::value<std::string>())
-    ("i,input", "input files", cxxopts::value<std::vector<std::string>>())
+    ("command", "command to use: blocks,combine,setpoint,convert,stats,bench", cxxopts::value<std::string>())
+    ("i,input", "input files (or directories for convert)", cxxopts::value<std::vector<std::string>>())
     // ("n,name", "input file name", cxxopts::value<std::vector<std::string>>())
-    ("o,output", "output file", cxxopts::value<std::string>())
+    ("o,output", "output file (output directory for convert)", cxxopts::value<std::string>())
+    ("l,list", "convert: file listing input paths, one per line", cxxopts::value<std::string>())
+    ("f,format", "convert: output format, 3zh or vox (defaults to input format)", cxxopts::value<std::string>())
+    ("j,jobs", "convert: number of worker threads (defaults to number of cores)", cxxopts::value<unsigned int>())
+    ("bake", "convert: recompute baked lighting", cxxopts::value<bool>()->default_value("false"))
+    ("json", "stats: print JSON output", cxxopts::value<bool>()->default_value("false"))
+    ("bench", "bench: benchmarks to run, comma separated (defaults to all)", cxxopts::value<std::vector<std::string>>())
     ;
 
     options.parse_positional({"command"});
@@ -45,6 +54,12 @@ int main(int argc, const char * argv[]) {
         success = count_blocks(result, err);
     } else if (command == "combine") {
         success = command_combine(result, err);
+    } else if (command == "convert" || command == "batch") {
+        success = command_convert(result, err);
+    } else if (command == "stats") {
+        success = command_stats(result, err);
+    } else if (command == "bench") {
+        success = command_bench(result, err);
     } else if (command == "setpoint") {
         success = commandSetPoint(result, err);
     } else {
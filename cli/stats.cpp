@@ -0,0 +1,361 @@
+//
+//  stats.cpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "stats.hpp"
+
+// C++
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+// cli
+#include "common.hpp"
+
+// Cubzh Core
+#include "chunk.h"
+#include "color_atlas.h"
+#include "serialization.h"
+#include "serialization_vox.h"
+#include "shape.h"
+#include "stream.h"
+#include "transform.h"
+#include "vertextbuffer.h"
+
+namespace {
+
+struct ShapeStats {
+    std::string name;
+    int depth = 0; // 0 for root shape
+    size_t blocks = 0;
+    size_t chunks = 0;
+    size_t minBlocksPerChunk = 0;
+    size_t maxBlocksPerChunk = 0;
+    int3 boundingBox = {0, 0, 0};
+    size_t paletteSize = 0;
+    const ColorPalette *palette = nullptr; // shapes may share a palette
+    size_t verticesOpaque = 0;
+    size_t verticesTransparent = 0;
+    size_t vertexBuffers = 0;
+    size_t vertexBufferBytesUsed = 0;
+    size_t vertexBufferBytesAllocated = 0;
+
+    double blocksPerChunk() const {
+        return chunks > 0 ? static_cast<double>(blocks) / static_cast<double>(chunks) : 0.0;
+    }
+
+    double fillRatio() const {
+        const double volume = static_cast<double>(boundingBox.x) *
+                              static_cast<double>(boundingBox.y) *
+                              static_cast<double>(boundingBox.z);
+        return volume > 0.0 ? static_cast<double>(blocks) / volume : 0.0;
+    }
+};
+
+struct PhaseTimings {
+    double readMs = 0.0; // file IO
+    double loadMs = 0.0; // inflate & block build (done together by core loaders)
+    double bakeMs = 0.0;
+    size_t bakedShapes = 0; // shapes loaded without baked lighting
+    double meshMs = 0.0;
+};
+
+void collectVertexBuffers(const VertexBuffer *vb, ShapeStats& stats, size_t& vertices) {
+    while (vb != nullptr) {
+        stats.vertexBuffers++;
+        vertices += vertex_buffer_get_count(vb);
+        stats.vertexBufferBytesUsed += vertex_buffer_get_count(vb) * DRAWBUFFER_VERTICES_BYTES;
+        stats.vertexBufferBytesAllocated += vertex_buffer_get_max_count(vb) *
+                                            DRAWBUFFER_VERTICES_BYTES;
+        vb = vertex_buffer_get_next(vb);
+    }
+}
+
+ShapeStats collectShapeStats(Shape *shape, int depth) {
+    ShapeStats stats;
+    const char *name = shape_get_fullname(shape);
+    stats.name = name != nullptr ? name : "";
+    stats.depth = depth;
+    stats.blocks = shape_get_nb_blocks(shape);
+    stats.chunks = shape_get_nb_chunks(shape);
+    shape_get_bounding_box_size(shape, &stats.boundingBox);
+
+    stats.palette = shape_get_palette(shape);
+    stats.paletteSize = stats.palette != nullptr ? color_palette_get_count(stats.palette) : 0;
+
+    bool first = true;
+    Index3DIterator *it = index3d_iterator_new(shape_get_chunks(shape));
+    while (index3d_iterator_pointer(it) != nullptr) {
+        const Chunk *chunk = (const Chunk *)index3d_iterator_pointer(it);
+        const size_t nbBlocks = static_cast<size_t>(chunk_get_nb_blocks(chunk));
+        stats.minBlocksPerChunk = first ? nbBlocks : std::min(stats.minBlocksPerChunk, nbBlocks);
+        stats.maxBlocksPerChunk = std::max(stats.maxBlocksPerChunk, nbBlocks);
+        first = false;
+        index3d_iterator_next(it);
+    }
+    index3d_iterator_free(it);
+
+    collectVertexBuffers(shape_get_first_vertex_buffer(shape, false), stats, stats.verticesOpaque);
+    collectVertexBuffers(shape_get_first_vertex_buffer(shape, true),
+                         stats,
+                         stats.verticesTransparent);
+
+    return stats;
+}
+
+std::string jsonEscape(const std::string& s) {
+    std::ostringstream o;
+    for (const char c : s) {
+        switch (c) {
+            case '"':
+                o << "\\\"";
+                break;
+            case '\\':
+                o << "\\\\";
+                break;
+            case '\n':
+                o << "\\n";
+                break;
+            case '\t':
+                o << "\\t";
+                break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    o << "\\u" << std::hex << std::setw(4) << std::setfill('0')
+                      << static_cast<int>(c) << std::dec;
+                } else {
+                    o << c;
+                }
+        }
+    }
+    return o.str();
+}
+
+void printJSON(const std::string& path,
+               const uintmax_t fileBytes,
+               const std::vector<ShapeStats>& shapes,
+               const ShapeStats& total,
+               const PhaseTimings& timings) {
+    std::ostringstream o;
+    o << std::fixed << std::setprecision(3);
+
+    auto shapeFields = [&o](const ShapeStats& s) {
+        o << "\"blocks\":" << s.blocks << ",\"chunks\":" << s.chunks
+          << ",\"blocksPerChunk\":" << s.blocksPerChunk()
+          << ",\"minBlocksPerChunk\":" << s.minBlocksPerChunk
+          << ",\"maxBlocksPerChunk\":" << s.maxBlocksPerChunk << ",\"boundingBox\":["
+          << s.boundingBox.x << "," << s.boundingBox.y << "," << s.boundingBox.z << "]"
+          << ",\"fillRatio\":" << s.fillRatio() << ",\"paletteSize\":" << s.paletteSize
+          << ",\"verticesOpaque\":" << s.verticesOpaque
+          << ",\"verticesTransparent\":" << s.verticesTransparent
+          << ",\"vertexBuffers\":" << s.vertexBuffers
+          << ",\"vertexBufferBytesUsed\":" << s.vertexBufferBytesUsed
+          << ",\"vertexBufferBytesAllocated\":" << s.vertexBufferBytesAllocated;
+    };
+
+    o << "{\"file\":\"" << jsonEscape(path) << "\",\"fileBytes\":" << fileBytes;
+    o << ",\"timingsMs\":{\"read\":" << timings.readMs << ",\"load\":" << timings.loadMs
+      << ",\"bake\":" << timings.bakeMs << ",\"mesh\":" << timings.meshMs << "}";
+    o << ",\"bakedShapes\":" << timings.bakedShapes;
+    o << ",\"total\":{\"shapes\":" << shapes.size() << ",";
+    shapeFields(total);
+    o << "},\"shapes\":[";
+    for (size_t i = 0; i < shapes.size(); ++i) {
+        o << (i > 0 ? "," : "") << "{\"name\":\"" << jsonEscape(shapes[i].name)
+          << "\",\"depth\":" << shapes[i].depth << ",";
+        shapeFields(shapes[i]);
+        o << "}";
+    }
+    o << "]}";
+
+    std::cout << o.str() << std::endl;
+}
+
+void printText(const std::string& path,
+               const uintmax_t fileBytes,
+               const std::vector<ShapeStats>& shapes,
+               const ShapeStats& total,
+               const PhaseTimings& timings) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "* " << path << " (" << fileBytes << " bytes)" << std::endl;
+
+    auto printShape = [](const ShapeStats& s, const std::string& indent) {
+        std::cout << indent << "blocks: " << s.blocks << std::endl;
+        std::cout << indent << "chunks: " << s.chunks << " (blocks per chunk: avg "
+                  << s.blocksPerChunk() << ", min " << s.minBlocksPerChunk << ", max "
+                  << s.maxBlocksPerChunk << ")" << std::endl;
+        std::cout << indent << "bounding box: " << s.boundingBox.x << "x" << s.boundingBox.y
+                  << "x" << s.boundingBox.z << " (fill ratio: " << s.fillRatio() * 100.0 << "%)"
+                  << std::endl;
+        std::cout << indent << "palette: " << s.paletteSize << " colors" << std::endl;
+        std::cout << indent << "vertices: " << s.verticesOpaque << " opaque, "
+                  << s.verticesTransparent << " transparent" << std::endl;
+        std::cout << indent << "vertex buffers: " << s.vertexBuffers << " ("
+                  << s.vertexBufferBytesUsed << " bytes used, " << s.vertexBufferBytesAllocated
+                  << " bytes allocated)" << std::endl;
+    };
+
+    if (shapes.size() > 1) {
+        for (size_t i = 0; i < shapes.size(); ++i) {
+            const std::string indent(static_cast<size_t>(2 + shapes[i].depth * 2), ' ');
+            std::cout << indent << "- shape #" << i
+                      << (shapes[i].name.empty() ? "" : " (" + shapes[i].name + ")") << std::endl;
+            printShape(shapes[i], indent + "  ");
+        }
+        std::cout << "  total (" << shapes.size() << " shapes):" << std::endl;
+        printShape(total, "    ");
+    } else {
+        printShape(total, "  ");
+    }
+
+    std::cout << "  timings: read " << timings.readMs << "ms, load " << timings.loadMs
+              << "ms, bake " << timings.bakeMs << "ms (" << timings.bakedShapes
+              << " shapes without baked lighting), mesh " << timings.meshMs << "ms" << std::endl;
+}
+
+} // namespace
+
+bool command_stats(cxxopts::ParseResult parseResult, std::string& err) {
+
+    // validation
+
+    if (parseResult.count("input") != 1) {
+        err.assign("exactly one input file expected");
+        return false;
+    }
+
+    const std::string inputPath = parseResult["input"].as<std::vector<std::string>>().front();
+    const bool json = parseResult.count("json") > 0 && parseResult["json"].as<bool>();
+
+    const std::string ext = lowercaseExtension(inputPath);
+    const bool isVox = ext == ".vox";
+    if (isVox == false && ext != ".3zh" && ext != ".pcubes") {
+        err.assign("unsupported input file (supported: .3zh, .vox)");
+        return false;
+    }
+
+    // processing
+
+    PhaseTimings timings;
+
+    // read
+
+    Clock::time_point start = Clock::now();
+    std::ifstream file(inputPath, std::ios::binary);
+    if (file.is_open() == false) {
+        err.assign("can't open input file: " + inputPath);
+        return false;
+    }
+    const std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+    file.close();
+    timings.readMs = elapsedMs(start);
+
+    // load
+
+    // lighting data is allocated while baking
+    chunk_alloc_default_light();
+
+    ColorAtlas *colorAtlas = color_atlas_new();
+    Stream *stream = stream_new_buffer_read(bytes.data(), bytes.size());
+    Shape *shape = nullptr;
+
+    start = Clock::now();
+    if (isVox) {
+        const enum serialization_vox_error error = serialization_vox_load(stream,
+                                                                          &shape,
+                                                                          false,
+                                                                          colorAtlas);
+        stream_free(stream);
+        if (error != no_error && shape != nullptr) {
+            shape_release(shape);
+            shape = nullptr;
+        }
+    } else {
+        ShapeSettings settings = {
+            .lighting = true,
+            .isMutable = false
+        };
+        shape = serialization_load_shape(stream, // frees stream
+                                         "",
+                                         colorAtlas,
+                                         &settings,
+                                         true); // allowLegacy
+    }
+    timings.loadMs = elapsedMs(start);
+
+    if (shape == nullptr) {
+        color_atlas_free(colorAtlas);
+        err.assign("can't load input file: " + inputPath);
+        return false;
+    }
+
+    // bake shapes loaded without lighting data, like the runtime does, before meshing since
+    // vertices include lighting
+
+    start = Clock::now();
+    timings.bakedShapes = bakeLighting(shape, true);
+    timings.bakeMs = elapsedMs(start);
+
+    // mesh
+
+    start = Clock::now();
+    forEachShape(shape, 0, [](Shape *s, int) {
+        shape_refresh_all_vertices(s);
+    });
+    timings.meshMs = elapsedMs(start);
+
+    // collect
+
+    std::vector<ShapeStats> shapes;
+    forEachShape(shape, 0, [&shapes](Shape *s, int depth) {
+        shapes.push_back(collectShapeStats(s, depth));
+    });
+
+    ShapeStats total;
+    bool first = true;
+    std::vector<const ColorPalette *> palettes; // total palette size sums distinct palettes
+    for (const ShapeStats& s : shapes) {
+        if (s.palette != nullptr &&
+            std::find(palettes.begin(), palettes.end(), s.palette) == palettes.end()) {
+            palettes.push_back(s.palette);
+            total.paletteSize += s.paletteSize;
+        }
+        total.blocks += s.blocks;
+        total.chunks += s.chunks;
+        if (s.chunks > 0) {
+            total.minBlocksPerChunk = first ? s.minBlocksPerChunk
+                                            : std::min(total.minBlocksPerChunk,
+                                                       s.minBlocksPerChunk);
+            first = false;
+        }
+        total.maxBlocksPerChunk = std::max(total.maxBlocksPerChunk, s.maxBlocksPerChunk);
+        total.verticesOpaque += s.verticesOpaque;
+        total.verticesTransparent += s.verticesTransparent;
+        total.vertexBuffers += s.vertexBuffers;
+        total.vertexBufferBytesUsed += s.vertexBufferBytesUsed;
+        total.vertexBufferBytesAllocated += s.vertexBufferBytesAllocated;
+    }
+    // shapes bounding boxes are in different model spaces, they can't be combined
+    total.boundingBox = shapes.size() == 1 ? shapes.front().boundingBox : int3{0, 0, 0};
+
+    if (json) {
+        printJSON(inputPath, bytes.size(), shapes, total, timings);
+    } else {
+        printText(inputPath, bytes.size(), shapes, total, timings);
+    }
+
+    shape_release(shape);
+    color_atlas_free(colorAtlas);
+
+    return true;
+}
@@ -0,0 +1,21 @@
+//
+//  stats.hpp
+//  cli
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <string>
+
+// cxxopts
+#include <cxxopts.hpp>
+
+/// Loads a .3zh or .vox file and reports its structure (shapes, chunks, blocks, palette,
+/// vertex buffers) along with the time spent in each loading phase.
+/// Prints JSON instead of text when the `json` option is set.
+/// Returns true on success, false otherwise.
+/// When an error occured, the `err` argument is filled with an error message.
+bool command_stats(cxxopts::ParseResult parseResult, std::string& err);
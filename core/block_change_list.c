@@ -0,0 +1,356 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  block_change_list.c
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#include "block_change_list.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cclog.h"
+#include "zlib.h"
+
+#define BLOCK_CHANGE_LIST_DEFAULT_CAPACITY 64
+#define BLOCK_CHANGE_LIST_RUN_MAX_LENGTH UINT16_MAX
+
+// Consecutive changes along z sharing the same colors, coordinates are relative to
+// previous run's coordinates, which keeps values small and compresses well.
+typedef struct {
+    int16_t dx, dy, dz;                    /* 3 x 2 bytes */
+    uint16_t length;                       /* 2 bytes */
+    SHAPE_COLOR_INDEX_INT_T before, after; /* 2 x 1 byte */
+} _BlockChangeRun;
+
+struct _BlockChangeList {
+    // recorded changes, NULL once packed
+    PackedBlockChange *changes; /* 8 bytes */
+    // encoded runs, possibly compressed, NULL if not packed
+    void *packed;        /* 8 bytes */
+    size_t count;        /* 8 bytes */
+    size_t capacity;     /* 8 bytes */
+    size_t packedSize;   /* 8 bytes */
+    size_t runsByteSize; /* 8 bytes */
+    bool isPacked;       /* 1 byte */
+    bool isCompressed;   /* 1 byte */
+    char pad[6];         /* 6 bytes */
+};
+
+static bool _block_change_list_sort(PackedBlockChange *changes, const size_t count);
+static size_t _block_change_list_merge(PackedBlockChange *changes, const size_t count);
+
+BlockChangeList *block_change_list_new(void) {
+    BlockChangeList *l = (BlockChangeList *)malloc(sizeof(BlockChangeList));
+    if (l == NULL) {
+        return NULL;
+    }
+    l->changes = NULL;
+    l->packed = NULL;
+    l->count = 0;
+    l->capacity = 0;
+    l->packedSize = 0;
+    l->runsByteSize = 0;
+    l->isPacked = false;
+    l->isCompressed = false;
+    return l;
+}
+
+void block_change_list_free(BlockChangeList *l) {
+    if (l == NULL) {
+        return;
+    }
+    free(l->changes);
+    free(l->packed);
+    free(l);
+}
+
+void block_change_list_free_func(void *l) {
+    block_change_list_free((BlockChangeList *)l);
+}
+
+bool block_change_list_push(BlockChangeList *l,
+                            const SHAPE_COORDS_INT_T x,
+                            const SHAPE_COORDS_INT_T y,
+                            const SHAPE_COORDS_INT_T z,
+                            const SHAPE_COLOR_INDEX_INT_T before,
+                            const SHAPE_COLOR_INDEX_INT_T after) {
+    vx_assert(l->isPacked == false);
+    if (l->isPacked) {
+        return false;
+    }
+    if (l->count == l->capacity) {
+        const size_t capacity = l->capacity == 0 ? BLOCK_CHANGE_LIST_DEFAULT_CAPACITY
+                                                 : l->capacity * 2;
+        PackedBlockChange *changes = (PackedBlockChange *)
+            realloc(l->changes, capacity * sizeof(PackedBlockChange));
+        if (changes == NULL) {
+            cclog_error("block_change_list: failed to allocate %zu changes", capacity);
+            return false;
+        }
+        l->changes = changes;
+        l->capacity = capacity;
+    }
+    l->changes[l->count++] = (PackedBlockChange){x, y, z, before, after};
+    return true;
+}
+
+bool block_change_list_pack(BlockChangeList *l) {
+    if (l->isPacked) {
+        return true;
+    }
+
+    if (_block_change_list_sort(l->changes, l->count) == false) {
+        return false;
+    }
+    const size_t count = _block_change_list_merge(l->changes, l->count);
+
+    // encode runs, worst case is one run per change
+    _BlockChangeRun *runs = count > 0 ? (_BlockChangeRun *)malloc(count * sizeof(_BlockChangeRun))
+                                      : NULL;
+    if (count > 0 && runs == NULL) {
+        l->count = count;
+        return false;
+    }
+
+    size_t nbRuns = 0;
+    SHAPE_COORDS_INT_T px = 0, py = 0, pz = 0;
+    const PackedBlockChange *c;
+    _BlockChangeRun *run = NULL;
+    for (size_t i = 0; i < count; ++i) {
+        c = &l->changes[i];
+        if (run != NULL && run->length < BLOCK_CHANGE_LIST_RUN_MAX_LENGTH && c->x == px &&
+            c->y == py && c->z == pz + run->length && c->before == run->before &&
+            c->after == run->after) {
+            run->length++;
+            continue;
+        }
+        run = &runs[nbRuns++];
+        run->dx = (int16_t)(c->x - px);
+        run->dy = (int16_t)(c->y - py);
+        run->dz = (int16_t)(c->z - pz);
+        run->length = 1;
+        run->before = c->before;
+        run->after = c->after;
+        px = c->x;
+        py = c->y;
+        pz = c->z;
+    }
+
+    const size_t runsByteSize = nbRuns * sizeof(_BlockChangeRun);
+    void *packed = runs;
+    size_t packedSize = runsByteSize;
+    bool isCompressed = false;
+
+    if (runsByteSize >= HISTORY_COMPRESSION_MIN_BYTES) {
+        uLong compressedSize = compressBound((uLong)runsByteSize);
+        void *compressed = malloc(compressedSize);
+        if (compressed != NULL) {
+            if (compress(compressed, &compressedSize, (const Bytef *)runs, (uLong)runsByteSize) ==
+                    Z_OK &&
+                compressedSize < runsByteSize) {
+                void *shrunk = realloc(compressed, compressedSize);
+                packed = shrunk != NULL ? shrunk : compressed;
+                packedSize = compressedSize;
+                isCompressed = true;
+                free(runs);
+            } else {
+                free(compressed);
+            }
+        }
+    }
+
+    if (isCompressed == false && nbRuns > 0 && nbRuns < count) {
+        void *shrunk = realloc(runs, runsByteSize);
+        packed = shrunk != NULL ? shrunk : runs;
+    }
+
+    free(l->changes);
+    l->changes = NULL;
+    l->capacity = 0;
+    l->count = count;
+    l->packed = packed;
+    l->packedSize = packedSize;
+    l->runsByteSize = runsByteSize;
+    l->isPacked = true;
+    l->isCompressed = isCompressed;
+
+    return true;
+}
+
+bool block_change_list_is_packed(const BlockChangeList *l) {
+    return l->isPacked;
+}
+
+const PackedBlockChange *block_change_list_read(const BlockChangeList *l,
+                                                size_t *count,
+                                                bool *mustFree) {
+    *count = 0;
+    *mustFree = false;
+
+    if (l->isPacked == false) {
+        *count = l->count;
+        return l->changes;
+    }
+
+    if (l->count == 0) {
+        return NULL;
+    }
+
+    const _BlockChangeRun *runs = (const _BlockChangeRun *)l->packed;
+    void *uncompressed = NULL;
+    if (l->isCompressed) {
+        uLong size = (uLong)l->runsByteSize;
+        uncompressed = malloc(size);
+        if (uncompressed == NULL) {
+            return NULL;
+        }
+        if (uncompress(uncompressed, &size, (const Bytef *)l->packed, (uLong)l->packedSize) !=
+                Z_OK ||
+            size != l->runsByteSize) {
+            free(uncompressed);
+            return NULL;
+        }
+        runs = (const _BlockChangeRun *)uncompressed;
+    }
+
+    PackedBlockChange *changes = (PackedBlockChange *)malloc(l->count * sizeof(PackedBlockChange));
+    if (changes == NULL) {
+        free(uncompressed);
+        return NULL;
+    }
+
+    const size_t nbRuns = l->runsByteSize / sizeof(_BlockChangeRun);
+    SHAPE_COORDS_INT_T x = 0, y = 0, z = 0;
+    size_t n = 0;
+    for (size_t i = 0; i < nbRuns; ++i) {
+        x = (SHAPE_COORDS_INT_T)(x + runs[i].dx);
+        y = (SHAPE_COORDS_INT_T)(y + runs[i].dy);
+        z = (SHAPE_COORDS_INT_T)(z + runs[i].dz);
+        for (uint16_t j = 0; j < runs[i].length && n < l->count; ++j) {
+            changes[n++] = (PackedBlockChange){x,
+                                               y,
+                                               (SHAPE_COORDS_INT_T)(z + j),
+                                               runs[i].before,
+                                               runs[i].after};
+        }
+    }
+    free(uncompressed);
+
+    *count = n;
+    *mustFree = true;
+    return changes;
+}
+
+size_t block_change_list_get_count(const BlockChangeList *l) {
+    return l->count;
+}
+
+bool block_change_list_is_empty(const BlockChangeList *l) {
+    return l == NULL || l->count == 0;
+}
+
+size_t block_change_list_get_byte_size(const BlockChangeList *l) {
+    if (l == NULL) {
+        return 0;
+    }
+    return sizeof(BlockChangeList) + l->capacity * sizeof(PackedBlockChange) + l->packedSize;
+}
+
+// MARK: - private functions -
+
+static int _block_change_compare(const PackedBlockChange *a, const PackedBlockChange *b) {
+    if (a->x != b->x) {
+        return a->x < b->x ? -1 : 1;
+    }
+    if (a->y != b->y) {
+        return a->y < b->y ? -1 : 1;
+    }
+    if (a->z != b->z) {
+        return a->z < b->z ? -1 : 1;
+    }
+    return 0;
+}
+
+/// Stable bottom-up merge sort, changes on the same block must keep their recording order
+static bool _block_change_list_sort(PackedBlockChange *changes, const size_t count) {
+    if (count < 2) {
+        return true;
+    }
+
+    // bulk edits usually record changes in order already
+    bool sorted = true;
+    for (size_t i = 1; i < count; ++i) {
+        if (_block_change_compare(&changes[i - 1], &changes[i]) > 0) {
+            sorted = false;
+            break;
+        }
+    }
+    if (sorted) {
+        return true;
+    }
+
+    PackedBlockChange *tmp = (PackedBlockChange *)malloc(count * sizeof(PackedBlockChange));
+    if (tmp == NULL) {
+        return false;
+    }
+
+    PackedBlockChange *src = changes;
+    PackedBlockChange *dst = tmp;
+    PackedBlockChange *swap;
+    size_t left, mid, right, i, j, k;
+
+    for (size_t width = 1; width < count; width *= 2) {
+        for (left = 0; left < count; left += 2 * width) {
+            mid = left + width < count ? left + width : count;
+            right = left + 2 * width < count ? left + 2 * width : count;
+            i = left;
+            j = mid;
+            k = left;
+            while (i < mid && j < right) {
+                if (_block_change_compare(&src[j], &src[i]) < 0) {
+                    dst[k++] = src[j++];
+                } else {
+                    dst[k++] = src[i++];
+                }
+            }
+            while (i < mid) {
+                dst[k++] = src[i++];
+            }
+            while (j < right) {
+                dst[k++] = src[j++];
+            }
+        }
+        swap = src;
+        src = dst;
+        dst = swap;
+    }
+
+    if (src != changes) {
+        memcpy(changes, src, count * sizeof(PackedBlockChange));
+    }
+    free(tmp);
+
+    return true;
+}
+
+/// Merges consecutive changes on the same block in a sorted array & removes no-op changes,
+/// returns new count
+static size_t _block_change_list_merge(PackedBlockChange *changes, const size_t count) {
+    size_t n = 0;
+    for (size_t i = 0; i < count; ++i) {
+        if (n > 0 && _block_change_compare(&changes[n - 1], &changes[i]) == 0) {
+            changes[n - 1].after = changes[i].after;
+        } else {
+            if (n > 0 && changes[n - 1].before == changes[n - 1].after) {
+                --n;
+            }
+            changes[n++] = changes[i];
+        }
+    }
+    if (n > 0 && changes[n - 1].before == changes[n - 1].after) {
+        --n;
+    }
+    return n;
+}
@@ -0,0 +1,67 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  block_change_list.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "config.h"
+
+// A block change list is a compact record of block changes, stored as a packed array.
+// Unlike a Transaction, it does not index changes by coordinates and allocates only when
+// growing its array, it is meant to record large edits to be undone/redone in bulk.
+//
+// Once recording is done, a list can be packed: changes are sorted by coordinates, changes
+// on the same block are merged, and the result is stored as delta-encoded runs along the
+// z axis, zlib-compressed when large enough (see HISTORY_COMPRESSION_MIN_BYTES).
+typedef struct _BlockChangeList BlockChangeList;
+
+typedef struct {
+    SHAPE_COORDS_INT_T x, y, z;            /* 3 x 2 bytes */
+    SHAPE_COLOR_INDEX_INT_T before, after; /* 2 x 1 byte */
+} PackedBlockChange;
+
+BlockChangeList *block_change_list_new(void);
+void block_change_list_free(BlockChangeList *l);
+void block_change_list_free_func(void *l);
+
+/// Records a change, list must not be packed.
+/// Returns false if the change could not be recorded, list is then incomplete and should be
+/// dropped.
+bool block_change_list_push(BlockChangeList *l,
+                            const SHAPE_COORDS_INT_T x,
+                            const SHAPE_COORDS_INT_T y,
+                            const SHAPE_COORDS_INT_T z,
+                            const SHAPE_COLOR_INDEX_INT_T before,
+                            const SHAPE_COLOR_INDEX_INT_T after);
+
+/// Sorts changes by (x, y, z), merges changes on the same block (keeping first "before" and
+/// last "after"), drops changes that have no effect, then encodes & compresses the result.
+/// Returns false if memory could not be allocated, list remains unpacked in that case.
+bool block_change_list_pack(BlockChangeList *l);
+bool block_change_list_is_packed(const BlockChangeList *l);
+
+/// Returns changes in recording order, or sorted by coordinates if the list is packed.
+/// When packed, changes are decoded in a new buffer and `mustFree` is set to true,
+/// caller is then responsible for freeing returned pointer.
+const PackedBlockChange *block_change_list_read(const BlockChangeList *l,
+                                                size_t *count,
+                                                bool *mustFree);
+
+size_t block_change_list_get_count(const BlockChangeList *l);
+bool block_change_list_is_empty(const BlockChangeList *l);
+
+/// Memory used by the list, including its own struct
+size_t block_change_list_get_byte_size(const BlockChangeList *l);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
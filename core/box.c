@@ -10,6 +10,7 @@
 #include <stdlib.h>
 #include <string.h>
 
+#include "simd.h"
 #include "utils.h"
 
 Box *box_new(void) {
@@ -114,6 +115,11 @@ bool box_contains_epsilon(const Box *b, const float3 *f3, float epsilon) {
             b->min.z <= f3->z + epsilon && b->max.z >= f3->z - epsilon);
 }
 
+bool box_contains_box(const Box *b, const Box *other) {
+    return (b->min.x <= other->min.x && b->max.x >= other->max.x && b->min.y <= other->min.y &&
+            b->max.y >= other->max.y && b->min.z <= other->min.z && b->max.z >= other->max.z);
+}
+
 void box_copy(Box *dest, const Box *src) {
     if (dest == NULL || src == NULL) {
         return;
@@ -447,17 +453,15 @@ void box_to_aabox(const Box *b,
                   const float3 *scale,
                   SquarifyType squarify) {
 
-    Matrix4x4 *tmp = matrix4x4_new_identity();
-    Matrix4x4 *mtx = matrix4x4_new_scale(scale);
-    quaternion_to_rotation_matrix(rotation, tmp);
-    matrix4x4_op_multiply_2(tmp, mtx);
-    matrix4x4_set_translation(tmp, translation->x, translation->y, translation->z);
-    matrix4x4_op_multiply_2(tmp, mtx);
-    matrix4x4_free(tmp);
-
-    box_to_aabox2(b, aab, mtx, offset, squarify);
+    Matrix4x4 tmp = matrix4x4_identity;
+    Matrix4x4 mtx;
+    matrix4x4_set_scaleXYZ(&mtx, scale->x, scale->y, scale->z);
+    quaternion_to_rotation_matrix(rotation, &tmp);
+    matrix4x4_op_multiply_2(&tmp, &mtx);
+    matrix4x4_set_translation(&tmp, translation->x, translation->y, translation->z);
+    matrix4x4_op_multiply_2(&tmp, &mtx);
 
-    matrix4x4_free(mtx);
+    box_to_aabox2(b, aab, &mtx, offset, squarify);
 }
 
 void box_to_aabox2(const Box *b,
@@ -469,6 +473,60 @@ void box_to_aabox2(const Box *b,
     box_model1_to_model2_aabox(b, aab, mtx, NULL, offset, squarify);
 }
 
+/// Transforms the 8 corners of (min, max) with `model1` (columns c1..c4), then optionally
+/// `invModel2`, and writes their bounds in `aab`.
+/// Each corner is computed in the same order as matrix4x4_op_multiply_vec_point, results are
+/// identical to transforming corners one by one.
+static inline void _box_corners_to_aabox(const float3 *min,
+                                         const float3 *max,
+                                         const simd4f c1,
+                                         const simd4f c2,
+                                         const simd4f c3,
+                                         const simd4f c4,
+                                         const Matrix4x4 *invModel2,
+                                         Box *aab) {
+    // terms shared by corners
+    const simd4f x[2] = {simd4f_mul(c1, simd4f_splat(min->x)),
+                         simd4f_mul(c1, simd4f_splat(max->x))};
+    const simd4f y[2] = {simd4f_mul(c2, simd4f_splat(min->y)),
+                         simd4f_mul(c2, simd4f_splat(max->y))};
+    const simd4f z[2] = {simd4f_mul(c3, simd4f_splat(min->z)),
+                         simd4f_mul(c3, simd4f_splat(max->z))};
+    const simd4f xy[4] = {simd4f_add(x[0], y[0]),
+                          simd4f_add(x[1], y[0]),
+                          simd4f_add(x[0], y[1]),
+                          simd4f_add(x[1], y[1])};
+
+    simd4f corners[8];
+    for (int i = 0; i < 8; ++i) {
+        corners[i] = simd4f_add(simd4f_add(xy[i & 3], z[i >> 2]), c4);
+    }
+
+    if (invModel2 != NULL) {
+        const float *m = (const float *)invModel2;
+        const simd4f n1 = simd4f_load(m);
+        const simd4f n2 = simd4f_load(m + 4);
+        const simd4f n3 = simd4f_load(m + 8);
+        const simd4f n4 = simd4f_load(m + 12);
+        for (int i = 0; i < 8; ++i) {
+            const simd4f c = corners[i];
+            simd4f r = simd4f_mul(n1, simd4f_splat_x(c));
+            r = simd4f_madd(n2, simd4f_splat_y(c), r);
+            r = simd4f_madd(n3, simd4f_splat_z(c), r);
+            corners[i] = simd4f_add(r, n4);
+        }
+    }
+
+    simd4f lo = corners[0];
+    simd4f hi = corners[0];
+    for (int i = 1; i < 8; ++i) {
+        lo = simd4f_min(lo, corners[i]);
+        hi = simd4f_max(hi, corners[i]);
+    }
+    simd4f_store3((float *)&aab->min, lo);
+    simd4f_store3((float *)&aab->max, hi);
+}
+
 void box_model1_to_model2_aabox(const Box *b,
                                 Box *aab,
                                 const Matrix4x4 *model1,
@@ -484,48 +542,16 @@ void box_model1_to_model2_aabox(const Box *b,
         float3_op_add(&max, offset);
     }
 
-    float3 points[8] = {min,
-                        {max.x, min.y, min.z},
-                        {max.x, min.y, max.z},
-                        {min.x, min.y, max.z},
-                        {min.x, max.y, min.z},
-                        {max.x, max.y, min.z},
-                        max,
-                        {min.x, max.y, max.z}};
-    float3 transformed[8];
-
-    // transform all 8 box points
-    matrix4x4_op_multiply_vec_point(&transformed[0], &points[0], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[1], &points[1], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[2], &points[2], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[3], &points[3], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[4], &points[4], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[5], &points[5], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[6], &points[6], model1);
-    matrix4x4_op_multiply_vec_point(&transformed[7], &points[7], model1);
-    if (invModel2 != NULL) {
-        memcpy(points, transformed, sizeof(float3) * 8);
-        matrix4x4_op_multiply_vec_point(&transformed[0], &points[0], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[1], &points[1], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[2], &points[2], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[3], &points[3], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[4], &points[4], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[5], &points[5], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[6], &points[6], invModel2);
-        matrix4x4_op_multiply_vec_point(&transformed[7], &points[7], invModel2);
-    }
-
     // get box min/max in that new space
-    aab->min = transformed[0];
-    aab->max = transformed[0];
-    for (int i = 1; i < 8; ++i) {
-        aab->min.x = minimum(aab->min.x, transformed[i].x);
-        aab->min.y = minimum(aab->min.y, transformed[i].y);
-        aab->min.z = minimum(aab->min.z, transformed[i].z);
-        aab->max.x = maximum(aab->max.x, transformed[i].x);
-        aab->max.y = maximum(aab->max.y, transformed[i].y);
-        aab->max.z = maximum(aab->max.z, transformed[i].z);
-    }
+    const float *m = (const float *)model1;
+    _box_corners_to_aabox(&min,
+                          &max,
+                          simd4f_load(m),
+                          simd4f_load(m + 4),
+                          simd4f_load(m + 8),
+                          simd4f_load(m + 12),
+                          invModel2,
+                          aab);
 
     // lastly, squarify box base if required
     if (squarify) {
@@ -533,6 +559,29 @@ void box_model1_to_model2_aabox(const Box *b,
     }
 }
 
+void box_to_aaboxes(const Box *boxes,
+                    Box *aabs,
+                    const size_t count,
+                    const Matrix4x4 *mtx,
+                    const float3 *offset) {
+    const float *m = (const float *)mtx;
+    const simd4f c1 = simd4f_load(m);
+    const simd4f c2 = simd4f_load(m + 4);
+    const simd4f c3 = simd4f_load(m + 8);
+    const simd4f c4 = simd4f_load(m + 12);
+
+    float3 min, max;
+    for (size_t i = 0; i < count; ++i) {
+        min = boxes[i].min;
+        max = boxes[i].max;
+        if (offset != NULL) {
+            float3_op_add(&min, offset);
+            float3_op_add(&max, offset);
+        }
+        _box_corners_to_aabox(&min, &max, c1, c2, c3, c4, NULL, &aabs[i]);
+    }
+}
+
 void box_op_merge(const Box *b1, const Box *b2, Box *result) {
     result->min.x = minimum(b1->min.x, b2->min.x);
     result->min.y = minimum(b1->min.y, b2->min.y);
@@ -63,6 +63,8 @@ bool box_collide_epsilon3(const Box *b1, const Box *b2, const float3 *epsilon);
 // Returns true if box contains point
 bool box_contains(const Box *b, const float3 *f3);
 bool box_contains_epsilon(const Box *b, const float3 *f3, float epsilon);
+// Returns true if box fully contains other box
+bool box_contains_box(const Box *b, const Box *other);
 
 void box_set_broadphase_box(const Box *b, const float3 *v, Box *bpBox);
 
@@ -121,6 +123,14 @@ void box_model1_to_model2_aabox(const Box *b,
                                 const float3 *offset,
                                 SquarifyType squarify);
 
+/// Same as box_to_aabox2 for `count` boxes sharing the same matrix & optional offset,
+/// without squarify. aabs may point to boxes.
+void box_to_aaboxes(const Box *boxes,
+                    Box *aabs,
+                    const size_t count,
+                    const Matrix4x4 *mtx,
+                    const float3 *offset);
+
 void box_op_merge(const Box *b1, const Box *b2, Box *result);
 
 float box_get_volume(const Box *b);
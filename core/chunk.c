@@ -31,6 +31,9 @@ struct _Chunk {
     // first opaque/transparent vbma reserved for that chunk, this can be chained across several vb
     VertexBufferMemArea *vbma_opaque;      /* 8 bytes */
     VertexBufferMemArea *vbma_transparent; /* 8 bytes */
+    // number of chunks referencing octree & lighting data, NULL if not shared.
+    // Shared data is copied on first write, see chunk_new_shared_copy
+    uint32_t *shareCount; /* 8 bytes */
     // number of blocks in that chunk
     int nbBlocks; /* 4 bytes */
     // position of chunk in shape's model
@@ -70,6 +73,8 @@ void _vertex_light_smoothing(VERTEX_LIGHT_STRUCT_T *base,
                              VERTEX_LIGHT_STRUCT_T vlight2,
                              VERTEX_LIGHT_STRUCT_T vlight3);
 
+static void _chunk_unshare(Chunk *c);
+
 bool _chunk_is_bounding_box_empty(const Chunk *chunk);
 void _chunk_update_bounding_box(Chunk *chunk,
                                 const CHUNK_COORDS_INT3_T coords,
@@ -107,6 +112,7 @@ Chunk *chunk_new(const SHAPE_COORDS_INT3_T origin) {
 
     chunk->vbma_opaque = NULL;
     chunk->vbma_transparent = NULL;
+    chunk->shareCount = NULL;
 
     return chunk;
 }
@@ -136,20 +142,66 @@ Chunk *chunk_new_copy(const Chunk *c) {
         copy->neighbors[i] = NULL;
     }
 
+    copy->vbma_opaque = NULL;
+    copy->vbma_transparent = NULL;
+    copy->shareCount = NULL;
+
+    return copy;
+}
+
+Chunk *chunk_new_shared_copy(Chunk *c) {
+    Chunk *copy = (Chunk *)malloc(sizeof(Chunk));
+    if (copy == NULL) {
+        return NULL;
+    }
+    if (c->shareCount == NULL) {
+        c->shareCount = (uint32_t *)malloc(sizeof(uint32_t));
+        if (c->shareCount == NULL) {
+            free(copy);
+            return chunk_new_copy(c);
+        }
+        *c->shareCount = 1;
+    }
+    *c->shareCount += 1;
+
+    copy->octree = c->octree;
+    copy->lightingData = c->lightingData;
+    copy->shareCount = c->shareCount;
+    copy->rtreeLeaf = NULL;
+    copy->dirty = false;
+    copy->origin = c->origin;
+    copy->bbMin = c->bbMin;
+    copy->bbMax = c->bbMax;
+    copy->nbBlocks = c->nbBlocks;
+
+    for (int i = 0; i < CHUNK_NEIGHBORS_COUNT; i++) {
+        copy->neighbors[i] = NULL;
+    }
+
     copy->vbma_opaque = NULL;
     copy->vbma_transparent = NULL;
 
     return copy;
 }
 
+bool chunk_is_shared(const Chunk *c) {
+    return c->shareCount != NULL && *c->shareCount > 1;
+}
+
 void chunk_free(Chunk *chunk, bool updateNeighbors) {
     if (updateNeighbors) {
         chunk_leave_neighborhood(chunk);
     }
 
-    octree_free(chunk->octree);
-    if (chunk->lightingData != NULL) {
-        free(chunk->lightingData);
+    if (chunk->shareCount != NULL && *chunk->shareCount > 1) {
+        // other chunks still use that data
+        *chunk->shareCount -= 1;
+    } else {
+        octree_free(chunk->octree);
+        if (chunk->lightingData != NULL) {
+            free(chunk->lightingData);
+        }
+        free(chunk->shareCount);
     }
 
     if (chunk->vbma_opaque != NULL) {
@@ -216,6 +268,8 @@ void chunk_set_light(Chunk *c,
 
     if (c->lightingData == NULL) {
         chunk_reset_lighting_data(c, initEmpty);
+    } else if (c->shareCount != NULL) {
+        _chunk_unshare(c);
     }
 
     c->lightingData[coords.x * CHUNK_SIZE_SQR + coords.y * CHUNK_SIZE + coords.z] = light;
@@ -245,6 +299,9 @@ VERTEX_LIGHT_STRUCT_T chunk_get_light_or_default(Chunk *c,
 }
 
 void chunk_clear_lighting_data(Chunk *c) {
+    if (c->shareCount != NULL) {
+        _chunk_unshare(c);
+    }
     if (c->lightingData != NULL) {
         free(c->lightingData);
         c->lightingData = NULL;
@@ -253,6 +310,9 @@ void chunk_clear_lighting_data(Chunk *c) {
 
 void chunk_reset_lighting_data(Chunk *c, const bool emptyOrDefault) {
     const size_t lightingSize = (size_t)CHUNK_SIZE_CUBE * (size_t)sizeof(VERTEX_LIGHT_STRUCT_T);
+    if (c->shareCount != NULL) {
+        _chunk_unshare(c);
+    }
     if (c->lightingData == NULL) {
         c->lightingData = malloc(lightingSize);
     }
@@ -265,6 +325,9 @@ void chunk_reset_lighting_data(Chunk *c, const bool emptyOrDefault) {
 }
 
 void chunk_set_lighting_data(Chunk *c, VERTEX_LIGHT_STRUCT_T *data) {
+    if (c->shareCount != NULL) {
+        _chunk_unshare(c);
+    }
     if (c->lightingData != NULL) {
         free(c->lightingData);
     }
@@ -284,6 +347,9 @@ bool chunk_add_block(Chunk *chunk,
     if (block_is_solid(&block) == false) {
         return false;
     }
+    if (chunk->shareCount != NULL) {
+        _chunk_unshare(chunk);
+    }
 
     Block *b = (Block *)
         octree_get_element_without_checking(chunk->octree, (size_t)x, (size_t)y, (size_t)z);
@@ -306,6 +372,13 @@ bool chunk_remove_block(Chunk *chunk,
     Block *b = (Block *)
         octree_get_element_without_checking(chunk->octree, (size_t)x, (size_t)y, (size_t)z);
     if (block_is_solid(b)) {
+        if (chunk->shareCount != NULL) {
+            _chunk_unshare(chunk);
+            b = (Block *)octree_get_element_without_checking(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
+        }
         if (prevColorIndex != NULL) {
             *prevColorIndex = block_get_color_index(b);
         }
@@ -329,6 +402,13 @@ bool chunk_paint_block(Chunk *chunk,
     Block *b = (Block *)
         octree_get_element_without_checking(chunk->octree, (size_t)x, (size_t)y, (size_t)z);
     if (block_is_solid(b)) {
+        if (chunk->shareCount != NULL) {
+            _chunk_unshare(chunk);
+            b = (Block *)octree_get_element_without_checking(chunk->octree,
+                                                             (size_t)x,
+                                                             (size_t)y,
+                                                             (size_t)z);
+        }
         if (prevColorIndex != NULL) {
             *prevColorIndex = block_get_color_index(b);
         }
@@ -2344,6 +2424,28 @@ void chunk_write_vertices(Shape *shape, Chunk *chunk) {
 
 // MARK: private functions
 
+/// Gives chunk its own copy of shared octree & lighting data, before writing to it
+static void _chunk_unshare(Chunk *c) {
+    if (c->shareCount == NULL) {
+        return;
+    }
+    if (*c->shareCount > 1) {
+        *c->shareCount -= 1;
+        c->octree = octree_new_copy(c->octree);
+        if (c->lightingData != NULL) {
+            const size_t lightingSize = (size_t)CHUNK_SIZE_CUBE *
+                                        (size_t)sizeof(VERTEX_LIGHT_STRUCT_T);
+            VERTEX_LIGHT_STRUCT_T *lightingData = malloc(lightingSize);
+            memcpy(lightingData, c->lightingData, lightingSize);
+            c->lightingData = lightingData;
+        }
+    } else {
+        // last chunk referencing that data
+        free(c->shareCount);
+    }
+    c->shareCount = NULL;
+}
+
 Octree *_chunk_new_octree(void) {
     unsigned long upPow2Size = upper_power_of_two(CHUNK_SIZE);
     Block *defaultBlock = block_new_air();
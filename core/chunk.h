@@ -59,6 +59,10 @@ void chunk_alloc_default_light(void);
 
 Chunk *chunk_new(const SHAPE_COORDS_INT3_T origin);
 Chunk *chunk_new_copy(const Chunk *c);
+/// Creates a copy referencing the same octree & lighting data, copied on first write.
+/// Data obtained through chunk_get_octree or chunk_get_lighting_data must not be modified.
+Chunk *chunk_new_shared_copy(Chunk *c);
+bool chunk_is_shared(const Chunk *c);
 void chunk_free(Chunk *chunk, bool updateNeighbors);
 void chunk_free_func(void *c);
 void chunk_set_dirty(Chunk *chunk, bool b);
@@ -71,8 +71,12 @@ extern "C" {
 #define EVENT_TYPE_FROM_SCRIPT_WITH_DEBUG                                                          \
     5 // sent as EVENT_TYPE_FROM_SCRIPT, with attached debug metadata
 
-// UNDO MAXIMUM ACTIONS
-#define NB_UNDOABLE_ACTIONS 20
+// UNDO HISTORY
+// memory budget for a shape's history, oldest entries are discarded when exceeded
+// (the most recent entry is always kept, whatever its size)
+#define HISTORY_MAX_BYTES 4194304
+// packed history entries are zlib-compressed above this size
+#define HISTORY_COMPRESSION_MIN_BYTES 1024
 
 // MARK: - Maths -
 
@@ -156,6 +160,9 @@ extern unsigned long upper_power_of_two(unsigned long v);
     0.01f // if pushing object mass is 1% or less of pushed object mass
 /// Multiple collision responses may fall within the same simulation frame, up to max iterations
 #define PHYSICS_MAX_SOLVER_ITERATIONS 4
+/// Margin around a dynamic rigidbody broadphase query, its candidates are reused across solver
+/// iterations and frames while its trajectory remains within and the r-tree is unchanged
+#define PHYSICS_BROADPHASE_MARGIN 4.0f
 /// How to combine friction/bounciness of 2 rigidbodies in contact, min (0), max (1), or average (2)
 #define PHYSICS_COMBINE_FRICTION_FUNC 2
 #define PHYSICS_COMBINE_BOUNCINESS_FUNC 1
@@ -184,6 +191,13 @@ extern unsigned long upper_power_of_two(unsigned long v);
 /// Number of frames during which an awaken rigidbody will skip sleep conditions, max 255 (uint8)
 #define PHYSICS_AWAKE_FRAMES 6
 #define PHYSICS_AWAKE_DISTANCE EPSILON_COLLISION * 2
+/// Number of consecutive resting frames after which a dynamic rigidbody may fall asleep along w/ its
+/// island of touching rigidbodies, max 255 (uint8)
+#define PHYSICS_SLEEP_FRAMES 30
+/// Fixed timestep is disabled by default, physics is stepped once per scene refresh w/ frame delta
+#define PHYSICS_DEFAULT_FIXED_RATE 0
+/// Max number of fixed steps per scene refresh, remaining time is dropped past that
+#define PHYSICS_DEFAULT_MAX_SUBSTEPS 4
 /// Should dynamic rigidbodies' collider be squarified?
 #define PHYSICS_SQUARIFY_DYNAMIC_COLLIDER false
 
@@ -341,6 +355,9 @@ static const FACE_INDEX_INT_T FACE_NONE = 7;
 #define GLOBAL_LIGHTING_BAKE_SAVE_ENABLED true
 /// Checks if a "baked_" file exists first when loading a shape
 #define GLOBAL_LIGHTING_BAKE_LOAD_ENABLED true
+/// Bulk edits affecting more blocks than this recompute baked lighting once for the whole shape
+/// instead of propagating light changes block by block
+#define SHAPE_BULK_EDIT_PER_BLOCK_LIGHTING_MAX 256
 
 //// Function used for vertex light smoothing
 /// Note: this affects only light intensity value, rgb values are always averaged
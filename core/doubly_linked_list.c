@@ -245,21 +245,64 @@ DoublyLinkedListNode *doubly_linked_list_insert_node_next(DoublyLinkedList *list
 
 void doubly_linked_list_sort_ascending(DoublyLinkedList *list,
                                        pointer_doubly_linked_list_sort_func func) {
-    DoublyLinkedListNode *last = list->last;
-    DoublyLinkedListNode *current = NULL;
-    void *ptr = NULL;
-    while (last != NULL) {
-        current = list->first;
-        while (current != last) {
-            if (func(current, last)) {
-                ptr = current->ptr;
-                current->ptr = last->ptr;
-                last->ptr = ptr;
+    DoublyLinkedListNode *head = list->first;
+    if (head == NULL || head->next == NULL) {
+        return;
+    }
+
+    // bottom-up merge sort on `next` links, merging runs of `width` nodes,
+    // stable: nodes from the left run go first unless strictly superior
+    DoublyLinkedListNode *p, *q, *e, *tail;
+    size_t width = 1, merges, pSize, qSize;
+    do {
+        p = head;
+        head = NULL;
+        tail = NULL;
+        merges = 0;
+        while (p != NULL) {
+            ++merges;
+            q = p;
+            pSize = 0;
+            while (pSize < width && q != NULL) {
+                ++pSize;
+                q = q->next;
             }
-            current = current->next;
+            qSize = width;
+            while (pSize > 0 || (qSize > 0 && q != NULL)) {
+                if (pSize == 0) {
+                    e = q;
+                    q = q->next;
+                    --qSize;
+                } else if (qSize == 0 || q == NULL || func(p, q) == false) {
+                    e = p;
+                    p = p->next;
+                    --pSize;
+                } else {
+                    e = q;
+                    q = q->next;
+                    --qSize;
+                }
+                if (tail != NULL) {
+                    tail->next = e;
+                } else {
+                    head = e;
+                }
+                tail = e;
+            }
+            p = q;
         }
-        last = last->previous;
-    }
+        tail->next = NULL;
+        width *= 2;
+    } while (merges > 1);
+
+    // restore `previous` links
+    DoublyLinkedListNode *previous = NULL;
+    for (e = head; e != NULL; e = e->next) {
+        e->previous = previous;
+        previous = e;
+    }
+    list->first = head;
+    list->last = previous;
 }
 
 size_t doubly_linked_list_node_count(const DoublyLinkedList *list) {
@@ -60,8 +60,10 @@ DoublyLinkedListNode *doubly_linked_list_insert_node_previous(DoublyLinkedList *
                                                               DoublyLinkedListNode *node,
                                                               void *ptr);
 
+// sort function returns true if n1 should be after n2
 typedef bool (*pointer_doubly_linked_list_sort_func)(DoublyLinkedListNode *n1,
                                                      DoublyLinkedListNode *n2);
+// stable merge sort, O(n log n), nodes are relinked
 void doubly_linked_list_sort_ascending(DoublyLinkedList *list,
                                        pointer_doubly_linked_list_sort_func func);
 
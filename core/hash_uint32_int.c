@@ -7,212 +7,166 @@
 #include "hash_uint32_int.h"
 
 #include "cclog.h"
-#include <stdio.h>
-
-#define HASH_UINT32_BIT_SHIFT 2
-// 32 / 2 = 16 levels
-#define HASH_TREE_LEVELS 16
-#define HASH_TREE_LEVELS_MINUS_ONE 15
-#define HASH_UINT32_CHILDREN_PER_NODE 16
-// % 16 (modulo) == & 15 (binary operation)
-#define HASH_UINT32_BIN_MODULO 15 // 1111
-
-typedef struct _HashUInt32IntNode HashUInt32IntNode;
-
-struct _HashUInt32IntNode {
-    void **slots;
-    HashUInt32IntNode *parent;
-    uint8_t level;
-    uint8_t index;
-};
+
+// open addressing with linear probing, slots capacity is always a power of 2
+#define HASH_UINT32_INT_MIN_CAPACITY 16
+// grows when count reaches 3/4 of capacity
+#define HASH_UINT32_INT_MAX_LOAD_NUM 3
+#define HASH_UINT32_INT_MAX_LOAD_DEN 4
+
+typedef struct {
+    uint32_t key;
+    int value;
+} HashUInt32IntSlot;
 
 struct _HashUInt32Int {
-    HashUInt32IntNode *rootNode;
+    HashUInt32IntSlot *slots;
+    uint8_t *used; // 1 when slot is occupied
+    uint32_t capacity;
+    uint32_t count;
 };
 
-// when leaf == true, each branch slot contains a value, not another branch
-HashUInt32IntNode *hash_uint32_node_new(HashUInt32IntNode *parent, uint8_t index, uint8_t level) {
-    vx_assert(level <= HASH_TREE_LEVELS);
-    HashUInt32IntNode *const n = (HashUInt32IntNode *)malloc(sizeof(HashUInt32IntNode));
-    void **slots = (void **)malloc(sizeof(void *) * HASH_UINT32_CHILDREN_PER_NODE);
-    for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-        slots[i] = NULL;
+// murmur3 finalizer, spreads palette colors (close values) over all slots
+static uint32_t _hash_uint32_int_mix(uint32_t key) {
+    key ^= key >> 16;
+    key *= 0x85ebca6bu;
+    key ^= key >> 13;
+    key *= 0xc2b2ae35u;
+    key ^= key >> 16;
+    return key;
+}
+
+static bool _hash_uint32_int_alloc(HashUInt32Int *h, const uint32_t capacity) {
+    HashUInt32IntSlot *slots = (HashUInt32IntSlot *)malloc(sizeof(HashUInt32IntSlot) * capacity);
+    uint8_t *used = (uint8_t *)calloc(capacity, sizeof(uint8_t));
+    if (slots == NULL || used == NULL) {
+        cclog_error("hash_uint32_int: failed to allocate %u slots", capacity);
+        free(slots);
+        free(used);
+        return false;
     }
-    n->slots = slots;
-    n->parent = parent;
-    n->level = level;
-    n->index = index;
-    return n;
+    h->slots = slots;
+    h->used = used;
+    h->capacity = capacity;
+    h->count = 0;
+    return true;
 }
 
-// frees node and all children
-// + sets parent slot to NULL
-void hash_uint32_node_free(HashUInt32IntNode *n) {
-    HashUInt32IntNode *cursor = n;
-    HashUInt32IntNode *tmp = NULL;
-    uint8_t slotCursor = 0;
-    HashUInt32IntNode **slots;
-
-    while (cursor != NULL) {
-        if (slotCursor == HASH_UINT32_CHILDREN_PER_NODE ||
-            cursor->level == HASH_TREE_LEVELS_MINUS_ONE) {
-            // done freeing all children, or reached last level
-            tmp = cursor->parent;
-            slotCursor = cursor->index + 1;
-            for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-                if (cursor->slots[i] != NULL) {
-                    free(cursor->slots[i]);
-                    cursor->slots[i] = NULL;
-                }
-            }
-            if (tmp != NULL) {
-                // set parent slot to NULL
-                tmp->slots[cursor->index] = NULL;
-            }
-            if (cursor == n) {
-                // don't free nodes above n
-                tmp = NULL;
-            }
-            free(cursor->slots);
-            free(cursor);
-            cursor = tmp;
-            continue;
-        }
+// returns index of key's slot, or of the empty slot where it would be inserted
+static uint32_t _hash_uint32_int_find(const HashUInt32Int *h, const uint32_t key) {
+    const uint32_t mask = h->capacity - 1;
+    uint32_t i = _hash_uint32_int_mix(key) & mask;
+    while (h->used[i] && h->slots[i].key != key) {
+        i = (i + 1) & mask;
+    }
+    return i;
+}
+
+static bool _hash_uint32_int_grow(HashUInt32Int *h) {
+    HashUInt32IntSlot *const slots = h->slots;
+    uint8_t *const used = h->used;
+    const uint32_t capacity = h->capacity;
 
-        slots = (HashUInt32IntNode **)(cursor->slots);
-        if (slots[slotCursor] != NULL) {
-            cursor = slots[slotCursor];
-            slotCursor = 0;
-            continue;
+    if (_hash_uint32_int_alloc(h, capacity * 2) == false) {
+        return false; // h left untouched
+    }
+    for (uint32_t i = 0; i < capacity; ++i) {
+        if (used[i]) {
+            const uint32_t j = _hash_uint32_int_find(h, slots[i].key);
+            h->slots[j] = slots[i];
+            h->used[j] = 1;
+            ++h->count;
         }
-        ++slotCursor; // child is NULL, go see next
     }
+    free(slots);
+    free(used);
+    return true;
 }
 
 HashUInt32Int *hash_uint32_int_new(void) {
     HashUInt32Int *h = (HashUInt32Int *)malloc(sizeof(HashUInt32Int));
-    h->rootNode = hash_uint32_node_new(NULL, 0, 1);
+    if (h == NULL) {
+        return NULL;
+    }
+    if (_hash_uint32_int_alloc(h, HASH_UINT32_INT_MIN_CAPACITY) == false) {
+        free(h);
+        return NULL;
+    }
     return h;
 }
 
 void hash_uint32_int_free(HashUInt32Int *h) {
-    hash_uint32_node_free(h->rootNode);
+    if (h == NULL) {
+        return;
+    }
+    free(h->slots);
+    free(h->used);
     free(h);
 }
 
 void hash_uint32_int_set(HashUInt32Int *const h, uint32_t key, const int value) {
-    uint8_t level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
+    vx_assert(h != NULL);
 
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-        // cclog_debug("LEVEL: %d - modulo: %d", level, modulo);
-        ++level;
-        if (slots[modulo] == NULL) {
-            slots[modulo] = hash_uint32_node_new(n, modulo, level);
-        }
-        n = slots[modulo];
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-            slots = (HashUInt32IntNode **)(n->slots);
-            int *i = (int *)slots[modulo];
-
-            if (i == NULL) {
-                slots[modulo] = (void *)malloc(sizeof(int *));
-                i = (int *)slots[modulo];
-            }
+    uint32_t i = _hash_uint32_int_find(h, key);
+    if (h->used[i]) {
+        h->slots[i].value = value;
+        return;
+    }
 
-            *i = value;
+    if ((h->count + 1) * HASH_UINT32_INT_MAX_LOAD_DEN >
+        h->capacity * HASH_UINT32_INT_MAX_LOAD_NUM) {
+        if (_hash_uint32_int_grow(h) == false) {
             return;
         }
+        i = _hash_uint32_int_find(h, key);
     }
+
+    h->slots[i].key = key;
+    h->slots[i].value = value;
+    h->used[i] = 1;
+    ++h->count;
 }
 
 bool hash_uint32_int_get(HashUInt32Int *h, uint32_t key, int *outValue) {
-    int level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
+    vx_assert(h != NULL);
 
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-
-        if (slots[modulo] == NULL) {
-            return false;
-        }
-        n = slots[modulo];
-        ++level;
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-
-            slots = (HashUInt32IntNode **)(n->slots);
-            int *i = (int *)slots[modulo];
-
-            if (i == NULL) {
-                return false;
-            }
-
-            *outValue = *i;
-            return true;
-        }
+    const uint32_t i = _hash_uint32_int_find(h, key);
+    if (h->used[i] == 0) {
+        return false;
     }
-
-    vx_assert(false); // should never reach this point
-    return false;
+    if (outValue != NULL) {
+        *outValue = h->slots[i].value;
+    }
+    return true;
 }
 
 void hash_uint32_int_delete(HashUInt32Int *h, uint32_t key) {
-    int level = 1;
-    HashUInt32IntNode *n = h->rootNode;
-    HashUInt32IntNode *tmp = NULL;
-    vx_assert(n != NULL);
-    uint8_t modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-    HashUInt32IntNode **slots;
+    vx_assert(h != NULL);
 
-    while (true) {
-        slots = (HashUInt32IntNode **)(n->slots);
-
-        if (slots[modulo] == NULL) {
-            // not found, nothing to delete
-            return;
-        }
-        n = slots[modulo];
-        ++level;
-        key = key >> HASH_UINT32_BIT_SHIFT;
-        modulo = (uint8_t)(key & HASH_UINT32_BIN_MODULO);
-
-        if (level == HASH_TREE_LEVELS_MINUS_ONE) {
-
-            slots = (HashUInt32IntNode **)(n->slots);
+    const uint32_t mask = h->capacity - 1;
+    uint32_t i = _hash_uint32_int_find(h, key);
+    if (h->used[i] == 0) {
+        return; // not found, nothing to delete
+    }
 
-            if (slots[modulo] == NULL) {
-                // not found, nothing to delete
+    // backward shift deletion: no tombstones, probe sequences stay short
+    uint32_t j = i;
+    while (true) {
+        h->used[i] = 0;
+        while (true) {
+            j = (j + 1) & mask;
+            if (h->used[j] == 0) {
+                --h->count;
                 return;
             }
-
-            free(slots[modulo]); // free int* (value)
-            slots[modulo] = NULL;
-            break;
-        }
-    }
-
-    // cleanup empty parents (except root node)
-    while (n != NULL && n->level > 1) {
-        for (int i = 0; i < HASH_UINT32_CHILDREN_PER_NODE; ++i) {
-            if (n->slots[i] != NULL) {
-                return; // at least one slot not empty, stop
+            // entry at j can move into the hole at i if its ideal slot isn't within (i, j]
+            const uint32_t ideal = _hash_uint32_int_mix(h->slots[j].key) & mask;
+            if (((j - ideal) & mask) >= ((j - i) & mask)) {
+                break;
             }
         }
-        tmp = n->parent;
-        hash_uint32_node_free(n);
-        n = tmp;
+        h->slots[i] = h->slots[j];
+        h->used[i] = 1;
+        i = j;
     }
 }
@@ -4,8 +4,8 @@
 //  Created by Adrien Duermael on August 15, 2022.
 // -------------------------------------------------------------
 
-// Allows to register uint32 values and quickly find out if some value is registered.
-// In that kind of hash, the key stored and the value are the same.
+// Maps uint32 keys to int values (e.g. colors to palette indexes).
+// Open addressing table with linear probing: keys & values are stored in one flat array.
 
 #pragma once
 
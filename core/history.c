@@ -10,7 +10,10 @@
 #include <stdlib.h>
 
 #include "block.h"
+#include "blockChange.h"
+#include "block_change_list.h"
 #include "cclog.h"
+#include "index3d.h"
 #include "int3.h"
 #include "shape.h"
 #include "transaction.h"
@@ -18,24 +21,28 @@
 typedef struct _HistoryTransaction HistoryTransaction;
 
 void _history_flush(History *const h);
+void _history_push(History *const h, HistoryTransaction *const htr);
+void _history_enforce_byte_limit(History *const h);
 
 struct _HistoryTransaction {
     HistoryTransaction *previousAction; // 8 bytes
     HistoryTransaction *nextAction;     // 8 bytes
-    Transaction *transaction;           // 8 bytes
+    BlockChangeList *changes;           // 8 bytes
+    size_t byteSize;                    // 8 bytes
 };
 
-HistoryTransaction *history_transaction_new(Transaction *const tr) {
+HistoryTransaction *history_transaction_new(BlockChangeList *const changes) {
     HistoryTransaction *ht = (HistoryTransaction *)malloc(sizeof(HistoryTransaction));
     ht->previousAction = NULL;
     ht->nextAction = NULL;
-    ht->transaction = tr;
+    ht->changes = changes;
+    ht->byteSize = sizeof(HistoryTransaction) + block_change_list_get_byte_size(changes);
     return ht;
 }
 
 void history_transaction_free(HistoryTransaction *const ht) {
     if (ht != NULL) {
-        transaction_free(ht->transaction);
+        block_change_list_free(ht->changes);
         free(ht);
     }
 }
@@ -46,8 +53,10 @@ struct _History {
     HistoryTransaction *oldest; // 8 bytes
     HistoryTransaction *cursor; // 8 bytes
 
-    uint16_t limit;     // 2 bytes
-    uint16_t nbActions; // 2 bytes
+    size_t byteLimit; // 8 bytes
+    size_t byteSize;  // 8 bytes
+
+    uint32_t nbActions; // 4 bytes
 
     char pad[4]; // 4 bytes
 };
@@ -58,7 +67,8 @@ History *history_new(void) {
     h->latest = NULL;
     h->oldest = NULL;
     h->cursor = NULL;
-    h->limit = NB_UNDOABLE_ACTIONS;
+    h->byteLimit = HISTORY_MAX_BYTES;
+    h->byteSize = 0;
     h->nbActions = 0;
     return h;
 }
@@ -79,7 +89,49 @@ void history_pushTransaction(History *const h, Transaction *const tr) {
         return;
     }
 
-    HistoryTransaction *const htr = history_transaction_new(tr);
+    // only keep colors before & after the transaction for each block
+    BlockChangeList *changes = block_change_list_new();
+    if (changes == NULL) {
+        transaction_free(tr);
+        return;
+    }
+
+    transaction_resetIndex3DIterator(tr);
+    Index3DIterator *it = transaction_getIndex3DIterator(tr);
+    SHAPE_COORDS_INT_T x, y, z;
+    SHAPE_COLOR_INDEX_INT_T before, after;
+    const BlockChange *bc;
+    while (it != NULL && index3d_iterator_pointer(it) != NULL) {
+        bc = (const BlockChange *)index3d_iterator_pointer(it);
+        blockChange_getXYZ(bc, &x, &y, &z);
+        before = blockChange_get_previous_color(bc);
+        after = blockChange_getBlock(bc)->colorIndex;
+        if (before != after && block_change_list_push(changes, x, y, z, before, after) == false) {
+            // an incomplete entry would undo/redo wrong content
+            block_change_list_free(changes);
+            transaction_free(tr);
+            return;
+        }
+        index3d_iterator_next(it);
+    }
+    transaction_free(tr);
+
+    history_pushChangeList(h, changes);
+}
+
+void history_pushChangeList(History *const h, BlockChangeList *const changes) {
+    vx_assert(h != NULL);
+    vx_assert(changes != NULL);
+
+    if (h == NULL || changes == NULL) {
+        return;
+    }
+
+    block_change_list_pack(changes);
+    _history_push(h, history_transaction_new(changes));
+}
+
+void _history_push(History *const h, HistoryTransaction *const htr) {
 
     if (h->oldest == NULL) {
         // history doesn't contain anything yet, we are setting the first transaction in it.
@@ -96,6 +148,7 @@ void history_pushTransaction(History *const h, Transaction *const tr) {
         h->cursor = htr;
         h->latest = htr;
         h->nbActions = 1;
+        h->byteSize = htr->byteSize;
 
     } else {
         // there is at least one transaction in history
@@ -121,40 +174,10 @@ void history_pushTransaction(History *const h, Transaction *const tr) {
         h->latest = htr;
         h->cursor = h->latest;
         h->nbActions++;
+        h->byteSize += htr->byteSize;
     }
 
-    // if there's no space to add an action, we remove the oldest ones
-    while (h->nbActions > h->limit) {
-        if (h->oldest != NULL) {
-            // there is at least one action in history
-            HistoryTransaction *toDelete = h->oldest;
-
-            if (h->oldest->nextAction == NULL) {
-                // there is only one action in history, empty the history
-                h->oldest = NULL;
-                h->cursor = NULL;
-                h->latest = NULL;
-            } else {
-                // there are more than one action in history
-                // set new oldest action
-                h->oldest = h->oldest->nextAction;
-                // new oldest cannot have a previous
-                h->oldest->previousAction = NULL;
-            }
-
-            history_transaction_free(toDelete);
-            h->nbActions--;
-        } else {
-            // do nothing if there is no oldest action (cursor and latest should be NULL)
-            if (h->cursor != NULL || h->latest != NULL) {
-                cclog_error("HISTORY",
-                            "cursor (%p) and latest (%p) should be NULL [2]",
-                            (void *)h->cursor,
-                            (void *)h->latest);
-                return;
-            }
-        }
-    }
+    _history_enforce_byte_limit(h);
 }
 
 bool history_can_undo(const History *const h) {
@@ -165,7 +188,7 @@ bool history_can_undo(const History *const h) {
     return h->cursor != NULL;
 }
 
-Transaction *history_getTransactionToUndo(History *const h) {
+const BlockChangeList *history_getChangesToUndo(History *const h) {
     if (h == NULL) {
         cclog_error("HISTORY", "%s error: history reference is NULL", __func__);
         return NULL;
@@ -175,13 +198,13 @@ Transaction *history_getTransactionToUndo(History *const h) {
         return NULL;
     }
 
-    // transaction to undo
-    Transaction *tr = h->cursor->transaction;
+    // entry to undo
+    const BlockChangeList *changes = h->cursor->changes;
 
     // update h->cursor with h->cursor->previous value
     h->cursor = h->cursor->previousAction;
 
-    return tr;
+    return changes;
 }
 
 bool history_can_redo(const History *const h) {
@@ -189,27 +212,44 @@ bool history_can_redo(const History *const h) {
            (h->cursor != NULL && h->cursor->nextAction != NULL);
 }
 
-Transaction *history_getTransactionToRedo(History *const h) {
+const BlockChangeList *history_getChangesToRedo(History *const h) {
     if (h == NULL) {
         cclog_error("HISTORY", "%s error: history reference is NULL", __func__);
         return NULL;
     }
 
-    Transaction *tr = NULL;
+    HistoryTransaction *htr = NULL;
 
     if (h->cursor == NULL) {
-        // the transaction to redo is "oldest"
-        if (h->oldest != NULL) {
-            tr = h->oldest->transaction;
-            h->cursor = h->oldest;
-        }
-    } else if (h->cursor->nextAction != NULL) {
-        tr = h->cursor->nextAction->transaction;
-        // update h->cursor with h->cursor->next value
-        h->cursor = h->cursor->nextAction;
+        // the entry to redo is "oldest"
+        htr = h->oldest;
+    } else {
+        htr = h->cursor->nextAction;
+    }
+
+    if (htr == NULL) {
+        return NULL;
+    }
+
+    h->cursor = htr;
+
+    return htr->changes;
+}
+
+void history_set_byte_limit(History *const h, const size_t limit) {
+    if (h == NULL) {
+        return;
     }
+    h->byteLimit = limit;
+    _history_enforce_byte_limit(h);
+}
 
-    return tr;
+size_t history_get_byte_limit(const History *const h) {
+    return h != NULL ? h->byteLimit : 0;
+}
+
+size_t history_get_byte_size(const History *const h) {
+    return h != NULL ? h->byteSize : 0;
 }
 
 void _history_flush(History *const h) {
@@ -228,6 +268,7 @@ void _history_flush(History *const h) {
     h->cursor = NULL;
     h->latest = NULL;
     h->nbActions = 0;
+    h->byteSize = 0;
 }
 
 void history_discardTransactionsMoreRecentThanCursor(History *const h) {
@@ -250,6 +291,7 @@ void history_discardTransactionsMoreRecentThanCursor(History *const h) {
     while (afterCursor != NULL) {
         HistoryTransaction *toDelete = afterCursor;
         afterCursor = afterCursor->nextAction;
+        h->byteSize -= toDelete->byteSize;
         history_transaction_free(toDelete);
         h->nbActions--;
     }
@@ -259,3 +301,20 @@ void history_discardTransactionsMoreRecentThanCursor(History *const h) {
     }
     h->latest = h->cursor;
 }
+
+void _history_enforce_byte_limit(History *const h) {
+    // Only entries that have been applied can be discarded, discarding an undone entry
+    // would break the redo chain. When oldest is the cursor, cursor becomes NULL, which
+    // is consistent: there is nothing left to undo, and next entry can still be redone.
+    while (h->byteSize > h->byteLimit && h->cursor != NULL && h->oldest != h->latest) {
+        HistoryTransaction *toDelete = h->oldest;
+        if (h->cursor == toDelete) {
+            h->cursor = NULL;
+        }
+        h->oldest = toDelete->nextAction;
+        h->oldest->previousAction = NULL;
+        h->byteSize -= toDelete->byteSize;
+        history_transaction_free(toDelete);
+        h->nbActions--;
+    }
+}
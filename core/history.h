@@ -11,12 +11,16 @@ extern "C" {
 #endif
 
 #include <stdbool.h>
+#include <stddef.h>
 
 // An history is used to keep the last actions received by a World
 // It can be used to undo/redo operations.
+// Entries are stored as packed block change lists, history memory is bounded by bytes
+// (HISTORY_MAX_BYTES by default) rather than by number of actions.
 typedef struct _History History;
 typedef struct _Shape Shape;
 typedef struct _Transaction Transaction;
+typedef struct _BlockChangeList BlockChangeList;
 
 ///
 History *history_new(void);
@@ -27,16 +31,25 @@ void history_free(History *const h);
 ///
 void history_discardTransactionsMoreRecentThanCursor(History *const h);
 
-///
+/// Records an applied transaction as a packed change list, history takes ownership of
+/// the transaction and frees it right away.
 void history_pushTransaction(History *const h, Transaction *const tr);
 
-///
+/// Pushes a compact record of a bulk edit, history takes ownership of the list
+void history_pushChangeList(History *const h, BlockChangeList *const changes);
+
+/// Returns NULL if there is nothing to undo/redo, returned list remains owned by history.
 bool history_can_undo(const History *const h);
-Transaction *history_getTransactionToUndo(History *const h);
+const BlockChangeList *history_getChangesToUndo(History *const h);
 
 ///
 bool history_can_redo(const History *const h);
-Transaction *history_getTransactionToRedo(History *const h);
+const BlockChangeList *history_getChangesToRedo(History *const h);
+
+/// Oldest entries are discarded when exceeding the limit, the most recent one is always kept.
+void history_set_byte_limit(History *const h, const size_t limit);
+size_t history_get_byte_limit(const History *const h);
+size_t history_get_byte_size(const History *const h);
 
 #ifdef __cplusplus
 } // extern "C"
@@ -0,0 +1,482 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  instance_group.c
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#include "instance_group.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "box.h"
+#include "config.h"
+
+#define INSTANCE_GROUP_DEFAULT_CAPACITY 16
+// internal flag, instance is in dirty list
+#define INSTANCE_FLAG_DIRTY 128
+
+struct _InstanceGroup {
+    Shape *shape;         /* 8 bytes */
+    Transform *transform; /* 8 bytes */
+    Rtree *rtree;         /* 8 bytes */
+    Weakptr *wptr;        /* 8 bytes */
+    // shared by all instance colliders, never simulated
+    RigidBody *rb; /* 8 bytes */
+
+    // dense arrays, one element per instance
+    float3 *positions;      /* 8 bytes */
+    Quaternion *rotations;  /* 8 bytes */
+    float3 *scales;         /* 8 bytes */
+    Matrix4x4 *matrices;    /* 8 bytes */
+    Box *aabbs;             /* 8 bytes */
+    RtreeNode **leaves;     /* 8 bytes */
+    uint16_t *layers;       /* 8 bytes */
+    uint8_t *flags;         /* 8 bytes */
+    InstanceID *ids;        /* 8 bytes */
+
+    // sparse array, InstanceID to dense index (INSTANCE_ID_NONE for free IDs)
+    uint32_t *indexes; /* 8 bytes */
+    // free IDs, reused before allocating new ones
+    InstanceID *freeIDs; /* 8 bytes */
+    // IDs of modified instances
+    InstanceID *dirty; /* 8 bytes */
+
+    // group transform ltw, source shape pivot & model AABB used for latest refresh
+    Matrix4x4 ltw; /* 64 bytes */
+    Box model;     /* 24 bytes */
+    float3 pivot;  /* 12 bytes */
+
+    uint32_t count;        /* 4 bytes */
+    uint32_t capacity;     /* 4 bytes */
+    uint32_t nbIDs;        /* 4 bytes */
+    uint32_t idsCapacity;  /* 4 bytes */
+    uint32_t nbFreeIDs;    /* 4 bytes */
+    uint32_t nbDirty;      /* 4 bytes */
+    // all instances must be refreshed
+    bool allDirty; /* 1 byte */
+
+    char pad[3];
+};
+
+static bool _instance_group_reserve(InstanceGroup *g, const uint32_t capacity);
+static bool _instance_group_reserve_ids(InstanceGroup *g, const uint32_t capacity);
+static void _instance_group_set_dirty(InstanceGroup *g, const uint32_t index);
+static void _instance_group_refresh_instance(InstanceGroup *g, const uint32_t index);
+
+InstanceGroup *instance_group_new(Shape *source) {
+    InstanceGroup *g = (InstanceGroup *)malloc(sizeof(InstanceGroup));
+    if (g == NULL) {
+        return NULL;
+    }
+    shape_retain(source);
+    g->shape = source;
+    g->transform = transform_new(HierarchyTransform);
+    g->rtree = rtree_new(RTREE_NODE_MIN_CAPACITY, RTREE_NODE_MAX_CAPACITY);
+    g->wptr = NULL;
+    g->rb = rigidbody_new(RigidbodyMode_Static,
+                          PHYSICS_GROUP_DEFAULT_OBJECT,
+                          PHYSICS_COLLIDESWITH_DEFAULT_OBJECT);
+
+    g->positions = NULL;
+    g->rotations = NULL;
+    g->scales = NULL;
+    g->matrices = NULL;
+    g->aabbs = NULL;
+    g->leaves = NULL;
+    g->layers = NULL;
+    g->flags = NULL;
+    g->ids = NULL;
+    g->indexes = NULL;
+    g->freeIDs = NULL;
+    g->dirty = NULL;
+
+    g->ltw = matrix4x4_identity;
+    g->model = shape_get_model_aabb(source);
+    g->pivot = shape_get_pivot(source);
+    g->count = 0;
+    g->capacity = 0;
+    g->nbIDs = 0;
+    g->idsCapacity = 0;
+    g->nbFreeIDs = 0;
+    g->nbDirty = 0;
+    g->allDirty = true;
+
+    return g;
+}
+
+void instance_group_free(InstanceGroup *g) {
+    if (g == NULL) {
+        return;
+    }
+    weakptr_invalidate(g->wptr);
+    rtree_free(g->rtree);
+    rigidbody_free(g->rb);
+    transform_remove_parent(g->transform, false);
+    transform_release(g->transform);
+    shape_release(g->shape);
+
+    free(g->positions);
+    free(g->rotations);
+    free(g->scales);
+    free(g->matrices);
+    free(g->aabbs);
+    free(g->leaves);
+    free(g->layers);
+    free(g->flags);
+    free(g->ids);
+    free(g->indexes);
+    free(g->freeIDs);
+    free(g->dirty);
+    free(g);
+}
+
+Weakptr *instance_group_get_weakptr(InstanceGroup *g) {
+    if (g->wptr == NULL) {
+        g->wptr = weakptr_new(g);
+    }
+    return g->wptr;
+}
+
+Weakptr *instance_group_get_and_retain_weakptr(InstanceGroup *g) {
+    if (g->wptr == NULL) {
+        g->wptr = weakptr_new(g);
+    }
+    if (weakptr_retain(g->wptr)) {
+        return g->wptr;
+    } else { // this can only happen if weakptr ref count is at max
+        return NULL;
+    }
+}
+
+Shape *instance_group_get_shape(const InstanceGroup *g) {
+    return g->shape;
+}
+
+Transform *instance_group_get_transform(const InstanceGroup *g) {
+    return g->transform;
+}
+
+Rtree *instance_group_get_rtree(const InstanceGroup *g) {
+    return g->rtree;
+}
+
+RigidBody *instance_group_get_rigidbody(const InstanceGroup *g) {
+    return g->rb;
+}
+
+size_t instance_group_get_count(const InstanceGroup *g) {
+    return g->count;
+}
+
+void instance_group_set_collision_masks(InstanceGroup *g,
+                                        const uint16_t groups,
+                                        const uint16_t collidesWith) {
+    if (rigidbody_get_groups(g->rb) == groups &&
+        rigidbody_get_collides_with(g->rb) == collidesWith) {
+        return;
+    }
+    rigidbody_set_groups(g->rb, groups);
+    rigidbody_set_collides_with(g->rb, collidesWith);
+    for (uint32_t i = 0; i < g->count; ++i) {
+        if (g->leaves[i] != NULL) {
+            rtree_node_set_collision_masks(g->leaves[i], groups, collidesWith);
+        }
+    }
+    rtree_refresh_collision_masks(g->rtree);
+}
+
+InstanceID instance_group_add(InstanceGroup *g,
+                              const float3 *position,
+                              const Quaternion *rotation,
+                              const float3 *scale,
+                              const uint16_t layers,
+                              const uint8_t flags) {
+    if (g->count == g->capacity) {
+        const uint32_t capacity = g->capacity == 0 ? INSTANCE_GROUP_DEFAULT_CAPACITY
+                                                   : g->capacity * 2;
+        if (_instance_group_reserve(g, capacity) == false) {
+            return INSTANCE_ID_NONE;
+        }
+    }
+
+    InstanceID id;
+    if (g->nbFreeIDs > 0) {
+        id = g->freeIDs[--g->nbFreeIDs];
+    } else {
+        if (g->nbIDs == g->idsCapacity) {
+            const uint32_t capacity = g->idsCapacity == 0 ? INSTANCE_GROUP_DEFAULT_CAPACITY
+                                                          : g->idsCapacity * 2;
+            if (_instance_group_reserve_ids(g, capacity) == false) {
+                return INSTANCE_ID_NONE;
+            }
+        }
+        id = g->nbIDs++;
+    }
+
+    const uint32_t index = g->count++;
+    g->indexes[id] = index;
+    g->ids[index] = id;
+    g->positions[index] = position != NULL ? *position : float3_zero;
+    g->rotations[index] = rotation != NULL ? *rotation : quaternion_identity;
+    g->scales[index] = scale != NULL ? *scale : float3_one;
+    g->matrices[index] = matrix4x4_identity;
+    g->aabbs[index] = (Box){float3_zero, float3_zero};
+    g->leaves[index] = NULL;
+    g->layers[index] = layers;
+    g->flags[index] = flags & (uint8_t)~INSTANCE_FLAG_DIRTY;
+
+    _instance_group_set_dirty(g, index);
+
+    return id;
+}
+
+bool instance_group_remove(InstanceGroup *g, const InstanceID id) {
+    if (instance_group_contains(g, id) == false) {
+        return false;
+    }
+    const uint32_t index = g->indexes[id];
+
+    if (g->leaves[index] != NULL) {
+        rtree_remove(g->rtree, g->leaves[index], true);
+    }
+    if (g->flags[index] & INSTANCE_FLAG_DIRTY) {
+        for (uint32_t i = 0; i < g->nbDirty; ++i) {
+            if (g->dirty[i] == id) {
+                g->dirty[i] = g->dirty[--g->nbDirty];
+                break;
+            }
+        }
+    }
+
+    // move last instance in removed slot
+    const uint32_t last = g->count - 1;
+    if (index != last) {
+        g->positions[index] = g->positions[last];
+        g->rotations[index] = g->rotations[last];
+        g->scales[index] = g->scales[last];
+        g->matrices[index] = g->matrices[last];
+        g->aabbs[index] = g->aabbs[last];
+        g->leaves[index] = g->leaves[last];
+        g->layers[index] = g->layers[last];
+        g->flags[index] = g->flags[last];
+        g->ids[index] = g->ids[last];
+        g->indexes[g->ids[index]] = index;
+    }
+    --g->count;
+
+    g->indexes[id] = INSTANCE_ID_NONE;
+    g->freeIDs[g->nbFreeIDs++] = id;
+
+    return true;
+}
+
+bool instance_group_contains(const InstanceGroup *g, const InstanceID id) {
+    return id < g->nbIDs && g->indexes[id] != INSTANCE_ID_NONE;
+}
+
+void instance_group_set_position(InstanceGroup *g, const InstanceID id, const float3 *position) {
+    if (instance_group_contains(g, id) == false) {
+        return;
+    }
+    const uint32_t index = g->indexes[id];
+    g->positions[index] = *position;
+    _instance_group_set_dirty(g, index);
+}
+
+void instance_group_set_rotation(InstanceGroup *g, const InstanceID id, const Quaternion *rotation) {
+    if (instance_group_contains(g, id) == false) {
+        return;
+    }
+    const uint32_t index = g->indexes[id];
+    g->rotations[index] = *rotation;
+    _instance_group_set_dirty(g, index);
+}
+
+void instance_group_set_scale(InstanceGroup *g, const InstanceID id, const float3 *scale) {
+    if (instance_group_contains(g, id) == false) {
+        return;
+    }
+    const uint32_t index = g->indexes[id];
+    g->scales[index] = *scale;
+    _instance_group_set_dirty(g, index);
+}
+
+void instance_group_set_layers(InstanceGroup *g, const InstanceID id, const uint16_t layers) {
+    if (instance_group_contains(g, id) == false) {
+        return;
+    }
+    g->layers[g->indexes[id]] = layers;
+}
+
+void instance_group_set_flags(InstanceGroup *g, const InstanceID id, const uint8_t flags) {
+    if (instance_group_contains(g, id) == false) {
+        return;
+    }
+    const uint32_t index = g->indexes[id];
+    const uint8_t prev = g->flags[index];
+    g->flags[index] = (uint8_t)((prev & INSTANCE_FLAG_DIRTY) | (flags & ~INSTANCE_FLAG_DIRTY));
+    if ((prev & INSTANCE_FLAG_COLLIDER) != (flags & INSTANCE_FLAG_COLLIDER)) {
+        _instance_group_set_dirty(g, index);
+    }
+}
+
+const float3 *instance_group_get_position(const InstanceGroup *g, const InstanceID id) {
+    return instance_group_contains(g, id) ? &g->positions[g->indexes[id]] : NULL;
+}
+
+const Quaternion *instance_group_get_rotation(const InstanceGroup *g, const InstanceID id) {
+    return instance_group_contains(g, id) ? &g->rotations[g->indexes[id]] : NULL;
+}
+
+const float3 *instance_group_get_scale(const InstanceGroup *g, const InstanceID id) {
+    return instance_group_contains(g, id) ? &g->scales[g->indexes[id]] : NULL;
+}
+
+uint16_t instance_group_get_layers(const InstanceGroup *g, const InstanceID id) {
+    return instance_group_contains(g, id) ? g->layers[g->indexes[id]] : 0;
+}
+
+uint8_t instance_group_get_flags(const InstanceGroup *g, const InstanceID id) {
+    return instance_group_contains(g, id)
+               ? (uint8_t)(g->flags[g->indexes[id]] & ~INSTANCE_FLAG_DIRTY)
+               : INSTANCE_FLAG_NONE;
+}
+
+size_t instance_group_refresh(InstanceGroup *g) {
+    transform_refresh(g->transform, false, true);
+    const Matrix4x4 *ltw = transform_get_ltw(g->transform);
+    if (memcmp(ltw, &g->ltw, sizeof(Matrix4x4)) != 0) {
+        g->ltw = *ltw;
+        g->allDirty = true;
+    }
+    const Box model = shape_get_model_aabb(g->shape);
+    const float3 pivot = shape_get_pivot(g->shape);
+    if (box_equals(&model, &g->model, EPSILON_ZERO) == false ||
+        float3_isEqual(&pivot, &g->pivot, EPSILON_ZERO) == false) {
+        g->model = model;
+        g->pivot = pivot;
+        g->allDirty = true;
+    }
+
+    size_t refreshed = 0;
+    if (g->allDirty) {
+        for (uint32_t i = 0; i < g->count; ++i) {
+            _instance_group_refresh_instance(g, i);
+        }
+        refreshed = g->count;
+        g->allDirty = false;
+    } else {
+        for (uint32_t i = 0; i < g->nbDirty; ++i) {
+            _instance_group_refresh_instance(g, g->indexes[g->dirty[i]]);
+        }
+        refreshed = g->nbDirty;
+    }
+    g->nbDirty = 0;
+
+    return refreshed;
+}
+
+const Matrix4x4 *instance_group_get_model_matrices(const InstanceGroup *g) {
+    return g->matrices;
+}
+
+const uint16_t *instance_group_get_layers_array(const InstanceGroup *g) {
+    return g->layers;
+}
+
+const uint8_t *instance_group_get_flags_array(const InstanceGroup *g) {
+    return g->flags;
+}
+
+const InstanceID *instance_group_get_ids_array(const InstanceGroup *g) {
+    return g->ids;
+}
+
+InstanceID instance_group_leaf_get_id(const RtreeNode *leaf) {
+    return (InstanceID)((uintptr_t)rtree_node_get_leaf_ptr(leaf) - 1);
+}
+
+bool instance_group_get_world_aabb(const InstanceGroup *g, const InstanceID id, Box *box) {
+    if (instance_group_contains(g, id) == false) {
+        return false;
+    }
+    *box = g->aabbs[g->indexes[id]];
+    return true;
+}
+
+// MARK: - private functions -
+
+#define _INSTANCE_GROUP_REALLOC(field, type, n)                                                    \
+    {                                                                                              \
+        type *resized = (type *)realloc(field, (n) * sizeof(type));                                \
+        if (resized == NULL) {                                                                     \
+            return false;                                                                          \
+        }                                                                                          \
+        field = resized;                                                                           \
+    }
+
+static bool _instance_group_reserve(InstanceGroup *g, const uint32_t capacity) {
+    _INSTANCE_GROUP_REALLOC(g->positions, float3, capacity)
+    _INSTANCE_GROUP_REALLOC(g->rotations, Quaternion, capacity)
+    _INSTANCE_GROUP_REALLOC(g->scales, float3, capacity)
+    _INSTANCE_GROUP_REALLOC(g->matrices, Matrix4x4, capacity)
+    _INSTANCE_GROUP_REALLOC(g->aabbs, Box, capacity)
+    _INSTANCE_GROUP_REALLOC(g->leaves, RtreeNode *, capacity)
+    _INSTANCE_GROUP_REALLOC(g->layers, uint16_t, capacity)
+    _INSTANCE_GROUP_REALLOC(g->flags, uint8_t, capacity)
+    _INSTANCE_GROUP_REALLOC(g->ids, InstanceID, capacity)
+    // an instance may be dirty only once, see INSTANCE_FLAG_DIRTY
+    _INSTANCE_GROUP_REALLOC(g->dirty, InstanceID, capacity)
+    g->capacity = capacity;
+    return true;
+}
+
+static bool _instance_group_reserve_ids(InstanceGroup *g, const uint32_t capacity) {
+    _INSTANCE_GROUP_REALLOC(g->indexes, uint32_t, capacity)
+    _INSTANCE_GROUP_REALLOC(g->freeIDs, InstanceID, capacity)
+    g->idsCapacity = capacity;
+    return true;
+}
+
+#undef _INSTANCE_GROUP_REALLOC
+
+static void _instance_group_set_dirty(InstanceGroup *g, const uint32_t index) {
+    if (g->allDirty || (g->flags[index] & INSTANCE_FLAG_DIRTY)) {
+        return;
+    }
+    g->flags[index] |= INSTANCE_FLAG_DIRTY;
+    g->dirty[g->nbDirty++] = g->ids[index];
+}
+
+static void _instance_group_refresh_instance(InstanceGroup *g, const uint32_t index) {
+    g->flags[index] &= (uint8_t)~INSTANCE_FLAG_DIRTY;
+
+    // model matrix = group ltw * instance SRT, offset by shape pivot
+    Matrix4x4 *mtx = &g->matrices[index];
+    transform_utils_compute_SRT(mtx, &g->scales[index], &g->rotations[index], &g->positions[index]);
+    matrix4x4_op_multiply_2(&g->ltw, mtx);
+
+    const float3 pivot = g->pivot;
+    const Matrix4x4 m = *mtx;
+    mtx->x4y1 -= m.x1y1 * pivot.x + m.x2y1 * pivot.y + m.x3y1 * pivot.z;
+    mtx->x4y2 -= m.x1y2 * pivot.x + m.x2y2 * pivot.y + m.x3y2 * pivot.z;
+    mtx->x4y3 -= m.x1y3 * pivot.x + m.x2y3 * pivot.y + m.x3y3 * pivot.z;
+
+    box_to_aabox2(&g->model, &g->aabbs[index], mtx, NULL, NoSquarify);
+
+    if (g->flags[index] & INSTANCE_FLAG_COLLIDER) {
+        if (g->leaves[index] == NULL) {
+            g->leaves[index] = rtree_create_and_insert(g->rtree,
+                                                       &g->aabbs[index],
+                                                       rigidbody_get_groups(g->rb),
+                                                       rigidbody_get_collides_with(g->rb),
+                                                       (void *)(uintptr_t)(g->ids[index] + 1));
+        } else {
+            rtree_update(g->rtree, g->leaves[index], &g->aabbs[index]);
+        }
+    } else if (g->leaves[index] != NULL) {
+        rtree_remove(g->rtree, g->leaves[index], true);
+        g->leaves[index] = NULL;
+    }
+}
@@ -0,0 +1,108 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  instance_group.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "float3.h"
+#include "matrix4x4.h"
+#include "quaternion.h"
+#include "rtree.h"
+#include "shape.h"
+#include "transform.h"
+#include "weakptr.h"
+
+/// An instance group draws the same source shape many times, without a Shape or a Transform
+/// per instance. Instances local transformations, layers and flags are stored in compact arrays
+/// (one array per field), so that a renderer can upload them as-is for a single instanced draw.
+///
+/// Instances are relative to the group transform, which can be parented in the scene hierarchy.
+/// World matrices are refreshed for modified instances only, or for all instances if the group
+/// transform moved or if source shape pivot or bounding box changed. Instances with
+/// INSTANCE_FLAG_COLLIDER get a leaf in the group r-tree, leaf ptr is an encoded InstanceID (see
+/// instance_group_leaf_get_id). Scene physics & casts solve them as static world-aligned boxes,
+/// reported on the group transform; they do not fire collision callbacks.
+///
+/// Dense arrays indexes are not stable, instances are identified by InstanceID.
+typedef struct _InstanceGroup InstanceGroup;
+
+typedef uint32_t InstanceID;
+#define INSTANCE_ID_NONE UINT32_MAX
+
+// instance flags
+#define INSTANCE_FLAG_NONE 0
+#define INSTANCE_FLAG_HIDDEN 1
+#define INSTANCE_FLAG_COLLIDER 2
+
+/// Source shape is retained by the group
+InstanceGroup *instance_group_new(Shape *source);
+void instance_group_free(InstanceGroup *g);
+Weakptr *instance_group_get_weakptr(InstanceGroup *g);
+Weakptr *instance_group_get_and_retain_weakptr(InstanceGroup *g);
+
+Shape *instance_group_get_shape(const InstanceGroup *g);
+Transform *instance_group_get_transform(const InstanceGroup *g);
+Rtree *instance_group_get_rtree(const InstanceGroup *g);
+/// Static rigidbody shared by all instance colliders for collision masks, friction & bounciness,
+/// it isn't simulated. Collision masks must be set w/ instance_group_set_collision_masks
+RigidBody *instance_group_get_rigidbody(const InstanceGroup *g);
+size_t instance_group_get_count(const InstanceGroup *g);
+
+/// Collision masks used for all instances r-tree leaves
+void instance_group_set_collision_masks(InstanceGroup *g,
+                                        const uint16_t groups,
+                                        const uint16_t collidesWith);
+
+/// Returns INSTANCE_ID_NONE if memory could not be allocated
+InstanceID instance_group_add(InstanceGroup *g,
+                              const float3 *position,
+                              const Quaternion *rotation,
+                              const float3 *scale,
+                              const uint16_t layers,
+                              const uint8_t flags);
+/// Last instance takes the place of removed instance in dense arrays
+bool instance_group_remove(InstanceGroup *g, const InstanceID id);
+bool instance_group_contains(const InstanceGroup *g, const InstanceID id);
+
+void instance_group_set_position(InstanceGroup *g, const InstanceID id, const float3 *position);
+void instance_group_set_rotation(InstanceGroup *g, const InstanceID id, const Quaternion *rotation);
+void instance_group_set_scale(InstanceGroup *g, const InstanceID id, const float3 *scale);
+void instance_group_set_layers(InstanceGroup *g, const InstanceID id, const uint16_t layers);
+void instance_group_set_flags(InstanceGroup *g, const InstanceID id, const uint8_t flags);
+const float3 *instance_group_get_position(const InstanceGroup *g, const InstanceID id);
+const Quaternion *instance_group_get_rotation(const InstanceGroup *g, const InstanceID id);
+const float3 *instance_group_get_scale(const InstanceGroup *g, const InstanceID id);
+uint16_t instance_group_get_layers(const InstanceGroup *g, const InstanceID id);
+uint8_t instance_group_get_flags(const InstanceGroup *g, const InstanceID id);
+
+/// Refreshes world matrices & r-tree leaves of modified instances, called by scene_refresh for
+/// groups added to a scene. Returns number of instances refreshed.
+size_t instance_group_refresh(InstanceGroup *g);
+
+/// MARK: - Render data -
+/// Dense arrays of instance_group_get_count elements, valid until next add/remove.
+/// Matrices include source shape pivot, they are ready to be used as model matrices.
+
+const Matrix4x4 *instance_group_get_model_matrices(const InstanceGroup *g);
+const uint16_t *instance_group_get_layers_array(const InstanceGroup *g);
+const uint8_t *instance_group_get_flags_array(const InstanceGroup *g);
+const InstanceID *instance_group_get_ids_array(const InstanceGroup *g);
+
+/// MARK: - Physics -
+
+InstanceID instance_group_leaf_get_id(const RtreeNode *leaf);
+bool instance_group_get_world_aabb(const InstanceGroup *g, const InstanceID id, Box *box);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -6,45 +6,202 @@
 
 #include "map_string_float3.h"
 
+#include <stdint.h>
 #include <stdio.h>
 #include <string.h>
 
 #include "cclog.h"
 
-struct node {
+// Entries are stored in a dense array, in insertion order (iterators go from newest to oldest).
+// Small maps (typical POI counts) keep entries inline and are searched linearly, without
+// hashing keys. Above MAP_STRING_FLOAT3_INLINE_CAPACITY, an open addressing index
+// (linear probing, at most half full) points to entries.
+#define MAP_STRING_FLOAT3_INLINE_CAPACITY 8
+
+typedef struct {
     char *key;
     float3 *value;
-    struct node *next;
-};
+    uint32_t hash; // 0 in inline mode
+    char pad[4];
+} MapStringFloat3Entry;
 
 struct _MapStringFloat3 {
-    struct node *list;
+    // points to inlineEntries while count <= MAP_STRING_FLOAT3_INLINE_CAPACITY
+    MapStringFloat3Entry *entries;
+    // entry index + 1 for each slot, 0 when empty, NULL in inline mode
+    uint32_t *slots;
+    uint32_t count;
+    uint32_t capacity;
+    uint32_t slotsCapacity; // power of 2
+    char pad[4];
+    MapStringFloat3Entry inlineEntries[MAP_STRING_FLOAT3_INLINE_CAPACITY];
 };
 
 struct _MapStringFloat3Iterator {
-    struct node *currentNode;
+    MapStringFloat3 *map;
+    // index of current entry + 1, 0 when done
+    uint32_t cursor;
+    char pad[4];
 };
 
+// FNV-1a
+static uint32_t _map_string_float3_hash(const char *key) {
+    uint32_t hash = 2166136261u;
+    while (*key != '\0') {
+        hash ^= (uint8_t)*key;
+        hash *= 16777619u;
+        ++key;
+    }
+    return hash;
+}
+
+static void _map_string_float3_slots_insert(MapStringFloat3 *m, const uint32_t entryIndex) {
+    const uint32_t mask = m->slotsCapacity - 1;
+    uint32_t i = m->entries[entryIndex].hash & mask;
+    while (m->slots[i] != 0) {
+        i = (i + 1) & mask;
+    }
+    m->slots[i] = entryIndex + 1;
+}
+
+static bool _map_string_float3_slots_rebuild(MapStringFloat3 *m, const uint32_t slotsCapacity) {
+    if (slotsCapacity != m->slotsCapacity) {
+        uint32_t *slots = (uint32_t *)malloc(sizeof(uint32_t) * slotsCapacity);
+        if (slots == NULL) {
+            cclog_error("map_string_float3: failed to allocate %u slots", slotsCapacity);
+            return false;
+        }
+        free(m->slots);
+        m->slots = slots;
+        m->slotsCapacity = slotsCapacity;
+    }
+    memset(m->slots, 0, sizeof(uint32_t) * m->slotsCapacity);
+    for (uint32_t i = 0; i < m->count; ++i) {
+        _map_string_float3_slots_insert(m, i);
+    }
+    return true;
+}
+
+// returns entry index, or -1 if not found
+static int64_t _map_string_float3_find(const MapStringFloat3 *m, const char *key) {
+    if (m->slots == NULL) {
+        for (uint32_t i = 0; i < m->count; ++i) {
+            if (strcmp(m->entries[i].key, key) == 0) {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    const uint32_t hash = _map_string_float3_hash(key);
+    const uint32_t mask = m->slotsCapacity - 1;
+    uint32_t i = hash & mask;
+    while (m->slots[i] != 0) {
+        const MapStringFloat3Entry *e = &m->entries[m->slots[i] - 1];
+        if (e->hash == hash && strcmp(e->key, key) == 0) {
+            return m->slots[i] - 1;
+        }
+        i = (i + 1) & mask;
+    }
+    return -1;
+}
+
+// makes room for one more entry, switching from inline mode to indexed mode if needed
+static bool _map_string_float3_reserve(MapStringFloat3 *m) {
+    if (m->count < m->capacity) {
+        return true;
+    }
+    const uint32_t capacity = m->capacity * 2;
+    MapStringFloat3Entry *entries;
+    if (m->entries == m->inlineEntries) {
+        entries = (MapStringFloat3Entry *)malloc(sizeof(MapStringFloat3Entry) * capacity);
+        if (entries != NULL) {
+            memcpy(entries, m->inlineEntries, sizeof(MapStringFloat3Entry) * m->count);
+            for (uint32_t i = 0; i < m->count; ++i) {
+                entries[i].hash = _map_string_float3_hash(entries[i].key);
+            }
+        }
+    } else {
+        entries = (MapStringFloat3Entry *)realloc(m->entries,
+                                                  sizeof(MapStringFloat3Entry) * capacity);
+    }
+    if (entries == NULL) {
+        cclog_error("map_string_float3: failed to allocate %u entries", capacity);
+        return false;
+    }
+    m->entries = entries;
+    m->capacity = capacity;
+    return _map_string_float3_slots_rebuild(m, capacity * 2);
+}
+
 MapStringFloat3 *map_string_float3_new(void) {
     MapStringFloat3 *m = (MapStringFloat3 *)malloc(sizeof(MapStringFloat3));
-    m->list = NULL;
+    if (m == NULL) {
+        return NULL;
+    }
+    m->entries = m->inlineEntries;
+    m->slots = NULL;
+    m->count = 0;
+    m->capacity = MAP_STRING_FLOAT3_INLINE_CAPACITY;
+    m->slotsCapacity = 0;
     return m;
 }
 
+MapStringFloat3 *map_string_float3_new_copy(const MapStringFloat3 *m) {
+    if (m == NULL) {
+        return NULL;
+    }
+    MapStringFloat3 *copy = map_string_float3_new();
+    if (copy == NULL) {
+        return NULL;
+    }
+    if (m->entries != m->inlineEntries) {
+        copy->entries = (MapStringFloat3Entry *)malloc(sizeof(MapStringFloat3Entry) *
+                                                       m->capacity);
+        copy->slots = (uint32_t *)malloc(sizeof(uint32_t) * m->slotsCapacity);
+        if (copy->entries == NULL || copy->slots == NULL) {
+            cclog_error("map_string_float3: failed to copy map");
+            free(copy->entries);
+            free(copy->slots);
+            free(copy);
+            return NULL;
+        }
+        copy->capacity = m->capacity;
+        copy->slotsCapacity = m->slotsCapacity;
+        // same entry indexes, index can be copied as is
+        memcpy(copy->slots, m->slots, sizeof(uint32_t) * m->slotsCapacity);
+    }
+    for (uint32_t i = 0; i < m->count; ++i) {
+        const MapStringFloat3Entry *e = &m->entries[i];
+        const size_t len = strlen(e->key) + 1;
+        MapStringFloat3Entry *c = &copy->entries[i];
+        c->key = (char *)malloc(len);
+        c->value = float3_new_copy(e->value);
+        c->hash = e->hash;
+        // entries copied so far are freed along w/ the copy
+        copy->count = i + 1;
+        if (c->key == NULL || (c->value == NULL && e->value != NULL)) {
+            cclog_error("map_string_float3: failed to copy map");
+            map_string_float3_free(copy);
+            return NULL;
+        }
+        memcpy(c->key, e->key, len);
+    }
+    return copy;
+}
+
 void map_string_float3_free(MapStringFloat3 *m) {
     if (m == NULL) {
         return;
     }
-    // free m->list
-    struct node *currentNode;
-    while (m->list != NULL) {
-        currentNode = m->list;
-        m->list = currentNode->next;
-        float3_free(currentNode->value);
-        free(currentNode->key);
-        free(currentNode);
+    for (uint32_t i = 0; i < m->count; ++i) {
+        float3_free(m->entries[i].value);
+        free(m->entries[i].key);
     }
-    // free m
+    if (m->entries != m->inlineEntries) {
+        free(m->entries);
+    }
+    free(m->slots);
     free(m);
 }
 
@@ -53,7 +210,8 @@ MapStringFloat3Iterator *map_string_float3_iterator_new(const MapStringFloat3 *m
         return NULL;
     }
     MapStringFloat3Iterator *i = (MapStringFloat3Iterator *)malloc(sizeof(MapStringFloat3Iterator));
-    i->currentNode = m->list;
+    i->map = (MapStringFloat3 *)m;
+    i->cursor = m->count;
     return i;
 }
 
@@ -62,15 +220,15 @@ void map_string_float3_iterator_free(MapStringFloat3Iterator *i) {
 }
 
 void map_string_float3_iterator_next(MapStringFloat3Iterator *i) {
-    if (i->currentNode != NULL) {
-        i->currentNode = i->currentNode->next;
+    if (i->cursor > 0) {
+        --i->cursor;
     }
 }
 
 const char *map_string_float3_iterator_current_key(const MapStringFloat3Iterator *i) {
     if (i != NULL) {
-        if (i->currentNode != NULL) {
-            return i->currentNode->key;
+        if (i->cursor > 0) {
+            return i->map->entries[i->cursor - 1].key;
         }
     }
     return NULL;
@@ -78,8 +236,8 @@ const char *map_string_float3_iterator_current_key(const MapStringFloat3Iterator
 
 float3 *map_string_float3_iterator_current_value(const MapStringFloat3Iterator *i) {
     if (i != NULL) {
-        if (i->currentNode != NULL) {
-            return i->currentNode->value;
+        if (i->cursor > 0) {
+            return i->map->entries[i->cursor - 1].value;
         }
     }
     return NULL;
@@ -87,41 +245,43 @@ float3 *map_string_float3_iterator_current_value(const MapStringFloat3Iterator *
 
 void map_string_float3_iterator_replace_current_value(const MapStringFloat3Iterator *i,
                                                       float3 *f3) {
-    if (i->currentNode != NULL) {
-        float3_free(i->currentNode->value);
-        i->currentNode->value = f3;
+    if (i->cursor > 0) {
+        MapStringFloat3Entry *e = &i->map->entries[i->cursor - 1];
+        float3_free(e->value);
+        e->value = f3;
     }
 }
 
 bool map_string_float3_iterator_is_done(const MapStringFloat3Iterator *i) {
-    return (i->currentNode == NULL);
+    return (i->cursor == 0);
 }
 
 void map_string_float3_set_key_value(MapStringFloat3 *m, const char *key, float3 *f3) {
-    // see if node exists
-    MapStringFloat3Iterator *it = map_string_float3_iterator_new(m);
-
-    while (map_string_float3_iterator_is_done(it) == false) {
-        if (strcmp(key, map_string_float3_iterator_current_key(it)) == 0) {
-            // key exists, update value
-            map_string_float3_iterator_replace_current_value(it, f3);
-            map_string_float3_iterator_free(it);
-            return;
-        }
-        map_string_float3_iterator_next(it);
+    const int64_t found = _map_string_float3_find(m, key);
+    if (found >= 0) {
+        // key exists, update value
+        float3_free(m->entries[found].value);
+        m->entries[found].value = f3;
+        return;
     }
-    map_string_float3_iterator_free(it);
-
-    struct node *newNode = (struct node *)malloc(sizeof(struct node));
 
-    newNode->key = (char *)malloc(strlen(key) + 1);
-    strcpy(newNode->key, key);
-    newNode->value = f3;
+    if (_map_string_float3_reserve(m) == false) {
+        float3_free(f3); // map owns f3 once given
+        return;
+    }
 
-    newNode->next = m->list;
-    m->list = newNode;
+    const size_t len = strlen(key);
+    MapStringFloat3Entry *e = &m->entries[m->count];
+    e->key = (char *)malloc(len + 1);
+    memcpy(e->key, key, len + 1);
+    e->value = f3;
+    e->hash = 0;
 
-    return;
+    if (m->slots != NULL) {
+        e->hash = _map_string_float3_hash(key);
+        _map_string_float3_slots_insert(m, m->count);
+    }
+    ++m->count;
 }
 
 void map_string_float3_debug(MapStringFloat3 *m) {
@@ -139,54 +299,34 @@ void map_string_float3_debug(MapStringFloat3 *m) {
 }
 
 const float3 *map_string_float3_value_for_key(MapStringFloat3 *m, const char *key) {
-    MapStringFloat3Iterator *it = map_string_float3_iterator_new(m);
-    while (map_string_float3_iterator_is_done(it) == false) {
-        if (strcmp(key, map_string_float3_iterator_current_key(it)) == 0) {
-            const float3 *r = map_string_float3_iterator_current_value(it);
-            map_string_float3_iterator_free(it);
-            return r;
-        }
-        map_string_float3_iterator_next(it);
-    }
-    map_string_float3_iterator_free(it);
-    return NULL;
+    return map_string_mutable_float3_value_for_key(m, key);
 }
 
 float3 *map_string_mutable_float3_value_for_key(MapStringFloat3 *m, const char *key) {
-    MapStringFloat3Iterator *it = map_string_float3_iterator_new(m);
-    while (map_string_float3_iterator_is_done(it) == false) {
-        if (strcmp(key, map_string_float3_iterator_current_key(it)) == 0) {
-            float3 *r = map_string_float3_iterator_current_value(it);
-            map_string_float3_iterator_free(it);
-            return r;
-        }
-        map_string_float3_iterator_next(it);
+    if (m == NULL) {
+        return NULL;
     }
-    map_string_float3_iterator_free(it);
-    return NULL;
+    const int64_t found = _map_string_float3_find(m, key);
+    return found >= 0 ? m->entries[found].value : NULL;
 }
 
 void map_string_float3_remove_key(MapStringFloat3 *m, const char *key) {
+    const int64_t found = _map_string_float3_find(m, key);
+    if (found < 0) {
+        return;
+    }
+    const uint32_t index = (uint32_t)found;
 
-    struct node *previousNode = NULL;
+    float3_free(m->entries[index].value);
+    free(m->entries[index].key);
 
-    MapStringFloat3Iterator *it = map_string_float3_iterator_new(m);
-    while (map_string_float3_iterator_is_done(it) == false) {
-        if (strcmp(key, map_string_float3_iterator_current_key(it)) == 0) {
-            if (previousNode == NULL) { // removing first node
-                m->list = it->currentNode->next;
-            } else {
-                previousNode->next = it->currentNode->next;
-            }
-            // free node
-            float3_free(it->currentNode->value);
-            free(it->currentNode->key);
-            free(it->currentNode);
-            break;
-        }
-        previousNode = it->currentNode;
-        map_string_float3_iterator_next(it);
+    // keep insertion order, removals are rare compared to lookups
+    memmove(&m->entries[index],
+            &m->entries[index + 1],
+            sizeof(MapStringFloat3Entry) * (m->count - index - 1));
+    --m->count;
+
+    if (m->slots != NULL) {
+        _map_string_float3_slots_rebuild(m, m->slotsCapacity);
     }
-    map_string_float3_iterator_free(it);
-    return;
 }
@@ -20,6 +20,8 @@ typedef struct _MapStringFloat3 MapStringFloat3;
 typedef struct _MapStringFloat3Iterator MapStringFloat3Iterator;
 
 MapStringFloat3 *map_string_float3_new(void);
+/// deep copy (keys & float3 values), preserving iteration order
+MapStringFloat3 *map_string_float3_new_copy(const MapStringFloat3 *m);
 void map_string_float3_free(MapStringFloat3 *m);
 
 MapStringFloat3Iterator *map_string_float3_iterator_new(const MapStringFloat3 *m);
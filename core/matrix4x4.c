@@ -9,6 +9,8 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "simd.h"
+
 static float float4x4_cos, float4x4_cosp, float4x4_sin;
 static float float4x4_s_length, float4x4_s_height, float4x4_s_depth;
 static float3 float4x4_v, float4x4_vx, float4x4_vy, float4x4_vz;
@@ -239,77 +241,90 @@ Matrix4x4 *matrix4x4_copy(Matrix4x4 *dest, const Matrix4x4 *src) {
     return dest;
 }
 
-Matrix4x4 *matrix4x4_op_multiply(Matrix4x4 *m1, const Matrix4x4 *m2) {
-
-    matrix4x4_set(
-        m1,
-        m1->x1y1 * m2->x1y1 + m1->x2y1 * m2->x1y2 + m1->x3y1 * m2->x1y3 + m1->x4y1 * m2->x1y4,
-        m1->x1y1 * m2->x2y1 + m1->x2y1 * m2->x2y2 + m1->x3y1 * m2->x2y3 + m1->x4y1 * m2->x2y4,
-        m1->x1y1 * m2->x3y1 + m1->x2y1 * m2->x3y2 + m1->x3y1 * m2->x3y3 + m1->x4y1 * m2->x3y4,
-        m1->x1y1 * m2->x4y1 + m1->x2y1 * m2->x4y2 + m1->x3y1 * m2->x4y3 + m1->x4y1 * m2->x4y4,
-
-        m1->x1y2 * m2->x1y1 + m1->x2y2 * m2->x1y2 + m1->x3y2 * m2->x1y3 + m1->x4y2 * m2->x1y4,
-        m1->x1y2 * m2->x2y1 + m1->x2y2 * m2->x2y2 + m1->x3y2 * m2->x2y3 + m1->x4y2 * m2->x2y4,
-        m1->x1y2 * m2->x3y1 + m1->x2y2 * m2->x3y2 + m1->x3y2 * m2->x3y3 + m1->x4y2 * m2->x3y4,
-        m1->x1y2 * m2->x4y1 + m1->x2y2 * m2->x4y2 + m1->x3y2 * m2->x4y3 + m1->x4y2 * m2->x4y4,
-
-        m1->x1y3 * m2->x1y1 + m1->x2y3 * m2->x1y2 + m1->x3y3 * m2->x1y3 + m1->x4y3 * m2->x1y4,
-        m1->x1y3 * m2->x2y1 + m1->x2y3 * m2->x2y2 + m1->x3y3 * m2->x2y3 + m1->x4y3 * m2->x2y4,
-        m1->x1y3 * m2->x3y1 + m1->x2y3 * m2->x3y2 + m1->x3y3 * m2->x3y3 + m1->x4y3 * m2->x3y4,
-        m1->x1y3 * m2->x4y1 + m1->x2y3 * m2->x4y2 + m1->x3y3 * m2->x4y3 + m1->x4y3 * m2->x4y4,
-
-        m1->x1y4 * m2->x1y1 + m1->x2y4 * m2->x1y2 + m1->x3y4 * m2->x1y3 + m1->x4y4 * m2->x1y4,
-        m1->x1y4 * m2->x2y1 + m1->x2y4 * m2->x2y2 + m1->x3y4 * m2->x2y3 + m1->x4y4 * m2->x2y4,
-        m1->x1y4 * m2->x3y1 + m1->x2y4 * m2->x3y2 + m1->x3y4 * m2->x3y3 + m1->x4y4 * m2->x3y4,
-        m1->x1y4 * m2->x4y1 + m1->x2y4 * m2->x4y2 + m1->x3y4 * m2->x4y3 + m1->x4y4 * m2->x4y4);
+/// result = m1 * m2, columns of the result are combinations of m1 columns.
+/// Summation order is the same as the scalar formula, results are identical.
+/// In-place safe: result may be m1 or m2.
+static void _matrix4x4_multiply(const Matrix4x4 *m1, const Matrix4x4 *m2, Matrix4x4 *result) {
+    const float *a = (const float *)m1;
+    const float *b = (const float *)m2;
+    float *r = (float *)result;
+    const simd4f a1 = simd4f_load(a);
+    const simd4f a2 = simd4f_load(a + 4);
+    const simd4f a3 = simd4f_load(a + 8);
+    const simd4f a4 = simd4f_load(a + 12);
+    for (int c = 0; c < 16; c += 4) {
+        simd4f col = simd4f_mul(a1, simd4f_splat(b[c]));
+        col = simd4f_madd(a2, simd4f_splat(b[c + 1]), col);
+        col = simd4f_madd(a3, simd4f_splat(b[c + 2]), col);
+        col = simd4f_madd(a4, simd4f_splat(b[c + 3]), col);
+        simd4f_store(r + c, col);
+    }
+}
 
+Matrix4x4 *matrix4x4_op_multiply(Matrix4x4 *m1, const Matrix4x4 *m2) {
+    _matrix4x4_multiply(m1, m2, m1);
     return m1;
 }
 
 Matrix4x4 *matrix4x4_op_multiply_2(const Matrix4x4 *m1, Matrix4x4 *m2) {
-
-    matrix4x4_set(
-        m2,
-        m1->x1y1 * m2->x1y1 + m1->x2y1 * m2->x1y2 + m1->x3y1 * m2->x1y3 + m1->x4y1 * m2->x1y4,
-        m1->x1y1 * m2->x2y1 + m1->x2y1 * m2->x2y2 + m1->x3y1 * m2->x2y3 + m1->x4y1 * m2->x2y4,
-        m1->x1y1 * m2->x3y1 + m1->x2y1 * m2->x3y2 + m1->x3y1 * m2->x3y3 + m1->x4y1 * m2->x3y4,
-        m1->x1y1 * m2->x4y1 + m1->x2y1 * m2->x4y2 + m1->x3y1 * m2->x4y3 + m1->x4y1 * m2->x4y4,
-
-        m1->x1y2 * m2->x1y1 + m1->x2y2 * m2->x1y2 + m1->x3y2 * m2->x1y3 + m1->x4y2 * m2->x1y4,
-        m1->x1y2 * m2->x2y1 + m1->x2y2 * m2->x2y2 + m1->x3y2 * m2->x2y3 + m1->x4y2 * m2->x2y4,
-        m1->x1y2 * m2->x3y1 + m1->x2y2 * m2->x3y2 + m1->x3y2 * m2->x3y3 + m1->x4y2 * m2->x3y4,
-        m1->x1y2 * m2->x4y1 + m1->x2y2 * m2->x4y2 + m1->x3y2 * m2->x4y3 + m1->x4y2 * m2->x4y4,
-
-        m1->x1y3 * m2->x1y1 + m1->x2y3 * m2->x1y2 + m1->x3y3 * m2->x1y3 + m1->x4y3 * m2->x1y4,
-        m1->x1y3 * m2->x2y1 + m1->x2y3 * m2->x2y2 + m1->x3y3 * m2->x2y3 + m1->x4y3 * m2->x2y4,
-        m1->x1y3 * m2->x3y1 + m1->x2y3 * m2->x3y2 + m1->x3y3 * m2->x3y3 + m1->x4y3 * m2->x3y4,
-        m1->x1y3 * m2->x4y1 + m1->x2y3 * m2->x4y2 + m1->x3y3 * m2->x4y3 + m1->x4y3 * m2->x4y4,
-
-        m1->x1y4 * m2->x1y1 + m1->x2y4 * m2->x1y2 + m1->x3y4 * m2->x1y3 + m1->x4y4 * m2->x1y4,
-        m1->x1y4 * m2->x2y1 + m1->x2y4 * m2->x2y2 + m1->x3y4 * m2->x2y3 + m1->x4y4 * m2->x2y4,
-        m1->x1y4 * m2->x3y1 + m1->x2y4 * m2->x3y2 + m1->x3y4 * m2->x3y3 + m1->x4y4 * m2->x3y4,
-        m1->x1y4 * m2->x4y1 + m1->x2y4 * m2->x4y2 + m1->x3y4 * m2->x4y3 + m1->x4y4 * m2->x4y4);
-
+    _matrix4x4_multiply(m1, m2, m2);
     return m2;
 }
 
 void matrix4x4_op_multiply_vec(float4 *result, const float4 *vec, const Matrix4x4 *mtx) {
-    result->x = vec->x * mtx->x1y1 + vec->y * mtx->x2y1 + vec->z * mtx->x3y1 + vec->w * mtx->x4y1;
-    result->y = vec->x * mtx->x1y2 + vec->y * mtx->x2y2 + vec->z * mtx->x3y2 + vec->w * mtx->x4y2;
-    result->z = vec->x * mtx->x1y3 + vec->y * mtx->x2y3 + vec->z * mtx->x3y3 + vec->w * mtx->x4y3;
-    result->w = vec->x * mtx->x1y4 + vec->y * mtx->x2y4 + vec->z * mtx->x3y4 + vec->w * mtx->x4y4;
+    const float *m = (const float *)mtx;
+    simd4f r = simd4f_mul(simd4f_load(m), simd4f_splat(vec->x));
+    r = simd4f_madd(simd4f_load(m + 4), simd4f_splat(vec->y), r);
+    r = simd4f_madd(simd4f_load(m + 8), simd4f_splat(vec->z), r);
+    r = simd4f_madd(simd4f_load(m + 12), simd4f_splat(vec->w), r);
+    float tmp[4];
+    simd4f_store(tmp, r);
+    result->x = tmp[0];
+    result->y = tmp[1];
+    result->z = tmp[2];
+    result->w = tmp[3];
 }
 
 void matrix4x4_op_multiply_vec_point(float3 *result, const float3 *vec, const Matrix4x4 *mtx) {
-    result->x = vec->x * mtx->x1y1 + vec->y * mtx->x2y1 + vec->z * mtx->x3y1 + mtx->x4y1;
-    result->y = vec->x * mtx->x1y2 + vec->y * mtx->x2y2 + vec->z * mtx->x3y2 + mtx->x4y2;
-    result->z = vec->x * mtx->x1y3 + vec->y * mtx->x2y3 + vec->z * mtx->x3y3 + mtx->x4y3;
+    const float *m = (const float *)mtx;
+    simd4f r = simd4f_mul(simd4f_load(m), simd4f_splat(vec->x));
+    r = simd4f_madd(simd4f_load(m + 4), simd4f_splat(vec->y), r);
+    r = simd4f_madd(simd4f_load(m + 8), simd4f_splat(vec->z), r);
+    r = simd4f_add(r, simd4f_load(m + 12));
+    simd4f_store3((float *)result, r);
 }
 
 void matrix4x4_op_multiply_vec_vector(float3 *result, const float3 *vec, const Matrix4x4 *mtx) {
-    result->x = vec->x * mtx->x1y1 + vec->y * mtx->x2y1 + vec->z * mtx->x3y1;
-    result->y = vec->x * mtx->x1y2 + vec->y * mtx->x2y2 + vec->z * mtx->x3y2;
-    result->z = vec->x * mtx->x1y3 + vec->y * mtx->x2y3 + vec->z * mtx->x3y3;
+    const float *m = (const float *)mtx;
+    simd4f r = simd4f_mul(simd4f_load(m), simd4f_splat(vec->x));
+    r = simd4f_madd(simd4f_load(m + 4), simd4f_splat(vec->y), r);
+    r = simd4f_madd(simd4f_load(m + 8), simd4f_splat(vec->z), r);
+    simd4f_store3((float *)result, r);
+}
+
+void matrix4x4_op_multiply_vec_points(float3 *results,
+                                      const float3 *points,
+                                      const size_t count,
+                                      const Matrix4x4 *mtx) {
+    // 4 points at a time, one lane per point
+    const simd4f m11 = simd4f_splat(mtx->x1y1), m21 = simd4f_splat(mtx->x2y1),
+                 m31 = simd4f_splat(mtx->x3y1), m41 = simd4f_splat(mtx->x4y1);
+    const simd4f m12 = simd4f_splat(mtx->x1y2), m22 = simd4f_splat(mtx->x2y2),
+                 m32 = simd4f_splat(mtx->x3y2), m42 = simd4f_splat(mtx->x4y2);
+    const simd4f m13 = simd4f_splat(mtx->x1y3), m23 = simd4f_splat(mtx->x2y3),
+                 m33 = simd4f_splat(mtx->x3y3), m43 = simd4f_splat(mtx->x4y3);
+    simd4f x, y, z, rx, ry, rz;
+    size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        simd4f_load_float3x4((const float *)(points + i), &x, &y, &z);
+        rx = simd4f_add(simd4f_madd(z, m31, simd4f_madd(y, m21, simd4f_mul(x, m11))), m41);
+        ry = simd4f_add(simd4f_madd(z, m32, simd4f_madd(y, m22, simd4f_mul(x, m12))), m42);
+        rz = simd4f_add(simd4f_madd(z, m33, simd4f_madd(y, m23, simd4f_mul(x, m13))), m43);
+        simd4f_store_float3x4((float *)(results + i), rx, ry, rz);
+    }
+    for (; i < count; ++i) {
+        matrix4x4_op_multiply_vec_point(&results[i], &points[i], mtx);
+    }
 }
 
 Matrix4x4 *matrix4x4_op_transpose(Matrix4x4 *m) {
@@ -342,7 +357,9 @@ void *matrix4x4_op_invert(Matrix4x4 *m) {
 
     float det;
 
-    Matrix4x4 *m2 = matrix4x4_new_copy(m);
+    // cofactors are computed from a copy, kept on the stack
+    const Matrix4x4 copy = *m;
+    const Matrix4x4 *m2 = &copy;
 
     m->x1y1 = m2->x2y2 * m2->x3y3 * m2->x4y4 - m2->x2y2 * m2->x3y4 * m2->x4y3 -
               m2->x3y2 * m2->x2y3 * m2->x4y4 + m2->x3y2 * m2->x2y4 * m2->x4y3 +
@@ -412,13 +429,10 @@ void *matrix4x4_op_invert(Matrix4x4 *m) {
 
     if (det == 0.0f) {
         // restore m using copy (m2)
-        matrix4x4_copy(m, m2);
-        free(m2);
+        *m = copy;
         return m;
     }
 
-    free(m2);
-
     det = 1.0f / det;
 
     m->x1y1 = m->x1y1 * det;
@@ -444,6 +458,71 @@ void *matrix4x4_op_invert(Matrix4x4 *m) {
     return m;
 }
 
+bool matrix4x4_is_affine(const Matrix4x4 *m) {
+    return m->x1y4 == 0.0f && m->x2y4 == 0.0f && m->x3y4 == 0.0f && m->x4y4 == 1.0f;
+}
+
+void matrix4x4_op_multiply_affine(const Matrix4x4 *m1, const Matrix4x4 *m2, Matrix4x4 *result) {
+    // 4th rows are (0, 0, 0, 1): m1 4th column is only added to translation
+    const float *a = (const float *)m1;
+    const float *b = (const float *)m2;
+    float *r = (float *)result;
+    const simd4f a1 = simd4f_load(a);
+    const simd4f a2 = simd4f_load(a + 4);
+    const simd4f a3 = simd4f_load(a + 8);
+    const simd4f a4 = simd4f_load(a + 12);
+    for (int c = 0; c < 16; c += 4) {
+        simd4f col = simd4f_mul(a1, simd4f_splat(b[c]));
+        col = simd4f_madd(a2, simd4f_splat(b[c + 1]), col);
+        col = simd4f_madd(a3, simd4f_splat(b[c + 2]), col);
+        if (c == 12) {
+            col = simd4f_add(col, a4);
+        }
+        simd4f_store(r + c, col);
+    }
+    r[3] = 0.0f;
+    r[7] = 0.0f;
+    r[11] = 0.0f;
+    r[15] = 1.0f;
+}
+
+void matrix4x4_op_invert_affine(const Matrix4x4 *m, Matrix4x4 *result) {
+    // inverse of upper 3x3 from its cofactors, then translation is brought back to origin
+    const float c11 = m->x2y2 * m->x3y3 - m->x3y2 * m->x2y3;
+    const float c12 = m->x3y2 * m->x1y3 - m->x1y2 * m->x3y3;
+    const float c13 = m->x1y2 * m->x2y3 - m->x2y2 * m->x1y3;
+
+    const float det = m->x1y1 * c11 + m->x2y1 * c12 + m->x3y1 * c13;
+    if (det == 0.0f) {
+        // same as matrix4x4_op_invert, matrix is left as is
+        *result = *m;
+        return;
+    }
+    const float inv = 1.0f / det;
+
+    Matrix4x4 r;
+    r.x1y1 = c11 * inv;
+    r.x1y2 = c12 * inv;
+    r.x1y3 = c13 * inv;
+    r.x2y1 = (m->x3y1 * m->x2y3 - m->x2y1 * m->x3y3) * inv;
+    r.x2y2 = (m->x1y1 * m->x3y3 - m->x3y1 * m->x1y3) * inv;
+    r.x2y3 = (m->x2y1 * m->x1y3 - m->x1y1 * m->x2y3) * inv;
+    r.x3y1 = (m->x2y1 * m->x3y2 - m->x3y1 * m->x2y2) * inv;
+    r.x3y2 = (m->x3y1 * m->x1y2 - m->x1y1 * m->x3y2) * inv;
+    r.x3y3 = (m->x1y1 * m->x2y2 - m->x2y1 * m->x1y2) * inv;
+
+    r.x4y1 = -(r.x1y1 * m->x4y1 + r.x2y1 * m->x4y2 + r.x3y1 * m->x4y3);
+    r.x4y2 = -(r.x1y2 * m->x4y1 + r.x2y2 * m->x4y2 + r.x3y2 * m->x4y3);
+    r.x4y3 = -(r.x1y3 * m->x4y1 + r.x2y3 * m->x4y2 + r.x3y3 * m->x4y3);
+
+    r.x1y4 = 0.0f;
+    r.x2y4 = 0.0f;
+    r.x3y4 = 0.0f;
+    r.x4y4 = 1.0f;
+
+    *result = r;
+}
+
 void matrix4x4_op_scale(Matrix4x4 *m, const float3 *scale) {
     m->x1y1 *= scale->x;
     m->x2y1 *= scale->x;
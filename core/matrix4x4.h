@@ -10,6 +10,8 @@
 extern "C" {
 #endif
 
+#include <stddef.h>
+
 #include "float3.h"
 #include "float4.h"
 
@@ -126,10 +128,27 @@ void matrix4x4_op_multiply_vec(float4 *result, const float4 *vec, const Matrix4x
 void matrix4x4_op_multiply_vec_point(float3 *result, const float3 *vec, const Matrix4x4 *mtx);
 void matrix4x4_op_multiply_vec_vector(float3 *result, const float3 *vec, const Matrix4x4 *mtx);
 
+/// Same as matrix4x4_op_multiply_vec_point for `count` points, vectorized 4 points at a time.
+/// results may point to points.
+void matrix4x4_op_multiply_vec_points(float3 *results,
+                                      const float3 *points,
+                                      const size_t count,
+                                      const Matrix4x4 *mtx);
+
 Matrix4x4 *matrix4x4_op_transpose(Matrix4x4 *m);
 
 void *matrix4x4_op_invert(Matrix4x4 *m);
 
+/// @returns true if 4th row is (0, 0, 0, 1), as for any matrix composed of scale, rotation &
+/// translation
+bool matrix4x4_is_affine(const Matrix4x4 *m);
+
+/// result = m1 * m2, for affine matrices only, result may point to m1 or m2
+void matrix4x4_op_multiply_affine(const Matrix4x4 *m1, const Matrix4x4 *m2, Matrix4x4 *result);
+
+/// inverse of an affine matrix, result may point to m
+void matrix4x4_op_invert_affine(const Matrix4x4 *m, Matrix4x4 *result);
+
 void matrix4x4_op_scale(Matrix4x4 *m, const float3 *scale);
 void matrix4x4_op_unscale(Matrix4x4 *m, const float3 *scale);
 
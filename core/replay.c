@@ -0,0 +1,188 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  replay.c
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#include "replay.h"
+
+#include <stdlib.h>
+
+#include "cclog.h"
+
+#define REPLAY_DEFAULT_CAPACITY 64
+
+typedef struct {
+    float3 value;
+    // tick before which the input was applied
+    uint32_t tick;
+    uint32_t key;
+    uint8_t type;
+
+    char pad[3];
+} _ReplayInput;
+
+struct _Replay {
+    _ReplayInput *inputs;
+    // physics hash after each tick
+    uint32_t *hashes;
+    TICK_DELTA_SEC_T dt;
+    uint32_t inputsCount;
+    uint32_t inputsCapacity;
+    uint32_t ticksCount;
+    uint32_t ticksCapacity;
+    // set when an input or hash could not be stored, recording stops for good
+    bool failed;
+
+    char pad[7];
+};
+
+/// Makes room for one more element, returns false if allocation failed
+static bool _replay_reserve(void **array, uint32_t count, uint32_t *capacity, size_t size) {
+    if (count < *capacity) {
+        return true;
+    }
+    const uint32_t newCapacity = *capacity > 0 ? *capacity * 2 : REPLAY_DEFAULT_CAPACITY;
+    void *grown = realloc(*array, size * newCapacity);
+    if (grown == NULL) {
+        cclog_error("replay: failed to grow buffer");
+        return false;
+    }
+    *array = grown;
+    *capacity = newCapacity;
+    return true;
+}
+
+static void _replay_apply(Transform *t, const ReplayInputType type, const float3 *value) {
+    if (type == ReplayInput_Position) {
+        transform_set_position_vec(t, value);
+        return;
+    }
+    RigidBody *rb = transform_get_rigidbody(t);
+    if (rb == NULL) {
+        return;
+    }
+    switch (type) {
+        case ReplayInput_Velocity:
+            rigidbody_set_velocity(rb, value);
+            break;
+        case ReplayInput_Motion:
+            rigidbody_set_motion(rb, value);
+            break;
+        case ReplayInput_Impulse:
+            rigidbody_apply_force_impulse(rb, value);
+            break;
+        default:
+            break;
+    }
+}
+
+Replay *replay_new(const TICK_DELTA_SEC_T dt) {
+    Replay *r = (Replay *)malloc(sizeof(Replay));
+    if (r == NULL) {
+        return NULL;
+    }
+    r->inputs = NULL;
+    r->hashes = NULL;
+    r->dt = dt;
+    r->inputsCount = 0;
+    r->inputsCapacity = 0;
+    r->ticksCount = 0;
+    r->ticksCapacity = 0;
+    r->failed = false;
+    return r;
+}
+
+void replay_free(Replay *r) {
+    if (r == NULL) {
+        return;
+    }
+    free(r->inputs);
+    free(r->hashes);
+    free(r);
+}
+
+void replay_apply_input(Replay *r,
+                        const uint32_t key,
+                        Transform *t,
+                        const ReplayInputType type,
+                        const float3 *value) {
+
+    _replay_apply(t, type, value);
+
+    if (r->failed) {
+        return;
+    }
+    if (_replay_reserve((void **)&r->inputs,
+                        r->inputsCount,
+                        &r->inputsCapacity,
+                        sizeof(_ReplayInput)) == false) {
+        r->failed = true;
+        return;
+    }
+    _ReplayInput *input = &r->inputs[r->inputsCount++];
+    input->value = *value;
+    input->tick = r->ticksCount;
+    input->key = key;
+    input->type = (uint8_t)type;
+}
+
+void replay_record_tick(Replay *r, Scene *sc, void *callbackData) {
+    // room for the hash is made first, a tick that can't be recorded must not be counted either
+    if (r->failed == false && _replay_reserve((void **)&r->hashes,
+                                              r->ticksCount,
+                                              &r->ticksCapacity,
+                                              sizeof(uint32_t)) == false) {
+        r->failed = true;
+    }
+
+    scene_refresh(sc, r->dt, callbackData);
+
+    if (r->failed == false) {
+        r->hashes[r->ticksCount++] = scene_get_physics_hash(sc, 0);
+    }
+}
+
+uint32_t replay_get_ticks_count(const Replay *r) {
+    return r->ticksCount;
+}
+
+uint32_t replay_get_tick_hash(const Replay *r, const uint32_t tick) {
+    return tick < r->ticksCount ? r->hashes[tick] : 0;
+}
+
+bool replay_is_complete(const Replay *r) {
+    return r->failed == false;
+}
+
+uint32_t replay_verify(const Replay *r,
+                       Scene *sc,
+                       pointer_replay_resolve_func resolve,
+                       void *ptr,
+                       void *callbackData) {
+
+    if (r->failed) {
+        cclog_error("replay: recording is incomplete, can't be verified");
+        return REPLAY_INCOMPLETE;
+    }
+
+    uint32_t next = 0;
+    const _ReplayInput *input;
+    Transform *t;
+    for (uint32_t tick = 0; tick < r->ticksCount; ++tick) {
+        while (next < r->inputsCount && r->inputs[next].tick == tick) {
+            input = &r->inputs[next++];
+            t = resolve(input->key, ptr);
+            if (t != NULL) {
+                _replay_apply(t, (ReplayInputType)input->type, &input->value);
+            }
+        }
+
+        scene_refresh(sc, r->dt, callbackData);
+
+        if (scene_get_physics_hash(sc, 0) != r->hashes[tick]) {
+            return tick;
+        }
+    }
+    return r->ticksCount;
+}
@@ -0,0 +1,63 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  replay.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+
+#include "scene.h"
+
+/// Records physics inputs & a state hash for each tick of a scene, then replays them on another
+/// scene to verify that both simulations agree tick for tick, see scene_set_deterministic.
+/// A tick is one scene refresh w/ the replay delta.
+typedef struct _Replay Replay;
+
+typedef enum {
+    ReplayInput_Position,
+    ReplayInput_Velocity,
+    ReplayInput_Motion,
+    ReplayInput_Impulse
+} ReplayInputType;
+
+/// Returned by replay_verify when recording failed, never a valid tick
+#define REPLAY_INCOMPLETE UINT32_MAX
+
+/// Resolves a transform of the replayed scene from the key it was recorded with
+typedef Transform *(*pointer_replay_resolve_func)(uint32_t key, void *ptr);
+
+Replay *replay_new(const TICK_DELTA_SEC_T dt);
+void replay_free(Replay *r);
+
+/// Applies an input to a transform & records it for next tick, under `key`
+void replay_apply_input(Replay *r,
+                        const uint32_t key,
+                        Transform *t,
+                        const ReplayInputType type,
+                        const float3 *value);
+/// Refreshes the scene for one tick & records its physics hash
+void replay_record_tick(Replay *r, Scene *sc, void *callbackData);
+uint32_t replay_get_ticks_count(const Replay *r);
+uint32_t replay_get_tick_hash(const Replay *r, const uint32_t tick);
+/// False once an input or tick could not be stored, recording then stops
+/// but ticks keep refreshing the scene
+bool replay_is_complete(const Replay *r);
+
+/// Replays all recorded ticks on a scene set up like the recorded one was before its first tick.
+/// Returns the first tick whose hash differs from the recorded one, ticks count if they all match,
+/// REPLAY_INCOMPLETE if recording failed
+uint32_t replay_verify(const Replay *r,
+                       Scene *sc,
+                       pointer_replay_resolve_func resolve,
+                       void *ptr,
+                       void *callbackData);
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
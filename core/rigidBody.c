@@ -10,7 +10,9 @@
 #include <math.h>
 #include <stdlib.h>
 
+#include "cclog.h"
 #include "scene.h"
+#include "zlib.h"
 
 #define SIMULATIONFLAG_NONE 0
 #define SIMULATIONFLAG_MODE 7 // first 3 bits
@@ -20,14 +22,67 @@
 #define SIMULATIONFLAG_END_CALLBACK_ENABLED 64
 #define SIMULATIONFLAG_COLLIDER_CUSTOM_SET 128
 
+#define ISLAND_DEFAULT_CAPACITY 64
+
 #if DEBUG_RIGIDBODY
 static int debug_rigidbody_solver_iterations = 0;
 static int debug_rigidbody_replacements = 0;
 static int debug_rigidbody_collisions = 0;
 static int debug_rigidbody_sleeps = 0;
 static int debug_rigidbody_awakes = 0;
+static int debug_rigidbody_islands = 0;
+static int debug_rigidbody_queries = 0;
 #endif
 
+/// Broadphase candidate of a dynamic rigidbody, w/ its sweep result for current solver iteration
+typedef struct {
+    // resolved from ID every tick
+    Transform *t;
+    RigidBody *rb;
+    // instance collider, w/ group transform & rigidbody as t & rb ; NULL otherwise
+    InstanceGroup *group;
+    // contact normal, in candidate model space if solved w/ its model-aligned collider
+    float3 normal;
+    float3 wNormal;
+    // ratio of trajectory before contact, 1 if none
+    float swept;
+    TransformID id;
+    InstanceID instance;
+    bool isTrigger;
+    bool inManifold;
+
+    char pad[2];
+} _RigidbodyCandidate;
+
+/// Candidates of a dynamic rigidbody from its last r-tree query, they remain exact as long as the
+/// r-tree is unchanged, for any trajectory within the queried box. Instance colliders candidates
+/// follow them, and are only kept within one tick since instance groups may change at any time
+typedef struct {
+    _RigidbodyCandidate *candidates;
+    // indices of candidates to process in current solver iteration: crossed triggers & manifold
+    uint32_t *contacts;
+    // NULL if cache is invalid
+    Rtree *rtree;
+    Box box;
+    Box instancesBox;
+    uint32_t count;
+    uint32_t instancesCount;
+    uint32_t capacity;
+    uint32_t rtreeVersion;
+    uint32_t contactsCount;
+
+    char pad[4];
+} _BroadphaseCache;
+
+struct _RigidbodyIslands {
+    // overlap query results, empty between calls
+    FifoList *query;
+    // members of the island being flooded, also used as flood queue
+    RigidBody **island;
+    uint32_t capacity;
+    char pad[4];
+};
+
 struct _RigidBody {
     // collider axis-aligned box, may be arbitrary or similar to the axis-aligned bounding box
     Box *collider;
@@ -47,6 +102,15 @@ struct _RigidBody {
     // last known valid position
     float3 *checkpoint;
 
+    // dynamic rigidbodies broadphase candidates, created on first tick
+    _BroadphaseCache *cache;
+
+    // next rigidbody of the same island, looping back to itself ; NULL if not sleeping
+    RigidBody *sleepNext;
+
+    // weak ref to owner transform, flagged whenever scene refresh needs to visit this rigidbody
+    Transform *transform;
+
     // combined friction of 2 surfaces in contact represents how much force is absorbed,
     // it is a rate between 0 (full stop on contact) and 1 (full slide, no friction), or
     // below 0 (inverted movement) and above 1 (amplified movement)
@@ -60,6 +124,15 @@ struct _RigidBody {
     // it cannot be zero, a neutral mass is a mass of 1
     float mass;
 
+    // world position before last tick, for fixed timestep interpolation
+    float3 previous;
+
+    // last islands pass that visited this rigidbody
+    uint32_t islandStamp;
+
+    // scene step of last tick, previous position is stale otherwise
+    uint32_t previousStep;
+
     // collision masks
     uint16_t groups;
     uint16_t collidesWith;
@@ -75,8 +148,8 @@ struct _RigidBody {
     // [5-7] <unused>
     uint8_t simulationFlags;
     uint8_t awakeFlag;
-
-    char pad[5];
+    // consecutive frames spent resting, up to PHYSICS_SLEEP_FRAMES
+    uint8_t restFrames;
 };
 
 static pointer_rigidbody_collision_func rigidbody_collision_callback = NULL;
@@ -106,6 +179,389 @@ void _rigidbody_reset_state(RigidBody *rb) {
     rb->contact = AxesMaskNone;
 }
 
+/// Returns whether or not all components of the velocity are blocked by current contacts
+bool _rigidbody_is_blocked(const RigidBody *rb, const float3 *velocity) {
+    if (float_isZero(velocity->x, EPSILON_ZERO) == false) {
+        const bool x = utils_axes_mask_get(rb->contact, AxesMaskX);
+        const bool nx = utils_axes_mask_get(rb->contact, AxesMaskNX);
+        if ((velocity->x < 0.0f && nx == false) || (velocity->x > 0.0f && x == false)) {
+            return false;
+        }
+    }
+    if (float_isZero(velocity->y, EPSILON_ZERO) == false) {
+        const bool y = utils_axes_mask_get(rb->contact, AxesMaskY);
+        const bool ny = utils_axes_mask_get(rb->contact, AxesMaskNY);
+        if ((velocity->y < 0.0f && ny == false) || (velocity->y > 0.0f && y == false)) {
+            return false;
+        }
+    }
+    if (float_isZero(velocity->z, EPSILON_ZERO) == false) {
+        const bool z = utils_axes_mask_get(rb->contact, AxesMaskZ);
+        const bool nz = utils_axes_mask_get(rb->contact, AxesMaskNZ);
+        if ((velocity->z < 0.0f && nz == false) || (velocity->z > 0.0f && z == false)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Scene refresh will visit this rigidbody at least once
+void _rigidbody_set_branch_dirty(RigidBody *rb) {
+    if (rb->transform != NULL) {
+        transform_set_branch_dirty(rb->transform);
+    }
+}
+
+/// Wakes up all rigidbodies of a sleeping island
+void _rigidbody_wake_island(RigidBody *rb) {
+    RigidBody *member = rb;
+    while (member != NULL && member->sleepNext != NULL) {
+        RigidBody *next = member->sleepNext;
+        member->sleepNext = NULL;
+        member->restFrames = 0;
+        _rigidbody_set_branch_dirty(member);
+        member = next;
+    }
+}
+
+_BroadphaseCache *_rigidbody_cache_new(void) {
+    _BroadphaseCache *cache = (_BroadphaseCache *)malloc(sizeof(_BroadphaseCache));
+    if (cache == NULL) {
+        return NULL;
+    }
+    cache->candidates = NULL;
+    cache->contacts = NULL;
+    cache->rtree = NULL;
+    cache->box = box_zero;
+    cache->instancesBox = box_zero;
+    cache->count = 0;
+    cache->instancesCount = 0;
+    cache->capacity = 0;
+    cache->rtreeVersion = 0;
+    cache->contactsCount = 0;
+    return cache;
+}
+
+void _rigidbody_cache_free(_BroadphaseCache *cache) {
+    if (cache == NULL) {
+        return;
+    }
+    free(cache->candidates);
+    free(cache->contacts);
+    free(cache);
+}
+
+/// Resolves cached candidates, returns false if the cache has to be refreshed w/ a new query
+bool _rigidbody_cache_resolve(_BroadphaseCache *cache, Rtree *r) {
+    cache->instancesCount = 0;
+    if (cache->rtree != r || cache->rtreeVersion != rtree_get_version(r)) {
+        return false;
+    }
+    _RigidbodyCandidate *c;
+    for (uint32_t i = 0; i < cache->count; ++i) {
+        c = &cache->candidates[i];
+        c->t = transform_get_by_id(c->id);
+        c->rb = c->t != NULL ? transform_get_rigidbody(c->t) : NULL;
+        if (c->rb == NULL) {
+            cache->rtree = NULL;
+            return false;
+        }
+    }
+    return true;
+}
+
+/// Returns a new candidate after all current candidates, or NULL if the cache could not grow
+_RigidbodyCandidate *_rigidbody_cache_push(_BroadphaseCache *cache) {
+    const uint32_t total = cache->count + cache->instancesCount;
+    if (total == cache->capacity) {
+        const uint32_t capacity = cache->capacity > 0 ? cache->capacity * 2 : 8;
+        _RigidbodyCandidate *candidates = (_RigidbodyCandidate *)realloc(
+            cache->candidates,
+            sizeof(_RigidbodyCandidate) * capacity);
+        if (candidates != NULL) {
+            cache->candidates = candidates;
+        }
+        uint32_t *contacts = (uint32_t *)realloc(cache->contacts, sizeof(uint32_t) * capacity);
+        if (contacts != NULL) {
+            cache->contacts = contacts;
+        }
+        if (candidates == NULL || contacts == NULL) {
+            cclog_error("rigidbody: failed to grow broadphase cache");
+            return NULL;
+        }
+        cache->capacity = capacity;
+    }
+    _RigidbodyCandidate *c = &cache->candidates[total];
+    c->group = NULL;
+    c->instance = INSTANCE_ID_NONE;
+    c->isTrigger = false;
+    c->inManifold = false;
+    return c;
+}
+
+/// Queries r-tree for all leaves around a broadphase box, w/ a margin proportional to the
+/// trajectory so that following solver iterations fall within
+bool _rigidbody_cache_query(_BroadphaseCache *cache,
+                            Transform *self,
+                            Rtree *r,
+                            const Box *broadphase,
+                            const float3 *dv,
+                            FifoList *sceneQuery) {
+
+    const float margin = float3_length(dv) + PHYSICS_BROADPHASE_MARGIN;
+    cache->box = *broadphase;
+    float3_op_substract_scalar(&cache->box.min, margin);
+    float3_op_add_scalar(&cache->box.max, margin);
+    cache->rtree = r;
+    cache->rtreeVersion = rtree_get_version(r);
+    cache->count = 0;
+    cache->instancesCount = 0;
+
+    // previous query should be processed entirely
+    vx_assert(fifo_list_pop(sceneQuery) == NULL);
+
+    // collision masks may change w/o modifying the r-tree, candidates are filtered when solving
+    rtree_query_overlap_box(r,
+                            &cache->box,
+                            PHYSICS_GROUP_ALL_SYSTEM,
+                            PHYSICS_GROUP_ALL_SYSTEM,
+                            NULL,
+                            sceneQuery,
+                            &float3_epsilon_collision);
+
+    RtreeNode *hit = fifo_list_pop(sceneQuery);
+    Transform *hitLeaf;
+    RigidBody *hitRb;
+    while (hit != NULL) {
+        hitLeaf = (Transform *)rtree_node_get_leaf_ptr(hit);
+        vx_assert(rtree_node_is_leaf(hit));
+
+        // self isn't removed from r-tree before query
+        hitRb = hitLeaf != self ? transform_get_rigidbody(hitLeaf) : NULL;
+
+        if (hitRb != NULL) {
+            _RigidbodyCandidate *c = _rigidbody_cache_push(cache);
+            if (c == NULL) {
+                cache->rtree = NULL;
+                fifo_list_flush(sceneQuery, NULL);
+                break;
+            }
+            c->t = hitLeaf;
+            c->rb = hitRb;
+            c->id = transform_get_id(hitLeaf);
+            cache->count++;
+        }
+
+        hit = fifo_list_pop(sceneQuery);
+    }
+
+    return cache->rtree != NULL;
+}
+
+typedef struct {
+    _BroadphaseCache *cache;
+    FifoList *query;
+} _RigidbodyInstancesQuery;
+
+bool _rigidbody_cache_query_instances_func(InstanceGroup *g, void *ptr) {
+    _RigidbodyInstancesQuery *q = (_RigidbodyInstancesQuery *)ptr;
+    _BroadphaseCache *cache = q->cache;
+
+    rtree_query_overlap_box(instance_group_get_rtree(g),
+                            &cache->instancesBox,
+                            PHYSICS_GROUP_ALL_SYSTEM,
+                            PHYSICS_GROUP_ALL_SYSTEM,
+                            NULL,
+                            q->query,
+                            &float3_epsilon_collision);
+
+    Transform *t = instance_group_get_transform(g);
+    RtreeNode *hit = fifo_list_pop(q->query);
+    while (hit != NULL) {
+        _RigidbodyCandidate *c = _rigidbody_cache_push(cache);
+        if (c == NULL) {
+            fifo_list_flush(q->query, NULL);
+            return true;
+        }
+        c->t = t;
+        c->rb = instance_group_get_rigidbody(g);
+        c->group = g;
+        c->id = transform_get_id(t);
+        c->instance = instance_group_leaf_get_id(hit);
+        cache->instancesCount++;
+
+        hit = fifo_list_pop(q->query);
+    }
+    return false;
+}
+
+/// Queries instance colliders of all scene groups around a broadphase box, w/ same margin as
+/// _rigidbody_cache_query
+void _rigidbody_cache_query_instances(_BroadphaseCache *cache,
+                                      Scene *scene,
+                                      const Box *broadphase,
+                                      const float3 *dv,
+                                      FifoList *sceneQuery) {
+
+    const float margin = float3_length(dv) + PHYSICS_BROADPHASE_MARGIN;
+    cache->instancesBox = *broadphase;
+    float3_op_substract_scalar(&cache->instancesBox.min, margin);
+    float3_op_add_scalar(&cache->instancesBox.max, margin);
+    cache->instancesCount = 0;
+
+    vx_assert(fifo_list_pop(sceneQuery) == NULL);
+
+    _RigidbodyInstancesQuery q = {cache, sceneQuery};
+    scene_instance_groups_iterate(scene, _rigidbody_cache_query_instances_func, &q);
+}
+
+/// World-aligned box of a candidate: its r-tree leaf box, or instance world AABB
+bool _rigidbody_candidate_get_aabb(const _RigidbodyCandidate *c, Box *aabb) {
+    if (c->group != NULL) {
+        return instance_group_get_world_aabb(c->group, c->instance, aabb);
+    }
+    const RtreeNode *leaf = rigidbody_get_rtree_leaf(c->rb);
+    if (leaf == NULL) {
+        return false;
+    }
+    *aabb = *rtree_node_get_aabb(leaf);
+    return true;
+}
+
+/// Orders candidates by their world-aligned box, then by ID for identical boxes. Unlike r-tree
+/// query order, it doesn't depend on the history of insertions & removals
+int _rigidbody_candidate_compare(const _RigidbodyCandidate *c1, const _RigidbodyCandidate *c2) {
+    Box aabb1 = box_zero, aabb2 = box_zero;
+    _rigidbody_candidate_get_aabb(c1, &aabb1);
+    _rigidbody_candidate_get_aabb(c2, &aabb2);
+    const float *b1 = &aabb1.min.x;
+    const float *b2 = &aabb2.min.x;
+    for (int i = 0; i < 6; ++i) {
+        if (b1[i] != b2[i]) {
+            return b1[i] < b2[i] ? -1 : 1;
+        }
+    }
+    if (c1->id != c2->id) {
+        return c1->id < c2->id ? -1 : 1;
+    }
+    return c1->instance < c2->instance ? -1 : (c1->instance > c2->instance ? 1 : 0);
+}
+
+/// Insertion sort of current contacts for deterministic simulation, there are only a few of them
+void _rigidbody_cache_sort_contacts(_BroadphaseCache *cache) {
+    uint32_t index, j;
+    for (uint32_t i = 1; i < cache->contactsCount; ++i) {
+        index = cache->contacts[i];
+        j = i;
+        while (j > 0 && _rigidbody_candidate_compare(&cache->candidates[cache->contacts[j - 1]],
+                                                     &cache->candidates[index]) > 0) {
+            cache->contacts[j] = cache->contacts[j - 1];
+            --j;
+        }
+        cache->contacts[j] = index;
+    }
+}
+
+/// Own r-tree leaf update counts as the only expected change to keep the cache for next frame
+void _rigidbody_cache_expect_update(_BroadphaseCache *cache, const Rtree *r) {
+    if (cache->rtree == r && cache->rtreeVersion == rtree_get_version(r)) {
+        cache->rtreeVersion++;
+    } else {
+        cache->rtree = NULL;
+    }
+}
+
+/// Sweeps world collider along dv against a candidate, sets its swept ratio & contact normals
+void _rigidbody_candidate_sweep(_RigidbodyCandidate *c,
+                                const Box *worldCollider,
+                                const Box *broadphase,
+                                const float3 *dv) {
+
+    Box aabb;
+    if (_rigidbody_candidate_get_aabb(c, &aabb) == false) {
+        return;
+    }
+    if (box_collide_epsilon3(broadphase, &aabb, &float3_epsilon_collision) == false) {
+        return;
+    }
+
+    float3 rtreeNormal;
+    const float rtreeSwept = box_swept(worldCollider,
+                                       dv,
+                                       &aabb,
+                                       &float3_epsilon_collision,
+                                       true,
+                                       &rtreeNormal,
+                                       NULL);
+
+    // instance colliders are solved as their world-aligned box
+    if (rigidbody_is_dynamic(c->rb) || c->group != NULL) {
+        c->swept = rtreeSwept;
+        c->normal = rtreeNormal;
+        c->wNormal = rtreeNormal;
+        return;
+    }
+
+    Shape *shape = transform_utils_get_shape(c->t);
+    const bool hitPerBlock = shape != NULL && rigidbody_uses_per_block_collisions(c->rb);
+
+    // solve non-dynamic rigidbodies in their model space (rotated collider)
+    const Box collider = hitPerBlock ? shape_get_model_aabb(shape) : *rigidbody_get_collider(c->rb);
+    Matrix4x4 invModel;
+    transform_utils_get_model_wtl(c->t, &invModel);
+    Box modelBox, modelBroadphase;
+    float3 modelDv, modelEpsilon, normal = float3_zero;
+    rigidbody_broadphase_world_to_model(&invModel,
+                                        worldCollider,
+                                        &modelBox,
+                                        dv,
+                                        &modelDv,
+                                        EPSILON_COLLISION,
+                                        &modelEpsilon);
+
+    box_set_broadphase_box(&modelBox, &modelDv, &modelBroadphase);
+    if (box_collide_epsilon3(&modelBroadphase, &collider, &modelEpsilon) == false) {
+        return;
+    }
+
+    // shapes may enable per-block collisions
+    float swept;
+    if (hitPerBlock) {
+        swept = shape_box_cast(shape,
+                               &modelBox,
+                               &modelDv,
+                               &modelEpsilon,
+                               true,
+                               &normal,
+                               NULL,
+                               NULL,
+                               NULL);
+    } else {
+        swept = box_swept(&modelBox,
+                          &modelDv,
+                          rigidbody_get_collider(c->rb),
+                          &modelEpsilon,
+                          true,
+                          &normal,
+                          NULL);
+    }
+
+    // if replacement, solve collision using shortest replacement between world-aligned &
+    // model-aligned
+    if (swept < 0.0f && rtreeSwept > swept) {
+        c->swept = rtreeSwept;
+        c->normal = rtreeNormal;
+        c->wNormal = rtreeNormal;
+    } else {
+        Matrix4x4 model;
+        transform_utils_get_model_ltw(c->t, &model);
+        c->swept = swept;
+        c->normal = normal;
+        matrix4x4_op_multiply_vec_vector(&c->wNormal, &normal, &model);
+        float3_normalize(&c->wNormal);
+    }
+}
+
 void _rigidbody_fire_reciprocal_callbacks(Scene *sc,
                                           RigidBody *selfRb,
                                           Transform *selfTr,
@@ -207,10 +663,12 @@ bool _rigidbody_dynamic_tick(Scene *scene,
 #define INC_REPLACEMENTS debug_rigidbody_replacements++;
 #define INC_COLLISIONS debug_rigidbody_collisions++;
 #define INC_SLEEPS debug_rigidbody_sleeps++;
+#define INC_QUERIES debug_rigidbody_queries++;
 #else
 #define INC_REPLACEMENTS
 #define INC_COLLISIONS
 #define INC_SLEEPS
+#define INC_QUERIES
 #endif
 
     float3 f3;
@@ -270,12 +728,19 @@ bool _rigidbody_dynamic_tick(Scene *scene,
     float3_op_add(&f3, rb->motion);
     // f3 now represents object's velocity + motion
 
-    // dynamic rigidbodies may sleep
+    // dynamic rigidbodies may rest, and eventually fall asleep w/ their island
     if (rigidbody_check_velocity_sleep(rb, &f3)) {
         float3_set_zero(rb->velocity);
+        if (rb->restFrames < PHYSICS_SLEEP_FRAMES) {
+            rb->restFrames++;
+        }
+        if (rb->restFrames == PHYSICS_SLEEP_FRAMES) {
+            scene_register_sleep_candidate(scene, rb);
+        }
         INC_SLEEPS
         return false;
     }
+    rb->restFrames = 0;
 
     // ------------------------
     // CLAMP TO MAX VELOCITY
@@ -299,25 +764,29 @@ bool _rigidbody_dynamic_tick(Scene *scene,
     // PREPARE COLLISION TESTING
     // ------------------------
 
-    float3 dv, normal, push3, modelDv, modelEpsilon, rtreeNormal;
-    float minSwept, swept, rtreeSwept;
+    float3 dv, push3;
+    float minSwept;
     float3 pos = *transform_get_position(t, false);
     const bool selfCallbacks = rigidbody_has_callbacks(rb);
-    Box broadphase, modelBox, modelBroadphase;
-    Shape *shape;
-
-    typedef struct {
-        Transform *t;
-        RigidBody *rb;
-        Matrix4x4 *model;
-        float3 normal;
-    } ContactData;
-    ContactData contact; // TODO: list of contacts to handle contact ties
+    Box broadphase;
+    _RigidbodyCandidate *c;
 
     // initial frame delta translation
     float3_copy(&dv, &f3);
     float3_op_scale(&dv, dt_f);
 
+    // candidates from a previous query may still be used if r-tree is unchanged
+    if (rb->cache == NULL) {
+        rb->cache = _rigidbody_cache_new();
+        if (rb->cache == NULL) {
+            return false;
+        }
+    }
+    _BroadphaseCache *cache = rb->cache;
+    const bool deterministic = scene_is_deterministic(scene);
+    bool cached = _rigidbody_cache_resolve(cache, r);
+    bool instancesCached = false;
+
     // ----------------------
     // SOLVER ITERATIONS
     // ----------------------
@@ -329,9 +798,6 @@ bool _rigidbody_dynamic_tick(Scene *scene,
            solverCount < PHYSICS_MAX_SOLVER_ITERATIONS) {
 
         minSwept = 1.0f;
-        contact.t = NULL;
-        contact.rb = NULL;
-        contact.model = NULL;
 
         box_set_broadphase_box(worldCollider, &dv, &broadphase);
 
@@ -344,154 +810,83 @@ bool _rigidbody_dynamic_tick(Scene *scene,
         // static scene. It isn't going to be accurate in case of concurring trajectories. We can
         // add a full broadphase if we see it's necessary
 
-        // previous query should be processed entirely
-        vx_assert(fifo_list_pop(sceneQuery) == NULL);
-
-        // run collision query in r-tree
-        if (rtree_query_overlap_box(r,
-                                    &broadphase,
-                                    rb->groups,
-                                    rb->collidesWith,
-                                    NULL,
-                                    sceneQuery,
-                                    &float3_epsilon_collision) > 0) {
-            RtreeNode *hit = fifo_list_pop(sceneQuery);
-            Transform *hitLeaf;
-            RigidBody *hitRb;
-            while (hit != NULL) {
-                hitLeaf = (Transform *)rtree_node_get_leaf_ptr(hit);
-                vx_assert(rtree_node_is_leaf(hit));
-
-                // self isn't removed from r-tree before query
-                if (hitLeaf == t) {
-                    hit = fifo_list_pop(sceneQuery);
-                    continue;
-                }
-
-                hitRb = transform_get_rigidbody(hitLeaf);
-                vx_assert(hitRb != NULL);
+        // a single r-tree query, w/ a margin, provides candidates for all solver iterations and
+        // following frames, as long as trajectory remains within the queried box
+        if (cached == false || box_contains_box(&cache->box, &broadphase) == false) {
+            cached = _rigidbody_cache_query(cache, t, r, &broadphase, &dv, sceneQuery);
+            instancesCached = false;
+            INC_QUERIES
+        }
 
-                if (rigidbody_collides_with_rigidbody(rb, hitRb) == false) {
-                    hit = fifo_list_pop(sceneQuery);
-                    continue;
-                }
+        // instance colliders are queried at least once per tick, in the same way
+        if (instancesCached == false ||
+            box_contains_box(&cache->instancesBox, &broadphase) == false) {
+            _rigidbody_cache_query_instances(cache, scene, &broadphase, &dv, sceneQuery);
+            instancesCached = true;
+        }
+        const uint32_t candidatesCount = cache->count + cache->instancesCount;
 
-                const RigidbodyMode mode = rigidbody_get_simulation_mode(hitRb);
-                if (mode == RigidbodyMode_Disabled) {
-                    hit = fifo_list_pop(sceneQuery);
-                    continue;
-                }
+        for (uint32_t i = 0; i < candidatesCount; ++i) {
+            c = &cache->candidates[i];
+            c->swept = 1.0f;
+            c->inManifold = false;
 
-                const bool isTrigger = mode == RigidbodyMode_Trigger ||
-                                       mode == RigidbodyMode_TriggerPerBlock;
+            if (rigidbody_collides_with_rigidbody(rb, c->rb) == false) {
+                continue;
+            }
 
-                if (isTrigger && selfCallbacks == false &&
-                    rigidbody_has_callbacks(hitRb) == false) {
-                    hit = fifo_list_pop(sceneQuery);
-                    continue;
-                }
+            const RigidbodyMode mode = rigidbody_get_simulation_mode(c->rb);
+            if (mode == RigidbodyMode_Disabled) {
+                continue;
+            }
 
-                rtreeSwept = box_swept(worldCollider,
-                                       &dv,
-                                       rtree_node_get_aabb(hit),
-                                       &float3_epsilon_collision,
-                                       true,
-                                       &rtreeNormal,
-                                       NULL);
+            c->isTrigger = mode == RigidbodyMode_Trigger || mode == RigidbodyMode_TriggerPerBlock;
 
-                Matrix4x4 *model = NULL;
-                normal = float3_zero;
+            if (c->isTrigger && selfCallbacks == false && rigidbody_has_callbacks(c->rb) == false) {
+                continue;
+            }
 
-                if (mode == RigidbodyMode_Dynamic) {
-                    swept = rtreeSwept;
-                    normal = rtreeNormal;
-                } else {
-                    shape = transform_utils_get_shape(hitLeaf);
-                    const bool hitPerBlock = shape != NULL &&
-                                             rigidbody_uses_per_block_collisions(hitRb);
-
-                    // solve non-dynamic rigidbodies in their model space (rotated collider)
-                    const Box collider = hitPerBlock ? shape_get_model_aabb(shape)
-                                                     : *rigidbody_get_collider(hitRb);
-                    Matrix4x4 invModel;
-                    transform_utils_get_model_wtl(hitLeaf, &invModel);
-                    rigidbody_broadphase_world_to_model(&invModel,
-                                                        worldCollider,
-                                                        &modelBox,
-                                                        &dv,
-                                                        &modelDv,
-                                                        EPSILON_COLLISION,
-                                                        &modelEpsilon);
-
-                    box_set_broadphase_box(&modelBox, &modelDv, &modelBroadphase);
-                    if (box_collide_epsilon3(&modelBroadphase, &collider, &modelEpsilon)) {
-                        // shapes may enable per-block collisions
-                        if (hitPerBlock) {
-                            swept = shape_box_cast(shape,
-                                                   &modelBox,
-                                                   &modelDv,
-                                                   &modelEpsilon,
-                                                   true,
-                                                   &normal,
-                                                   NULL,
-                                                   NULL,
-                                                   NULL);
-                        } else {
-                            swept = box_swept(&modelBox,
-                                              &modelDv,
-                                              rigidbody_get_collider(hitRb),
-                                              &modelEpsilon,
-                                              true,
-                                              &normal,
-                                              NULL);
-                        }
+            _rigidbody_candidate_sweep(c, worldCollider, &broadphase, &dv);
 
-                        // if replacement, solve collision using shortest replacement between
-                        // world-aligned & model-aligned
-                        if (swept < 0.0f && rtreeSwept > swept) {
-                            swept = rtreeSwept;
-                            normal = rtreeNormal;
-                        } else {
-                            model = matrix4x4_new_identity();
-                            transform_utils_get_model_ltw(hitLeaf, model);
-                        }
-                    } else {
-                        swept = 1.0f;
-                    }
-                }
-                // earlier contact found
-                if (swept < minSwept) {
-                    if (isTrigger) {
-                        // consider triggers here too, in case dynamic rb passes through in one
-                        // frame, or the callback is defined only on the dynamic rb
-                        float3 wNormal;
-                        if (model != NULL) {
-                            matrix4x4_op_multiply_vec_vector(&wNormal, &normal, model);
-                            float3_normalize(&wNormal);
-                            matrix4x4_free(model);
-                        } else {
-                            wNormal = normal;
-                        }
+            // earlier contact found
+            if (c->isTrigger == false && c->swept < minSwept) {
+                minSwept = c->swept;
+            }
+        }
 
-                        _rigidbody_fire_reciprocal_callbacks(scene,
-                                                             rb,
-                                                             t,
-                                                             hitRb,
-                                                             hitLeaf,
-                                                             wNormal,
-                                                             callbackData);
-                    } else {
-                        contact.t = hitLeaf;
-                        contact.rb = hitRb;
-                        contact.model = model;
-                        contact.normal = normal;
-                        minSwept = swept;
-                    }
-                } else if (model != NULL) {
-                    matrix4x4_free(model);
-                }
+        // ----------------------
+        // CONTACT MANIFOLD
+        // ----------------------
+        // all contacts tied w/ the first one, within collision tolerance along the trajectory, are
+        // solved together. Contacts are processed in candidates order, or in an order independent
+        // from r-tree history for deterministic simulation
+
+        const float tie = minSwept < 1.0f ? EPSILON_COLLISION / float3_length(&dv) : 0.0f;
+        cache->contactsCount = 0;
+        for (uint32_t i = 0; i < candidatesCount; ++i) {
+            c = &cache->candidates[i];
+            c->inManifold = minSwept < 1.0f && c->isTrigger == false &&
+                            c->swept <= minSwept + tie;
+            if (c->inManifold || (c->isTrigger && c->swept < minSwept)) {
+                cache->contacts[cache->contactsCount++] = i;
+            }
+        }
+        if (deterministic) {
+            _rigidbody_cache_sort_contacts(cache);
+        }
 
-                hit = fifo_list_pop(sceneQuery);
+        // consider triggers crossed before first contact, in case dynamic rb passes through in one
+        // frame, or the callback is defined only on the dynamic rb
+        for (uint32_t i = 0; i < cache->contactsCount; ++i) {
+            c = &cache->candidates[cache->contacts[i]];
+            if (c->isTrigger) {
+                _rigidbody_fire_reciprocal_callbacks(scene,
+                                                     rb,
+                                                     t,
+                                                     c->rb,
+                                                     c->t,
+                                                     c->wNormal,
+                                                     callbackData);
             }
         }
 
@@ -568,109 +963,163 @@ bool _rigidbody_dynamic_tick(Scene *scene,
 
         // collision or contact on at least one component
         if (minSwept < 1.0f) {
-            // remainder of the trajectory after contact
-            float3 remainder = dv;
-            float3_op_scale(&remainder, 1.0f - minSwept);
-
-            // contact world normal
-            float3 wNormal;
-            if (contact.model != NULL) {
-                matrix4x4_op_multiply_vec_vector(&wNormal, &contact.normal, contact.model);
-                float3_normalize(&wNormal);
-            } else {
-                wNormal = contact.normal;
-            }
+            // remainder of the trajectory after contact, responses for each contact normal of the
+            // manifold are applied one after the other
+            float3_op_scale(&dv, 1.0f - minSwept);
+
+            uint8_t hitMask = AxesMaskNone;
+            bool first = true;
+            for (uint32_t i = 0; i < cache->contactsCount; ++i) {
+                c = &cache->candidates[cache->contacts[i]];
+                if (c->inManifold == false) {
+                    continue;
+                }
+                const float3 wNormal = c->wNormal;
+
+                // combined friction & bounciness, averaged over contacts sharing this normal
+                float friction = 0.0f, bounciness = 0.0f;
+                int shared = 0;
+                for (uint32_t j = i; j < cache->contactsCount; ++j) {
+                    const _RigidbodyCandidate *other = &cache->candidates[cache->contacts[j]];
+                    if (other->inManifold &&
+                        float3_isEqual(&other->wNormal, &wNormal, EPSILON_ZERO)) {
+                        const FACE_INDEX_INT_T contactFace = utils_aligned_normal_to_face(
+                            &other->normal);
+                        const FACE_INDEX_INT_T face = utils_face_swapped(contactFace);
+                        friction += rigidbody_get_combined_friction(rb,
+                                                                    other->rb,
+                                                                    face,
+                                                                    contactFace);
+                        bounciness += rigidbody_get_combined_bounciness(rb,
+                                                                        other->rb,
+                                                                        face,
+                                                                        contactFace);
+                        ++shared;
+                    }
+                }
+                friction /= (float)shared;
+                bounciness /= (float)shared;
+
+                // split intruding & tangential displacements
+                const float intruding_mag = float3_dot_product(&dv, &wNormal);
+                const float vIntruding_mag = float3_dot_product(rb->velocity, &wNormal);
+
+                // a previous response of the manifold may already be moving away from this contact
+                const bool respond = first || intruding_mag < 0.0f || vIntruding_mag < 0.0f;
+                first = false;
 
-            // split intruding & tangential displacements
-            const float intruding_mag = float3_dot_product(&remainder, &wNormal);
-            const float vIntruding_mag = float3_dot_product(rb->velocity, &wNormal);
-            const float3 intruding = (float3){wNormal.x * intruding_mag,
-                                              wNormal.y * intruding_mag,
-                                              wNormal.z * intruding_mag};
-            const float3 tangential = (float3){remainder.x - intruding.x,
-                                               remainder.y - intruding.y,
-                                               remainder.z - intruding.z};
-            const float3 vIntruding = (float3){wNormal.x * vIntruding_mag,
-                                               wNormal.y * vIntruding_mag,
-                                               wNormal.z * vIntruding_mag};
-
-            // combined friction & bounciness
-            const FACE_INDEX_INT_T contactFace = utils_aligned_normal_to_face(&contact.normal);
-            const FACE_INDEX_INT_T face = utils_face_swapped(contactFace);
-            const float friction = contact.rb != NULL ? rigidbody_get_combined_friction(rb,
-                                                                                        contact.rb,
-                                                                                        face,
-                                                                                        contactFace)
-                                                      : rb->friction[face];
-            const float bounciness = contact.rb != NULL
-                                         ? rigidbody_get_combined_bounciness(rb,
-                                                                             contact.rb,
-                                                                             face,
-                                                                             contactFace)
-                                         : rb->bounciness[face];
-
-            // (1) apply combined friction on tangential displacement, assign tangential push if
-            // displacement originated at least partly from own velocity, not only motion or scene
-            // constant
-            dv = tangential;
-            float3_op_substract(rb->velocity, &vIntruding);
-
-            float3_op_scale(&dv, friction);
-            float3_op_scale(rb->velocity, friction);
-
-            if (float3_isZero(rb->velocity, EPSILON_ZERO) == false) {
-                push3 = tangential;
-                // float3_op_scale(&push3, 1.0f - friction);
-            } else {
                 push3 = float3_zero;
-            }
+                if (respond) {
+                    const float3 intruding = (float3){wNormal.x * intruding_mag,
+                                                      wNormal.y * intruding_mag,
+                                                      wNormal.z * intruding_mag};
+                    const float3 tangential = (float3){dv.x - intruding.x,
+                                                       dv.y - intruding.y,
+                                                       dv.z - intruding.z};
+                    const float3 vIntruding = (float3){wNormal.x * vIntruding_mag,
+                                                       wNormal.y * vIntruding_mag,
+                                                       wNormal.z * vIntruding_mag};
+
+                    // (1) apply combined friction on tangential displacement, assign tangential
+                    // push if displacement originated at least partly from own velocity, not only
+                    // motion or scene constant
+                    dv = tangential;
+                    float3_op_substract(rb->velocity, &vIntruding);
+
+                    float3_op_scale(&dv, friction);
+                    float3_op_scale(rb->velocity, friction);
+
+                    if (float3_isZero(rb->velocity, EPSILON_ZERO) == false) {
+                        push3 = tangential;
+                    }
 
-            // (2) apply combined bounciness on intruding displacement, add leftover to push ;
-            // minor bounce responses are muffled
-            const float3 vBounce = (float3){-vIntruding.x * bounciness,
-                                            -vIntruding.y * bounciness,
-                                            -vIntruding.z * bounciness};
-            if (float3_sqr_length(&vBounce) > PHYSICS_BOUNCE_SQR_THRESHOLD) {
-                const float3 bounce = (float3){-intruding.x * bounciness,
-                                               -intruding.y * bounciness,
-                                               -intruding.z * bounciness};
-
-                float3_op_add(&dv, &bounce);
-                float3_op_add(rb->velocity, &vBounce);
-
-                push3.x += intruding.x * (1.0f - bounciness);
-                push3.y += intruding.y * (1.0f - bounciness);
-                push3.z += intruding.z * (1.0f - bounciness);
-            } else {
-                float3_op_add(&push3, &intruding);
-            }
+                    // (2) apply combined bounciness on intruding displacement, add leftover to
+                    // push ; minor bounce responses are muffled
+                    const float3 vBounce = (float3){-vIntruding.x * bounciness,
+                                                    -vIntruding.y * bounciness,
+                                                    -vIntruding.z * bounciness};
+                    if (float3_sqr_length(&vBounce) > PHYSICS_BOUNCE_SQR_THRESHOLD) {
+                        const float3 bounce = (float3){-intruding.x * bounciness,
+                                                       -intruding.y * bounciness,
+                                                       -intruding.z * bounciness};
+
+                        float3_op_add(&dv, &bounce);
+                        float3_op_add(rb->velocity, &vBounce);
+
+                        push3.x += intruding.x * (1.0f - bounciness);
+                        push3.y += intruding.y * (1.0f - bounciness);
+                        push3.z += intruding.z * (1.0f - bounciness);
+                    } else {
+                        float3_op_add(&push3, &intruding);
+                    }
+                }
 
-            // (3) apply push relative to colliding masses
-            if (contact.rb != NULL && rigidbody_is_dynamic(contact.rb)) {
-                const float push = rigidbody_get_mass_push_ratio(rb, contact.rb);
+                // (3) apply push relative to colliding masses, fire reciprocal callbacks for all
+                // contacts sharing this normal
+                for (uint32_t j = i; j < cache->contactsCount; ++j) {
+                    _RigidbodyCandidate *other = &cache->candidates[cache->contacts[j]];
+                    if (other->inManifold == false ||
+                        float3_isEqual(&other->wNormal, &wNormal, EPSILON_ZERO) == false) {
+                        continue;
+                    }
+                    other->inManifold = false;
 
-                push3.x *= push / dt_f;
-                push3.y *= push / dt_f;
-                push3.z *= push / dt_f;
+                    if (respond && rigidbody_is_dynamic(other->rb)) {
+                        const float push = rigidbody_get_mass_push_ratio(rb, other->rb);
+                        const float3 otherPush3 = {push3.x * push / dt_f,
+                                                   push3.y * push / dt_f,
+                                                   push3.z * push / dt_f};
 
-                rigidbody_apply_push(contact.rb, &push3);
+                        // contact blocked along the push won't move, eg. resting at the bottom of
+                        // a stack, this lets the whole stack rest
+                        if (_rigidbody_is_blocked(other->rb, &otherPush3) == false) {
+                            rigidbody_apply_push(other->rb, &otherPush3);
+
+                            // self is flagged as awake, since contact will move from push
+                            rigidbody_set_awake(rb);
+                        }
+
+                        // TODO: inherit velocity from contact rigidbody
+                    }
+
+                    if (other->group == NULL) {
+                        _rigidbody_fire_reciprocal_callbacks(scene,
+                                                             rb,
+                                                             t,
+                                                             other->rb,
+                                                             other->t,
+                                                             other->wNormal,
+                                                             callbackData);
+                    }
+                }
 
-                // self is flagged as awake, since contact will move from push
-                rigidbody_set_awake(rb);
+                // contact along self's box
+                if (fabsf(wNormal.x) >= fabsf(wNormal.y) && fabsf(wNormal.x) >= fabsf(wNormal.z)) {
+                    if (wNormal.x > 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskNX, true);
+                    } else if (wNormal.x < 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskX, true);
+                    }
+                }
+                if (fabsf(wNormal.y) >= fabsf(wNormal.x) && fabsf(wNormal.y) >= fabsf(wNormal.z)) {
+                    if (wNormal.y > 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskNY, true);
+                    } else if (wNormal.y < 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskY, true);
+                    }
+                }
+                if (fabsf(wNormal.z) >= fabsf(wNormal.x) && fabsf(wNormal.z) >= fabsf(wNormal.y)) {
+                    if (wNormal.z > 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskNZ, true);
+                    } else if (wNormal.z < 0.0f) {
+                        utils_axes_mask_set(&hitMask, AxesMaskZ, true);
+                    }
+                }
 
-                // TODO: inherit velocity from contact rigidbody
-                /*const float inherit_push = rigidbody_get_mass_push_ratio(contact.rb, rb);
-                const float inherit_mag = float3_dot_product(contact.rb->velocity, &tangential);
-                const float3 inherit = (float3){
-                    tangential.x * inherit_mag * (1.0f - friction),
-                    tangential.y * inherit_mag * (1.0f - friction),
-                    tangential.z * inherit_mag * (1.0f - friction)
-                };
-                rigidbody_apply_push(contact.rb, &push3);*/
+                INC_COLLISIONS
             }
 
-            // (4) reset contact mask if there was any motion, then update new contact along self's
-            // box
+            // (4) reset contact mask if there was any motion, then update new contacts
             if (minSwept > 0.0f) {
                 if (float_isZero(dv.x, EPSILON_ZERO) != false) {
                     utils_axes_mask_set(&rb->contact,
@@ -688,38 +1137,7 @@ bool _rigidbody_dynamic_tick(Scene *scene,
                                         false);
                 }
             }
-            if (fabsf(wNormal.x) >= fabsf(wNormal.y) && fabsf(wNormal.x) >= fabsf(wNormal.z)) {
-                if (wNormal.x > 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskNX, true);
-                } else if (wNormal.x < 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskX, true);
-                }
-            }
-            if (fabsf(wNormal.y) >= fabsf(wNormal.x) && fabsf(wNormal.y) >= fabsf(wNormal.z)) {
-                if (wNormal.y > 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskNY, true);
-                } else if (wNormal.y < 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskY, true);
-                }
-            }
-            if (fabsf(wNormal.z) >= fabsf(wNormal.x) && fabsf(wNormal.z) >= fabsf(wNormal.y)) {
-                if (wNormal.z > 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskNZ, true);
-                } else if (wNormal.z < 0.0f) {
-                    utils_axes_mask_set(&rb->contact, AxesMaskZ, true);
-                }
-            }
-
-            // (5) fire reciprocal callbacks
-            _rigidbody_fire_reciprocal_callbacks(scene,
-                                                 rb,
-                                                 t,
-                                                 contact.rb,
-                                                 contact.t,
-                                                 wNormal,
-                                                 callbackData);
-
-            INC_COLLISIONS
+            utils_axes_mask_set(&rb->contact, hitMask, true);
         }
         // no collision,
         else {
@@ -738,10 +1156,6 @@ bool _rigidbody_dynamic_tick(Scene *scene,
             float3_set_zero(&dv);
         }
 
-        if (contact.model != NULL) {
-            matrix4x4_free(contact.model);
-        }
-
         solverCount++;
     }
 #if DEBUG_RIGIDBODY_CALLS
@@ -759,6 +1173,9 @@ bool _rigidbody_dynamic_tick(Scene *scene,
             float3_copy(rb->checkpoint, &pos);
         }
 
+        // own r-tree leaf is updated right after a move
+        _rigidbody_cache_expect_update(cache, r);
+
         return true;
     } else {
         return false;
@@ -781,6 +1198,7 @@ void _rigidbody_trigger_tick(Scene *scene,
     vx_assert(fifo_list_pop(sceneQuery) == NULL);
 
     // run overlap query in r-tree
+    INC_QUERIES
     if (rtree_query_overlap_box(r,
                                 worldCollider,
                                 rb->groups,
@@ -923,12 +1341,19 @@ RigidBody *rigidbody_new(const uint8_t mode, const uint16_t groups, const uint16
     rb->velocity = float3_new_zero();
     rb->constantAcceleration = float3_new_zero();
     rb->checkpoint = NULL;
+    rb->cache = NULL;
+    rb->sleepNext = NULL;
+    rb->transform = NULL;
     rb->mass = PHYSICS_MASS_DEFAULT;
+    rb->previous = float3_zero;
+    rb->islandStamp = 0;
+    rb->previousStep = 0;
     rb->contact = AxesMaskNone;
     rb->groups = groups;
     rb->collidesWith = collidesWith;
     rb->simulationFlags = SIMULATIONFLAG_NONE;
     rb->awakeFlag = 0;
+    rb->restFrames = 0;
 
     rb->friction = (float *)malloc(sizeof(float) * FACE_COUNT);
     if (rb->friction == NULL) {
@@ -964,12 +1389,19 @@ RigidBody *rigidbody_new_copy(const RigidBody *other) {
     rb->velocity = float3_new_zero();
     rb->constantAcceleration = float3_new_copy(other->constantAcceleration);
     rb->checkpoint = other->checkpoint != NULL ? float3_new_copy(other->checkpoint) : NULL;
+    rb->cache = NULL;
+    rb->sleepNext = NULL;
+    rb->transform = NULL;
     rb->mass = other->mass;
+    rb->previous = float3_zero;
+    rb->islandStamp = 0;
+    rb->previousStep = 0;
     rb->contact = AxesMaskNone;
     rb->groups = other->groups;
     rb->collidesWith = other->collidesWith;
     rb->simulationFlags = SIMULATIONFLAG_NONE;
     rb->awakeFlag = 0;
+    rb->restFrames = 0;
 
     rb->friction = (float *)malloc(sizeof(float) * FACE_COUNT);
     if (rb->friction == NULL) {
@@ -995,6 +1427,9 @@ void rigidbody_free(RigidBody *rb) {
         return;
     }
 
+    // rest of the island may have been supported by this rigidbody
+    _rigidbody_wake_island(rb);
+
     box_free(rb->collider);
     float3_free(rb->motion);
     float3_free(rb->velocity);
@@ -1002,6 +1437,7 @@ void rigidbody_free(RigidBody *rb) {
     if (rb->checkpoint != NULL) {
         float3_free(rb->checkpoint);
     }
+    _rigidbody_cache_free(rb->cache);
     free(rb->friction);
     free(rb->bounciness);
 
@@ -1020,6 +1456,7 @@ void rigidbody_reset(RigidBody *rb) {
     rb->checkpoint = NULL;
 
     _rigidbody_reset_state(rb);
+    _rigidbody_wake_island(rb);
 }
 
 void rigidbody_non_kinematic_reset(RigidBody *rb) {
@@ -1028,6 +1465,7 @@ void rigidbody_non_kinematic_reset(RigidBody *rb) {
     }
 
     _rigidbody_reset_state(rb);
+    _rigidbody_wake_island(rb);
 }
 
 bool rigidbody_tick(Scene *scene,
@@ -1050,6 +1488,9 @@ bool rigidbody_tick(Scene *scene,
     // dynamic rigidbodies are fully simulated, their callbacks are evaluated in this loop
     // vs. other dynamic rigidbodies only
     if (rigidbody_is_dynamic(rb)) {
+        rb->previous = *transform_get_position(t, false);
+        rb->previousStep = scene_get_steps(scene);
+
         return _rigidbody_dynamic_tick(scene,
                                        rb,
                                        t,
@@ -1067,6 +1508,127 @@ bool rigidbody_tick(Scene *scene,
     return false;
 }
 
+RigidbodyIslands *rigidbody_islands_new(void) {
+    RigidbodyIslands *islands = (RigidbodyIslands *)malloc(sizeof(RigidbodyIslands));
+    if (islands == NULL) {
+        return NULL;
+    }
+    islands->query = fifo_list_new();
+    islands->island = (RigidBody **)malloc(sizeof(RigidBody *) * ISLAND_DEFAULT_CAPACITY);
+    if (islands->query == NULL || islands->island == NULL) {
+        if (islands->query != NULL) {
+            fifo_list_free(islands->query, NULL);
+        }
+        free(islands->island);
+        free(islands);
+        return NULL;
+    }
+    islands->capacity = ISLAND_DEFAULT_CAPACITY;
+    return islands;
+}
+
+void rigidbody_islands_free(RigidbodyIslands *islands) {
+    if (islands == NULL) {
+        return;
+    }
+    fifo_list_free(islands->query, NULL);
+    free(islands->island);
+    free(islands);
+}
+
+void rigidbody_sleep_islands(RigidbodyIslands *islands, FifoList *candidates, Rtree *r) {
+    // shared by all scenes, a rigidbody's stamp can't match a pass it wasn't visited by
+    static uint32_t stamp = 0;
+
+    if (islands == NULL) {
+        while (fifo_list_pop(candidates) != NULL) {}
+        return;
+    }
+    FifoList *query = islands->query;
+    RigidBody **island = islands->island;
+    uint32_t capacity = islands->capacity;
+
+    // each island is flooded entirely, at most once per pass
+    stamp++;
+
+    RigidBody *rb = (RigidBody *)fifo_list_pop(candidates);
+    while (rb != NULL) {
+        if (rb->sleepNext != NULL || rb->islandStamp == stamp || rb->rtreeLeaf == NULL) {
+            rb = (RigidBody *)fifo_list_pop(candidates);
+            continue;
+        }
+        rb->islandStamp = stamp;
+        island[0] = rb;
+        uint32_t count = 1;
+        bool canSleep = true;
+
+        // island array is also the flood queue, dynamic rigidbodies are connected if within the
+        // same distance used to wake up contacts
+        for (uint32_t i = 0; i < count; ++i) {
+            Box box = *rtree_node_get_aabb(island[i]->rtreeLeaf);
+            float3_op_add_scalar(&box.max, PHYSICS_AWAKE_DISTANCE);
+            float3_op_substract_scalar(&box.min, PHYSICS_AWAKE_DISTANCE);
+
+            vx_assert(fifo_list_pop(query) == NULL);
+            rtree_query_overlap_box(r,
+                                    &box,
+                                    PHYSICS_GROUP_ALL_SYSTEM,
+                                    PHYSICS_GROUP_ALL_SYSTEM,
+                                    NULL,
+                                    query,
+                                    &float3_epsilon_collision);
+
+            RtreeNode *hit = (RtreeNode *)fifo_list_pop(query);
+            while (hit != NULL) {
+                RigidBody *other = transform_get_rigidbody(
+                    (Transform *)rtree_node_get_leaf_ptr(hit));
+
+                // static & kinematic rigidbodies do not connect islands, a sleeping neighbour
+                // island will be woken up separately by any movement around it
+                if (other != NULL && other->islandStamp != stamp && other->sleepNext == NULL &&
+                    rigidbody_is_dynamic(other)) {
+                    other->islandStamp = stamp;
+
+                    // keep flooding to mark the whole island as visited, even if it can't sleep
+                    if (other->restFrames < PHYSICS_SLEEP_FRAMES) {
+                        canSleep = false;
+                    }
+                    if (count == capacity) {
+                        const uint32_t newCapacity = capacity * 2;
+                        RigidBody **newIsland = (RigidBody **)realloc(island,
+                                                                      sizeof(RigidBody *) *
+                                                                          newCapacity);
+                        if (newIsland == NULL) {
+                            cclog_error("⚠️ rigidbody_sleep_islands: failed to grow island");
+                            canSleep = false;
+                        } else {
+                            island = newIsland;
+                            capacity = newCapacity;
+                            islands->island = island;
+                            islands->capacity = capacity;
+                        }
+                    }
+                    if (count < capacity) {
+                        island[count++] = other;
+                    }
+                }
+                hit = (RtreeNode *)fifo_list_pop(query);
+            }
+        }
+
+        if (canSleep) {
+            for (uint32_t i = 0; i < count; ++i) {
+                island[i]->sleepNext = island[(i + 1) % count];
+            }
+#if DEBUG_RIGIDBODY_CALLS
+            debug_rigidbody_islands++;
+#endif
+        }
+
+        rb = (RigidBody *)fifo_list_pop(candidates);
+    }
+}
+
 // MARK: - Accessors -
 
 const Box *rigidbody_get_collider(const RigidBody *rb) {
@@ -1075,6 +1637,8 @@ const Box *rigidbody_get_collider(const RigidBody *rb) {
 
 void rigidbody_set_collider(RigidBody *rb, const Box *value, const bool custom) {
     box_copy(rb->collider, value);
+    _rigidbody_wake_island(rb);
+    _rigidbody_set_branch_dirty(rb);
     if (_rigidbody_get_simulation_flag_value(rb, SIMULATIONFLAG_MODE) != RigidbodyMode_Disabled) {
         _rigidbody_set_simulation_flag(rb, SIMULATIONFLAG_COLLIDER_DIRTY);
     }
@@ -1083,6 +1647,14 @@ void rigidbody_set_collider(RigidBody *rb, const Box *value, const bool custom)
     }
 }
 
+void rigidbody_set_transform(RigidBody *rb, Transform *t) {
+    rb->transform = t;
+}
+
+const float3 *rigidbody_get_previous_position(const RigidBody *rb, const uint32_t step) {
+    return rb->previousStep == step ? &rb->previous : NULL;
+}
+
 RtreeNode *rigidbody_get_rtree_leaf(const RigidBody *rb) {
     return rb->rtreeLeaf;
 }
@@ -1096,6 +1668,9 @@ const float3 *rigidbody_get_motion(const RigidBody *rb) {
 }
 
 void rigidbody_set_motion(RigidBody *rb, const float3 *value) {
+    if (float3_isEqual(rb->motion, value, EPSILON_ZERO) == false) {
+        _rigidbody_wake_island(rb);
+    }
     float3_copy(rb->motion, value);
 }
 
@@ -1104,6 +1679,9 @@ const float3 *rigidbody_get_velocity(const RigidBody *rb) {
 }
 
 void rigidbody_set_velocity(RigidBody *rb, const float3 *value) {
+    if (float3_isEqual(rb->velocity, value, EPSILON_ZERO) == false) {
+        _rigidbody_wake_island(rb);
+    }
     float3_copy(rb->velocity, value);
 }
 
@@ -1112,6 +1690,9 @@ const float3 *rigidbody_get_constant_acceleration(const RigidBody *rb) {
 }
 
 void rigidbody_set_constant_acceleration(RigidBody *rb, const float3 *value) {
+    if (float3_isEqual(rb->constantAcceleration, value, EPSILON_ZERO) == false) {
+        _rigidbody_wake_island(rb);
+    }
     float3_copy(rb->constantAcceleration, value);
 }
 
@@ -1148,6 +1729,10 @@ uint16_t rigidbody_get_groups(const RigidBody *rb) {
 }
 
 void rigidbody_set_groups(RigidBody *rb, uint16_t value) {
+    if (rb->groups != value) {
+        _rigidbody_wake_island(rb);
+        _rigidbody_set_branch_dirty(rb);
+    }
     rb->groups = value;
 }
 
@@ -1156,6 +1741,10 @@ uint16_t rigidbody_get_collides_with(const RigidBody *rb) {
 }
 
 void rigidbody_set_collides_with(RigidBody *rb, uint16_t value) {
+    if (rb->collidesWith != value) {
+        _rigidbody_wake_island(rb);
+        _rigidbody_set_branch_dirty(rb);
+    }
     rb->collidesWith = value;
 }
 
@@ -1168,6 +1757,8 @@ void rigidbody_set_simulation_mode(RigidBody *rb, const uint8_t value) {
     const uint8_t mode = _rigidbody_get_simulation_flag_value(rb, SIMULATIONFLAG_MODE);
     if (mode != value) {
         _rigidbody_set_simulation_flag_value(rb, SIMULATIONFLAG_MODE, value);
+        _rigidbody_wake_island(rb);
+        _rigidbody_set_branch_dirty(rb);
 #if TRANSFORM_AABOX_STATIC_COLLIDER_MODE != TRANSFORM_AABOX_DYNAMIC_COLLIDER_MODE
         if (value != RigidbodyMode_Disabled) {
             _rigidbody_set_simulation_flag(rb, SIMULATIONFLAG_COLLIDER_DIRTY);
@@ -1185,6 +1776,7 @@ void rigidbody_reset_collider_dirty(RigidBody *rb) {
 }
 
 void rigidbody_set_awake(RigidBody *rb) {
+    _rigidbody_wake_island(rb);
     rb->awakeFlag = PHYSICS_AWAKE_FRAMES;
 }
 
@@ -1270,6 +1862,10 @@ bool rigidbody_uses_per_block_collisions(const RigidBody *rb) {
                               RigidbodyMode_StaticPerBlock);
 }
 
+bool rigidbody_is_sleeping(const RigidBody *rb) {
+    return rb->sleepNext != NULL;
+}
+
 bool rigidbody_is_collider_custom_set(const RigidBody *rb) {
     return rb != NULL && _rigidbody_get_simulation_flag(rb, SIMULATIONFLAG_COLLIDER_CUSTOM_SET);
 }
@@ -1317,43 +1913,22 @@ bool rigidbody_check_velocity_sleep(RigidBody *rb, const float3 *velocity) {
 #endif
         return false;
     }
-    if (float_isZero(velocity->x, EPSILON_ZERO) == false) {
-        const bool x = utils_axes_mask_get(rb->contact, AxesMaskX);
-        const bool nx = utils_axes_mask_get(rb->contact, AxesMaskNX);
-        if ((velocity->x < 0.0f && nx == false) || (velocity->x > 0.0f && x == false)) {
-            return false;
-        }
-    }
-    if (float_isZero(velocity->y, EPSILON_ZERO) == false) {
-        const bool y = utils_axes_mask_get(rb->contact, AxesMaskY);
-        const bool ny = utils_axes_mask_get(rb->contact, AxesMaskNY);
-        if ((velocity->y < 0.0f && ny == false) || (velocity->y > 0.0f && y == false)) {
-            return false;
-        }
-    }
-    if (float_isZero(velocity->z, EPSILON_ZERO) == false) {
-        const bool z = utils_axes_mask_get(rb->contact, AxesMaskZ);
-        const bool nz = utils_axes_mask_get(rb->contact, AxesMaskNZ);
-        if ((velocity->z < 0.0f && nz == false) || (velocity->z > 0.0f && z == false)) {
-            return false;
-        }
-    }
-    return true;
+    return _rigidbody_is_blocked(rb, velocity);
 }
 
 void rigidbody_toggle_groups(RigidBody *rb, uint16_t groups, bool toggle) {
     if (toggle) {
-        rb->groups = rb->groups | groups;
+        rigidbody_set_groups(rb, rb->groups | groups);
     } else {
-        rb->groups = rb->groups & ~groups;
+        rigidbody_set_groups(rb, rb->groups & ~groups);
     }
 }
 
 void rigidbody_toggle_collides_with(RigidBody *rb, uint16_t groups, bool toggle) {
     if (toggle) {
-        rb->collidesWith = rb->collidesWith | groups;
+        rigidbody_set_collides_with(rb, rb->collidesWith | groups);
     } else {
-        rb->collidesWith = rb->collidesWith & ~groups;
+        rigidbody_set_collides_with(rb, rb->collidesWith & ~groups);
     }
 }
 
@@ -1405,22 +1980,30 @@ void rigidbody_apply_force_impulse(RigidBody *rb, const float3 *value) {
     // that force
     const float3 v = {value->x / rb->mass, value->y / rb->mass, value->z / rb->mass};
     float3_op_add(rb->velocity, &v);
+    _rigidbody_wake_island(rb);
 }
 
 void rigidbody_apply_push(RigidBody *rb, const float3 *value) {
     // a PUSH ensures a given velocity at minimum and is not additive, to emulate the principle of
     // both objects possibly moving already in the same direction
+    bool pushed = false;
     if ((value->x > 0 && value->x > rb->velocity->x) ||
         (value->x < 0 && value->x < rb->velocity->x)) {
         rb->velocity->x = value->x;
+        pushed = true;
     }
     if ((value->y > 0 && value->y > rb->velocity->y) ||
         (value->y < 0 && value->y < rb->velocity->y)) {
         rb->velocity->y = value->y;
+        pushed = true;
     }
     if ((value->z > 0 && value->z > rb->velocity->z) ||
         (value->z < 0 && value->z < rb->velocity->z)) {
         rb->velocity->z = value->z;
+        pushed = true;
+    }
+    if (pushed) {
+        _rigidbody_wake_island(rb);
     }
 }
 
@@ -1438,6 +2021,16 @@ void rigidbody_broadphase_world_to_model(const Matrix4x4 *invModel,
     *outEpsilon3 = float3_mmax2(outEpsilon3, &float3_epsilon_zero);
 }
 
+uint32_t rigidbody_get_hash(const RigidBody *rb, Transform *t, uint32_t crc) {
+    crc = (uint32_t)crc32((uLong)crc,
+                          (const Bytef *)transform_get_position(t, false),
+                          (uInt)sizeof(float3));
+    crc = (uint32_t)crc32((uLong)crc, (const Bytef *)rb->velocity, (uInt)sizeof(float3));
+    crc = (uint32_t)crc32((uLong)crc, (const Bytef *)rb->motion, (uInt)sizeof(float3));
+    const uint8_t state[2] = {rb->contact, rigidbody_is_sleeping(rb) ? 1 : 0};
+    return (uint32_t)crc32((uLong)crc, (const Bytef *)state, (uInt)sizeof(state));
+}
+
 // MARK: - Callbacks -
 
 void rigidbody_set_collision_callback(pointer_rigidbody_collision_func f) {
@@ -1499,6 +2092,8 @@ void rigidbody_toggle_collision_callback(RigidBody *rb, CollisionCallbackType ty
             }
             break;
     }
+    // triggers w/ callbacks are visited every frame
+    _rigidbody_set_branch_dirty(rb);
 }
 
 // MARK: - Debug -
@@ -1524,12 +2119,22 @@ int debug_rigidbody_get_awakes(void) {
     return debug_rigidbody_awakes;
 }
 
+int debug_rigidbody_get_islands(void) {
+    return debug_rigidbody_islands;
+}
+
+int debug_rigidbody_get_queries(void) {
+    return debug_rigidbody_queries;
+}
+
 void debug_rigidbody_reset_calls(void) {
     debug_rigidbody_solver_iterations = 0;
     debug_rigidbody_replacements = 0;
     debug_rigidbody_collisions = 0;
     debug_rigidbody_sleeps = 0;
     debug_rigidbody_awakes = 0;
+    debug_rigidbody_islands = 0;
+    debug_rigidbody_queries = 0;
 }
 
 #endif
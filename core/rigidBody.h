@@ -22,7 +22,7 @@ extern "C" {
 #define DEBUG_RIGIDBODY false
 #endif
 #if DEBUG_RIGIDBODY
-/// Count number of solver iterations, replacements & collisions per frame
+/// Count number of solver iterations, replacements, collisions & queries per frame
 #define DEBUG_RIGIDBODY_CALLS true
 #define DEBUG_RIGIDBODY_EXTRA_LOGS false
 #else
@@ -31,6 +31,7 @@ extern "C" {
 #endif
 
 typedef struct _RigidBody RigidBody;
+typedef struct _RigidbodyIslands RigidbodyIslands;
 typedef struct _Transform Transform;
 typedef struct _Scene Scene;
 
@@ -91,9 +92,22 @@ bool rigidbody_tick(Scene *scene,
                     const TICK_DELTA_SEC_T dt,
                     void *callbackData);
 
+/// Dynamic rigidbodies resting for PHYSICS_SLEEP_FRAMES are registered as sleep candidates during
+/// their tick. A candidate falls asleep along w/ its island, ie. all dynamic rigidbodies touching it
+/// directly or transitively, only if they are all candidates or already sleeping.
+/// Sleeping rigidbodies are skipped by scene refresh, until their island is woken up.
+/// `islands` holds scratch buffers reused across calls, owned by the scene
+void rigidbody_sleep_islands(RigidbodyIslands *islands, FifoList *candidates, Rtree *r);
+RigidbodyIslands *rigidbody_islands_new(void);
+void rigidbody_islands_free(RigidbodyIslands *islands);
+
 /// MARK: - Accessors -
 const Box *rigidbody_get_collider(const RigidBody *rb);
 void rigidbody_set_collider(RigidBody *rb, const Box *value, const bool custom);
+/// Weak ref to owner transform, set by transform_ensure_rigidbody
+void rigidbody_set_transform(RigidBody *rb, Transform *t);
+/// World position before its tick during given scene step, NULL if it wasn't ticked then
+const float3 *rigidbody_get_previous_position(const RigidBody *rb, const uint32_t step);
 RtreeNode *rigidbody_get_rtree_leaf(const RigidBody *rb);
 void rigidbody_set_rtree_leaf(RigidBody *rb, RtreeNode *leaf);
 const float3 *rigidbody_get_motion(const RigidBody *rb);
@@ -117,6 +131,7 @@ uint8_t rigidbody_get_simulation_mode(const RigidBody *rb);
 void rigidbody_set_simulation_mode(RigidBody *rb, const uint8_t value);
 bool rigidbody_get_collider_dirty(const RigidBody *rb);
 void rigidbody_reset_collider_dirty(RigidBody *rb);
+/// Wakes up rigidbody's island if sleeping, rigidbody then skips sleep conditions for a few frames
 void rigidbody_set_awake(RigidBody *rb);
 
 /// MARK: - State -
@@ -134,6 +149,7 @@ bool rigidbody_is_dynamic(const RigidBody *rb);
 bool rigidbody_is_static(const RigidBody *rb);
 bool rigidbody_uses_per_block_collisions(const RigidBody *rb);
 bool rigidbody_is_collider_custom_set(const RigidBody *rb);
+bool rigidbody_is_sleeping(const RigidBody *rb);
 
 /// MARK: - Utils -
 bool rigidbody_check_velocity_contact(const RigidBody *rb, const float3 *velocity);
@@ -163,6 +179,9 @@ void rigidbody_broadphase_world_to_model(const Matrix4x4 *invModel,
                                          float3 *outVector,
                                          float epsilon,
                                          float3 *outEpsilon3);
+/// CRC-32 of simulation state chained w/ `crc`: world position, velocity, motion, contacts &
+/// sleep state
+uint32_t rigidbody_get_hash(const RigidBody *rb, Transform *t, uint32_t crc);
 
 /// MARK: - Callbacks -
 void rigidbody_set_collision_callback(pointer_rigidbody_collision_func f);
@@ -178,6 +197,10 @@ int debug_rigidbody_get_replacements(void);
 int debug_rigidbody_get_collisions(void);
 int debug_rigidbody_get_sleeps(void);
 int debug_rigidbody_get_awakes(void);
+/// Islands of rigidbodies put to sleep
+int debug_rigidbody_get_islands(void);
+/// R-tree queries made by dynamic & trigger rigidbodies
+int debug_rigidbody_get_queries(void);
 void debug_rigidbody_reset_calls(void);
 #endif
 
@@ -7,6 +7,8 @@
 #include "rtree.h"
 
 #include <float.h>
+#include <stdlib.h>
+#include <string.h>
 
 #include "cclog.h"
 #include "config.h"
@@ -31,8 +33,8 @@ struct _Rtree {
     uint8_t m;
     // maximum number of entries per node, over which a node overflows and has to split
     uint8_t M;
-
-    char pad[4];
+    // incremented by every insert, remove & update
+    uint32_t version;
 };
 
 struct _RtreeNode {
@@ -503,6 +505,7 @@ Rtree *rtree_new(uint8_t m, uint8_t M) {
     r->h = 0;
     r->m = m;
     r->M = M;
+    r->version = 0;
 
     _rtree_node_new_root(r);
 
@@ -522,6 +525,10 @@ RtreeNode *rtree_get_root(const Rtree *r) {
     return r->root;
 }
 
+uint32_t rtree_get_version(const Rtree *r) {
+    return r->version;
+}
+
 // MARK: Nodes
 
 Box *rtree_node_get_aabb(const RtreeNode *rn) {
@@ -655,6 +662,7 @@ void rtree_insert(Rtree *r, RtreeNode *leaf) {
             }
         }
     }
+    r->version++;
 
 #if DEBUG_RTREE_CALLS
     debug_rtree_insert_calls++;
@@ -704,6 +712,7 @@ void rtree_remove(Rtree *r, RtreeNode *leaf, bool freeLeaf) {
             r->h--;
             SET_HEIGHT_DECREASED
         }
+        r->version++;
     }
 
 #if DEBUG_RTREE_CALLS
@@ -735,6 +744,8 @@ void rtree_update(Rtree *r, RtreeNode *leaf, Box *aabb) {
     Box tmpBox;
     DoublyLinkedListNode *n;
     RtreeNode *child;
+    // counted as a single modification, even if leaf is reinserted
+    const uint32_t version = r->version + 1;
 
     // simulate node volume w/ updated leaf aabb
     box_copy(&tmpBox, aabb);
@@ -767,6 +778,7 @@ void rtree_update(Rtree *r, RtreeNode *leaf, Box *aabb) {
         box_copy(leaf->aabb, aabb);
         rtree_insert(r, leaf);
     }
+    r->version = version;
 }
 
 void rtree_refresh_collision_masks(Rtree *r) {
@@ -851,7 +863,7 @@ size_t rtree_query_cast_all_func(Rtree *r,
                                  pointer_rtree_query_cast_all_func func,
                                  void *ptr,
                                  const DoublyLinkedList *excludeLeafPtrs,
-                                 DoublyLinkedList *results) {
+                                 RtreeCastResults *results) {
     vx_assert(results != NULL);
 
     FifoList *toExamine = fifo_list_new();
@@ -859,7 +871,6 @@ size_t rtree_query_cast_all_func(Rtree *r,
     RtreeNode *rn, *child;
     size_t hits = 0;
     float dist;
-    RtreeCastResult *result;
 
     rn = r->root;
     while (rn != NULL) {
@@ -878,11 +889,7 @@ size_t rtree_query_cast_all_func(Rtree *r,
                 } else if (excludeLeafPtrs == NULL ||
                            doubly_linked_list_contains(excludeLeafPtrs, child->leaf) == false) {
 
-                    result = malloc(sizeof(RtreeCastResult));
-                    if (result != NULL) {
-                        result->rtreeLeaf = child;
-                        result->distance = dist;
-                        doubly_linked_list_push_last(results, result);
+                    if (rtree_cast_results_push(results, child, dist)) {
                         hits++;
                     }
                 }
@@ -907,7 +914,7 @@ size_t rtree_query_cast_all_ray(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results) {
+                                RtreeCastResults *results) {
 
     return rtree_query_cast_all_func(r,
                                      groups,
@@ -927,13 +934,12 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           uint16_t collidesWith,
                                           void *optionalPtr,
                                           const DoublyLinkedList *excludeLeafPtrs,
-                                          DoublyLinkedList *results,
+                                          RtreeCastResults *results,
                                           const float3 *epsilon) {
 
     float swept;
     RtreeNode *hit;
     FifoList *query = fifo_list_new();
-    RtreeCastResult *result;
     size_t hits = 0;
 
     if (rtree_query_overlap_box(r,
@@ -950,11 +956,9 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
             if ((excludeLeafPtrs == NULL ||
                  doubly_linked_list_contains(excludeLeafPtrs, hit->leaf) == false)) {
 
-                result = malloc(sizeof(RtreeCastResult));
-                if (result != NULL) {
-                    result->rtreeLeaf = hit;
-                    result->distance = stepStartDistance + swept * float3_length(step3);
-                    doubly_linked_list_push_last(results, result);
+                if (rtree_cast_results_push(results,
+                                            hit,
+                                            stepStartDistance + swept * float3_length(step3))) {
                     hits++;
                 }
             }
@@ -975,7 +979,7 @@ size_t rtree_query_cast_all_box(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results,
+                                RtreeCastResults *results,
                                 const float3 *epsilon) {
 
     return rtree_utils_broadphase_steps(r,
@@ -1002,7 +1006,7 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
                                     pointer_rtree_broadphase_step_func func,
                                     void *optionalPtr,
                                     const DoublyLinkedList *excludeLeafPtrs,
-                                    DoublyLinkedList *results,
+                                    RtreeCastResults *results,
                                     const float3 *epsilon) {
     vx_assert(results != NULL);
 
@@ -1038,9 +1042,102 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
     return hits;
 }
 
-bool rtree_utils_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2) {
-    return ((RtreeCastResult *)doubly_linked_list_node_pointer(n1))->distance >
-           ((RtreeCastResult *)doubly_linked_list_node_pointer(n2))->distance;
+// MARK: Cast results
+
+void rtree_cast_results_init(RtreeCastResults *r) {
+    r->results = r->inlined;
+    r->count = 0;
+    r->capacity = RTREE_CAST_RESULTS_INLINE_CAPACITY;
+}
+
+void rtree_cast_results_dispose(RtreeCastResults *r) {
+    if (r->results != r->inlined) {
+        free(r->results);
+    }
+    r->results = NULL;
+    r->count = 0;
+    r->capacity = 0;
+}
+
+void rtree_cast_results_clear(RtreeCastResults *r) {
+    r->count = 0;
+}
+
+bool rtree_cast_results_push(RtreeCastResults *r, RtreeNode *leaf, float distance) {
+    if (r->count == r->capacity) {
+        const size_t capacity = r->capacity * 2;
+        RtreeCastResult *results;
+        if (r->results == r->inlined) {
+            results = (RtreeCastResult *)malloc(capacity * sizeof(RtreeCastResult));
+            if (results != NULL) {
+                memcpy(results, r->inlined, r->count * sizeof(RtreeCastResult));
+            }
+        } else {
+            results = (RtreeCastResult *)realloc(r->results, capacity * sizeof(RtreeCastResult));
+        }
+        if (results == NULL) {
+            cclog_error("rtree: can't allocate cast results");
+            return false;
+        }
+        r->results = results;
+        r->capacity = capacity;
+    }
+    RtreeCastResult *result = &r->results[r->count];
+    result->rtreeLeaf = leaf;
+    result->distance = distance;
+    result->order = (uint32_t)r->count;
+    ++r->count;
+    return true;
+}
+
+static bool _rtree_cast_result_is_nearer(const RtreeCastResult *r1, const RtreeCastResult *r2) {
+    return r1->distance < r2->distance || (r1->distance == r2->distance && r1->order < r2->order);
+}
+
+static int _rtree_cast_result_compare(const void *p1, const void *p2) {
+    const RtreeCastResult *r1 = (const RtreeCastResult *)p1;
+    const RtreeCastResult *r2 = (const RtreeCastResult *)p2;
+    return _rtree_cast_result_is_nearer(r1, r2) ? -1 : (_rtree_cast_result_is_nearer(r2, r1) ? 1 : 0);
+}
+
+void rtree_cast_results_sort(RtreeCastResults *r) {
+    qsort(r->results, r->count, sizeof(RtreeCastResult), _rtree_cast_result_compare);
+}
+
+static void _rtree_cast_results_sift_down(RtreeCastResults *r, size_t i) {
+    RtreeCastResult *heap = r->results;
+    const RtreeCastResult tmp = heap[i];
+    size_t child;
+    while ((child = 2 * i + 1) < r->count) {
+        if (child + 1 < r->count && _rtree_cast_result_is_nearer(&heap[child + 1], &heap[child])) {
+            ++child;
+        }
+        if (_rtree_cast_result_is_nearer(&heap[child], &tmp) == false) {
+            break;
+        }
+        heap[i] = heap[child];
+        i = child;
+    }
+    heap[i] = tmp;
+}
+
+void rtree_cast_results_make_heap(RtreeCastResults *r) {
+    for (size_t i = r->count / 2; i > 0; --i) {
+        _rtree_cast_results_sift_down(r, i - 1);
+    }
+}
+
+bool rtree_cast_results_pop_nearest(RtreeCastResults *r, RtreeCastResult *result) {
+    if (r->count == 0) {
+        return false;
+    }
+    *result = r->results[0];
+    --r->count;
+    if (r->count > 0) {
+        r->results[0] = r->results[r->count];
+        _rtree_cast_results_sift_down(r, 0);
+    }
+    return true;
 }
 
 // MARK: - Debug functions -
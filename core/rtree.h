@@ -40,6 +40,28 @@ typedef struct _RtreeNode RtreeNode;
 typedef void (*pointer_rtree_recurse_func)(RtreeNode *rn);
 typedef bool (*pointer_rtree_query_overlap_func)(RtreeNode *rn, void *ptr, const float3 *epsilon);
 typedef bool (*pointer_rtree_query_cast_all_func)(RtreeNode *rn, void *ptr, float *distance);
+
+typedef struct RtreeCastResult {
+    RtreeNode *rtreeLeaf;
+    float distance;
+    /// insertion order, breaks ties between equal distances
+    uint32_t order;
+} RtreeCastResult;
+
+/// Number of results stored without allocation
+#define RTREE_CAST_RESULTS_INLINE_CAPACITY 16
+
+/// Flat array of cast results, filled by CAST ALL queries.
+/// Can be kept on the stack: it only allocates beyond RTREE_CAST_RESULTS_INLINE_CAPACITY
+/// results, and keeps its storage when cleared to be reused by following queries.
+/// It must not be copied, as it may point to its own inline storage.
+typedef struct {
+    RtreeCastResult *results;
+    size_t count;
+    size_t capacity;
+    RtreeCastResult inlined[RTREE_CAST_RESULTS_INLINE_CAPACITY];
+} RtreeCastResults;
+
 typedef size_t (*pointer_rtree_broadphase_step_func)(Rtree *r,
                                                      const Box *stepOriginBox,
                                                      float stepStartDistance,
@@ -49,21 +71,17 @@ typedef size_t (*pointer_rtree_broadphase_step_func)(Rtree *r,
                                                      uint16_t collidesWith,
                                                      void *optionalPtr,
                                                      const DoublyLinkedList *excludeLeafPtrs,
-                                                     DoublyLinkedList *results,
+                                                     RtreeCastResults *results,
                                                      const float3 *epsilon);
 
-typedef struct RtreeCastResult {
-    RtreeNode *rtreeLeaf;
-    float distance;
-
-    char pad[4];
-} RtreeCastResult;
-
 Rtree *rtree_new(uint8_t m, uint8_t M);
 void rtree_free(Rtree *r);
 
 uint16_t rtree_get_height(const Rtree *r);
 RtreeNode *rtree_get_root(const Rtree *r);
+/// Incremented by every insert, remove & update (collision masks excluded),
+/// query results remain exact as long as it is unchanged
+uint32_t rtree_get_version(const Rtree *r);
 
 /// MARK: - Nodes -
 Box *rtree_node_get_aabb(const RtreeNode *rn);
@@ -99,7 +117,7 @@ void rtree_refresh_collision_masks(Rtree *r);
 ///
 /// Each query returns,
 /// - OVERLAP: directly fills the 'results' parameter w/ leaf ptr
-/// - CAST ALL: populates the 'results' parameter w/ RtreeCastResult structs, to be freed by caller
+/// - CAST ALL: appends RtreeCastResult structs to the 'results' parameter, in no particular order
 /// - CAST: returns only 1 hit, but parameter 'excludeLeafPtrs' can be used to add a few exceptions
 ///
 /// Two usages for collision masks in queries,
@@ -126,13 +144,13 @@ size_t rtree_query_cast_all_func(Rtree *r,
                                  pointer_rtree_query_cast_all_func func,
                                  void *ptr,
                                  const DoublyLinkedList *excludeLeafPtrs,
-                                 DoublyLinkedList *results);
+                                 RtreeCastResults *results);
 size_t rtree_query_cast_all_ray(Rtree *r,
                                 const Ray *worldRay,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results);
+                                RtreeCastResults *results);
 size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           const Box *stepOriginBox,
                                           float stepStartDistance,
@@ -142,7 +160,7 @@ size_t rtree_query_cast_all_box_step_func(Rtree *r,
                                           uint16_t collidesWith,
                                           void *optionalPtr,
                                           const DoublyLinkedList *excludeLeafPtrs,
-                                          DoublyLinkedList *results,
+                                          RtreeCastResults *results,
                                           const float3 *epsilon);
 size_t rtree_query_cast_all_box(Rtree *r,
                                 const Box *aabb,
@@ -151,7 +169,7 @@ size_t rtree_query_cast_all_box(Rtree *r,
                                 uint16_t groups,
                                 uint16_t collidesWith,
                                 const DoublyLinkedList *excludeLeafPtrs,
-                                DoublyLinkedList *results,
+                                RtreeCastResults *results,
                                 const float3 *epsilon);
 
 /// MARK: - Utils -
@@ -164,9 +182,26 @@ size_t rtree_utils_broadphase_steps(Rtree *r,
                                     pointer_rtree_broadphase_step_func func,
                                     void *optionalPtr,
                                     const DoublyLinkedList *excludeLeafPtrs,
-                                    DoublyLinkedList *results,
+                                    RtreeCastResults *results,
                                     const float3 *epsilon);
-bool rtree_utils_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2);
+
+/// MARK: - Cast results -
+void rtree_cast_results_init(RtreeCastResults *r);
+/// Frees storage allocated beyond inline capacity, results can't be used afterwards
+/// unless initialized again
+void rtree_cast_results_dispose(RtreeCastResults *r);
+/// Removes all results, keeping storage
+void rtree_cast_results_clear(RtreeCastResults *r);
+/// Returns false if storage couldn't grow, result is then dropped
+bool rtree_cast_results_push(RtreeCastResults *r, RtreeNode *leaf, float distance);
+/// Sorts results by ascending distance, equal distances keep insertion order
+void rtree_cast_results_sort(RtreeCastResults *r);
+/// Arranges results in a min-heap, for when only nearest results are examined:
+/// building the heap is linear, then each rtree_cast_results_pop_nearest is O(log n)
+void rtree_cast_results_make_heap(RtreeCastResults *r);
+/// Pops results in same order as rtree_cast_results_sort, after rtree_cast_results_make_heap
+/// @returns false if there is no more result
+bool rtree_cast_results_pop_nearest(RtreeCastResults *r, RtreeCastResult *result);
 
 /// MARK: - Debug -
 #if DEBUG_RTREE
@@ -13,6 +13,8 @@
 
 #if DEBUG_SCENE
 static int debug_scene_awake_queries = 0;
+static int debug_scene_skipped_rigidbodies = 0;
+static int debug_scene_visited_transforms = 0;
 #endif
 
 struct _Scene {
@@ -34,8 +36,36 @@ struct _Scene {
     // awake volumes can be registered for end-of-frame awake phase
     DoublyLinkedList *awakeBoxes;
 
+    // resting rigidbodies registered for end-of-frame islands sleep
+    FifoList *sleepCandidates;
+    RigidbodyIslands *islands;
+
+    // weak references to instance groups refreshed at end-of-frame
+    DoublyLinkedList *instanceGroups;
+
+    // fixed timestep, frame time left to simulate
+    TICK_DELTA_SEC_T accumulator;
+
     // constant acceleration for the whole Scene (gravity usually)
     float3 constantAcceleration;
+
+    // fixed timestep, fraction of a step left in the accumulator after last refresh
+    float alpha;
+
+    // physics steps since scene creation
+    uint32_t steps;
+
+    // fixed timestep in steps per second, 0 to step once per refresh w/ frame delta
+    uint16_t fixedRate;
+    uint8_t maxSubsteps;
+
+    // wake up all sleeping rigidbodies during next refresh
+    bool wakeAll;
+
+    // contacts are solved in an order independent from r-tree history
+    bool deterministic;
+
+    char pad[6];
 };
 
 typedef struct {
@@ -99,6 +129,25 @@ void _scene_refresh_rtree_collision_masks(RigidBody *rb) {
     }
 }
 
+/// Whether or not a transform must be visited every frame by scene refresh, regardless of changes
+bool _scene_is_transform_active(Transform *t) {
+    RigidBody *rb = transform_get_rigidbody(t);
+    if (rb != NULL && ((rigidbody_is_dynamic(rb) && rigidbody_is_sleeping(rb) == false) ||
+                       rigidbody_is_active_trigger(rb))) {
+        return true;
+    }
+    return transform_get_type(t) == ShapeTransform &&
+           shape_has_pending_transaction(transform_utils_get_shape(t));
+}
+
+bool _scene_physics_hash_func(Transform *t, void *ptr) {
+    RigidBody *rb = transform_get_rigidbody(t);
+    if (rb != NULL && rigidbody_is_enabled(rb)) {
+        *(uint32_t *)ptr = rigidbody_get_hash(rb, t, *(uint32_t *)ptr);
+    }
+    return false;
+}
+
 bool _scene_shapes_iterator_func(Transform *t, void *ptr) {
     if (transform_get_type(t) == ShapeTransform) {
         doubly_linked_list_push_last((DoublyLinkedList *)ptr, (Shape *)transform_get_ptr(t));
@@ -114,6 +163,28 @@ bool _scene_standalone_refresh_func(Transform *t, void *ptr) {
     return false;
 }
 
+void _scene_instance_group_wptr_free_func(void *ptr) {
+    weakptr_release((Weakptr *)ptr);
+}
+
+void _scene_refresh_instance_groups(Scene *sc) {
+    DoublyLinkedListNode *n = doubly_linked_list_first(sc->instanceGroups);
+    DoublyLinkedListNode *next;
+    InstanceGroup *g;
+    while (n != NULL) {
+        next = doubly_linked_list_node_next(n);
+        g = (InstanceGroup *)weakptr_get(doubly_linked_list_node_pointer(n));
+        if (g == NULL) {
+            // group was freed
+            weakptr_release(doubly_linked_list_node_pointer(n));
+            doubly_linked_list_delete_node(sc->instanceGroups, n);
+        } else {
+            instance_group_refresh(g);
+        }
+        n = next;
+    }
+}
+
 void _scene_register_removed_transform(Scene *sc, Transform *t) {
     if (sc == NULL || t == NULL) {
         return;
@@ -137,7 +208,17 @@ Scene *scene_new(Weakptr *g) {
         sc->removed = fifo_list_new();
         sc->collisions = doubly_linked_list_new();
         sc->awakeBoxes = doubly_linked_list_new();
+        sc->sleepCandidates = fifo_list_new();
+        sc->islands = rigidbody_islands_new();
+        sc->instanceGroups = doubly_linked_list_new();
+        sc->accumulator = 0.0;
         float3_set(&sc->constantAcceleration, 0.0f, 0.0f, 0.0f);
+        sc->alpha = 0.0f;
+        sc->steps = 0;
+        sc->fixedRate = PHYSICS_DEFAULT_FIXED_RATE;
+        sc->maxSubsteps = PHYSICS_DEFAULT_MAX_SUBSTEPS;
+        sc->wakeAll = false;
+        sc->deterministic = false;
 
         transform_set_parent(sc->system, sc->root, false);
     }
@@ -164,6 +245,10 @@ void scene_free(Scene *sc) {
     doubly_linked_list_free(sc->collisions);
     doubly_linked_list_flush(sc->awakeBoxes, box_free_std);
     doubly_linked_list_free(sc->awakeBoxes);
+    fifo_list_free(sc->sleepCandidates, NULL);
+    rigidbody_islands_free(sc->islands);
+    doubly_linked_list_flush(sc->instanceGroups, _scene_instance_group_wptr_free_func);
+    doubly_linked_list_free(sc->instanceGroups);
 
     free(sc);
 }
@@ -198,22 +283,30 @@ Rtree *scene_get_rtree(Scene *sc) {
     return sc->rtree;
 }
 
-void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
-    if (sc == NULL) {
-        return;
-    }
+/// One physics step, and end-of-step processing: removal, end-of-contact callbacks, awake phase
+void _scene_step(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
 #if DEBUG_RIGIDBODY_EXTRA_LOGS
     cclog_debug("🏞 physics step");
 #endif
+    sc->steps++;
+
+    // Refresh dirty transforms after sandbox changes, in one batch
+    transform_refresh_hierarchy(sc->root, false);
 
+    // Only flagged branches are visited: transforms changed since last refresh, and those that must
+    // be visited every frame, see _scene_is_transform_active
+    const bool visitAll = sc->wakeAll;
     FifoList *toExamine = fifo_list_new();
     Transform *t = sc->root, *child = NULL;
     DoublyLinkedListNode *n;
     while (t != NULL) {
+#if DEBUG_SCENE_CALLS
+        debug_scene_visited_transforms++;
+#endif
         // Transform still inside scene hierarchy
         transform_set_removed_from_scene(t, false);
 
-        // Refresh transform (top-first) after sandbox changes
+        // Refresh transform (top-first) if changed since batch refresh, by physics or callbacks
         transform_refresh(t, transform_is_hierarchy_dirty(t), false);
 
         // Apply shape current transaction (top-first), this may change BB & collider
@@ -221,9 +314,25 @@ void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
             shape_apply_current_transaction(transform_utils_get_shape(t), false);
         }
 
-        // Get rigidbody, compute world collider
+        // Sleeping rigidbody is skipped entirely, unless it changed since falling asleep
+        RigidBody *rb = transform_get_rigidbody(t);
+        if (rb != NULL && rigidbody_is_sleeping(rb)) {
+            if (sc->wakeAll || transform_is_physics_dirty(t) || rigidbody_get_collider_dirty(rb) ||
+                rigidbody_get_rtree_leaf(rb) == NULL) {
+                rigidbody_set_awake(rb);
+            } else {
+                rb = NULL;
+#if DEBUG_SCENE_CALLS
+                debug_scene_skipped_rigidbodies++;
+#endif
+            }
+        }
+
+        // Compute world collider
         Box collider;
-        RigidBody *rb = transform_get_or_compute_world_aligned_collider(t, &collider, false);
+        if (rb != NULL) {
+            rb = transform_get_or_compute_world_aligned_collider(t, &collider, false);
+        }
 
         if (rb != NULL) {
             // Update r-tree (top-first) after sandbox changes
@@ -245,23 +354,45 @@ void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
             }
         }
 
-        // Enqueue children and propagate dirty hierarchy flag
-        n = transform_get_children_iterator(t);
-        while (n != NULL) {
-            child = (Transform *)doubly_linked_list_node_pointer(n);
+        // Enqueue children and propagate dirty hierarchy flag, all children are flagged then
+        if (visitAll || transform_is_hierarchy_dirty(t)) {
+            n = transform_get_children_iterator(t);
+            while (n != NULL) {
+                child = (Transform *)doubly_linked_list_node_pointer(n);
 
-            if (transform_is_hierarchy_dirty(t)) {
-                transform_set_children_dirty(child);
-            }
+                if (transform_is_hierarchy_dirty(t)) {
+                    transform_set_children_dirty(child);
+                }
 
-            fifo_list_push(toExamine, child);
-            n = doubly_linked_list_node_next(n);
+                fifo_list_push(toExamine, child);
+                n = doubly_linked_list_node_next(n);
+            }
+        } else {
+            // clean children aren't even scanned
+            child = transform_get_first_branch_dirty_child(t);
+            while (child != NULL) {
+                fifo_list_push(toExamine, child);
+                child = transform_get_next_branch_dirty_sibling(child);
+            }
         }
         transform_reset_children_dirty(t);
 
+        // Flag is reset once visited, unless this transform remains active next frame
+        transform_reset_branch_dirty(t);
+        if (_scene_is_transform_active(t)) {
+            transform_set_branch_dirty(t);
+        }
+
         t = (Transform *)fifo_list_pop(toExamine);
     }
     fifo_list_free(toExamine, NULL);
+    sc->wakeAll = false;
+
+    // Islands of resting rigidbodies may fall asleep, while all transforms are still retained
+    rigidbody_sleep_islands(sc->islands, sc->sleepCandidates, sc->rtree);
+
+    // Refresh modified instances, once their group transform is up-to-date
+    _scene_refresh_instance_groups(sc);
 
 #if DEBUG_RTREE_CHECK
     vx_assert(debug_rtree_integrity_check(sc->rtree));
@@ -287,6 +418,7 @@ void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
             // r-tree leaf removal
             rb = transform_get_rigidbody(t);
             if (rb != NULL && rigidbody_get_rtree_leaf(rb) != NULL) {
+                scene_register_awake_rigidbody_contacts(sc, rb);
                 rtree_remove(sc->rtree, rigidbody_get_rtree_leaf(rb), true);
                 rigidbody_set_rtree_leaf(rb, NULL);
             }
@@ -367,6 +499,40 @@ void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
     rtree_refresh_collision_masks(sc->rtree);
 }
 
+void scene_refresh(Scene *sc, const TICK_DELTA_SEC_T dt, void *callbackData) {
+    if (sc == NULL) {
+        return;
+    }
+
+    if (sc->fixedRate == 0) {
+        _scene_step(sc, dt, callbackData);
+        return;
+    }
+
+    // fixed timestep: frame delta is accumulated & consumed in fixed steps
+    const TICK_DELTA_SEC_T step = 1.0 / (TICK_DELTA_SEC_T)sc->fixedRate;
+    sc->accumulator += dt;
+
+    uint8_t substeps = 0;
+    while (sc->accumulator >= step && substeps < sc->maxSubsteps) {
+        _scene_step(sc, step, callbackData);
+        sc->accumulator -= step;
+        ++substeps;
+    }
+
+    // simulation slows down rather than spiraling when a frame takes longer than max sub-steps
+    if (sc->accumulator >= step) {
+        sc->accumulator = 0.0;
+    }
+    sc->alpha = (float)(sc->accumulator / step);
+
+    // no step this frame, transforms & instances are still refreshed for rendering
+    if (substeps == 0) {
+        transform_refresh_hierarchy(sc->root, false);
+        _scene_refresh_instance_groups(sc);
+    }
+}
+
 void scene_standalone_refresh(Scene *sc) {
     transform_recurse(sc->root, _scene_standalone_refresh_func, NULL, false);
 }
@@ -377,6 +543,78 @@ DoublyLinkedList *scene_new_shapes_iterator(Scene *sc) {
     return list;
 }
 
+void scene_add_instance_group(Scene *sc, InstanceGroup *g) {
+    vx_assert(sc != NULL);
+    vx_assert(g != NULL);
+
+    Weakptr *wptr = instance_group_get_weakptr(g);
+    DoublyLinkedListNode *n = doubly_linked_list_first(sc->instanceGroups);
+    while (n != NULL) {
+        if (doubly_linked_list_node_pointer(n) == wptr) {
+            return;
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+
+    if (weakptr_retain(wptr)) {
+        doubly_linked_list_push_last(sc->instanceGroups, wptr);
+    }
+
+    Transform *t = instance_group_get_transform(g);
+    if (transform_get_parent(t) == NULL) {
+        transform_set_parent(t, sc->root, true);
+    }
+}
+
+void scene_remove_instance_group(Scene *sc, InstanceGroup *g) {
+    vx_assert(sc != NULL);
+    vx_assert(g != NULL);
+
+    Weakptr *wptr = instance_group_get_weakptr(g);
+    DoublyLinkedListNode *n = doubly_linked_list_first(sc->instanceGroups);
+    while (n != NULL) {
+        if (doubly_linked_list_node_pointer(n) == wptr) {
+            weakptr_release(wptr);
+            doubly_linked_list_delete_node(sc->instanceGroups, n);
+            break;
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+
+    // undo scene_add_instance_group parenting
+    Transform *t = instance_group_get_transform(g);
+    if (transform_get_parent(t) == sc->root) {
+        transform_remove_parent(t, true);
+    }
+}
+
+DoublyLinkedList *scene_new_instance_groups_iterator(Scene *sc) {
+    DoublyLinkedList *list = doubly_linked_list_new();
+    DoublyLinkedListNode *n = doubly_linked_list_first(sc->instanceGroups);
+    InstanceGroup *g;
+    while (n != NULL) {
+        g = (InstanceGroup *)weakptr_get(doubly_linked_list_node_pointer(n));
+        if (g != NULL) {
+            doubly_linked_list_push_last(list, g);
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+    return list;
+}
+
+bool scene_instance_groups_iterate(Scene *sc, pointer_scene_instance_group_func func, void *ptr) {
+    DoublyLinkedListNode *n = doubly_linked_list_first(sc->instanceGroups);
+    InstanceGroup *g;
+    while (n != NULL) {
+        g = (InstanceGroup *)weakptr_get(doubly_linked_list_node_pointer(n));
+        if (g != NULL && func(g, ptr)) {
+            return true;
+        }
+        n = doubly_linked_list_node_next(n);
+    }
+    return false;
+}
+
 void scene_add_map(Scene *sc, Shape *map) {
     vx_assert(sc != NULL);
     vx_assert(map != NULL);
@@ -389,7 +627,7 @@ void scene_add_map(Scene *sc, Shape *map) {
     transform_set_parent(sc->map, sc->root, true);
 
 #if DEBUG_SCENE_EXTRALOG
-    cclog_debug("🏞 map %p (id: %d) added to scene %p", sc->map, transform_get_id(sc->map), sc);
+    cclog_debug("🏞 map %p (id: %u) added to scene %p", sc->map, transform_get_id(sc->map), sc);
 #endif
 }
 
@@ -405,7 +643,7 @@ bool scene_remove_transform(Scene *sc, Transform *t, const bool keepWorld) {
     if (transform_remove_parent(t, keepWorld)) {
         _scene_register_removed_transform(sc, t);
 #if DEBUG_SCENE_EXTRALOG
-        cclog_debug("🏞 transform %p (id: %d) removed from scene %p", t, transform_get_id(t), sc);
+        cclog_debug("🏞 transform %p (id: %u) removed from scene %p", t, transform_get_id(t), sc);
 #endif
         return true;
     }
@@ -472,6 +710,7 @@ CollisionCoupleStatus scene_register_collision_couple(Scene *sc,
 void scene_set_constant_acceleration(Scene *sc, const float *x, const float *y, const float *z) {
     vx_assert(sc != NULL);
 
+    const float3 previous = sc->constantAcceleration;
     if (x != NULL) {
         sc->constantAcceleration.x = *x;
     }
@@ -479,7 +718,10 @@ void scene_set_constant_acceleration(Scene *sc, const float *x, const float *y,
         sc->constantAcceleration.y = *y;
     }
     if (z != NULL) {
-        sc->constantAcceleration.x = *z;
+        sc->constantAcceleration.z = *z;
+    }
+    if (float3_isEqual(&previous, &sc->constantAcceleration, EPSILON_ZERO) == false) {
+        sc->wakeAll = true;
     }
 }
 
@@ -488,6 +730,92 @@ const float3 *scene_get_constant_acceleration(const Scene *sc) {
     return &sc->constantAcceleration;
 }
 
+void scene_set_fixed_timestep(Scene *sc, const uint16_t rate, const uint8_t maxSubsteps) {
+    vx_assert(sc != NULL);
+
+    sc->fixedRate = rate;
+    sc->maxSubsteps = maxSubsteps > 0 ? maxSubsteps : 1;
+    sc->accumulator = 0.0;
+    sc->alpha = 0.0f;
+}
+
+uint16_t scene_get_fixed_timestep_rate(const Scene *sc) {
+    vx_assert(sc != NULL);
+    return sc->fixedRate;
+}
+
+void scene_set_deterministic(Scene *sc, const bool value) {
+    vx_assert(sc != NULL);
+    sc->deterministic = value;
+}
+
+bool scene_is_deterministic(const Scene *sc) {
+    vx_assert(sc != NULL);
+    return sc->deterministic;
+}
+
+uint32_t scene_get_physics_hash(Scene *sc, uint32_t crc) {
+    vx_assert(sc != NULL);
+    transform_recurse(sc->root, _scene_physics_hash_func, &crc, false);
+    return crc;
+}
+
+uint32_t scene_get_steps(const Scene *sc) {
+    vx_assert(sc != NULL);
+    return sc->steps;
+}
+
+float scene_get_interpolation_alpha(const Scene *sc) {
+    vx_assert(sc != NULL);
+    return sc->fixedRate > 0 ? sc->alpha : 1.0f;
+}
+
+/// World offset from current position to interpolated position, for the closest rigidbody
+/// ticked during last step in transform's ancestors (or itself)
+static bool _scene_get_interpolation_offset(const Scene *sc, Transform *t, float3 *offset) {
+    if (sc->fixedRate == 0) {
+        return false;
+    }
+    Transform *it = t;
+    RigidBody *rb;
+    const float3 *previous;
+    while (it != NULL) {
+        rb = transform_get_rigidbody(it);
+        previous = rb != NULL ? rigidbody_get_previous_position(rb, sc->steps) : NULL;
+        if (previous != NULL) {
+            *offset = *transform_get_position(it, false);
+            float3_op_substract(offset, previous);
+            float3_op_scale(offset, sc->alpha - 1.0f);
+            return true;
+        }
+        it = transform_get_parent(it);
+    }
+    return false;
+}
+
+void scene_get_interpolated_position(const Scene *sc, Transform *t, float3 *pos) {
+    vx_assert(sc != NULL);
+
+    *pos = *transform_get_position(t, true);
+    float3 offset;
+    if (_scene_get_interpolation_offset(sc, t, &offset)) {
+        float3_op_add(pos, &offset);
+    }
+}
+
+void scene_get_interpolated_ltw(const Scene *sc, Transform *t, Matrix4x4 *ltw) {
+    vx_assert(sc != NULL);
+
+    transform_refresh(t, false, true);
+    *ltw = *transform_get_ltw(t);
+    float3 offset;
+    if (_scene_get_interpolation_offset(sc, t, &offset)) {
+        ltw->x4y1 += offset.x;
+        ltw->x4y2 += offset.y;
+        ltw->x4y3 += offset.z;
+    }
+}
+
 void scene_register_awake_box(Scene *sc, Box *b) {
     float3 size;
     box_get_size_float(b, &size);
@@ -543,6 +871,15 @@ void scene_register_awake_block_box(Scene *sc,
     scene_register_awake_box(sc, worldBox);
 }
 
+void scene_register_sleep_candidate(Scene *sc, RigidBody *rb) {
+    fifo_list_push(sc->sleepCandidates, rb);
+}
+
+static bool _scene_cast_result_sort_func(DoublyLinkedListNode *n1, DoublyLinkedListNode *n2) {
+    return ((CastResult *)doubly_linked_list_node_pointer(n1))->distance >
+           ((CastResult *)doubly_linked_list_node_pointer(n2))->distance;
+}
+
 CastResult scene_cast_result_default(void) {
     CastResult hit;
     hit.hitTr = NULL;
@@ -550,10 +887,126 @@ CastResult scene_cast_result_default(void) {
     hit.blockCoords = coords3_zero;
     hit.distance = FLT_MAX;
     hit.type = Hit_None;
+    hit.instance = INSTANCE_ID_NONE;
     hit.faceTouched = FACE_NONE;
     return hit;
 }
 
+typedef struct {
+    // ray cast if not NULL, box cast otherwise
+    const Ray *worldRay;
+    const Box *aabb;
+    const float3 *unit;
+    const DoublyLinkedList *filterOutTransforms;
+    // nearest hit is updated if not NULL, all hits are appended to results if not NULL
+    CastResult *nearest;
+    DoublyLinkedList *results;
+    size_t count;
+    float maxDist;
+    uint16_t groups;
+
+    char pad[2];
+} _SceneInstancesCast;
+
+/// Instance colliders are cast against their world-aligned box
+bool _scene_cast_instances_func(InstanceGroup *g, void *ptr) {
+    _SceneInstancesCast *cast = (_SceneInstancesCast *)ptr;
+    Transform *t = instance_group_get_transform(g);
+    if (cast->filterOutTransforms != NULL &&
+        doubly_linked_list_contains(cast->filterOutTransforms, t)) {
+        return false;
+    }
+
+    RtreeCastResults query;
+    rtree_cast_results_init(&query);
+    if (cast->worldRay != NULL) {
+        rtree_query_cast_all_ray(instance_group_get_rtree(g),
+                                 cast->worldRay,
+                                 PHYSICS_GROUP_NONE,
+                                 cast->groups,
+                                 NULL,
+                                 &query);
+    } else {
+        rtree_query_cast_all_box(instance_group_get_rtree(g),
+                                 cast->aabb,
+                                 cast->unit,
+                                 cast->maxDist,
+                                 PHYSICS_GROUP_NONE,
+                                 cast->groups,
+                                 NULL,
+                                 &query,
+                                 &float3_epsilon_collision);
+    }
+
+    CastResult hit = scene_cast_result_default();
+    hit.hitTr = t;
+    hit.type = Hit_CollisionBox;
+    for (size_t i = 0; i < query.count; ++i) {
+        hit.distance = query.results[i].distance;
+        hit.instance = instance_group_leaf_get_id(query.results[i].rtreeLeaf);
+
+        if (cast->nearest != NULL && hit.distance < cast->nearest->distance) {
+            *cast->nearest = hit;
+        }
+        if (cast->results != NULL) {
+            CastResult *result = (CastResult *)malloc(sizeof(CastResult));
+            *result = hit;
+            doubly_linked_list_push_last(cast->results, result);
+            ++cast->count;
+        }
+    }
+    rtree_cast_results_dispose(&query);
+
+    return false;
+}
+
+typedef struct {
+    const Box *aabb;
+    const DoublyLinkedList *filterOutTransforms;
+    // NULL to stop at first overlap
+    FifoList *results;
+    FifoList *query;
+    size_t hits;
+    uint16_t groups;
+    uint16_t collidesWith;
+
+    char pad[4];
+} _SceneInstancesOverlap;
+
+bool _scene_overlap_instances_func(InstanceGroup *g, void *ptr) {
+    _SceneInstancesOverlap *overlap = (_SceneInstancesOverlap *)ptr;
+    Transform *t = instance_group_get_transform(g);
+    if (overlap->filterOutTransforms != NULL &&
+        doubly_linked_list_contains(overlap->filterOutTransforms, t)) {
+        return false;
+    }
+
+    rtree_query_overlap_box(instance_group_get_rtree(g),
+                            overlap->aabb,
+                            overlap->groups,
+                            overlap->collidesWith,
+                            NULL,
+                            overlap->query,
+                            &float3_epsilon_collision);
+
+    RtreeNode *hit = fifo_list_pop(overlap->query);
+    while (hit != NULL) {
+        ++overlap->hits;
+        if (overlap->results == NULL) {
+            fifo_list_flush(overlap->query, NULL);
+            return true;
+        }
+        OverlapResult *result = (OverlapResult *)malloc(sizeof(OverlapResult));
+        result->hitTr = t;
+        result->type = Hit_CollisionBox;
+        result->instance = instance_group_leaf_get_id(hit);
+        fifo_list_push(overlap->results, result);
+
+        hit = fifo_list_pop(overlap->query);
+    }
+    return false;
+}
+
 HitType scene_cast_ray(Scene *sc,
                        const Ray *worldRay,
                        uint16_t groups,
@@ -570,29 +1023,38 @@ HitType scene_cast_ray(Scene *sc,
         return Hit_None;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    _SceneInstancesCast instancesCast = {worldRay,
+                                         NULL,
+                                         NULL,
+                                         filterOutTransforms,
+                                         &hit,
+                                         NULL,
+                                         0,
+                                         0.0f,
+                                         groups,
+                                         {0}};
+    scene_instance_groups_iterate(sc, _scene_cast_instances_func, &instancesCast);
+
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     if (rtree_query_cast_all_ray(sc->rtree,
                                  worldRay,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery) > 0) {
-
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(sceneQuery, rtree_utils_result_sort_func);
+                                 &sceneQuery) > 0) {
 
-        // process query results in order, to return first hit block or collision box
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        // process nearest query results first, to return first hit block or collision box
+        rtree_cast_results_make_heap(&sceneQuery);
+        RtreeCastResult rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&sceneQuery, &rtreeHit)) {
+            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
 
             // re-examine closer hits after updating hit.distance vs. per-block or rotated collider
-            if (rtreeHit->distance >= hit.distance) {
+            if (rtreeHit.distance >= hit.distance) {
                 break;
             }
 
@@ -600,7 +1062,7 @@ HitType scene_cast_ray(Scene *sc,
 
             if (mode == RigidbodyMode_Dynamic) {
                 hit.hitTr = hitTr;
-                hit.distance = rtreeHit->distance;
+                hit.distance = rtreeHit.distance;
                 hit.type = Hit_CollisionBox;
             } else if (transform_get_type(hitTr) == ShapeTransform &&
                        rigidbody_uses_per_block_collisions(transform_get_rigidbody(hitTr))) {
@@ -644,12 +1106,9 @@ HitType scene_cast_ray(Scene *sc,
 
                 ray_free(modelRay);
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_dispose(&sceneQuery);
 
     if (result != NULL) {
         *result = hit;
@@ -668,23 +1127,35 @@ size_t scene_cast_all_ray(Scene *sc,
         return 0;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
-    size_t count = 0;
+    _SceneInstancesCast instancesCast = {worldRay,
+                                         NULL,
+                                         NULL,
+                                         filterOutTransforms,
+                                         NULL,
+                                         results,
+                                         0,
+                                         0.0f,
+                                         groups,
+                                         {0}};
+    scene_instance_groups_iterate(sc, _scene_cast_instances_func, &instancesCast);
+
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
+    size_t count = instancesCast.count;
     if (rtree_query_cast_all_ray(sc->rtree,
                                  worldRay,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery) > 0) {
+                                 &sceneQuery) > 0) {
 
         // process query results to confirm intersections w/ per-block and rotated colliders
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
         RtreeCastResult *rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
         CastResult *hit;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
+        for (size_t i = 0; i < sceneQuery.count; ++i) {
+            rtreeHit = &sceneQuery.results[i];
             hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
             hit = NULL;
@@ -738,18 +1209,16 @@ size_t scene_cast_all_ray(Scene *sc,
             }
 
             if (hit != NULL) {
+                hit->instance = INSTANCE_ID_NONE;
                 doubly_linked_list_push_last(results, hit);
                 ++count;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_dispose(&sceneQuery);
 
     // sort query results by distance
-    doubly_linked_list_sort_ascending(results, rtree_utils_result_sort_func);
+    doubly_linked_list_sort_ascending(results, _scene_cast_result_sort_func);
 
     return count;
 }
@@ -806,7 +1275,20 @@ HitType scene_cast_box(Scene *sc,
         return Hit_None;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
+    _SceneInstancesCast instancesCast = {NULL,
+                                         aabb,
+                                         unit,
+                                         filterOutTransforms,
+                                         &hit,
+                                         NULL,
+                                         0,
+                                         maxDist,
+                                         groups,
+                                         {0}};
+    scene_instance_groups_iterate(sc, _scene_cast_instances_func, &instancesCast);
+
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
     if (rtree_query_cast_all_box(sc->rtree,
                                  aabb,
                                  unit,
@@ -814,24 +1296,20 @@ HitType scene_cast_box(Scene *sc,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery,
+                                 &sceneQuery,
                                  &float3_epsilon_collision)) {
 
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(sceneQuery, rtree_utils_result_sort_func);
-
-        // process query results in order, to return first hit block or collision box
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
-        RtreeCastResult *rtreeHit;
+        // process nearest query results first, to return first hit block or collision box
+        rtree_cast_results_make_heap(&sceneQuery);
+        RtreeCastResult rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&sceneQuery, &rtreeHit)) {
+            hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
 
             // re-examine closer hits after updating hit.distance vs. per-block or rotated collider
-            if (rtreeHit->distance >= hit.distance) {
+            if (rtreeHit.distance >= hit.distance) {
                 break;
             }
 
@@ -839,7 +1317,7 @@ HitType scene_cast_box(Scene *sc,
 
             if (mode == RigidbodyMode_Dynamic) {
                 hit.hitTr = hitTr;
-                hit.distance = rtreeHit->distance;
+                hit.distance = rtreeHit.distance;
                 hit.type = Hit_CollisionBox;
             } else {
                 Box modelBox, modelBroadphase;
@@ -925,12 +1403,9 @@ HitType scene_cast_box(Scene *sc,
                     }
                 }
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_dispose(&sceneQuery);
 
     if (result != NULL) {
         *result = hit;
@@ -951,8 +1426,21 @@ size_t scene_cast_all_box(Scene *sc,
         return 0;
     }
 
-    DoublyLinkedList *sceneQuery = doubly_linked_list_new();
-    size_t count = 0;
+    _SceneInstancesCast instancesCast = {NULL,
+                                         aabb,
+                                         unit,
+                                         filterOutTransforms,
+                                         NULL,
+                                         results,
+                                         0,
+                                         maxDist,
+                                         groups,
+                                         {0}};
+    scene_instance_groups_iterate(sc, _scene_cast_instances_func, &instancesCast);
+
+    RtreeCastResults sceneQuery;
+    rtree_cast_results_init(&sceneQuery);
+    size_t count = instancesCast.count;
     if (rtree_query_cast_all_box(sc->rtree,
                                  aabb,
                                  unit,
@@ -960,17 +1448,16 @@ size_t scene_cast_all_box(Scene *sc,
                                  PHYSICS_GROUP_NONE,
                                  groups,
                                  filterOutTransforms,
-                                 sceneQuery,
+                                 &sceneQuery,
                                  &float3_epsilon_collision)) {
 
         // process query results to confirm intersections w/ per-block and rotated colliders
-        DoublyLinkedListNode *n = doubly_linked_list_first(sceneQuery);
         RtreeCastResult *rtreeHit;
         Transform *hitTr;
         RigidBody *hitRb;
         CastResult *hit;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
+        for (size_t i = 0; i < sceneQuery.count; ++i) {
+            rtreeHit = &sceneQuery.results[i];
             hitTr = (Transform *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
             hitRb = transform_get_rigidbody(hitTr);
             hit = NULL;
@@ -1062,18 +1549,16 @@ size_t scene_cast_all_box(Scene *sc,
             }
 
             if (hit != NULL) {
+                hit->instance = INSTANCE_ID_NONE;
                 doubly_linked_list_push_last(results, hit);
                 ++count;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(sceneQuery, free);
-    doubly_linked_list_free(sceneQuery);
+    rtree_cast_results_dispose(&sceneQuery);
 
     // sort query results by distance
-    doubly_linked_list_sort_ascending(results, rtree_utils_result_sort_func);
+    doubly_linked_list_sort_ascending(results, _scene_cast_result_sort_func);
 
     return count;
 }
@@ -1090,7 +1575,22 @@ bool scene_overlap_box(Scene *sc,
     }
 
     FifoList *sceneQuery = fifo_list_new();
-    size_t hits = 0;
+
+    // stopped early only at first overlap w/o results
+    _SceneInstancesOverlap instancesOverlap = {aabb,
+                                               filterOutTransforms,
+                                               results,
+                                               sceneQuery,
+                                               0,
+                                               groups,
+                                               collidesWith,
+                                               {0}};
+    if (scene_instance_groups_iterate(sc, _scene_overlap_instances_func, &instancesOverlap)) {
+        fifo_list_free(sceneQuery, NULL);
+        return true;
+    }
+
+    size_t hits = instancesOverlap.hits;
     if (rtree_query_overlap_box(sc->rtree,
                                 aabb,
                                 groups,
@@ -1127,6 +1627,7 @@ bool scene_overlap_box(Scene *sc,
                         OverlapResult *result = (OverlapResult *)malloc(sizeof(OverlapResult));
                         result->hitTr = hitLeaf;
                         result->type = Hit_Block;
+                        result->instance = INSTANCE_ID_NONE;
                         fifo_list_push(results, result);
                         ++hits;
                     } else {
@@ -1138,6 +1639,7 @@ bool scene_overlap_box(Scene *sc,
                     OverlapResult *result = (OverlapResult *)malloc(sizeof(OverlapResult));
                     result->hitTr = hitLeaf;
                     result->type = Hit_CollisionBox;
+                    result->instance = INSTANCE_ID_NONE;
                     fifo_list_push(results, result);
                     ++hits;
                 } else {
@@ -1160,8 +1662,18 @@ int debug_scene_get_awake_queries(void) {
     return debug_scene_awake_queries;
 }
 
+int debug_scene_get_skipped_rigidbodies(void) {
+    return debug_scene_skipped_rigidbodies;
+}
+
+int debug_scene_get_visited_transforms(void) {
+    return debug_scene_visited_transforms;
+}
+
 void debug_scene_reset_calls(void) {
     debug_scene_awake_queries = 0;
+    debug_scene_skipped_rigidbodies = 0;
+    debug_scene_visited_transforms = 0;
 }
 
 #endif
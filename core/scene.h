@@ -11,6 +11,7 @@ extern "C" {
 #endif
 
 #include "fifo_list.h"
+#include "instance_group.h"
 #include "rigidBody.h"
 #include "rtree.h"
 #include "shape.h"
@@ -58,6 +59,21 @@ void scene_standalone_refresh(Scene *sc);
 /// The caller is responsible for freeing the returned list
 DoublyLinkedList *scene_new_shapes_iterator(Scene *sc);
 
+/// Instance groups added to the scene are refreshed at end-of-frame, the scene keeps a weak
+/// reference to them. Group transform is parented to the scene root if it has no parent, and
+/// unparented from it when removed.
+void scene_add_instance_group(Scene *sc, InstanceGroup *g);
+void scene_remove_instance_group(Scene *sc, InstanceGroup *g);
+
+/// Creates, populates and returns a list of all the instance groups of the scene
+/// The caller is responsible for freeing the returned list
+DoublyLinkedList *scene_new_instance_groups_iterator(Scene *sc);
+
+/// Calls func for each instance group of the scene w/o allocating, stops if func returns true.
+/// Returns true if stopped early
+typedef bool (*pointer_scene_instance_group_func)(InstanceGroup *g, void *ptr);
+bool scene_instance_groups_iterate(Scene *sc, pointer_scene_instance_group_func func, void *ptr);
+
 /// Parents or unparents a Map transform to the scene root
 void scene_add_map(Scene *sc, Shape *m);
 Transform *scene_get_map(Scene *sc);
@@ -86,6 +102,32 @@ CollisionCoupleStatus scene_register_collision_couple(Scene *sc,
 void scene_set_constant_acceleration(Scene *sc, const float *x, const float *y, const float *z);
 const float3 *scene_get_constant_acceleration(const Scene *sc);
 
+/// Physics can be stepped at a fixed `rate` (steps per second): frame delta is accumulated and
+/// consumed by scene refresh in up to `maxSubsteps` fixed steps, extra time is dropped.
+/// Rate 0 steps once per refresh w/ frame delta (default)
+void scene_set_fixed_timestep(Scene *sc, const uint16_t rate, const uint8_t maxSubsteps);
+uint16_t scene_get_fixed_timestep_rate(const Scene *sc);
+/// Deterministic simulation: contacts are solved in an order that only depends on the scene state,
+/// independently from r-tree history. Along w/ a fixed timestep, two scenes built & fed the same
+/// way step identically, see replay.h.
+/// Requires core to be compiled w/o floating-point contraction: `-ffp-contract=off` w/ clang & gcc,
+/// no `/fp:contract` w/ MSVC. Fused multiply-adds would round differently across platforms
+void scene_set_deterministic(Scene *sc, const bool value);
+bool scene_is_deterministic(const Scene *sc);
+/// CRC-32 of all enabled rigidbodies simulation state, in hierarchy order, chained w/ `crc`
+uint32_t scene_get_physics_hash(Scene *sc, uint32_t crc);
+/// Physics steps since scene creation
+uint32_t scene_get_steps(const Scene *sc);
+/// Fraction of a fixed step left to simulate after last refresh, 1 when not using fixed timestep
+float scene_get_interpolation_alpha(const Scene *sc);
+/// World position to render a transform at, interpolated between the last two fixed steps of the
+/// closest rigidbody in its ancestors (or itself). It lags by at most one step.
+/// Only translation is interpolated: physics never rotates rigidbodies, rotations are set by
+/// sandbox once per frame and do not snap to fixed steps
+void scene_get_interpolated_position(const Scene *sc, Transform *t, float3 *pos);
+/// Local-to-world matrix to render a transform w/, translated to its interpolated position
+void scene_get_interpolated_ltw(const Scene *sc, Transform *t, Matrix4x4 *ltw);
+
 /// Register a volume that will be processed during the awake phase
 void scene_register_awake_box(Scene *sc, Box *b);
 void scene_register_awake_rigidbody_contacts(Scene *sc, RigidBody *rb);
@@ -95,6 +137,8 @@ void scene_register_awake_block_box(Scene *sc,
                                     const SHAPE_COORDS_INT_T x,
                                     const SHAPE_COORDS_INT_T y,
                                     const SHAPE_COORDS_INT_T z);
+/// Register a resting dynamic rigidbody, its island may fall asleep at end-of-frame
+void scene_register_sleep_candidate(Scene *sc, RigidBody *rb);
 
 typedef enum {
     Hit_None,
@@ -102,23 +146,24 @@ typedef enum {
     Hit_CollisionBox
 } HitType;
 
+/// Instance colliders hits are reported on their group transform, w/ the instance ID
 typedef struct {
     Transform *hitTr;
     Block *block;
     float distance;
     HitType type;
+    InstanceID instance; // INSTANCE_ID_NONE if not an instance collider
     SHAPE_COORDS_INT3_T blockCoords;
     FACE_INDEX_INT_T faceTouched; // of the block if any (model space)
 
-    char pad[1];
+    char pad[5];
 } CastResult;
 CastResult scene_cast_result_default(void);
 
 typedef struct {
     Transform *hitTr;
     HitType type;
-
-    char pad[4];
+    InstanceID instance; // INSTANCE_ID_NONE if not an instance collider
 } OverlapResult;
 
 HitType scene_cast_ray(Scene *sc,
@@ -160,6 +205,10 @@ bool scene_overlap_box(Scene *sc,
 // MARK: - Debug -
 #if DEBUG_RIGIDBODY
 int debug_scene_get_awake_queries(void);
+/// Sleeping rigidbodies skipped during refresh
+int debug_scene_get_skipped_rigidbodies(void);
+/// Transforms visited during refresh, only changed & active branches are visited
+int debug_scene_get_visited_transforms(void);
 void debug_scene_reset_calls(void);
 #endif
 
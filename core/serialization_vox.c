@@ -6,15 +6,20 @@
 
 #include "serialization_vox.h"
 
+#include <stdio.h>
+#include <stdlib.h>
 #include <string.h>
 
 #include "cclog.h"
 #include "colors.h"
 #include "config.h"
 #include "hash_uint32_int.h"
+#include "matrix4x4.h"
+#include "quaternion.h"
 #include "serialization.h"
 #include "shape.h"
 #include "stream.h"
+#include "transform.h"
 
 #define VOX_MAGIC_BYTES "VOX "
 #define VOX_MAGIC_BYTES_SIZE 4
@@ -600,6 +605,447 @@ bool serialization_vox_save_shapes(Shape **shapes, const size_t nbShapes, FILE *
     return true;
 }
 
+// MARK: - Load -
+
+#define VOX_MAX_SIZE 256 // models can't be larger than 256 on each axis
+#define VOX_CHUNKS_PER_AXIS (VOX_MAX_SIZE / CHUNK_SIZE)
+#define VOX_MAX_HIERARCHY_DEPTH 64
+
+typedef struct {
+    // stream position of the XYZI chunk content
+    size_t voxelsPosition; /* 8 bytes */
+    // size with Cubzh axes (y <-> z)
+    uint32_t sizeX, sizeY, sizeZ; /* 3 x 4 bytes */
+    char pad[4];                  /* 4 bytes */
+} _VoxModel;
+
+typedef enum {
+    _VoxNode_None,
+    _VoxNode_Transform,
+    _VoxNode_Group,
+    _VoxNode_Shape
+} _VoxNodeType;
+
+typedef struct {
+    // nTRN: 1 child, nGRP: n children, nSHP: children are model ids
+    uint32_t *children; /* 8 bytes */
+    char *name;         /* 8 bytes */
+    // nTRN translation, Cubzh axes
+    float3 translation;  /* 12 bytes */
+    uint32_t nbChildren; /* 4 bytes */
+    _VoxNodeType type;   /* 4 bytes */
+    // nTRN rotation, see _voxRotationToQuaternion
+    uint8_t rotation; /* 1 byte */
+    bool hasRotation; /* 1 byte */
+    bool hidden;      /* 1 byte */
+    char pad[1];      /* 1 byte */
+} _VoxNode;
+
+// values read from a DICT, other keys are ignored
+typedef struct {
+    char *name;  /* 8 bytes */
+    float3 t;    /* 12 bytes */
+    uint8_t r;   /* 1 byte */
+    bool hasT;   /* 1 byte */
+    bool hasR;   /* 1 byte */
+    bool hidden; /* 1 byte */
+} _VoxDict;
+
+typedef struct {
+    Stream *s;               /* 8 bytes */
+    const _VoxModel *models; /* 8 bytes */
+    _VoxNode *nodes;         /* 8 bytes */
+    ColorPalette *palette;   /* 8 bytes */
+    const RGBAColor *colors; /* 8 bytes */
+    // .vox color index - 1 to shape palette index, built on first use of each color
+    SHAPE_COLOR_INDEX_INT_T *remap; /* 8 bytes */
+    bool *remapped;                 /* 8 bytes */
+    uint32_t nbModels;              /* 4 bytes */
+    uint32_t nbNodes;               /* 4 bytes */
+    bool isMutable;                 /* 1 byte */
+    char pad[7];                    /* 7 bytes */
+} _VoxLoader;
+
+static bool _readVoxString(Stream *s, char **out) {
+    uint32_t len = 0;
+    if (stream_read_uint32(s, &len) == false) {
+        return false;
+    }
+    char *str = (char *)malloc(len + 1);
+    if (str == NULL) {
+        return false;
+    }
+    if (len > 0 && stream_read(s, str, sizeof(char), len) == false) {
+        free(str);
+        return false;
+    }
+    str[len] = '\0';
+    *out = str;
+    return true;
+}
+
+static bool _readVoxDict(Stream *s, _VoxDict *dict) {
+    uint32_t nbPairs = 0;
+    if (stream_read_uint32(s, &nbPairs) == false) {
+        return false;
+    }
+
+    char *key = NULL;
+    char *value = NULL;
+    for (uint32_t i = 0; i < nbPairs; ++i) {
+        if (_readVoxString(s, &key) == false) {
+            return false;
+        }
+        if (_readVoxString(s, &value) == false) {
+            free(key);
+            return false;
+        }
+
+        if (strcmp(key, "_name") == 0 && dict != NULL && dict->name == NULL) {
+            dict->name = value;
+            value = NULL;
+        } else if (strcmp(key, "_hidden") == 0 && dict != NULL) {
+            dict->hidden = strcmp(value, "1") == 0;
+        } else if (strcmp(key, "_t") == 0 && dict != NULL) {
+            int x, y, z;
+            if (sscanf(value, "%d %d %d", &x, &y, &z) == 3) {
+                // ⚠️ y -> z, z -> y
+                dict->t = (float3){(float)x, (float)z, (float)y};
+                dict->hasT = true;
+            }
+        } else if (strcmp(key, "_r") == 0 && dict != NULL) {
+            dict->r = (uint8_t)atoi(value);
+            dict->hasR = true;
+        }
+
+        free(key);
+        free(value);
+        key = NULL;
+        value = NULL;
+    }
+    return true;
+}
+
+static _VoxNode *_getVoxNode(_VoxNode **nodes, uint32_t *nbNodes, const uint32_t id) {
+    if (id >= *nbNodes) {
+        uint32_t n = *nbNodes == 0 ? 16 : *nbNodes;
+        while (n <= id) {
+            n *= 2;
+        }
+        _VoxNode *resized = (_VoxNode *)realloc(*nodes, n * sizeof(_VoxNode));
+        if (resized == NULL) {
+            return NULL;
+        }
+        memset(resized + *nbNodes, 0, (n - *nbNodes) * sizeof(_VoxNode));
+        *nodes = resized;
+        *nbNodes = n;
+    }
+    return &(*nodes)[id];
+}
+
+static void _freeVoxNodes(_VoxNode *nodes, const uint32_t nbNodes) {
+    for (uint32_t i = 0; i < nbNodes; ++i) {
+        free(nodes[i].children);
+        free(nodes[i].name);
+    }
+    free(nodes);
+}
+
+/// Reads nTRN, nGRP or nSHP chunk content
+static bool _readVoxNode(Stream *s, const char *chunkName, _VoxNode **nodes, uint32_t *nbNodes) {
+    uint32_t id;
+    if (stream_read_uint32(s, &id) == false) {
+        return false;
+    }
+    _VoxNode *node = _getVoxNode(nodes, nbNodes, id);
+    if (node == NULL || node->type != _VoxNode_None) {
+        return false; // duplicate node id
+    }
+
+    _VoxDict dict = {NULL, float3_zero, 0, false, false, false};
+    if (_readVoxDict(s, &dict) == false) {
+        free(dict.name);
+        return false;
+    }
+    node->name = dict.name;
+    node->hidden = dict.hidden;
+
+    if (strcmp(chunkName, "nTRN") == 0) {
+        node->type = _VoxNode_Transform;
+        uint32_t child, reserved, layer, nbFrames;
+        if (stream_read_uint32(s, &child) == false || stream_read_uint32(s, &reserved) == false ||
+            stream_read_uint32(s, &layer) == false || stream_read_uint32(s, &nbFrames) == false) {
+            return false;
+        }
+        node->children = (uint32_t *)malloc(sizeof(uint32_t));
+        if (node->children == NULL) {
+            return false;
+        }
+        node->children[0] = child;
+        node->nbChildren = 1;
+
+        // only the first frame is used, animations aren't supported
+        for (uint32_t i = 0; i < nbFrames; ++i) {
+            _VoxDict frame = {NULL, float3_zero, 0, false, false, false};
+            if (_readVoxDict(s, i == 0 ? &frame : NULL) == false) {
+                return false;
+            }
+            if (i == 0) {
+                node->translation = frame.hasT ? frame.t : float3_zero;
+                node->rotation = frame.r;
+                node->hasRotation = frame.hasR;
+            }
+        }
+    } else {
+        node->type = strcmp(chunkName, "nGRP") == 0 ? _VoxNode_Group : _VoxNode_Shape;
+        uint32_t nbChildren;
+        if (stream_read_uint32(s, &nbChildren) == false) {
+            return false;
+        }
+        node->children = nbChildren > 0 ? (uint32_t *)malloc(nbChildren * sizeof(uint32_t))
+                                        : NULL;
+        if (nbChildren > 0 && node->children == NULL) {
+            return false;
+        }
+        for (uint32_t i = 0; i < nbChildren; ++i) {
+            if (stream_read_uint32(s, &node->children[i]) == false) {
+                return false;
+            }
+            node->nbChildren = i + 1;
+            // nSHP: each model has attributes (animation frame)
+            if (node->type == _VoxNode_Shape && _readVoxDict(s, NULL) == false) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/// Converts a MagicaVoxel rotation to a quaternion in Cubzh axes.
+/// The byte encodes a signed permutation matrix (row-major):
+/// bits 0-1: index of the non-zero entry in 1st row, bits 2-3: in 2nd row,
+/// bits 4, 5, 6: sign of 1st, 2nd & 3rd row (1 means negative).
+/// Returns false for reflections, which can't be represented by a rotation.
+static bool _voxRotationToQuaternion(const uint8_t r, Quaternion *q) {
+    const int i0 = r & 3;
+    const int i1 = (r >> 2) & 3;
+    if (i0 > 2 || i1 > 2 || i0 == i1) {
+        return false;
+    }
+    const int i2 = 3 - i0 - i1;
+
+    float m[3][3] = {{0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}, {0.0f, 0.0f, 0.0f}};
+    m[0][i0] = (r & (1 << 4)) ? -1.0f : 1.0f;
+    m[1][i1] = (r & (1 << 5)) ? -1.0f : 1.0f;
+    m[2][i2] = (r & (1 << 6)) ? -1.0f : 1.0f;
+
+    // ⚠️ y -> z, z -> y
+    static const int swap[3] = {0, 2, 1};
+    float c[3][3];
+    for (int row = 0; row < 3; ++row) {
+        for (int col = 0; col < 3; ++col) {
+            c[row][col] = m[swap[row]][swap[col]];
+        }
+    }
+
+    const float det = c[0][0] * (c[1][1] * c[2][2] - c[1][2] * c[2][1]) -
+                      c[0][1] * (c[1][0] * c[2][2] - c[1][2] * c[2][0]) +
+                      c[0][2] * (c[1][0] * c[2][1] - c[1][1] * c[2][0]);
+    if (det < 0.0f) {
+        return false;
+    }
+
+    Matrix4x4 mtx = matrix4x4_identity;
+    mtx.x1y1 = c[0][0];
+    mtx.x2y1 = c[0][1];
+    mtx.x3y1 = c[0][2];
+    mtx.x1y2 = c[1][0];
+    mtx.x2y2 = c[1][1];
+    mtx.x3y2 = c[1][2];
+    mtx.x1y3 = c[2][0];
+    mtx.x2y3 = c[2][1];
+    mtx.x3y3 = c[2][2];
+    rotation_matrix_to_quaternion(&mtx, q);
+
+    return true;
+}
+
+/// Creates a shape from model's voxels. Voxels are sorted by chunk with a counting sort,
+/// then written to the shape with a single bulk edit.
+static Shape *_loadVoxModel(_VoxLoader *l, const uint32_t modelId) {
+    const _VoxModel *model = &l->models[modelId];
+    Stream *s = l->s;
+
+    stream_set_cursor_position(s, model->voxelsPosition);
+
+    uint32_t nbVoxels;
+    if (stream_read_uint32(s, &nbVoxels) == false) {
+        cclog_error("could not read nbVoxels");
+        return NULL;
+    }
+
+    uint8_t *voxels = nbVoxels > 0 ? (uint8_t *)malloc(4 * (size_t)nbVoxels) : NULL;
+    SHAPE_COORDS_INT3_T *coords = nbVoxels > 0 ? (SHAPE_COORDS_INT3_T *)malloc(
+                                                     nbVoxels * sizeof(SHAPE_COORDS_INT3_T))
+                                               : NULL;
+    SHAPE_COLOR_INDEX_INT_T *colors = nbVoxels > 0 ? (SHAPE_COLOR_INDEX_INT_T *)malloc(
+                                                         nbVoxels * sizeof(SHAPE_COLOR_INDEX_INT_T))
+                                                   : NULL;
+    uint32_t *offsets = (uint32_t *)calloc(VOX_CHUNKS_PER_AXIS * VOX_CHUNKS_PER_AXIS *
+                                               VOX_CHUNKS_PER_AXIS + 1,
+                                           sizeof(uint32_t));
+
+    if ((nbVoxels > 0 && (voxels == NULL || coords == NULL || colors == NULL)) ||
+        offsets == NULL) {
+        free(voxels);
+        free(coords);
+        free(colors);
+        free(offsets);
+        return NULL;
+    }
+
+    if (nbVoxels > 0 && stream_read(s, voxels, 4, nbVoxels) == false) {
+        cclog_error("could not read voxels");
+        free(voxels);
+        free(coords);
+        free(colors);
+        free(offsets);
+        return NULL;
+    }
+
+    // ⚠️ y -> z, z -> y
+#define VOX_CHUNK_KEY(v)                                                                           \
+    ((((uint32_t)(v)[0] / CHUNK_SIZE) * VOX_CHUNKS_PER_AXIS + (uint32_t)(v)[2] / CHUNK_SIZE) *     \
+         VOX_CHUNKS_PER_AXIS +                                                                     \
+     (uint32_t)(v)[1] / CHUNK_SIZE)
+
+    // count voxels per chunk, then turn counts into offsets
+    for (uint32_t i = 0; i < nbVoxels; ++i) {
+        offsets[VOX_CHUNK_KEY(&voxels[4 * i]) + 1]++;
+    }
+    for (uint32_t i = 1; i <= VOX_CHUNKS_PER_AXIS * VOX_CHUNKS_PER_AXIS * VOX_CHUNKS_PER_AXIS;
+         ++i) {
+        offsets[i] += offsets[i - 1];
+    }
+
+    const uint8_t *v;
+    uint32_t dst;
+    SHAPE_COLOR_INDEX_INT_T colorIdx;
+    for (uint32_t i = 0; i < nbVoxels; ++i) {
+        v = &voxels[4 * i];
+        dst = offsets[VOX_CHUNK_KEY(v)]++;
+
+        // MV block indexes start at 1, while palette indexes start at 0.
+        // We have to shift the color index.
+        // It's also done when exporting .vox (+1 instead of -1)
+        colorIdx = (SHAPE_COLOR_INDEX_INT_T)(v[3] - 1);
+
+        // translate & shrink to a shape palette w/ only used colors, once per color
+        if (l->remapped[colorIdx] == false) {
+            if (color_palette_check_and_add_color(l->palette,
+                                                  l->colors[colorIdx],
+                                                  &l->remap[colorIdx],
+                                                  false) == false) {
+                l->remap[colorIdx] = 0;
+            }
+            l->remapped[colorIdx] = true;
+        }
+
+        coords[dst] = (SHAPE_COORDS_INT3_T){(SHAPE_COORDS_INT_T)v[0],
+                                            (SHAPE_COORDS_INT_T)v[2],
+                                            (SHAPE_COORDS_INT_T)v[1]};
+        colors[dst] = l->remap[colorIdx];
+    }
+#undef VOX_CHUNK_KEY
+
+    free(voxels);
+    free(offsets);
+
+    Shape *shape = shape_make_2(l->isMutable);
+    shape_set_palette(shape, l->palette, true);
+    shape_bulk_edit_blocks(shape, NULL, coords, colors, nbVoxels, 0, SHAPE_BULK_EDIT_ADD);
+
+    free(coords);
+    free(colors);
+
+    return shape;
+}
+
+static void _setVoxNodeTransform(Shape *shape, const _VoxNode *trn) {
+    shape_set_local_position(shape, trn->translation.x, trn->translation.y, trn->translation.z);
+    if (trn->hasRotation) {
+        Quaternion q;
+        if (_voxRotationToQuaternion(trn->rotation, &q)) {
+            shape_set_local_rotation(shape, &q);
+        } else {
+            cclog_warning("vox: mirrored transforms are not supported");
+        }
+    }
+    if (trn->name != NULL) {
+        transform_set_name(shape_get_root_transform(shape), trn->name);
+    }
+}
+
+/// Adds shapes under given nTRN node as children of `parent`
+static bool _loadVoxTransformNode(_VoxLoader *l,
+                                  const uint32_t trnId,
+                                  Shape *parent,
+                                  const int depth) {
+    if (depth > VOX_MAX_HIERARCHY_DEPTH || trnId >= l->nbNodes) {
+        return false;
+    }
+    const _VoxNode *trn = &l->nodes[trnId];
+    if (trn->type != _VoxNode_Transform || trn->children[0] >= l->nbNodes) {
+        return false;
+    }
+    if (trn->hidden) {
+        return true;
+    }
+    const _VoxNode *child = &l->nodes[trn->children[0]];
+
+    if (child->type == _VoxNode_Shape) {
+        if (child->nbChildren == 0 || child->children[0] >= l->nbModels) {
+            return false;
+        }
+        // only the first model is used, animations aren't supported
+        const uint32_t modelId = child->children[0];
+        Shape *shape = _loadVoxModel(l, modelId);
+        if (shape == NULL) {
+            return false;
+        }
+        shape_set_parent(shape, shape_get_root_transform(parent), false);
+        _setVoxNodeTransform(shape, trn);
+        // MagicaVoxel translates models from their center
+        const _VoxModel *model = &l->models[modelId];
+        shape_set_pivot(shape,
+                        (float)(model->sizeX / 2),
+                        (float)(model->sizeY / 2),
+                        (float)(model->sizeZ / 2));
+        shape_release(shape); // parent holds a reference
+        return true;
+    }
+
+    if (child->type == _VoxNode_Group) {
+        // groups are represented by empty shapes, root group by the root shape itself
+        Shape *group = parent;
+        if (depth > 0) {
+            group = shape_make_2(l->isMutable);
+            shape_set_palette(group, l->palette, true);
+            shape_set_parent(group, shape_get_root_transform(parent), false);
+            _setVoxNodeTransform(group, trn);
+            shape_release(group); // parent holds a reference
+        }
+        for (uint32_t i = 0; i < child->nbChildren; ++i) {
+            if (_loadVoxTransformNode(l, child->children[i], group, depth + 1) == false) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    return false;
+}
+
 enum serialization_vox_error serialization_vox_load(Stream *s,
                                                     Shape **out,
                                                     const bool isMutable,
@@ -649,20 +1095,25 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
 
     *out = NULL;
 
-    // read chunks
+    // read chunks, voxels are only located at this point and read once the palette is known,
+    // since it can be stored after the models
 
     char chunkName[CHUNK_HEADER_SIZE_PLUS_ONE]; // chunkNameSize
     chunkName[CHUNK_HEADER_SIZE] = '\0';        // null termination char
 
     uint32_t current_chunk_content_bytes;
     uint32_t current_chunk_children_content_bytes;
-    uint32_t sizeX = 0;
-    uint32_t sizeY = 0;
-    uint32_t sizeZ = 0;
+    size_t contentPosition;
 
     enum serialization_vox_error err = no_error;
 
-    size_t blocksPosition = 0;
+    _VoxModel *models = NULL;
+    uint32_t nbModels = 0;
+    uint32_t nbSizes = 0;
+    _VoxNode *nodes = NULL;
+    uint32_t nbNodes = 0;
+    bool hasTransformNodes = false;
+
     RGBAColor *colors = malloc(sizeof(RGBAColor) * VOX_MAX_NB_COLORS);
     if (colors == NULL) {
         return unknown_chunk;
@@ -694,59 +1145,45 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
             break;
         }
 
-        // PACK
-        if (strcmp(chunkName, "PACK") == 0) {
+        contentPosition = stream_get_cursor_position(s);
 
-            uint32_t nbModels = 0;
-            if (stream_read_uint32(s, &nbModels) == false) {
-                cclog_error("could not read number of models");
-                err = invalid_format;
-                break;
-            }
-
-            if (nbModels > 1) {
-                cclog_error("PACK with more than 1 model not supported");
-                err = pack_chunk_found;
-                break;
-            }
+        // PACK (deprecated, number of models is given by SIZE/XYZI couples)
+        if (strcmp(chunkName, "PACK") == 0) {
+            stream_skip(s, current_chunk_content_bytes + current_chunk_children_content_bytes);
         }
         // SIZE
         else if (strcmp(chunkName, "SIZE") == 0) {
-            // ⚠️ y -> z, z -> y
-            if (stream_read_uint32(s, &sizeX) == false) {
-                cclog_error("could not read sizeX");
+            _VoxModel *resized = (_VoxModel *)realloc(models, (nbSizes + 1) * sizeof(_VoxModel));
+            if (resized == NULL) {
                 err = invalid_format;
                 break;
             }
+            models = resized;
+            _VoxModel *model = &models[nbSizes];
+            model->voxelsPosition = 0;
 
-            if (stream_read_uint32(s, &sizeZ) == false) {
-                cclog_error("could not read sizeZ");
-                err = invalid_format;
-                break;
-            }
-
-            if (stream_read_uint32(s, &sizeY) == false) {
-                cclog_error("could not read sizeY");
+            // ⚠️ y -> z, z -> y
+            if (stream_read_uint32(s, &model->sizeX) == false ||
+                stream_read_uint32(s, &model->sizeZ) == false ||
+                stream_read_uint32(s, &model->sizeY) == false) {
+                cclog_error("could not read model size");
                 err = invalid_format;
                 break;
             }
+            ++nbSizes;
         }
         // XYZI
         else if (strcmp(chunkName, "XYZI") == 0) {
-            // Found blocks, but palette not loaded, keeping for later
-
-            blocksPosition = stream_get_cursor_position(s);
-
-            uint32_t nbVoxels;
-            if (stream_read_uint32(s, &nbVoxels) == false) {
-                cclog_error("could not read nbVoxels");
-                shape_release(*out);
-                return invalid_format;
+            if (nbModels >= nbSizes) {
+                cclog_error("XYZI chunk without SIZE");
+                err = invalid_format;
+                break;
             }
-
-            stream_skip(s, 4 * nbVoxels);
+            // Found blocks, but palette not loaded, keeping for later
+            models[nbModels].voxelsPosition = contentPosition;
+            ++nbModels;
+            stream_skip(s, current_chunk_content_bytes);
         }
-
         // RGBA (palette)
         else if (strcmp(chunkName, "RGBA") == 0) {
 
@@ -756,34 +1193,27 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
                 break;
             }
 
-            int nbColors = minimum(current_chunk_content_bytes / 4, VOX_MAX_NB_COLORS);
-
-            for (int i = 0; i < nbColors; i++) {
+            const uint32_t nbColors = minimum(current_chunk_content_bytes / 4, VOX_MAX_NB_COLORS);
 
-                if (stream_read_uint8(s, &(colors[i].r)) == false) {
-                    cclog_error("could not read r");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].g)) == false) {
-                    cclog_error("could not read g");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].b)) == false) {
-                    cclog_error("could not read b");
-                    err = invalid_format;
-                    break;
-                }
-
-                if (stream_read_uint8(s, &(colors[i].a)) == false) {
-                    cclog_error("could not read a");
-                    err = invalid_format;
-                    break;
-                }
+            // RGBAColor is 4 x uint8 (rgba), same as .vox
+            if (stream_read(s, colors, sizeof(RGBAColor), nbColors) == false) {
+                cclog_error("could not read colors");
+                err = invalid_format;
+                break;
+            }
+        }
+        // SCENE GRAPH
+        else if (strcmp(chunkName, "nTRN") == 0 || strcmp(chunkName, "nGRP") == 0 ||
+                 strcmp(chunkName, "nSHP") == 0) {
+            if (_readVoxNode(s, chunkName, &nodes, &nbNodes) == false) {
+                cclog_error("invalid %s chunk", chunkName);
+                err = invalid_format;
+                break;
             }
+            hasTransformNodes = true;
+            stream_set_cursor_position(s,
+                                       contentPosition + current_chunk_content_bytes +
+                                           current_chunk_children_content_bytes);
         }
         // UNSUPPORTED CHUNK
         else {
@@ -792,84 +1222,66 @@ enum serialization_vox_error serialization_vox_load(Stream *s,
         }
     }
 
-    if (err != no_error || sizeX == 0 || sizeY == 0 || sizeZ == 0 || blocksPosition == 0) {
-        free(colors);
-        if (err == no_error) {
-            return invalid_format;
-        }
-        return err;
+    if (err == no_error && nbModels == 0) {
+        err = invalid_format;
     }
-
-    // create Shape
-    *out = shape_make_2(isMutable);
-    shape_set_palette(*out, color_palette_new(colorAtlas), false);
-
-    stream_set_cursor_position(s, blocksPosition);
-
-    uint32_t nbVoxels;
-    uint8_t x, y, z;
-    SHAPE_COLOR_INDEX_INT_T color_index;
-
-    if (stream_read_uint32(s, &nbVoxels) == false) {
-        cclog_error("could not read nbVoxels");
-        shape_release(*out);
-        free(colors);
-        return invalid_format;
+    if (err == no_error && nbModels > 1 && hasTransformNodes == false) {
+        // models can't be placed relative to each other without a scene graph
+        cclog_error("%u models without scene graph not supported", nbModels);
+        err = pack_chunk_found;
     }
-
-    ColorPalette *palette = shape_get_palette(*out);
-    for (uint32_t i = 0; i < nbVoxels; i++) {
-
-        // ⚠️ y -> z, z -> y
-        if (stream_read_uint8(s, &x) == false) {
-            cclog_error("could not read x");
+    for (uint32_t i = 0; err == no_error && i < nbModels; ++i) {
+        if (models[i].sizeX == 0 || models[i].sizeY == 0 || models[i].sizeZ == 0) {
             err = invalid_format;
-            break;
         }
+    }
 
-        if (stream_read_uint8(s, &z) == false) {
-            cclog_error("could not read z");
-            err = invalid_format;
-            break;
-        }
+    if (err != no_error) {
+        free(colors);
+        free(models);
+        _freeVoxNodes(nodes, nbNodes);
+        return err;
+    }
 
-        if (stream_read_uint8(s, &y) == false) {
-            cclog_error("could not read y");
+    SHAPE_COLOR_INDEX_INT_T remap[VOX_MAX_NB_COLORS];
+    bool remapped[VOX_MAX_NB_COLORS];
+    memset(remapped, 0, sizeof(remapped));
+
+    _VoxLoader loader = {s,
+                         models,
+                         nodes,
+                         color_palette_new(colorAtlas),
+                         colors,
+                         remap,
+                         remapped,
+                         nbModels,
+                         nbNodes,
+                         isMutable,
+                         {0}};
+
+    if (nbModels == 1) {
+        // single model, no transformation applied
+        *out = _loadVoxModel(&loader, 0);
+        if (*out == NULL) {
             err = invalid_format;
-            break;
         }
-
-        if (stream_read_uint8(s, &color_index) == false) {
-            cclog_error("could not read color_index");
+    } else {
+        // scene graph starts with a nTRN (id 0) whose child is the root nGRP
+        *out = shape_make_2(isMutable);
+        shape_set_palette(*out, loader.palette, true);
+        if (_loadVoxTransformNode(&loader, 0, *out, 0) == false) {
+            cclog_error("invalid .vox scene graph");
+            shape_release(*out);
+            *out = NULL;
             err = invalid_format;
-            break;
-        }
-
-        // MV block indexes start at 1, while palette indexes start at 0.
-        // We have to shift the color index.
-        // It's also done when exporting .vox (+1 instead of -1)
-        SHAPE_COLOR_INDEX_INT_T colorIdx = color_index - 1;
-
-        // translate & shrink to a shape palette w/ only used colors
-        if (color_palette_check_and_add_color(palette, colors[colorIdx], &colorIdx, false) ==
-            false) {
-            colorIdx = 0;
         }
-
-        shape_add_block(*out,
-                        colorIdx,
-                        (SHAPE_COORDS_INT_T)x,
-                        (SHAPE_COORDS_INT_T)y,
-                        (SHAPE_COORDS_INT_T)z,
-                        false);
     }
-    color_palette_clear_lighting_dirty(palette);
+    color_palette_clear_lighting_dirty(loader.palette);
+    color_palette_release(loader.palette);
 
-    if (err != no_error) {
-        shape_release(*out);
-        free(colors);
-        return err;
-    }
+    free(colors);
+    free(models);
+    _freeVoxNodes(nodes, nbNodes);
 
-    return no_error;
+    return err;
 }
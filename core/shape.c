@@ -11,6 +11,7 @@
 #include <string.h>
 
 #include "blockChange.h"
+#include "block_change_list.h"
 #include "cclog.h"
 #include "config.h"
 #include "easings.h"
@@ -111,6 +112,7 @@ void _shape_chunk_enqueue_refresh(Shape *shape, Chunk *c);
 void _shape_chunk_check_neighbors_dirty(Shape *shape,
                                         const Chunk *chunk,
                                         CHUNK_COORDS_INT3_T block_pos);
+static Chunk *_shape_new_chunk(Shape *shape, const SHAPE_COORDS_INT3_T chunk_coords);
 static bool _shape_add_block_in_chunks(Shape *shape,
                                        const Block block,
                                        const SHAPE_COORDS_INT_T x,
@@ -123,6 +125,38 @@ static bool _shape_add_block_in_chunks(Shape *shape,
 
 void _set_vb_allocation_flag_one_frame(Shape *s);
 
+/// state of an ongoing bulk edit, see shape_bulk_edit_* functions
+typedef struct {
+    Shape *s;
+    // compact undo record, NULL if history is disabled
+    BlockChangeList *changes;
+    // latest chunk looked up, may be NULL if there is no chunk at chunkCoords
+    Chunk *chunk;
+    // blocks count variation per color index, applied to palette at the end of the edit
+    int32_t colorDeltas[SHAPE_COLOR_INDEX_MAX_COUNT];
+    size_t nbChanged;
+    SHAPE_COORDS_INT3_T chunkCoords;
+    // bounding box of all changes & of added blocks only (inclusive)
+    SHAPE_COORDS_INT3_T changedMin, changedMax, addedMin, addedMax;
+    // faces of current chunk touched by a change, neighbors need a mesh refresh
+    uint8_t chunkBorders;
+    bool chunkCached;
+    bool chunkChanged;
+    bool anyAdded;
+    bool anyRemoved;
+    bool perBlockLighting;
+} _ShapeBulkEdit;
+
+static bool _shape_bulk_edit_begin(_ShapeBulkEdit *e,
+                                   Shape *s,
+                                   const size_t maxChanges,
+                                   const bool recordHistory);
+static void _shape_bulk_edit_block(_ShapeBulkEdit *e,
+                                   const SHAPE_COORDS_INT3_T coords,
+                                   const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                                   const ShapeBulkEditMode mode);
+static size_t _shape_bulk_edit_end(_ShapeBulkEdit *e, Scene *scene);
+
 /// internal functions used to flag the relevant data when lighting has changed
 void _lighting_set_dirty(SHAPE_COORDS_INT3_T *bbMin,
                          SHAPE_COORDS_INT3_T *bbMax,
@@ -193,7 +227,7 @@ void _shape_fill_draw_slices(VertexBuffer *vb);
 VertexBuffer *_shape_get_latest_buffer(const Shape *s, const bool transparent);
 
 bool _shape_apply_transaction(Shape *const sh, Transaction *tr);
-bool _shape_undo_transaction(Shape *const sh, Transaction *tr);
+void _shape_apply_change_list(Shape *const sh, const BlockChangeList *changes, const bool undo);
 
 void _shape_clear_cached_world_aabb(Shape *s);
 
@@ -275,41 +309,24 @@ Shape *shape_make_copy(Shape *const origin) {
     s->palette = color_palette_new_copy(origin->palette);
     memcpy(s->blocksCount, origin->blocksCount, SHAPE_COLOR_INDEX_MAX_COUNT * sizeof(uint32_t));
 
-    // copy each point of interest
-    MapStringFloat3Iterator *it = NULL;
-    float3 *f3 = NULL;
-    const char *key = NULL;
-
-    it = map_string_float3_iterator_new(origin->POIs);
-    while (map_string_float3_iterator_is_done(it) == false) {
-        f3 = map_string_float3_iterator_current_value(it);
-        key = map_string_float3_iterator_current_key(it);
-
-        if (f3 != NULL && key != NULL) {
-            shape_set_point_of_interest(s, key, f3);
-        }
-
-        map_string_float3_iterator_next(it);
-    }
-    map_string_float3_iterator_free(it);
-
-    // copy each POI rotation
-    it = map_string_float3_iterator_new(origin->pois_rotation);
-    while (map_string_float3_iterator_is_done(it) == false) {
-        f3 = map_string_float3_iterator_current_value(it);
-        key = map_string_float3_iterator_current_key(it);
-
-        if (f3 != NULL && key != NULL) {
-            shape_set_point_rotation(s, key, f3);
-        }
-
-        map_string_float3_iterator_next(it);
+    // copy points of interest & POI rotations, copy keeps its empty maps if allocation fails
+    MapStringFloat3 *pois = map_string_float3_new_copy(origin->POIs);
+    MapStringFloat3 *poisRotation = map_string_float3_new_copy(origin->pois_rotation);
+    if (pois != NULL && poisRotation != NULL) {
+        map_string_float3_free(s->POIs);
+        s->POIs = pois;
+        map_string_float3_free(s->pois_rotation);
+        s->pois_rotation = poisRotation;
+    } else {
+        cclog_error("[shape_make_copy] failed to copy points of interest");
+        map_string_float3_free(pois);
+        map_string_float3_free(poisRotation);
     }
-    map_string_float3_iterator_free(it);
-    it = NULL;
 
     s->bbMin = origin->bbMin;
     s->bbMax = origin->bbMax;
+    s->nbBlocks = origin->nbBlocks;
+    s->nbChunks = origin->nbChunks;
 
     s->drawMode = origin->drawMode;
     s->renderingFlags = origin->renderingFlags;
@@ -317,12 +334,12 @@ Shape *shape_make_copy(Shape *const origin) {
 
     s->luaFlags = origin->luaFlags;
 
-    // copy chunks data
+    // share chunks data, each chunk is copied on its first write
     Index3DIterator *chunks_it = index3d_iterator_new(origin->chunks);
     Chunk *chunk, *chunkCopy;
     while (index3d_iterator_pointer(chunks_it) != NULL) {
         chunk = index3d_iterator_pointer(chunks_it);
-        chunkCopy = chunk_new_copy(chunk);
+        chunkCopy = chunk_new_shared_copy(chunk);
 
         const SHAPE_COORDS_INT3_T chunkOrigin = chunk_get_origin(chunk);
         const SHAPE_COORDS_INT3_T chunkCoords = chunk_utils_get_coords(chunkOrigin);
@@ -527,7 +544,7 @@ Weakptr *shape_get_and_retain_weakptr(Shape *const s) {
     }
 }
 
-uint16_t shape_get_id(const Shape *shape) {
+uint32_t shape_get_id(const Shape *shape) {
     return transform_get_id(shape->transform);
 }
 
@@ -557,6 +574,9 @@ bool shape_add_block_as_transaction(Shape *const shape,
     }
 
     if (transaction_addBlock(shape->pendingTransaction, x, y, z, colorIndex)) {
+        // transaction is applied by next scene refresh
+        transform_set_branch_dirty(shape->transform);
+
         // register awake box if using per-block collisions
         if (rigidbody_uses_per_block_collisions(transform_get_rigidbody(shape->transform))) {
             scene_register_awake_block_box(scene, shape->transform, shape, x, y, z);
@@ -589,6 +609,7 @@ bool shape_remove_block_as_transaction(Shape *const shape,
     }
 
     transaction_removeBlock(shape->pendingTransaction, x, y, z);
+    transform_set_branch_dirty(shape->transform);
 
     // register awake box is using per-block collisions
     if (rigidbody_uses_per_block_collisions(transform_get_rigidbody(shape->transform))) {
@@ -626,6 +647,7 @@ bool shape_paint_block_as_transaction(Shape *const shape,
     }
 
     transaction_replaceBlock(shape->pendingTransaction, x, y, z, newColorIndex);
+    transform_set_branch_dirty(shape->transform);
 
     return true; // block is considered replaced
 }
@@ -660,6 +682,10 @@ void shape_apply_current_transaction(Shape *const shape, bool keepPending) {
     }
 }
 
+bool shape_has_pending_transaction(const Shape *const s) {
+    return s->pendingTransaction != NULL;
+}
+
 bool shape_add_block(Shape *shape,
                      SHAPE_COLOR_INDEX_INT_T colorIndex,
                      const SHAPE_COORDS_INT_T x,
@@ -812,6 +838,145 @@ bool shape_paint_block(Shape *shape,
     return painted;
 }
 
+// MARK: - Bulk edits -
+
+size_t shape_bulk_edit_box(Shape *s,
+                           Scene *scene,
+                           const SHAPE_COORDS_INT3_T min,
+                           const SHAPE_COORDS_INT3_T max,
+                           const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                           const ShapeBulkEditMode mode) {
+    if (s == NULL || min.x > max.x || min.y > max.y || min.z > max.z) {
+        return 0;
+    }
+
+    const size_t volume = (size_t)(max.x - min.x + 1) * (size_t)(max.y - min.y + 1) *
+                          (size_t)(max.z - min.z + 1);
+
+    _ShapeBulkEdit e;
+    if (_shape_bulk_edit_begin(&e, s, volume, true) == false) {
+        return 0;
+    }
+
+    // iterate chunk by chunk, so that each chunk is looked up only once
+    const SHAPE_COORDS_INT3_T chunkFrom = chunk_utils_get_coords(min);
+    const SHAPE_COORDS_INT3_T chunkTo = chunk_utils_get_coords(max);
+    for (int cx = chunkFrom.x; cx <= chunkTo.x; ++cx) {
+        const int xFrom = maximum(min.x, cx * CHUNK_SIZE);
+        const int xTo = minimum(max.x, cx * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+        for (int cy = chunkFrom.y; cy <= chunkTo.y; ++cy) {
+            const int yFrom = maximum(min.y, cy * CHUNK_SIZE);
+            const int yTo = minimum(max.y, cy * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+            for (int cz = chunkFrom.z; cz <= chunkTo.z; ++cz) {
+                const int zFrom = maximum(min.z, cz * CHUNK_SIZE);
+                const int zTo = minimum(max.z, cz * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+
+                for (int x = xFrom; x <= xTo; ++x) {
+                    for (int y = yFrom; y <= yTo; ++y) {
+                        for (int z = zFrom; z <= zTo; ++z) {
+                            _shape_bulk_edit_block(&e,
+                                                   (SHAPE_COORDS_INT3_T){(SHAPE_COORDS_INT_T)x,
+                                                                         (SHAPE_COORDS_INT_T)y,
+                                                                         (SHAPE_COORDS_INT_T)z},
+                                                   colorIndex,
+                                                   mode);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return _shape_bulk_edit_end(&e, scene);
+}
+
+size_t shape_bulk_edit_sphere(Shape *s,
+                              Scene *scene,
+                              const SHAPE_COORDS_INT3_T center,
+                              const float radius,
+                              const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                              const ShapeBulkEditMode mode) {
+    if (s == NULL || radius < 0.0f) {
+        return 0;
+    }
+
+    const int r = (int)ceilf(radius);
+    const SHAPE_COORDS_INT3_T min = {(SHAPE_COORDS_INT_T)maximum(center.x - r, SHAPE_COORDS_MIN),
+                                     (SHAPE_COORDS_INT_T)maximum(center.y - r, SHAPE_COORDS_MIN),
+                                     (SHAPE_COORDS_INT_T)maximum(center.z - r, SHAPE_COORDS_MIN)};
+    const SHAPE_COORDS_INT3_T max = {(SHAPE_COORDS_INT_T)minimum(center.x + r, SHAPE_COORDS_MAX),
+                                     (SHAPE_COORDS_INT_T)minimum(center.y + r, SHAPE_COORDS_MAX),
+                                     (SHAPE_COORDS_INT_T)minimum(center.z + r, SHAPE_COORDS_MAX)};
+    const float sqrRadius = radius * radius;
+
+    const size_t volume = (size_t)(max.x - min.x + 1) * (size_t)(max.y - min.y + 1) *
+                          (size_t)(max.z - min.z + 1);
+
+    _ShapeBulkEdit e;
+    if (_shape_bulk_edit_begin(&e, s, volume, true) == false) {
+        return 0;
+    }
+
+    const SHAPE_COORDS_INT3_T chunkFrom = chunk_utils_get_coords(min);
+    const SHAPE_COORDS_INT3_T chunkTo = chunk_utils_get_coords(max);
+    for (int cx = chunkFrom.x; cx <= chunkTo.x; ++cx) {
+        const int xFrom = maximum(min.x, cx * CHUNK_SIZE);
+        const int xTo = minimum(max.x, cx * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+        for (int cy = chunkFrom.y; cy <= chunkTo.y; ++cy) {
+            const int yFrom = maximum(min.y, cy * CHUNK_SIZE);
+            const int yTo = minimum(max.y, cy * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+            for (int cz = chunkFrom.z; cz <= chunkTo.z; ++cz) {
+                const int zFrom = maximum(min.z, cz * CHUNK_SIZE);
+                const int zTo = minimum(max.z, cz * CHUNK_SIZE + CHUNK_SIZE_MINUS_ONE);
+
+                for (int x = xFrom; x <= xTo; ++x) {
+                    const float dx = (float)(x - center.x);
+                    for (int y = yFrom; y <= yTo; ++y) {
+                        const float dy = (float)(y - center.y);
+                        for (int z = zFrom; z <= zTo; ++z) {
+                            const float dz = (float)(z - center.z);
+                            if (dx * dx + dy * dy + dz * dz > sqrRadius) {
+                                continue;
+                            }
+                            _shape_bulk_edit_block(&e,
+                                                   (SHAPE_COORDS_INT3_T){(SHAPE_COORDS_INT_T)x,
+                                                                         (SHAPE_COORDS_INT_T)y,
+                                                                         (SHAPE_COORDS_INT_T)z},
+                                                   colorIndex,
+                                                   mode);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return _shape_bulk_edit_end(&e, scene);
+}
+
+size_t shape_bulk_edit_blocks(Shape *s,
+                              Scene *scene,
+                              const SHAPE_COORDS_INT3_T *coords,
+                              const SHAPE_COLOR_INDEX_INT_T *colors,
+                              const size_t count,
+                              const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                              const ShapeBulkEditMode mode) {
+    if (s == NULL || coords == NULL || count == 0) {
+        return 0;
+    }
+
+    _ShapeBulkEdit e;
+    if (_shape_bulk_edit_begin(&e, s, count, true) == false) {
+        return 0;
+    }
+
+    for (size_t i = 0; i < count; ++i) {
+        _shape_bulk_edit_block(&e, coords[i], colors != NULL ? colors[i] : colorIndex, mode);
+    }
+
+    return _shape_bulk_edit_end(&e, scene);
+}
+
 ColorPalette *shape_get_palette(const Shape *shape) {
     return shape->palette;
 }
@@ -877,7 +1042,8 @@ void shape_remap_colors(Shape *s, const SHAPE_COLOR_INDEX_INT_T *remap) {
                                     continue;
                                 }
 
-                                block_set_color_index(b, newColor);
+                                // chunk data may be shared with copies
+                                chunk_paint_block(chunk, cx, cy, cz, newColor, NULL);
 
                                 color_palette_decrement_color(s->palette, prevColor, 1);
                                 color_palette_increment_color(s->palette, newColor, 1);
@@ -1911,7 +2077,8 @@ float shape_box_cast(const Shape *s,
                          modelVector->z / maxDist};
 
     // select overlapped chunks
-    DoublyLinkedList *chunksQuery = doubly_linked_list_new();
+    RtreeCastResults chunksQuery;
+    rtree_cast_results_init(&chunksQuery);
     if (rtree_query_cast_all_box(s->rtree,
                                  modelBox,
                                  &unit,
@@ -1919,32 +2086,30 @@ float shape_box_cast(const Shape *s,
                                  0,
                                  1,
                                  NULL,
-                                 chunksQuery,
+                                 &chunksQuery,
                                  modelEpsilon) > 0) {
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(chunksQuery, rtree_utils_result_sort_func);
+        // examine nearest query results first
+        rtree_cast_results_make_heap(&chunksQuery);
 
         Box broadPhaseBox, tmpBox;
         box_set_broadphase_box(modelBox, modelVector, &broadPhaseBox);
 
-        // examine query results in order, return first hit block
-        DoublyLinkedListNode *n = doubly_linked_list_first(chunksQuery);
-        RtreeCastResult *rtreeHit;
+        // return first hit block
+        RtreeCastResult rtreeHit;
         OctreeIterator *oi;
         Chunk *c;
         bool didHit = false, leaf;
         float3 tmpNormal, tmpReplacement;
         float swept = 1.0f, lastRtreeDist = FLT_MAX;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&chunksQuery, &rtreeHit)) {
+            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
 
             // make sure to examine all hits w/ similar distances before stopping
             if (didHit &&
-                float_isEqual(rtreeHit->distance, lastRtreeDist, EPSILON_COLLISION) == false) {
+                float_isEqual(rtreeHit.distance, lastRtreeDist, EPSILON_COLLISION) == false) {
                 break;
             }
-            lastRtreeDist = rtreeHit->distance;
+            lastRtreeDist = rtreeHit.distance;
 
             const SHAPE_COORDS_INT3_T chunkOrigin = chunk_get_origin(c);
             leaf = false;
@@ -2052,12 +2217,9 @@ float shape_box_cast(const Shape *s,
                 blockCoords->y += chunkOrigin.y;
                 blockCoords->z += chunkOrigin.z;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
     }
-    doubly_linked_list_flush(chunksQuery, free);
-    doubly_linked_list_free(chunksQuery);
+    rtree_cast_results_dispose(&chunksQuery);
 
     return minSwept;
 }
@@ -2080,14 +2242,14 @@ bool shape_ray_cast(const Transform *t,
     Ray *modelRay = ray_transform(worldRay, &invModel);
 
     // select traversed chunks
-    DoublyLinkedList *chunksQuery = doubly_linked_list_new();
-    if (rtree_query_cast_all_ray(s->rtree, modelRay, 0, 1, NULL, chunksQuery) > 0) {
-        // sort query results by distance
-        doubly_linked_list_sort_ascending(chunksQuery, rtree_utils_result_sort_func);
-
-        // examine query results in order, return first hit block
-        DoublyLinkedListNode *n = doubly_linked_list_first(chunksQuery);
-        RtreeCastResult *rtreeHit;
+    RtreeCastResults chunksQuery;
+    rtree_cast_results_init(&chunksQuery);
+    if (rtree_query_cast_all_ray(s->rtree, modelRay, 0, 1, NULL, &chunksQuery) > 0) {
+        // examine nearest query results first
+        rtree_cast_results_make_heap(&chunksQuery);
+
+        // return first hit block
+        RtreeCastResult rtreeHit;
         OctreeIterator *oi;
         Chunk *c;
         bool didHit = false, leaf;
@@ -2096,16 +2258,15 @@ bool shape_ray_cast(const Transform *t,
         uint16_t x = 0, y = 0, z = 0;
         Box tmpBox;
         float d;
-        while (n != NULL) {
-            rtreeHit = (RtreeCastResult *)doubly_linked_list_node_pointer(n);
-            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit->rtreeLeaf);
+        while (rtree_cast_results_pop_nearest(&chunksQuery, &rtreeHit)) {
+            c = (Chunk *)rtree_node_get_leaf_ptr(rtreeHit.rtreeLeaf);
 
             // make sure to examine all hits w/ similar distances before stopping
             if (didHit &&
-                float_isEqual(rtreeHit->distance, lastRtreeDist, EPSILON_COLLISION) == false) {
+                float_isEqual(rtreeHit.distance, lastRtreeDist, EPSILON_COLLISION) == false) {
                 break;
             }
-            lastRtreeDist = rtreeHit->distance;
+            lastRtreeDist = rtreeHit.distance;
 
             const SHAPE_COORDS_INT3_T chunkOrigin = chunk_get_origin(c);
             leaf = false;
@@ -2144,14 +2305,11 @@ bool shape_ray_cast(const Transform *t,
                 y += chunkOrigin.y;
                 z += chunkOrigin.z;
             }
-
-            n = doubly_linked_list_node_next(n);
         }
 
         if (hitBlock == NULL) {
             ray_free(modelRay);
-            doubly_linked_list_flush(chunksQuery, free);
-            doubly_linked_list_free(chunksQuery);
+            rtree_cast_results_dispose(&chunksQuery);
             return false;
         }
 
@@ -2184,14 +2342,12 @@ bool shape_ray_cast(const Transform *t,
         }
 
         ray_free(modelRay);
-        doubly_linked_list_flush(chunksQuery, free);
-        doubly_linked_list_free(chunksQuery);
+        rtree_cast_results_dispose(&chunksQuery);
         return true;
     }
 
     ray_free(modelRay);
-    doubly_linked_list_flush(chunksQuery, free);
-    doubly_linked_list_free(chunksQuery);
+    rtree_cast_results_dispose(&chunksQuery);
 
     return false;
 }
@@ -2899,10 +3055,9 @@ void shape_history_undo(Shape *const s) {
         transaction_free(s->pendingTransaction);
         s->pendingTransaction = NULL;
     } else {
-        Transaction *const tr = history_getTransactionToUndo(s->history);
-        if (tr != NULL) {
-            transaction_resetIndex3DIterator(tr);
-            _shape_undo_transaction(s, tr);
+        const BlockChangeList *changes = history_getChangesToUndo(s->history);
+        if (changes != NULL) {
+            _shape_apply_change_list(s, changes, true);
         }
     }
 }
@@ -2914,10 +3069,9 @@ void shape_history_redo(Shape *const s) {
     if (s->history == NULL) {
         return;
     }
-    Transaction *tr = history_getTransactionToRedo(s->history);
-    if (tr != NULL) {
-        transaction_resetIndex3DIterator(tr);
-        _shape_apply_transaction(s, tr);
+    const BlockChangeList *changes = history_getChangesToRedo(s->history);
+    if (changes != NULL) {
+        _shape_apply_change_list(s, changes, false);
     }
 }
 
@@ -3031,6 +3185,24 @@ void _shape_chunk_check_neighbors_dirty(Shape *shape,
     }
 }
 
+static Chunk *_shape_new_chunk(Shape *shape, const SHAPE_COORDS_INT3_T chunk_coords) {
+    SHAPE_COORDS_INT3_T chunkOrigin = {(SHAPE_COORDS_INT_T)chunk_coords.x * CHUNK_SIZE,
+                                       (SHAPE_COORDS_INT_T)chunk_coords.y * CHUNK_SIZE,
+                                       (SHAPE_COORDS_INT_T)chunk_coords.z * CHUNK_SIZE};
+    Chunk *chunk = chunk_new(chunkOrigin);
+
+    index3d_insert(shape->chunks, chunk, chunk_coords.x, chunk_coords.y, chunk_coords.z, NULL);
+    chunk_move_in_neighborhood(shape->chunks, chunk, chunk_coords);
+
+    Box chunkBox = {{(float)chunkOrigin.x, (float)chunkOrigin.y, (float)chunkOrigin.z},
+                    {(float)(chunkOrigin.x + CHUNK_SIZE),
+                     (float)(chunkOrigin.y + CHUNK_SIZE),
+                     (float)(chunkOrigin.z + CHUNK_SIZE)}};
+    chunk_set_rtree_leaf(chunk, rtree_create_and_insert(shape->rtree, &chunkBox, 1, 1, chunk));
+
+    return chunk;
+}
+
 bool _shape_add_block_in_chunks(Shape *shape,
                                 const Block block,
                                 const SHAPE_COORDS_INT_T x,
@@ -3048,20 +3220,7 @@ bool _shape_add_block_in_chunks(Shape *shape,
 
     // insert new chunk if needed
     if (chunk == NULL) {
-        SHAPE_COORDS_INT3_T chunkOrigin = {(SHAPE_COORDS_INT_T)chunk_coords.x * CHUNK_SIZE,
-                                           (SHAPE_COORDS_INT_T)chunk_coords.y * CHUNK_SIZE,
-                                           (SHAPE_COORDS_INT_T)chunk_coords.z * CHUNK_SIZE};
-        chunk = chunk_new(chunkOrigin);
-
-        index3d_insert(shape->chunks, chunk, chunk_coords.x, chunk_coords.y, chunk_coords.z, NULL);
-        chunk_move_in_neighborhood(shape->chunks, chunk, chunk_coords);
-
-        Box chunkBox = {{(float)chunkOrigin.x, (float)chunkOrigin.y, (float)chunkOrigin.z},
-                        {(float)(chunkOrigin.x + CHUNK_SIZE),
-                         (float)(chunkOrigin.y + CHUNK_SIZE),
-                         (float)(chunkOrigin.z + CHUNK_SIZE)}};
-        chunk_set_rtree_leaf(chunk, rtree_create_and_insert(shape->rtree, &chunkBox, 1, 1, chunk));
-
+        chunk = _shape_new_chunk(shape, chunk_coords);
         *chunkAdded = true;
     } else {
         *chunkAdded = false;
@@ -3091,6 +3250,267 @@ bool _shape_add_block_in_chunks(Shape *shape,
     return added;
 }
 
+static bool _shape_bulk_edit_begin(_ShapeBulkEdit *e,
+                                   Shape *s,
+                                   const size_t maxChanges,
+                                   const bool recordHistory) {
+    if (_shape_get_rendering_flag(s, SHAPE_RENDERING_FLAG_BAKE_LOCKED)) {
+        return false;
+    }
+
+    // pending transaction was registered before this edit
+    shape_apply_current_transaction(s, false);
+
+    e->s = s;
+    e->changes = NULL;
+    e->chunk = NULL;
+    memset(e->colorDeltas, 0, SHAPE_COLOR_INDEX_MAX_COUNT * sizeof(int32_t));
+    e->nbChanged = 0;
+    e->chunkCoords = coords3_zero;
+    e->changedMin = coords3_max;
+    e->changedMax = coords3_min;
+    e->addedMin = coords3_max;
+    e->addedMax = coords3_min;
+    e->chunkBorders = 0;
+    e->chunkCached = false;
+    e->chunkChanged = false;
+    e->anyAdded = false;
+    e->anyRemoved = false;
+
+    // small edits are cheaper to light incrementally, large ones are lit once at the end
+    e->perBlockLighting = maxChanges <= SHAPE_BULK_EDIT_PER_BLOCK_LIGHTING_MAX;
+
+    if (recordHistory && s->history != NULL && _shape_get_lua_flag(s, SHAPE_LUA_FLAG_HISTORY)) {
+        e->changes = block_change_list_new();
+    }
+
+    return true;
+}
+
+static void _shape_bulk_edit_flush_chunk(_ShapeBulkEdit *e) {
+    if (e->chunk == NULL || e->chunkChanged == false) {
+        return;
+    }
+
+    _shape_chunk_enqueue_refresh(e->s, e->chunk);
+
+    // neighbors sharing a face with a changed block need a mesh refresh, see
+    // _shape_chunk_check_neighbors_dirty
+    if (e->chunkBorders & 1) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, NX));
+    }
+    if (e->chunkBorders & 2) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, X));
+    }
+    if (e->chunkBorders & 4) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, NY));
+    }
+    if (e->chunkBorders & 8) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, Y));
+    }
+    if (e->chunkBorders & 16) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, NZ));
+    }
+    if (e->chunkBorders & 32) {
+        _shape_chunk_enqueue_refresh(e->s, chunk_get_neighbor(e->chunk, Z));
+    }
+
+    e->chunkBorders = 0;
+    e->chunkChanged = false;
+}
+
+static void _shape_bulk_edit_block(_ShapeBulkEdit *e,
+                                   const SHAPE_COORDS_INT3_T coords,
+                                   const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                                   const ShapeBulkEditMode mode) {
+    Shape *s = e->s;
+
+    const SHAPE_COORDS_INT3_T chunkCoords = chunk_utils_get_coords(coords);
+    if (e->chunkCached == false || chunkCoords.x != e->chunkCoords.x ||
+        chunkCoords.y != e->chunkCoords.y || chunkCoords.z != e->chunkCoords.z) {
+        _shape_bulk_edit_flush_chunk(e);
+        e->chunk = (Chunk *)index3d_get(s->chunks, chunkCoords.x, chunkCoords.y, chunkCoords.z);
+        e->chunkCoords = chunkCoords;
+        e->chunkCached = true;
+    }
+
+    const CHUNK_COORDS_INT3_T coords_in_chunk = chunk_utils_get_coords_in_chunk(coords);
+    const Block *b = e->chunk != NULL ? chunk_get_block_2(e->chunk, coords_in_chunk) : NULL;
+    const SHAPE_COLOR_INDEX_INT_T before = block_is_solid(b) ? b->colorIndex
+                                                             : SHAPE_COLOR_INDEX_AIR_BLOCK;
+
+    SHAPE_COLOR_INDEX_INT_T after;
+    switch (mode) {
+        case SHAPE_BULK_EDIT_ADD:
+            if (before != SHAPE_COLOR_INDEX_AIR_BLOCK) {
+                return;
+            }
+            after = colorIndex;
+            break;
+        case SHAPE_BULK_EDIT_REMOVE:
+            after = SHAPE_COLOR_INDEX_AIR_BLOCK;
+            break;
+        case SHAPE_BULK_EDIT_PAINT:
+            if (before == SHAPE_COLOR_INDEX_AIR_BLOCK) {
+                return;
+            }
+            after = colorIndex;
+            break;
+        default:
+            after = colorIndex;
+            break;
+    }
+    if (before == after) {
+        return;
+    }
+
+    if (before == SHAPE_COLOR_INDEX_AIR_BLOCK) {
+        if (e->chunk == NULL) {
+            e->chunk = _shape_new_chunk(s, chunkCoords);
+            s->nbChunks++;
+        }
+        chunk_add_block(e->chunk,
+                        (Block){after},
+                        coords_in_chunk.x,
+                        coords_in_chunk.y,
+                        coords_in_chunk.z);
+        s->nbBlocks++;
+        ++e->colorDeltas[after];
+
+        e->addedMin.x = minimum(e->addedMin.x, coords.x);
+        e->addedMin.y = minimum(e->addedMin.y, coords.y);
+        e->addedMin.z = minimum(e->addedMin.z, coords.z);
+        e->addedMax.x = maximum(e->addedMax.x, coords.x);
+        e->addedMax.y = maximum(e->addedMax.y, coords.y);
+        e->addedMax.z = maximum(e->addedMax.z, coords.z);
+        e->anyAdded = true;
+
+        if (e->perBlockLighting &&
+            _shape_get_rendering_flag(s, SHAPE_RENDERING_FLAG_BAKED_LIGHTING)) {
+            shape_compute_baked_lighting_added_block(s, e->chunk, coords, coords_in_chunk, after);
+        }
+    } else if (after == SHAPE_COLOR_INDEX_AIR_BLOCK) {
+        chunk_remove_block(e->chunk, coords_in_chunk.x, coords_in_chunk.y, coords_in_chunk.z, NULL);
+        s->nbBlocks--;
+        --e->colorDeltas[before];
+        e->anyRemoved = true;
+
+        if (e->perBlockLighting &&
+            _shape_get_rendering_flag(s, SHAPE_RENDERING_FLAG_BAKED_LIGHTING)) {
+            shape_compute_baked_lighting_removed_block(s, e->chunk, coords, coords_in_chunk, before);
+        }
+    } else {
+        chunk_paint_block(e->chunk,
+                          coords_in_chunk.x,
+                          coords_in_chunk.y,
+                          coords_in_chunk.z,
+                          after,
+                          NULL);
+        --e->colorDeltas[before];
+        ++e->colorDeltas[after];
+
+        if (e->perBlockLighting &&
+            _shape_get_rendering_flag(s, SHAPE_RENDERING_FLAG_BAKED_LIGHTING)) {
+            shape_compute_baked_lighting_replaced_block(s,
+                                                        e->chunk,
+                                                        coords,
+                                                        coords_in_chunk,
+                                                        after);
+        }
+    }
+
+    e->chunkChanged = true;
+    if (coords_in_chunk.x == 0) {
+        e->chunkBorders |= 1;
+    } else if (coords_in_chunk.x == CHUNK_SIZE_MINUS_ONE) {
+        e->chunkBorders |= 2;
+    }
+    if (coords_in_chunk.y == 0) {
+        e->chunkBorders |= 4;
+    } else if (coords_in_chunk.y == CHUNK_SIZE_MINUS_ONE) {
+        e->chunkBorders |= 8;
+    }
+    if (coords_in_chunk.z == 0) {
+        e->chunkBorders |= 16;
+    } else if (coords_in_chunk.z == CHUNK_SIZE_MINUS_ONE) {
+        e->chunkBorders |= 32;
+    }
+
+    e->changedMin.x = minimum(e->changedMin.x, coords.x);
+    e->changedMin.y = minimum(e->changedMin.y, coords.y);
+    e->changedMin.z = minimum(e->changedMin.z, coords.z);
+    e->changedMax.x = maximum(e->changedMax.x, coords.x);
+    e->changedMax.y = maximum(e->changedMax.y, coords.y);
+    e->changedMax.z = maximum(e->changedMax.z, coords.z);
+    e->nbChanged++;
+
+    if (e->changes != NULL &&
+        block_change_list_push(e->changes, coords.x, coords.y, coords.z, before, after) == false) {
+        // stop recording, an incomplete entry would undo/redo wrong content ; redo entries no
+        // longer apply to this shape either
+        block_change_list_free(e->changes);
+        e->changes = NULL;
+        history_discardTransactionsMoreRecentThanCursor(e->s->history);
+    }
+}
+
+static size_t _shape_bulk_edit_end(_ShapeBulkEdit *e, Scene *scene) {
+    Shape *s = e->s;
+
+    _shape_bulk_edit_flush_chunk(e);
+
+    if (e->nbChanged == 0) {
+        block_change_list_free(e->changes);
+        return 0;
+    }
+
+    // palette counts
+    for (int i = 0; i < SHAPE_COLOR_INDEX_MAX_COUNT; ++i) {
+        const int32_t delta = e->colorDeltas[i];
+        if (delta > 0) {
+            color_palette_increment_color(s->palette, (SHAPE_COLOR_INDEX_INT_T)i, (uint32_t)delta);
+        } else if (delta < 0) {
+            color_palette_decrement_color(s->palette, (SHAPE_COLOR_INDEX_INT_T)i, (uint32_t)-delta);
+        }
+        s->blocksCount[i] = (uint32_t)((int32_t)s->blocksCount[i] + delta);
+    }
+
+    // bounding box
+    if (e->anyRemoved) {
+        shape_reset_box(s);
+    } else if (e->anyAdded) {
+        shape_expand_box(s, e->addedMin);
+        shape_expand_box(s, e->addedMax);
+    }
+
+    if (e->perBlockLighting == false &&
+        _shape_get_rendering_flag(s, SHAPE_RENDERING_FLAG_BAKED_LIGHTING)) {
+        shape_compute_baked_lighting(s);
+    }
+
+    // register awake box if using per-block collisions
+    if (scene != NULL &&
+        rigidbody_uses_per_block_collisions(transform_get_rigidbody(s->transform))) {
+        const Box model = {{(float)e->changedMin.x, (float)e->changedMin.y, (float)e->changedMin.z},
+                           {(float)(e->changedMax.x + 1),
+                            (float)(e->changedMax.y + 1),
+                            (float)(e->changedMax.z + 1)}};
+        Box *world = box_new();
+        shape_aabox_model_to_world(s, &model, world, false, false);
+        float3_op_add_scalar(&world->max, PHYSICS_AWAKE_DISTANCE);
+        float3_op_substract_scalar(&world->min, PHYSICS_AWAKE_DISTANCE);
+        scene_register_awake_box(scene, world);
+    }
+
+    if (e->changes != NULL) {
+        history_discardTransactionsMoreRecentThanCursor(s->history);
+        history_pushChangeList(s->history, e->changes);
+        e->changes = NULL;
+    }
+
+    return e->nbChanged;
+}
+
 // flag used in shape_add_buffer
 void _set_vb_allocation_flag_one_frame(Shape *s) {
     // shape VB chain was just initialized this frame, and will now be 1+ frame old
@@ -4200,69 +4620,43 @@ bool _shape_apply_transaction(Shape *const sh, Transaction *tr) {
     return true;
 }
 
-bool _shape_undo_transaction(Shape *const sh, Transaction *tr) {
-    vx_assert(sh != NULL);
-    vx_assert(tr != NULL);
-    if (sh == NULL) {
-        return false;
-    }
-    if (tr == NULL) {
-        return false;
+void _shape_apply_change_list(Shape *const sh, const BlockChangeList *changes, const bool undo) {
+    size_t count;
+    bool mustFree;
+    const PackedBlockChange *c = block_change_list_read(changes, &count, &mustFree);
+    if (c == NULL) {
+        return;
     }
 
-    // No need to resize the shape down
-
-    // Returned iterator remains under transaction responsibility
-    // Do not free it!
-    Index3DIterator *it = transaction_getIndex3DIterator(tr);
-    if (it == NULL) {
-        return false;
+    _ShapeBulkEdit e;
+    if (_shape_bulk_edit_begin(&e, sh, count, false) == false) {
+        if (mustFree) {
+            free((void *)c);
+        }
+        return;
     }
 
-    // loop on all the BlockChanges and revert them
-    bool resetBoxNeeded = false;
-    SHAPE_COLOR_INDEX_INT_T before, after;
-    SHAPE_COORDS_INT_T x, y, z;
-    BlockChange *bc;
-    const Block *b;
-
-    while (index3d_iterator_pointer(it) != NULL) {
-        bc = (BlockChange *)index3d_iterator_pointer(it);
-
-        blockChange_getXYZ(bc, &x, &y, &z);
-
-        b = shape_get_block_immediate(sh, x, y, z);
-        before = b != NULL ? b->colorIndex : SHAPE_COLOR_INDEX_AIR_BLOCK;
-
-        after = blockChange_get_previous_color(bc);
-
-        // [air>block] = add block
-        if (before == SHAPE_COLOR_INDEX_AIR_BLOCK && after != SHAPE_COLOR_INDEX_AIR_BLOCK) {
-            shape_add_block(sh, after, x, y, z, false);
+    if (undo) {
+        for (size_t i = count; i > 0; --i) {
+            _shape_bulk_edit_block(&e,
+                                   (SHAPE_COORDS_INT3_T){c[i - 1].x, c[i - 1].y, c[i - 1].z},
+                                   c[i - 1].before,
+                                   SHAPE_BULK_EDIT_REPLACE);
         }
-        // [block>air] = remove block
-        else if (before != SHAPE_COLOR_INDEX_AIR_BLOCK && after == SHAPE_COLOR_INDEX_AIR_BLOCK) {
-            shape_remove_block(sh, x, y, z);
-            if (index3d_iterator_pointer(it) == NULL) {
-                // if block removal is the only transaction, use cheaper function
-                shape_shrink_box(sh, (SHAPE_COORDS_INT3_T){x, y, z});
-            } else {
-                resetBoxNeeded = true;
-            }
-        }
-        // [block>block] = paint block
-        else if (before != SHAPE_COLOR_INDEX_AIR_BLOCK && after != SHAPE_COLOR_INDEX_AIR_BLOCK) {
-            shape_paint_block(sh, after, x, y, z);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            _shape_bulk_edit_block(&e,
+                                   (SHAPE_COORDS_INT3_T){c[i].x, c[i].y, c[i].z},
+                                   c[i].after,
+                                   SHAPE_BULK_EDIT_REPLACE);
         }
-
-        index3d_iterator_next(it);
     }
 
-    if (resetBoxNeeded == true) {
-        shape_reset_box(sh);
-    }
+    _shape_bulk_edit_end(&e, NULL);
 
-    return true;
+    if (mustFree) {
+        free((void *)c);
+    }
 }
 
 void _shape_clear_cached_world_aabb(Shape *s) {
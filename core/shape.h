@@ -66,6 +66,8 @@ typedef uint8_t ShapeDrawMode;
 
 Shape *shape_make(void);
 Shape *shape_make_2(const bool isMutable);
+/// Copies shape, chunks data (blocks & lighting) is shared with origin until first write on
+/// either side. Vertices are written on copy's next refresh.
 Shape *shape_make_copy(Shape *const origin);
 
 /// Returns false if retain fails
@@ -80,7 +82,7 @@ void shape_free(Shape *const shape);
 Weakptr *shape_get_weakptr(Shape *const s);
 Weakptr *shape_get_and_retain_weakptr(Shape *const s);
 
-uint16_t shape_get_id(const Shape *shape);
+uint32_t shape_get_id(const Shape *shape);
 
 // removes all blocks from shape and resets its transform(s)
 void shape_flush(Shape *shape);
@@ -131,6 +133,7 @@ bool shape_paint_block_as_transaction(Shape *const shape,
 
 ///
 void shape_apply_current_transaction(Shape *const shape, bool keepPending);
+bool shape_has_pending_transaction(const Shape *const s);
 
 /// @param useDefaultColor will translate a default color into shape palette
 bool shape_add_block(Shape *shape,
@@ -151,6 +154,47 @@ bool shape_paint_block(Shape *shape,
                        const SHAPE_COORDS_INT_T y,
                        const SHAPE_COORDS_INT_T z);
 
+// MARK: - Bulk edits -
+
+/// Bulk edits write straight into chunks, bypassing the transaction system. Bounding box,
+/// palette counts, dirty chunks and baked lighting are updated once for the whole edit rather
+/// than per block. If history is enabled, a compact undo entry is recorded.
+/// Pending transaction, if any, is applied first to preserve edits order.
+typedef uint8_t ShapeBulkEditMode;
+#define SHAPE_BULK_EDIT_ADD 0     // add blocks in empty cells only
+#define SHAPE_BULK_EDIT_REMOVE 1  // remove existing blocks, color is ignored
+#define SHAPE_BULK_EDIT_PAINT 2   // paint existing blocks only
+#define SHAPE_BULK_EDIT_REPLACE 3 // set all cells to color, air color removes blocks
+
+/// @param min max inclusive box corners in model space
+/// @param scene optional, used to awake rigidbodies if shape uses per-block collisions
+/// @return number of changed blocks
+size_t shape_bulk_edit_box(Shape *s,
+                           Scene *scene,
+                           const SHAPE_COORDS_INT3_T min,
+                           const SHAPE_COORDS_INT3_T max,
+                           const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                           const ShapeBulkEditMode mode);
+
+/// Edits all blocks whose center is within given radius
+size_t shape_bulk_edit_sphere(Shape *s,
+                              Scene *scene,
+                              const SHAPE_COORDS_INT3_T center,
+                              const float radius,
+                              const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                              const ShapeBulkEditMode mode);
+
+/// Edits an arbitrary list of blocks, chunk lookups are cached between consecutive blocks so
+/// lists ordered by chunk are processed faster
+/// @param colors one color per block, or NULL to use colorIndex for all blocks
+size_t shape_bulk_edit_blocks(Shape *s,
+                              Scene *scene,
+                              const SHAPE_COORDS_INT3_T *coords,
+                              const SHAPE_COLOR_INDEX_INT_T *colors,
+                              const size_t count,
+                              const SHAPE_COLOR_INDEX_INT_T colorIndex,
+                              const ShapeBulkEditMode mode);
+
 void shape_get_bounding_box_size(const Shape *shape, int3 *size);
 // TODO: users of this function should probably use bounding box size and discard empty space at
 // origin
@@ -0,0 +1,211 @@
+// -------------------------------------------------------------
+//  Cubzh Core
+//  simd.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// 4-lane float vectors for math kernels, implementation is chosen at compile time:
+// SSE on x86_64 (always available), scalar code otherwise.
+// Define SIMD_DISABLED to force the scalar implementation.
+// Loads & stores are unaligned, kernels are written once using these functions.
+
+#if !defined(SIMD_DISABLED) && (defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64))
+
+#define SIMD_SSE 1
+#include <emmintrin.h>
+
+typedef __m128 simd4f;
+
+static inline simd4f simd4f_load(const float *p) {
+    return _mm_loadu_ps(p);
+}
+static inline void simd4f_store(float *p, const simd4f v) {
+    _mm_storeu_ps(p, v);
+}
+static inline simd4f simd4f_set(const float x, const float y, const float z, const float w) {
+    return _mm_set_ps(w, z, y, x);
+}
+static inline simd4f simd4f_splat(const float f) {
+    return _mm_set1_ps(f);
+}
+static inline simd4f simd4f_add(const simd4f a, const simd4f b) {
+    return _mm_add_ps(a, b);
+}
+static inline simd4f simd4f_sub(const simd4f a, const simd4f b) {
+    return _mm_sub_ps(a, b);
+}
+static inline simd4f simd4f_mul(const simd4f a, const simd4f b) {
+    return _mm_mul_ps(a, b);
+}
+/// a * b + c
+static inline simd4f simd4f_madd(const simd4f a, const simd4f b, const simd4f c) {
+    return _mm_add_ps(_mm_mul_ps(a, b), c);
+}
+static inline simd4f simd4f_min(const simd4f a, const simd4f b) {
+    return _mm_min_ps(a, b);
+}
+static inline simd4f simd4f_max(const simd4f a, const simd4f b) {
+    return _mm_max_ps(a, b);
+}
+static inline simd4f simd4f_abs(const simd4f v) {
+    return _mm_andnot_ps(_mm_set1_ps(-0.0f), v);
+}
+/// Lane x, y or z in all lanes
+static inline simd4f simd4f_splat_x(const simd4f v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0));
+}
+static inline simd4f simd4f_splat_y(const simd4f v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1));
+}
+static inline simd4f simd4f_splat_z(const simd4f v) {
+    return _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2));
+}
+
+/// Stores x, y, z lanes only
+static inline void simd4f_store3(float *p, const simd4f v) {
+    _mm_storel_pi((__m64 *)p, v);
+    _mm_store_ss(p + 2, _mm_movehl_ps(v, v));
+}
+
+/// Loads 4 consecutive float3 (12 floats) as x, y, z lanes
+static inline void simd4f_load_float3x4(const float *p, simd4f *x, simd4f *y, simd4f *z) {
+    const __m128 a = _mm_loadu_ps(p);     // x0 y0 z0 x1
+    const __m128 b = _mm_loadu_ps(p + 4); // y1 z1 x2 y2
+    const __m128 c = _mm_loadu_ps(p + 8); // z2 x3 y3 z3
+    const __m128 bc = _mm_shuffle_ps(b, c, _MM_SHUFFLE(1, 1, 2, 2));
+    *x = _mm_shuffle_ps(a, bc, _MM_SHUFFLE(2, 0, 3, 0));
+    *y = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(0, 0, 1, 1)),
+                        _mm_shuffle_ps(b, c, _MM_SHUFFLE(2, 2, 3, 3)),
+                        _MM_SHUFFLE(2, 0, 2, 0));
+    *z = _mm_shuffle_ps(_mm_shuffle_ps(a, b, _MM_SHUFFLE(1, 1, 2, 2)),
+                        _mm_shuffle_ps(c, c, _MM_SHUFFLE(3, 3, 0, 0)),
+                        _MM_SHUFFLE(2, 0, 2, 0));
+}
+
+/// Stores x, y, z lanes as 4 consecutive float3 (12 floats)
+static inline void simd4f_store_float3x4(float *p, const simd4f x, const simd4f y, const simd4f z) {
+    _mm_storeu_ps(p,
+                  _mm_shuffle_ps(_mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 0, 0, 0)),
+                                 _mm_shuffle_ps(z, x, _MM_SHUFFLE(1, 1, 0, 0)),
+                                 _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 4,
+                  _mm_shuffle_ps(_mm_shuffle_ps(y, z, _MM_SHUFFLE(1, 1, 1, 1)),
+                                 _mm_shuffle_ps(x, y, _MM_SHUFFLE(2, 2, 2, 2)),
+                                 _MM_SHUFFLE(2, 0, 2, 0)));
+    _mm_storeu_ps(p + 8,
+                  _mm_shuffle_ps(_mm_shuffle_ps(z, x, _MM_SHUFFLE(3, 3, 2, 2)),
+                                 _mm_shuffle_ps(y, z, _MM_SHUFFLE(3, 3, 3, 3)),
+                                 _MM_SHUFFLE(2, 0, 2, 0)));
+}
+
+#else
+
+#define SIMD_SCALAR 1
+
+typedef struct {
+    float v[4];
+} simd4f;
+
+static inline simd4f simd4f_load(const float *p) {
+    const simd4f r = {{p[0], p[1], p[2], p[3]}};
+    return r;
+}
+static inline void simd4f_store(float *p, const simd4f v) {
+    p[0] = v.v[0];
+    p[1] = v.v[1];
+    p[2] = v.v[2];
+    p[3] = v.v[3];
+}
+static inline simd4f simd4f_set(const float x, const float y, const float z, const float w) {
+    const simd4f r = {{x, y, z, w}};
+    return r;
+}
+static inline simd4f simd4f_splat(const float f) {
+    const simd4f r = {{f, f, f, f}};
+    return r;
+}
+static inline simd4f simd4f_add(const simd4f a, const simd4f b) {
+    const simd4f r = {{a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3]}};
+    return r;
+}
+static inline simd4f simd4f_sub(const simd4f a, const simd4f b) {
+    const simd4f r = {{a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3]}};
+    return r;
+}
+static inline simd4f simd4f_mul(const simd4f a, const simd4f b) {
+    const simd4f r = {{a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3]}};
+    return r;
+}
+/// a * b + c
+static inline simd4f simd4f_madd(const simd4f a, const simd4f b, const simd4f c) {
+    return simd4f_add(simd4f_mul(a, b), c);
+}
+static inline simd4f simd4f_min(const simd4f a, const simd4f b) {
+    simd4f r;
+    for (int i = 0; i < 4; ++i) {
+        r.v[i] = a.v[i] < b.v[i] ? a.v[i] : b.v[i];
+    }
+    return r;
+}
+static inline simd4f simd4f_max(const simd4f a, const simd4f b) {
+    simd4f r;
+    for (int i = 0; i < 4; ++i) {
+        r.v[i] = a.v[i] > b.v[i] ? a.v[i] : b.v[i];
+    }
+    return r;
+}
+static inline simd4f simd4f_abs(const simd4f v) {
+    simd4f r;
+    for (int i = 0; i < 4; ++i) {
+        r.v[i] = v.v[i] < 0.0f ? -v.v[i] : v.v[i];
+    }
+    return r;
+}
+/// Lane x, y or z in all lanes
+static inline simd4f simd4f_splat_x(const simd4f v) {
+    return simd4f_splat(v.v[0]);
+}
+static inline simd4f simd4f_splat_y(const simd4f v) {
+    return simd4f_splat(v.v[1]);
+}
+static inline simd4f simd4f_splat_z(const simd4f v) {
+    return simd4f_splat(v.v[2]);
+}
+
+/// Stores x, y, z lanes only
+static inline void simd4f_store3(float *p, const simd4f v) {
+    p[0] = v.v[0];
+    p[1] = v.v[1];
+    p[2] = v.v[2];
+}
+
+/// Loads 4 consecutive float3 (12 floats) as x, y, z lanes
+static inline void simd4f_load_float3x4(const float *p, simd4f *x, simd4f *y, simd4f *z) {
+    for (int i = 0; i < 4; ++i) {
+        x->v[i] = p[i * 3];
+        y->v[i] = p[i * 3 + 1];
+        z->v[i] = p[i * 3 + 2];
+    }
+}
+
+/// Stores x, y, z lanes as 4 consecutive float3 (12 floats)
+static inline void simd4f_store_float3x4(float *p, const simd4f x, const simd4f y, const simd4f z) {
+    for (int i = 0; i < 4; ++i) {
+        p[i * 3] = x.v[i];
+        p[i * 3 + 1] = y.v[i];
+        p[i * 3 + 2] = z.v[i];
+    }
+}
+
+#endif
+
+
+#ifdef __cplusplus
+} // extern "C"
+#endif
@@ -0,0 +1,91 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_block_change_list.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "block_change_list.h"
+
+// Push unsorted changes, with several changes on the same block and a change that ends up
+// having no effect. Check that packing sorts, merges and drops them as expected.
+void test_block_change_list_pack(void) {
+    BlockChangeList *l = block_change_list_new();
+
+    TEST_CHECK(block_change_list_push(l, 2, 0, 0, 255, 1));
+    block_change_list_push(l, 0, 0, 1, 255, 1);
+    block_change_list_push(l, 2, 0, 0, 1, 3); // amends first change
+    block_change_list_push(l, 0, 0, 0, 4, 5);
+    block_change_list_push(l, 1, 0, 0, 255, 2);
+    block_change_list_push(l, 1, 0, 0, 2, 255); // cancels previous change
+    TEST_CHECK(block_change_list_get_count(l) == 6);
+
+    TEST_CHECK(block_change_list_pack(l));
+    TEST_CHECK(block_change_list_is_packed(l));
+    TEST_CHECK(block_change_list_get_count(l) == 3);
+
+    size_t count;
+    bool mustFree;
+    const PackedBlockChange *c = block_change_list_read(l, &count, &mustFree);
+    TEST_ASSERT(c != NULL);
+    TEST_CHECK(count == 3);
+    TEST_CHECK(mustFree);
+
+    TEST_CHECK(c[0].x == 0 && c[0].y == 0 && c[0].z == 0);
+    TEST_CHECK(c[0].before == 4 && c[0].after == 5);
+    TEST_CHECK(c[1].x == 0 && c[1].y == 0 && c[1].z == 1);
+    TEST_CHECK(c[1].before == 255 && c[1].after == 1);
+    TEST_CHECK(c[2].x == 2 && c[2].y == 0 && c[2].z == 0);
+    TEST_CHECK(c[2].before == 255 && c[2].after == 3);
+
+    free((void *)c);
+    block_change_list_free(l);
+}
+
+// Pack a large edit, check it is stored in a fraction of its raw size and decodes back
+// to the same changes, including negative coordinates.
+void test_block_change_list_pack_large(void) {
+    BlockChangeList *l = block_change_list_new();
+    SHAPE_COORDS_INT_T x, y, z;
+    size_t n = 0;
+
+    for (x = -20; x < 20; ++x) {
+        for (y = -20; y < 20; ++y) {
+            for (z = -20; z < 20; ++z) {
+                block_change_list_push(l, x, y, z, 255, (SHAPE_COLOR_INDEX_INT_T)(y < 0 ? 1 : 2));
+                ++n;
+            }
+        }
+    }
+    const size_t rawSize = block_change_list_get_byte_size(l);
+    TEST_CHECK(rawSize >= n * sizeof(PackedBlockChange));
+
+    TEST_CHECK(block_change_list_pack(l));
+    TEST_CHECK(block_change_list_get_count(l) == n);
+    TEST_CHECK(block_change_list_get_byte_size(l) * 10 < rawSize);
+
+    size_t count;
+    bool mustFree;
+    const PackedBlockChange *c = block_change_list_read(l, &count, &mustFree);
+    TEST_ASSERT(c != NULL);
+    TEST_CHECK(count == n);
+
+    size_t i = 0;
+    bool ok = true;
+    for (x = -20; x < 20; ++x) {
+        for (y = -20; y < 20; ++y) {
+            for (z = -20; z < 20; ++z) {
+                ok = ok && c[i].x == x && c[i].y == y && c[i].z == z && c[i].before == 255 &&
+                     c[i].after == (y < 0 ? 1 : 2);
+                ++i;
+            }
+        }
+    }
+    TEST_CHECK(ok);
+
+    if (mustFree) {
+        free((void *)c);
+    }
+    block_change_list_free(l);
+}
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <float.h>
+
 #include "box.h"
 #include "float3.h"
 #include "int3.h"
@@ -167,6 +169,13 @@ void test_box_contains(void) {
     TEST_CHECK(box_contains(a, &pointCheck) == true);
     TEST_CHECK(box_contains_epsilon(a, &pointCheck, EPSILON_COLLISION) == true);
 
+    Box inner = {{3.0f, 5.0f, 2.0f}, {8.0f, 10.0f, 7.0f}};
+    TEST_CHECK(box_contains_box(a, &inner));
+    TEST_CHECK(box_contains_box(a, a));
+    TEST_CHECK(box_contains_box(&inner, a) == false);
+    inner.max.y = 15.1f;
+    TEST_CHECK(box_contains_box(a, &inner) == false);
+
     box_free(a);
 }
 
@@ -389,3 +398,43 @@ void test_box_to_aabox2(void) {
     box_free(b);
     matrix4x4_free(BMatrix);
 }
+
+// Transform boxes with rotation, scale & translation, check against their 8 transformed corners.
+// Batch version gives the same results as box_to_aabox2
+void test_box_to_aaboxes(void) {
+    Matrix4x4 m1, m2;
+    matrix4x4_set_from_euler_xyz(&m1, 0.4f, 1.1f, -0.6f);
+    matrix4x4_op_scale(&m1, &(float3){2.0f, 0.5f, 1.0f});
+    m1.x4y1 = 5.0f;
+    m1.x4y2 = -3.0f;
+    m1.x4y3 = 12.0f;
+    matrix4x4_set_from_euler_xyz(&m2, -1.0f, 0.2f, 0.3f);
+    matrix4x4_op_invert(&m2);
+
+    Box boxes[5], aabs[5], expected;
+    for (int i = 0; i < 5; ++i) {
+        boxes[i].min = (float3){(float)i, -2.0f, 1.0f};
+        boxes[i].max = (float3){(float)i * 3.0f + 1.0f, 4.0f, 1.5f};
+    }
+
+    // 8 corners of first box
+    float3 corner, transformed;
+    Box fromCorners = {{FLT_MAX, FLT_MAX, FLT_MAX}, {-FLT_MAX, -FLT_MAX, -FLT_MAX}};
+    for (int i = 0; i < 8; ++i) {
+        corner.x = (i & 1) ? boxes[0].max.x : boxes[0].min.x;
+        corner.y = (i & 2) ? boxes[0].max.y : boxes[0].min.y;
+        corner.z = (i & 4) ? boxes[0].max.z : boxes[0].min.z;
+        matrix4x4_op_multiply_vec_point(&transformed, &corner, &m1);
+        matrix4x4_op_multiply_vec_point(&transformed, &transformed, &m2);
+        box_op_merge(&fromCorners, &(Box){transformed, transformed}, &fromCorners);
+    }
+    box_model1_to_model2_aabox(&boxes[0], &expected, &m1, &m2, NULL, NoSquarify);
+    TEST_CHECK(box_equals(&expected, &fromCorners, EPSILON_ZERO));
+
+    const float3 offset = {0.5f, 0.5f, -1.0f};
+    box_to_aaboxes(boxes, aabs, 5, &m1, &offset);
+    for (int i = 0; i < 5; ++i) {
+        box_to_aabox2(&boxes[i], &expected, &m1, &offset, NoSquarify);
+        TEST_CHECK(box_equals(&aabs[i], &expected, EPSILON_ZERO));
+    }
+}
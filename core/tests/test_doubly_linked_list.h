@@ -577,5 +577,28 @@ void test_doubly_linked_list_sort_ascending(void) {
     pointerCheck = doubly_linked_list_node_pointer(NodeCheck);
     TEST_CHECK(*pointerCheck == 119);
 
+    // larger list w/ equal values, which keep their order
+    doubly_linked_list_free(list);
+    list = doubly_linked_list_new();
+    int values[100];
+    for (int i = 0; i < 100; ++i) {
+        values[i] = (i * 37) % 10;
+        doubly_linked_list_push_last(list, &values[i]);
+    }
+    doubly_linked_list_sort_ascending(list, _node_is_superior);
+    TEST_CHECK(doubly_linked_list_node_count(list) == 100);
+    DoublyLinkedListNode *n = doubly_linked_list_first(list);
+    int *previous = NULL;
+    while (n != NULL) {
+        int *current = (int *)doubly_linked_list_node_pointer(n);
+        TEST_CHECK(previous == NULL || *previous < *current ||
+                   (*previous == *current && previous < current));
+        TEST_CHECK(doubly_linked_list_node_previous(n) == NULL ||
+                   doubly_linked_list_node_pointer(doubly_linked_list_node_previous(n)) == previous);
+        previous = current;
+        n = doubly_linked_list_node_next(n);
+    }
+    TEST_CHECK(doubly_linked_list_node_pointer(doubly_linked_list_last(list)) == previous);
+
     doubly_linked_list_free(list);
 }
@@ -50,3 +50,45 @@ void test_hash_uint32_int(void) {
 
     hash_uint32_int_free(h);
 }
+
+// Set enough close keys to grow the table several times, delete half of them and check the others
+// are still found across shifted probe sequences, then set deleted keys again.
+void test_hash_uint32_int_many_keys(void) {
+    HashUInt32Int *h = hash_uint32_int_new();
+    int v = 0;
+    uint32_t key;
+
+    // colors with close values
+    for (uint32_t i = 0; i < 1000; ++i) {
+        hash_uint32_int_set(h, 0xFF000000 + i * 3, (int)i);
+    }
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        hash_uint32_int_delete(h, 0xFF000000 + i * 3);
+    }
+    for (uint32_t i = 0; i < 1000; ++i) {
+        key = 0xFF000000 + i * 3;
+        v = -1;
+        if (i % 2 == 0) {
+            TEST_CHECK(hash_uint32_int_get(h, key, &v) == false);
+        } else {
+            TEST_CHECK(hash_uint32_int_get(h, key, &v) && v == (int)i);
+        }
+        TEST_MSG("key %u, value %d", key, v);
+    }
+
+    // deleted keys take free slots again, without duplicating remaining ones
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        hash_uint32_int_set(h, 0xFF000000 + i * 3, -(int)i);
+    }
+    for (uint32_t i = 1; i < 1000; i += 2) {
+        hash_uint32_int_delete(h, 0xFF000000 + i * 3);
+    }
+    for (uint32_t i = 0; i < 1000; i += 2) {
+        key = 0xFF000000 + i * 3;
+        v = 1;
+        TEST_CHECK(hash_uint32_int_get(h, key, &v) && v == -(int)i);
+        TEST_MSG("key %u, value %d", key, v);
+    }
+
+    hash_uint32_int_free(h);
+}
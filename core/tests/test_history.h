@@ -0,0 +1,57 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_history.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "block_change_list.h"
+#include "history.h"
+
+static BlockChangeList *_test_history_change_list(const SHAPE_COORDS_INT_T x) {
+    BlockChangeList *l = block_change_list_new();
+    block_change_list_push(l, x, 0, 0, 255, 1);
+    return l;
+}
+
+// Push entries until exceeding the byte limit, check that oldest ones are discarded
+// and that the most recent one is kept even when it doesn't fit alone.
+void test_history_byte_limit(void) {
+    History *h = history_new();
+    TEST_CHECK(history_get_byte_size(h) == 0);
+    TEST_CHECK(history_get_byte_limit(h) == HISTORY_MAX_BYTES);
+
+    history_pushChangeList(h, _test_history_change_list(0));
+    const size_t entrySize = history_get_byte_size(h);
+    TEST_CHECK(entrySize > 0);
+
+    history_set_byte_limit(h, entrySize * 2);
+    history_pushChangeList(h, _test_history_change_list(1));
+    history_pushChangeList(h, _test_history_change_list(2));
+    TEST_CHECK(history_get_byte_size(h) == entrySize * 2);
+
+    // only 2 entries left
+    const BlockChangeList *l = history_getChangesToUndo(h);
+    TEST_ASSERT(l != NULL);
+    size_t count;
+    bool mustFree;
+    const PackedBlockChange *c = block_change_list_read(l, &count, &mustFree);
+    TEST_CHECK(count == 1 && c[0].x == 2);
+    if (mustFree) {
+        free((void *)c);
+    }
+    TEST_CHECK(history_getChangesToUndo(h) != NULL);
+    TEST_CHECK(history_can_undo(h) == false);
+
+    // undone entries are not discarded, they can still be redone
+    history_set_byte_limit(h, 0);
+    TEST_CHECK(history_get_byte_size(h) == entrySize * 2);
+    TEST_CHECK(history_getChangesToRedo(h) != NULL);
+    history_set_byte_limit(h, 0);
+    TEST_CHECK(history_get_byte_size(h) == entrySize);
+    TEST_CHECK(history_can_undo(h) == false);
+    TEST_CHECK(history_can_redo(h));
+
+    history_free(h);
+}
@@ -0,0 +1,168 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_instance_group.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "instance_group.h"
+#include "scene.h"
+
+#include "test_rigidbody.h"
+
+static Shape *_test_instance_group_shape(ColorAtlas *atlas) {
+    Shape *s = shape_make_2(true);
+    shape_set_palette(s, color_palette_new(atlas), false);
+    shape_add_block(s, 1, 0, 0, 0, true);
+    shape_add_block(s, 1, 1, 1, 1, true);
+    return s;
+}
+
+// check that IDs remain valid when instances are moved in dense arrays
+void test_instance_group_add_remove(void) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _test_instance_group_shape(atlas);
+    InstanceGroup *g = instance_group_new(s);
+
+    InstanceID ids[3];
+    for (int i = 0; i < 3; ++i) {
+        const float3 pos = {(float)i * 10.0f, 0.0f, 0.0f};
+        ids[i] = instance_group_add(g, &pos, NULL, NULL, 1, INSTANCE_FLAG_NONE);
+        TEST_ASSERT(ids[i] != INSTANCE_ID_NONE);
+    }
+    TEST_CHECK(instance_group_get_count(g) == 3);
+
+    TEST_CHECK(instance_group_remove(g, ids[0]));
+    TEST_CHECK(instance_group_remove(g, ids[0]) == false);
+    TEST_CHECK(instance_group_contains(g, ids[0]) == false);
+    TEST_CHECK(instance_group_get_count(g) == 2);
+    TEST_CHECK(instance_group_get_position(g, ids[2])->x == 20.0f);
+    TEST_CHECK(instance_group_get_position(g, ids[1])->x == 10.0f);
+
+    // removed ID is reused
+    const InstanceID id = instance_group_add(g, NULL, NULL, NULL, 1, INSTANCE_FLAG_NONE);
+    TEST_CHECK(id == ids[0]);
+    TEST_CHECK(instance_group_get_position(g, id)->x == 0.0f);
+
+    instance_group_free(g);
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+// check that only modified instances are refreshed, and that r-tree leaves follow instances
+void test_instance_group_refresh(void) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _test_instance_group_shape(atlas);
+    Scene *sc = scene_new(NULL);
+    InstanceGroup *g = instance_group_new(s);
+    scene_add_instance_group(sc, g);
+
+    InstanceID ids[100];
+    for (int i = 0; i < 100; ++i) {
+        const float3 pos = {(float)i * 10.0f, 0.0f, 0.0f};
+        ids[i] = instance_group_add(g, &pos, NULL, NULL, 1, INSTANCE_FLAG_COLLIDER);
+    }
+    scene_refresh(sc, 0.0, NULL);
+    TEST_CHECK(instance_group_refresh(g) == 0);
+
+    const float3 pos = {0.0f, 50.0f, 0.0f};
+    instance_group_set_position(g, ids[42], &pos);
+    TEST_CHECK(instance_group_refresh(g) == 1);
+
+    Box box;
+    TEST_ASSERT(instance_group_get_world_aabb(g, ids[42], &box));
+    TEST_CHECK(box.min.y == 50.0f && box.max.y == 52.0f);
+
+    FifoList *results = fifo_list_new();
+    const Box query = {{-1.0f, 49.0f, -1.0f}, {3.0f, 53.0f, 3.0f}};
+    TEST_CHECK(rtree_query_overlap_box(instance_group_get_rtree(g),
+                                       &query,
+                                       PHYSICS_GROUP_ALL_SYSTEM,
+                                       PHYSICS_GROUP_ALL_SYSTEM,
+                                       NULL,
+                                       results,
+                                       &float3_zero) == 1);
+    RtreeNode *leaf = (RtreeNode *)fifo_list_pop(results);
+    TEST_CHECK(instance_group_leaf_get_id(leaf) == ids[42]);
+    fifo_list_free(results, NULL);
+
+    // moving group transform refreshes all instances
+    transform_set_local_position(instance_group_get_transform(g), 0.0f, 0.0f, 5.0f);
+    TEST_CHECK(instance_group_refresh(g) == 100);
+    TEST_CHECK(instance_group_get_model_matrices(g)[0].x4y3 == 5.0f);
+
+    // so does changing source shape pivot
+    const float3 pivot = shape_get_pivot(s);
+    shape_set_pivot(s, pivot.x + 1.0f, pivot.y, pivot.z);
+    TEST_CHECK(instance_group_refresh(g) == 100);
+    TEST_CHECK(instance_group_refresh(g) == 0);
+
+    DoublyLinkedList *list = scene_new_instance_groups_iterator(sc);
+    TEST_CHECK(doubly_linked_list_first(list) != NULL &&
+               doubly_linked_list_node_pointer(doubly_linked_list_first(list)) == g);
+    doubly_linked_list_free(list);
+
+    // scene drops freed groups
+    instance_group_free(g);
+    scene_refresh(sc, 0.0, NULL);
+    list = scene_new_instance_groups_iterator(sc);
+    TEST_CHECK(doubly_linked_list_first(list) == NULL);
+    doubly_linked_list_free(list);
+
+    scene_free(sc);
+    shape_release(s);
+    color_atlas_free(atlas);
+}
+
+// dynamic rigidbodies land on instance colliders, which can also be cast against
+void test_instance_group_collider(void) {
+    ColorAtlas *atlas = color_atlas_new();
+    Shape *s = _test_instance_group_shape(atlas);
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+
+    InstanceGroup *g = instance_group_new(s);
+    scene_add_instance_group(sc, g);
+    const InstanceID id = instance_group_add(g, NULL, NULL, NULL, 1, INSTANCE_FLAG_COLLIDER);
+    scene_refresh(sc, 0.0, NULL);
+
+    Box aabb;
+    TEST_ASSERT(instance_group_get_world_aabb(g, id, &aabb));
+    const float3 center = {(aabb.min.x + aabb.max.x) * 0.5f,
+                           aabb.max.y + 3.0f,
+                           (aabb.min.z + aabb.max.z) * 0.5f};
+
+    const Box cube = {{-0.25f, 0.0f, -0.25f}, {0.25f, 0.5f, 0.25f}};
+    Transform *t = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &center);
+    for (int frame = 0; frame < 120; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    TEST_CHECK(float_isEqual(transform_get_position(t, false)->y, aabb.max.y, 0.01f));
+    TEST_MSG("landed at %.3f, instance top at %.3f",
+             (double)transform_get_position(t, false)->y,
+             (double)aabb.max.y);
+    TEST_CHECK(utils_axes_mask_get(rigidbody_get_contact_mask(transform_get_rigidbody(t)),
+                                   AxesMaskNY));
+
+    // ray next to the rigidbody hits the instance, reported on group transform
+    const float3 origin = {aabb.min.x + 0.1f, aabb.max.y + 10.0f, aabb.min.z + 0.1f};
+    const float3 down = {0.0f, -1.0f, 0.0f};
+    Ray *ray = ray_new(&origin, &down);
+    CastResult hit;
+    TEST_CHECK(scene_cast_ray(sc, ray, PHYSICS_GROUP_ALL_SYSTEM, NULL, &hit) == Hit_CollisionBox);
+    TEST_CHECK(hit.hitTr == instance_group_get_transform(g));
+    TEST_CHECK(hit.instance == id);
+    TEST_CHECK(float_isEqual(hit.distance, 10.0f, EPSILON_ZERO));
+    ray_free(ray);
+
+    // group transform parented by scene_add_instance_group is unparented
+    scene_remove_instance_group(sc, g);
+    TEST_CHECK(transform_get_parent(instance_group_get_transform(g)) == NULL);
+
+    instance_group_free(g);
+    scene_free(sc);
+    shape_release(s);
+    color_atlas_free(atlas);
+}
@@ -14,6 +14,7 @@
 
 #include "test_block.h"
 #include "test_blockChange.h"
+#include "test_block_change_list.h"
 #include "test_box.h"
 #include "test_chunk.h"
 #include "test_config.h"
@@ -29,12 +30,17 @@
 #include "test_float4.h"
 #include "test_flood_fill_lighting.h"
 #include "test_hash_uint32_int.h"
+#include "test_history.h"
 #include "test_inputs.h"
+#include "test_instance_group.h"
 #include "test_int3.h"
 #include "test_map_string_float3.h"
 #include "test_matrix4x4.h"
 #include "test_quaternion.h"
+#include "test_replay.h"
+#include "test_rigidbody.h"
 #include "test_rtree.h"
+#include "test_serialization_vox.h"
 #include "test_shape.h"
 #include "test_stream.h"
 #include "test_transaction.h"
@@ -63,6 +69,10 @@ TEST_LIST = {
     {"test_blockChange_get", test_blockChange_get},
     {"test_blockChange_amend", test_blockChange_amend},
 
+    // block_change_list
+    {"block_change_list_pack", test_block_change_list_pack},
+    {"block_change_list_pack_large", test_block_change_list_pack_large},
+
     // box
     {"test_box_new", test_box_new},
     {"test_box_new_2", test_box_new_2},
@@ -80,6 +90,7 @@ TEST_LIST = {
     {"test_box_get_volume", test_box_get_volume},
     {"test_box_to_aabox_no_rot", test_box_to_aabox_no_rot},
     {"test_box_to_aabox2", test_box_to_aabox2},
+    {"test_box_to_aaboxes", test_box_to_aaboxes},
 
     // chunk
     {"test_chunk_new", test_chunk_new},
@@ -175,6 +186,10 @@ TEST_LIST = {
 
     // hash_uint32
     {"hash_uint32_int", test_hash_uint32_int},
+    {"hash_uint32_int_many_keys", test_hash_uint32_int_many_keys},
+
+    // history
+    {"history_byte_limit", test_history_byte_limit},
 
     // inputs
     {"isTouchEventID", test_isTouchEventID},
@@ -200,6 +215,11 @@ TEST_LIST = {
     // {"input_pressedInputsImGui", test_input_pressedInputsImGui},
     {"input_get_cursor", test_input_get_cursor},
 
+    // instance_group
+    {"instance_group_add_remove", test_instance_group_add_remove},
+    {"instance_group_refresh", test_instance_group_refresh},
+    {"instance_group_collider", test_instance_group_collider},
+
     // int3
     {"int3_pool_pop", test_int3_pool_pop},
     {"int3_pool_recycle", test_int3_pool_recycle},
@@ -239,6 +259,7 @@ TEST_LIST = {
     {"map_string_float3_value_for_key", test_map_string_float3_value_for_key},
     {"map_string_mutable_float3_value_for_key", test_map_string_mutable_float3_value_for_key},
     {"map_string_float3_remove_key", test_map_string_float3_remove_key},
+    {"map_string_float3_many_keys", test_map_string_float3_many_keys},
 
     // matrix4x4
     {"matrix4x4_new", test_matrix4x4_new},
@@ -259,7 +280,9 @@ TEST_LIST = {
     {"matrix4x4_op_multiply_vec", test_matrix4x4_op_multiply_vec},
     {"matrix4x4_op_multiply_vec_point", test_matrix4x4_op_multiply_vec_point},
     {"matrix4x4_op_multiply_vec_vector", test_matrix4x4_op_multiply_vec_vector},
+    {"matrix4x4_op_multiply_vec_points", test_matrix4x4_op_multiply_vec_points},
     {"matrix4x4_op_invert", test_matrix4x4_op_invert},
+    {"matrix4x4_affine", test_matrix4x4_affine},
     {"matrix4x4_op_unscale", test_matrix4x4_op_unscale},
 
     // quaternion
@@ -290,16 +313,28 @@ TEST_LIST = {
     {"quaternion_rotate_vector", test_quaternion_rotate_vector},
     {"quaternion_coherence_check", test_quaternion_coherence_check},
 
+    // replay
+    {"replay_verify", test_replay_verify},
+
+    // rigidbody
+    {"rigidbody_stack", test_rigidbody_stack},
+    {"rigidbody_slide", test_rigidbody_slide},
+    {"rigidbody_islands", test_rigidbody_islands},
+    {"rigidbody_visits", test_rigidbody_visits},
+    {"rigidbody_fixed_timestep", test_rigidbody_fixed_timestep},
+
     // rtree
     {"rtree_new", test_rtree_new},
     {"rtree_node_get_aabb", test_rtree_node_get_aabb},
     {"rtree_node_get_groups", test_rtree_node_get_groups},
     {"rtree_node_get_collides_with", test_rtree_node_get_collides_with},
     {"rtree_create_and_insert", test_rtree_create_and_insert},
+    {"rtree_query_cast_all_ray", test_rtree_query_cast_all_ray},
 
     // shape
     {"shape_make", test_shape_make},
     {"shape_make_copy", test_shape_make_copy},
+    {"shape_make_copy_shared_chunks", test_shape_make_copy_shared_chunks},
     {"shape_retain", test_shape_retain},
     {"shape_release", test_shape_release},
     {"shape_get_id", test_shape_get_id},
@@ -312,6 +347,14 @@ TEST_LIST = {
     {"test_shape_addblock_1", test_shape_addblock_1},
     // {"test_shape_addblock_2", test_shape_addblock_2},
     {"test_shape_addblock_3", test_shape_addblock_3},
+    {"shape_bulk_edit", test_shape_bulk_edit},
+    {"shape_bulk_edit_history", test_shape_bulk_edit_history},
+
+    // serialization_vox
+    {"serialization_vox_load_single_model", test_serialization_vox_load_single_model},
+    {"serialization_vox_load_hierarchy", test_serialization_vox_load_hierarchy},
+    {"serialization_vox_load_models_without_scene_graph",
+     test_serialization_vox_load_models_without_scene_graph},
 
     // stream
     {"stream_new_buffer_read", test_stream_new_buffer_read},
@@ -341,6 +384,9 @@ TEST_LIST = {
     {"transform_children", test_transform_children},
     {"transform_retain", test_transform_retain},
     {"transform_flush", test_transform_flush},
+    {"transform_refresh_hierarchy", test_transform_refresh_hierarchy},
+    {"transform_branch_dirty", test_transform_branch_dirty},
+    {"transform_id", test_transform_id},
 
     // utils
     {"test_utils_float_isEqual", test_utils_float_isEqual},
@@ -273,3 +273,58 @@ void test_map_string_float3_remove_key(void) {
     map_string_float3_iterator_free(mapIterator);
     map_string_float3_free(map);
 }
+
+// Insert enough nodes to go past the inline storage, checking all keys at each insertion across the
+// switch to indexed lookups, then check removal and copy, which keeps iteration order (filo).
+void test_map_string_float3_many_keys(void) {
+    MapStringFloat3 *map = map_string_float3_new();
+    char key[16];
+    const float3 *f3;
+
+    for (int i = 0; i < 100; ++i) {
+        snprintf(key, sizeof(key), "poi_%d", i);
+        map_string_float3_set_key_value(map, key, float3_new((float)i, 0, 0));
+        if (i % 7 != 0 && i > 16) {
+            continue;
+        }
+        for (int j = 0; j <= i; ++j) {
+            snprintf(key, sizeof(key), "poi_%d", j);
+            f3 = map_string_float3_value_for_key(map, key);
+            TEST_CHECK(f3 != NULL && (int)f3->x == j);
+            TEST_MSG("key %s, after inserting %d keys", key, i + 1);
+        }
+    }
+
+    for (int i = 0; i < 100; i += 3) {
+        snprintf(key, sizeof(key), "poi_%d", i);
+        map_string_float3_remove_key(map, key);
+    }
+    snprintf(key, sizeof(key), "poi_%d", 100);
+    TEST_CHECK(map_string_float3_value_for_key(map, key) == NULL);
+
+    MapStringFloat3 *copy = map_string_float3_new_copy(map);
+    map_string_float3_free(map);
+    TEST_ASSERT(copy != NULL);
+
+    MapStringFloat3Iterator *mapIterator = map_string_float3_iterator_new(copy);
+    int expected = 99;
+    while (map_string_float3_iterator_is_done(mapIterator) == false) {
+        if (expected % 3 == 0) {
+            --expected;
+        }
+        snprintf(key, sizeof(key), "poi_%d", expected);
+        TEST_CHECK(strcmp(map_string_float3_iterator_current_key(mapIterator), key) == 0);
+        TEST_MSG("key %s, expected %s", map_string_float3_iterator_current_key(mapIterator), key);
+        TEST_CHECK((int)map_string_float3_iterator_current_value(mapIterator)->x == expected);
+        TEST_MSG("key %s", key);
+        f3 = map_string_float3_value_for_key(copy, key);
+        TEST_CHECK(f3 == map_string_float3_iterator_current_value(mapIterator));
+        TEST_MSG("key %s", key);
+        --expected;
+        map_string_float3_iterator_next(mapIterator);
+    }
+    TEST_CHECK(expected == 0);
+
+    map_string_float3_iterator_free(mapIterator);
+    map_string_float3_free(copy);
+}
@@ -487,6 +487,64 @@ void test_matrix4x4_op_invert(void) {
     matrix4x4_free(m);
 }
 
+// check that affine kernels match generic multiply & invert
+void test_matrix4x4_affine(void) {
+    Matrix4x4 a, b;
+    matrix4x4_set_from_euler_xyz(&a, 0.3f, -1.2f, 2.1f);
+    matrix4x4_op_scale(&a, &(float3){2.0f, 0.5f, 3.0f});
+    matrix4x4_set_translation(&a, 10.0f, -4.0f, 7.0f);
+    matrix4x4_set_from_euler_xyz(&b, -0.8f, 0.1f, 0.4f);
+    matrix4x4_set_translation(&b, 1.0f, 2.0f, 3.0f);
+    TEST_CHECK(matrix4x4_is_affine(&a) && matrix4x4_is_affine(&b));
+
+    Matrix4x4 expected = b;
+    matrix4x4_op_multiply_2(&a, &expected);
+    Matrix4x4 result;
+    matrix4x4_op_multiply_affine(&a, &b, &result);
+    const float *e = (const float *)&expected, *r = (const float *)&result;
+    for (int i = 0; i < 16; ++i) {
+        TEST_CHECK(float_isEqual(r[i], e[i], EPSILON_ZERO));
+    }
+
+    // in-place
+    expected = result;
+    matrix4x4_op_invert(&expected);
+    matrix4x4_op_invert_affine(&result, &result);
+    for (int i = 0; i < 16; ++i) {
+        TEST_CHECK(float_isEqual(r[i], e[i], EPSILON_ZERO));
+    }
+
+    // singular matrix is left as is
+    matrix4x4_set_scale(&a, 0.0f);
+    matrix4x4_op_invert_affine(&a, &result);
+    TEST_CHECK(result.x1y1 == 0.0f && result.x4y4 == 1.0f);
+}
+
+// batch version transforms points exactly as one by one, including remaining points and in-place
+void test_matrix4x4_op_multiply_vec_points(void) {
+    Matrix4x4 m;
+    matrix4x4_set_from_euler_xyz(&m, 0.7f, -0.2f, 1.3f);
+    matrix4x4_op_scale(&m, &(float3){1.5f, 2.0f, 0.25f});
+    m.x4y1 = 3.0f;
+    m.x4y2 = -8.0f;
+    m.x4y3 = 0.5f;
+
+    float3 points[11], results[11], expected;
+    for (int i = 0; i < 11; ++i) {
+        float3_set(&points[i], (float)i * 1.5f - 4.0f, (float)(i * i) * 0.1f, 7.0f - (float)i);
+    }
+    matrix4x4_op_multiply_vec_points(results, points, 11, &m);
+    for (int i = 0; i < 11; ++i) {
+        matrix4x4_op_multiply_vec_point(&expected, &points[i], &m);
+        TEST_CHECK(float3_isEqual(&results[i], &expected, EPSILON_ZERO));
+    }
+
+    matrix4x4_op_multiply_vec_points(points, points, 11, &m);
+    for (int i = 0; i < 11; ++i) {
+        TEST_CHECK(float3_isEqual(&points[i], &results[i], EPSILON_ZERO));
+    }
+}
+
 // check second column
 void test_matrix4x4_op_unscale(void) {
     Matrix4x4 *m = matrix4x4_new(0.0f,
@@ -0,0 +1,93 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_replay.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "replay.h"
+
+#include "test_rigidbody.h"
+
+#define TEST_REPLAY_TILES 60
+#define TEST_REPLAY_BODIES 6
+
+static Transform *_test_replay_resolve(uint32_t key, void *ptr) {
+    return key < TEST_REPLAY_BODIES ? ((Transform **)ptr)[key] : NULL;
+}
+
+/// Bodies thrown at each other over narrow floor tiles of various frictions, tiles are first
+/// inserted in the r-tree at `offset` then moved in place, for a different r-tree history
+static Scene *_test_replay_scene(Transform **bodies, const float offset) {
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+    scene_set_deterministic(sc, true);
+
+    const Box tile = {{0.0f, -1.0f, -1.0f}, {0.3f, 0.0f, 1.0f}};
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    const float frictions[3] = {0.31f, 0.67f, 0.93f};
+
+    Transform *tiles[TEST_REPLAY_TILES];
+    for (int i = 0; i < TEST_REPLAY_TILES; ++i) {
+        const float3 pos = {(float)i * 0.3f - 9.0f, offset * (float)(i % 3), offset};
+        tiles[i] = _test_rigidbody_add(sc, RigidbodyMode_Static, &tile, &pos);
+        for (FACE_INDEX_INT_T f = 0; f < FACE_COUNT; ++f) {
+            rigidbody_set_friction(transform_get_rigidbody(tiles[i]), f, frictions[i % 3]);
+        }
+    }
+    for (int i = 0; i < TEST_REPLAY_BODIES; ++i) {
+        const float3 pos = {(float)i * 3.0f - 8.0f, 2.0f + (float)i, 0.0f};
+        const float3 velocity = {i % 2 == 0 ? 6.0f : -6.0f, 0.0f, 0.0f};
+        bodies[i] = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &pos);
+        rigidbody_set_velocity(transform_get_rigidbody(bodies[i]), &velocity);
+    }
+    scene_refresh(sc, 0.0, NULL);
+
+    for (int i = 0; i < TEST_REPLAY_TILES; ++i) {
+        const float3 pos = {(float)i * 0.3f - 9.0f, 0.0f, 0.0f};
+        transform_set_position_vec(tiles[i], &pos);
+    }
+    scene_refresh(sc, 0.0, NULL);
+
+    scene_set_fixed_timestep(sc, 60, 1);
+    return sc;
+}
+
+// replaying recorded inputs on a scene w/ a different r-tree history matches every tick, while a
+// different initial state is detected
+void test_replay_verify(void) {
+    Transform *bodies[TEST_REPLAY_BODIES];
+    Replay *r = replay_new(1.0 / 60.0);
+
+    Scene *sc = _test_replay_scene(bodies, 0.0f);
+    const float3 impulse = {0.0f, 8.0f, 2.0f};
+    const float3 velocity = {-3.0f, 4.0f, 0.0f};
+    for (int tick = 0; tick < 120; ++tick) {
+        if (tick == 30) {
+            replay_apply_input(r, 0, bodies[0], ReplayInput_Impulse, &impulse);
+        } else if (tick == 60) {
+            replay_apply_input(r, 3, bodies[3], ReplayInput_Velocity, &velocity);
+        }
+        replay_record_tick(r, sc, NULL);
+    }
+    TEST_CHECK(replay_is_complete(r));
+    TEST_CHECK(replay_get_ticks_count(r) == 120);
+    TEST_CHECK(replay_get_tick_hash(r, 0) != replay_get_tick_hash(r, 119));
+    scene_free(sc);
+
+    sc = _test_replay_scene(bodies, 50.0f);
+    const uint32_t mismatch = replay_verify(r, sc, _test_replay_resolve, bodies, NULL);
+    TEST_CHECK(mismatch == 120);
+    TEST_MSG("mismatch at tick %u", mismatch);
+    scene_free(sc);
+
+    sc = _test_replay_scene(bodies, 0.0f);
+    const float3 nudge = {0.0f, 0.0f, 0.001f};
+    rigidbody_set_velocity(transform_get_rigidbody(bodies[5]), &nudge);
+    TEST_CHECK(replay_verify(r, sc, _test_replay_resolve, bodies, NULL) == 0);
+    scene_free(sc);
+
+    replay_free(r);
+}
@@ -0,0 +1,333 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_rigidbody.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include "rigidBody.h"
+#include "scene.h"
+
+static Transform *_test_rigidbody_add(Scene *sc,
+                                      const RigidbodyMode mode,
+                                      const Box *collider,
+                                      const float3 *position) {
+    Transform *t = transform_new(PointTransform);
+    RigidBody *rb = NULL;
+    transform_ensure_rigidbody(t,
+                               mode,
+                               PHYSICS_GROUP_DEFAULT_OBJECT,
+                               PHYSICS_COLLIDESWITH_DEFAULT_OBJECT,
+                               &rb);
+    rigidbody_set_collider(rb, collider, true);
+    transform_set_position_vec(t, position);
+    transform_set_parent(t, scene_get_root(sc), false);
+    transform_release(t); // owned by scene hierarchy
+    return t;
+}
+
+// dynamic boxes falling on top of each other settle into a stable stack
+void test_rigidbody_stack(void) {
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+
+    const Box floor = {{-10.0f, -1.0f, -10.0f}, {10.0f, 0.0f, 10.0f}};
+    _test_rigidbody_add(sc, RigidbodyMode_Static, &floor, &float3_zero);
+
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    Transform *stack[10];
+    for (int i = 0; i < 10; ++i) {
+        const float3 pos = {0.0f, (float)i * 1.5f + 0.5f, 0.0f};
+        stack[i] = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &pos);
+    }
+
+    // cubes kept awake, the whole stack is solved every frame
+    debug_rigidbody_reset_calls();
+    for (int frame = 0; frame < 180; ++frame) {
+        for (int i = 0; i < 10; ++i) {
+            rigidbody_set_awake(transform_get_rigidbody(stack[i]));
+        }
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+#if DEBUG_RIGIDBODY_CALLS
+    // candidates are queried once for all solver iterations
+    TEST_CHECK(debug_rigidbody_get_queries() * 4 < debug_rigidbody_get_solver_iterations());
+    TEST_MSG("queries: %d, solver iterations: %d",
+             debug_rigidbody_get_queries(),
+             debug_rigidbody_get_solver_iterations());
+    TEST_CHECK(debug_rigidbody_get_islands() == 0);
+#endif
+
+    // then settled stack falls asleep as a single island, and isn't solved anymore
+    debug_rigidbody_reset_calls();
+    for (int frame = 0; frame < PHYSICS_SLEEP_FRAMES + PHYSICS_AWAKE_FRAMES; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+#if DEBUG_RIGIDBODY_CALLS
+    TEST_CHECK(debug_rigidbody_get_islands() == 1);
+    debug_rigidbody_reset_calls();
+    for (int frame = 0; frame < 60; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    TEST_CHECK(debug_rigidbody_get_solver_iterations() == 0);
+#endif
+
+    for (int i = 0; i < 10; ++i) {
+        const float3 *pos = transform_get_position(stack[i], false);
+        TEST_CHECK(fabsf(pos->y - (float)i) < (float)(i + 1) * EPSILON_CONTACT);
+        TEST_CHECK(pos->x == 0.0f && pos->z == 0.0f);
+        TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stack[i])));
+        TEST_MSG("cube %d at (%f, %f, %f)", i, (double)pos->x, (double)pos->y, (double)pos->z);
+    }
+
+    scene_free(sc);
+}
+
+// a body sliding over a floor made of many tiles stays on top of the floor, while its broadphase
+// candidates are reused across frames
+void test_rigidbody_slide(void) {
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+
+    const Box tile = {{0.0f, -1.0f, -1.0f}, {1.0f, 0.0f, 1.0f}};
+    for (int i = 0; i < 40; ++i) {
+        const float3 pos = {(float)i - 5.0f, 0.0f, 0.0f};
+        _test_rigidbody_add(sc, RigidbodyMode_Static, &tile, &pos);
+    }
+
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    Transform *t = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &float3_zero);
+    const float3 motion = {15.0f, 0.0f, 0.0f};
+    rigidbody_set_motion(transform_get_rigidbody(t), &motion);
+
+    debug_rigidbody_reset_calls();
+    for (int frame = 0; frame < 120; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+#if DEBUG_RIGIDBODY_CALLS
+    // r-tree only changes from the sliding body, trajectory leaves queried box every few frames
+    TEST_CHECK(debug_rigidbody_get_queries() < 20);
+#endif
+
+    const float3 *pos = transform_get_position(t, false);
+    TEST_CHECK(fabsf(pos->y) < EPSILON_CONTACT);
+    TEST_CHECK(pos->x > 25.0f);
+    TEST_MSG("cube at (%f, %f, %f)", (double)pos->x, (double)pos->y, (double)pos->z);
+
+    scene_free(sc);
+}
+
+// resting stacks fall asleep as islands and are skipped, while a body keeps moving elsewhere ;
+// waking up one body wakes up its whole stack only
+void test_rigidbody_islands(void) {
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+
+    const Box floor = {{-20.0f, -1.0f, -20.0f}, {20.0f, 0.0f, 20.0f}};
+    _test_rigidbody_add(sc, RigidbodyMode_Static, &floor, &float3_zero);
+
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    Transform *stacks[9][2];
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            const float3 pos = {(float)(i % 3) * 6.0f - 6.0f,
+                                (float)j * 1.5f + 0.5f,
+                                (float)(i / 3) * 6.0f - 6.0f};
+            stacks[i][j] = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &pos);
+        }
+    }
+
+    const float3 start = {-15.0f, 0.0f, -15.0f};
+    Transform *slider = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &start);
+    const float3 motion = {2.0f, 0.0f, 0.0f};
+    rigidbody_set_motion(transform_get_rigidbody(slider), &motion);
+
+    for (int frame = 0; frame < 180; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    for (int i = 0; i < 9; ++i) {
+        TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[i][0])));
+        TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[i][1])));
+    }
+    TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(slider)) == false);
+
+    // only the slider is simulated
+    debug_rigidbody_reset_calls();
+    debug_scene_reset_calls();
+    for (int frame = 0; frame < 60; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+#if DEBUG_RIGIDBODY_CALLS
+    TEST_CHECK(debug_rigidbody_get_sleeps() == 0);
+#endif
+#if DEBUG_SCENE_CALLS
+    // sleeping stacks aren't even visited, only root & slider
+    TEST_CHECK(debug_scene_get_skipped_rigidbodies() == 0);
+    TEST_CHECK(debug_scene_get_visited_transforms() == 2 * 60);
+    TEST_MSG("visited: %d", debug_scene_get_visited_transforms());
+#endif
+
+    const float3 jump = {0.0f, 5.0f, 0.0f};
+    rigidbody_set_velocity(transform_get_rigidbody(stacks[4][1]), &jump);
+    TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[4][0])) == false);
+    for (int i = 0; i < 9; ++i) {
+        if (i != 4) {
+            TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[i][0])));
+        }
+    }
+
+    // woken up stack settles back & falls asleep again
+    for (int frame = 0; frame < 180; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[4][0])));
+    TEST_CHECK(rigidbody_is_sleeping(transform_get_rigidbody(stacks[4][1])));
+    for (int i = 0; i < 9; ++i) {
+        for (int j = 0; j < 2; ++j) {
+            const float3 *pos = transform_get_position(stacks[i][j], false);
+            TEST_CHECK(fabsf(pos->y - (float)j) < (float)(j + 1) * EPSILON_CONTACT);
+            TEST_MSG("stack %d cube %d at y=%f", i, j, (double)pos->y);
+        }
+    }
+
+    scene_free(sc);
+}
+
+// scene refresh only visits branches that changed, or that are still active ; static props are left
+// alone once settled, until one of them is moved
+void test_rigidbody_visits(void) {
+    Scene *sc = scene_new(NULL);
+    const float gravity = PHYSICS_GRAVITY;
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+
+    const Box floor = {{-50.0f, -1.0f, -50.0f}, {50.0f, 0.0f, 50.0f}};
+    _test_rigidbody_add(sc, RigidbodyMode_Static, &floor, &float3_zero);
+
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    Transform *props[200];
+    for (int i = 0; i < 200; ++i) {
+        const float3 pos = {(float)(i % 20) * 4.0f - 40.0f, 0.0f, (float)(i / 20) * 4.0f - 40.0f};
+        props[i] = _test_rigidbody_add(sc, RigidbodyMode_Static, &cube, &pos);
+    }
+
+    const float3 start = {-45.0f, 0.0f, -45.0f};
+    Transform *slider = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &start);
+    const float3 motion = {2.0f, 0.0f, 0.0f};
+    rigidbody_set_motion(transform_get_rigidbody(slider), &motion);
+
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+
+#if DEBUG_SCENE_CALLS
+    // root & slider only
+    debug_scene_reset_calls();
+    for (int frame = 0; frame < 60; ++frame) {
+        scene_refresh(sc, 1.0 / 60.0, NULL);
+    }
+    TEST_CHECK(debug_scene_get_visited_transforms() == 2 * 60);
+    TEST_MSG("visited: %d", debug_scene_get_visited_transforms());
+
+    // moved prop is visited once
+    const float3 moved = {0.0f, 0.0f, 45.0f};
+    transform_set_position_vec(props[0], &moved);
+    debug_scene_reset_calls();
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+    TEST_CHECK(debug_scene_get_visited_transforms() == 2 * 2 + 1);
+    TEST_MSG("visited: %d", debug_scene_get_visited_transforms());
+#endif
+
+    // moved prop collider was updated in the r-tree
+    const float3 *pos = transform_get_position(props[0], false);
+    TEST_CHECK(pos->z == 45.0f);
+    RtreeNode *leaf = rigidbody_get_rtree_leaf(transform_get_rigidbody(props[0]));
+    TEST_CHECK(leaf != NULL && rtree_node_get_aabb(leaf)->min.z > 44.0f);
+    TEST_CHECK(transform_get_position(slider, false)->x > -44.0f);
+
+    scene_free(sc);
+}
+
+// fixed timestep simulation doesn't depend on frame delta, rendered position is interpolated
+// between the last two steps
+void test_rigidbody_fixed_timestep(void) {
+    const float gravity = PHYSICS_GRAVITY;
+    const Box cube = {{-0.5f, 0.0f, -0.5f}, {0.5f, 1.0f, 0.5f}};
+    const float3 start = {0.0f, 10.0f, 0.0f};
+    const float3 motion = {3.0f, 0.0f, 0.0f};
+
+    // same steps w/ 60 or 30 frames per second
+    Scene *scenes[2];
+    Transform *falling[2];
+    for (int i = 0; i < 2; ++i) {
+        scenes[i] = scene_new(NULL);
+        scene_set_constant_acceleration(scenes[i], NULL, &gravity, NULL);
+        scene_set_fixed_timestep(scenes[i], 60, 4);
+        falling[i] = _test_rigidbody_add(scenes[i], RigidbodyMode_Dynamic, &cube, &start);
+        rigidbody_set_motion(transform_get_rigidbody(falling[i]), &motion);
+    }
+    for (int frame = 0; frame < 120; ++frame) {
+        scene_refresh(scenes[0], 1.0 / 60.0, NULL);
+        if (frame % 2 == 0) {
+            scene_refresh(scenes[1], 1.0 / 30.0, NULL);
+        }
+    }
+    TEST_CHECK(scene_get_steps(scenes[0]) == 120 && scene_get_steps(scenes[1]) == 120);
+    const float3 *pos0 = transform_get_position(falling[0], false);
+    const float3 *pos1 = transform_get_position(falling[1], false);
+    TEST_CHECK(pos0->x == pos1->x && pos0->y == pos1->y && pos0->z == pos1->z);
+    TEST_MSG("(%f, %f) vs. (%f, %f)",
+             (double)pos0->x,
+             (double)pos0->y,
+             (double)pos1->x,
+             (double)pos1->y);
+    TEST_CHECK(pos0->y < 0.0f);
+
+    // frame taking longer than max sub-steps
+    scene_refresh(scenes[0], 1.0, NULL);
+    TEST_CHECK(scene_get_steps(scenes[0]) == 124);
+    TEST_CHECK(scene_get_interpolation_alpha(scenes[0]) == 0.0f);
+
+    scene_free(scenes[0]);
+    scene_free(scenes[1]);
+
+    // 30 steps per second w/ 60 frames per second
+    Scene *sc = scene_new(NULL);
+    scene_set_constant_acceleration(sc, NULL, &gravity, NULL);
+    scene_set_fixed_timestep(sc, 30, 4);
+    Transform *t = _test_rigidbody_add(sc, RigidbodyMode_Dynamic, &cube, &start);
+    rigidbody_set_motion(transform_get_rigidbody(t), &motion);
+
+    float3 pos, previous;
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+    TEST_CHECK(scene_get_steps(sc) == 0);
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+    TEST_CHECK(scene_get_steps(sc) == 1);
+    TEST_CHECK(scene_get_interpolation_alpha(sc) == 0.0f);
+    scene_get_interpolated_position(sc, t, &previous);
+    TEST_CHECK(float3_isEqual(&previous, &start, EPSILON_ZERO));
+
+    scene_refresh(sc, 1.0 / 60.0, NULL);
+    TEST_CHECK(scene_get_steps(sc) == 1);
+    TEST_CHECK(fabsf(scene_get_interpolation_alpha(sc) - 0.5f) < EPSILON_ZERO);
+    scene_get_interpolated_position(sc, t, &pos);
+    const float3 *current = transform_get_position(t, false);
+    TEST_CHECK(fabsf(pos.x - (previous.x + current->x) * 0.5f) < EPSILON_ZERO);
+    TEST_CHECK(fabsf(pos.y - (previous.y + current->y) * 0.5f) < EPSILON_ZERO);
+    TEST_MSG("interpolated (%f, %f), current (%f, %f)",
+             (double)pos.x,
+             (double)pos.y,
+             (double)current->x,
+             (double)current->y);
+
+    // render matrix is translated to the interpolated position
+    Matrix4x4 ltw;
+    scene_get_interpolated_ltw(sc, t, &ltw);
+    TEST_CHECK(fabsf(ltw.x4y1 - pos.x) < EPSILON_ZERO);
+    TEST_CHECK(fabsf(ltw.x4y2 - pos.y) < EPSILON_ZERO);
+    TEST_CHECK(fabsf(ltw.x4y3 - pos.z) < EPSILON_ZERO);
+
+    scene_free(sc);
+}
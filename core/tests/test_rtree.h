@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include "ray.h"
 #include "rtree.h"
 #include "transform.h"
 
@@ -25,7 +26,6 @@
 // rtree_query_overlap_func
 // rtree_query_overlap_box
 // rtree_query_cast_all_func
-// rtree_query_cast_all_ray
 // rtree_query_cast_all_box_step_func
 // rtree_query_cast_all_box
 // rtree_utils_broadphase_steps
@@ -104,3 +104,46 @@ void test_rtree_create_and_insert(void) {
     rtree_free(r);
     transform_release(t);
 }
+
+// Cast a ray through 40 aligned boxes, inserted out of order: results go beyond inline storage,
+// and are popped nearest first. Equal distances keep insertion order once sorted
+void test_rtree_query_cast_all_ray(void) {
+    Rtree *r = rtree_new(2, 4);
+    Box b;
+    for (int i = 0; i < 40; ++i) {
+        const int x = (i * 17) % 40;
+        b.min = (float3){(float)x * 2.0f, 0.0f, 0.0f};
+        b.max = (float3){(float)x * 2.0f + 1.0f, 1.0f, 1.0f};
+        rtree_create_and_insert(r, &b, 1, 1, (void *)(uintptr_t)(x + 1));
+    }
+
+    const float3 origin = {-5.0f, 0.5f, 0.5f};
+    Ray *ray = ray_new(&origin, &float3_right);
+    RtreeCastResults results;
+    rtree_cast_results_init(&results);
+    TEST_CHECK(rtree_query_cast_all_ray(r, ray, 1, 1, NULL, &results) == 40);
+    TEST_CHECK(results.count == 40);
+
+    rtree_cast_results_make_heap(&results);
+    RtreeCastResult hit;
+    uintptr_t expected = 1;
+    while (rtree_cast_results_pop_nearest(&results, &hit)) {
+        TEST_CHECK((uintptr_t)rtree_node_get_leaf_ptr(hit.rtreeLeaf) == expected);
+        TEST_CHECK(float_isEqual(hit.distance, (float)(expected - 1) * 2.0f + 5.0f, EPSILON_ZERO));
+        ++expected;
+    }
+    TEST_CHECK(expected == 41);
+
+    rtree_cast_results_clear(&results);
+    TEST_CHECK(rtree_cast_results_push(&results, NULL, 2.0f));
+    TEST_CHECK(rtree_cast_results_push(&results, rtree_get_root(r), 1.0f));
+    TEST_CHECK(rtree_cast_results_push(&results, rtree_get_root(r), 2.0f));
+    rtree_cast_results_sort(&results);
+    TEST_CHECK(results.results[0].distance == 1.0f);
+    TEST_CHECK(results.results[1].rtreeLeaf == NULL && results.results[1].order == 0);
+    TEST_CHECK(results.results[2].order == 2);
+
+    rtree_cast_results_dispose(&results);
+    ray_free(ray);
+    rtree_free(r);
+}
@@ -0,0 +1,171 @@
+// -------------------------------------------------------------
+//  Cubzh Core Unit Tests
+//  test_serialization_vox.h
+//  Created by agent on October 18, 2026.
+// -------------------------------------------------------------
+
+#pragma once
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "color_atlas.h"
+#include "color_palette.h"
+#include "serialization_vox.h"
+#include "shape.h"
+#include "stream.h"
+#include "transform.h"
+
+static Shape *_test_serialization_vox_shape(ColorAtlas *atlas,
+                                            const SHAPE_COORDS_INT_T size,
+                                            const RGBAColor color) {
+    Shape *s = shape_make_2(true);
+    ColorPalette *palette = color_palette_new(atlas);
+    SHAPE_COLOR_INDEX_INT_T entry;
+    color_palette_check_and_add_color(palette, color, &entry, false);
+    shape_set_palette(s, palette, false);
+    for (SHAPE_COORDS_INT_T x = 0; x < size; ++x) {
+        for (SHAPE_COORDS_INT_T y = 0; y < size; ++y) {
+            for (SHAPE_COORDS_INT_T z = 0; z < size; ++z) {
+                shape_add_block(s, entry, x, y, z, false);
+            }
+        }
+    }
+    return s;
+}
+
+static Shape *_test_serialization_vox_round_trip(Shape **shapes,
+                                                 const size_t nbShapes,
+                                                 ColorAtlas *atlas) {
+    FILE *fd = tmpfile();
+    TEST_ASSERT(fd != NULL);
+    TEST_ASSERT(serialization_vox_save_shapes(shapes, nbShapes, fd));
+
+    const long size = ftell(fd);
+    TEST_ASSERT(size > 0);
+    char *buf = (char *)malloc((size_t)size);
+    TEST_ASSERT(buf != NULL);
+    rewind(fd);
+    TEST_ASSERT(fread(buf, 1, (size_t)size, fd) == (size_t)size);
+    fclose(fd);
+
+    Stream *s = stream_new_buffer_read(buf, (size_t)size);
+    Shape *out = NULL;
+    TEST_CHECK(serialization_vox_load(s, &out, true, atlas) == no_error);
+    stream_free(s);
+    free(buf);
+    return out;
+}
+
+// a single model is loaded as a single shape, spanning several chunks
+void test_serialization_vox_load_single_model(void) {
+    ColorAtlas *atlas = color_atlas_new();
+    const RGBAColor red = {255, 0, 0, 255};
+    Shape *src = _test_serialization_vox_shape(atlas, 20, red);
+
+    Shape *out = _test_serialization_vox_round_trip(&src, 1, atlas);
+    TEST_ASSERT(out != NULL);
+    TEST_CHECK(shape_get_nb_blocks(out) == 20 * 20 * 20);
+    TEST_CHECK(transform_get_children_count(shape_get_root_transform(out)) == 0);
+
+    ColorPalette *palette = shape_get_palette(out);
+    TEST_CHECK(color_palette_get_count(palette) == 1);
+    const Block *b = shape_get_block(out, 19, 3, 17);
+    TEST_ASSERT(b != NULL);
+    const RGBAColor c = color_palette_get_color(palette, b->colorIndex);
+    TEST_CHECK(c.r == 255 && c.g == 0 && c.b == 0);
+
+    shape_release(src);
+    shape_release(out);
+    color_atlas_free(atlas);
+}
+
+// several models are loaded as children of an empty root shape, sharing one palette
+void test_serialization_vox_load_hierarchy(void) {
+    ColorAtlas *atlas = color_atlas_new();
+    const RGBAColor red = {255, 0, 0, 255};
+    const RGBAColor blue = {0, 0, 255, 255};
+    Shape *src[2] = {_test_serialization_vox_shape(atlas, 2, red),
+                     _test_serialization_vox_shape(atlas, 3, blue)};
+
+    Shape *out = _test_serialization_vox_round_trip(src, 2, atlas);
+    TEST_ASSERT(out != NULL);
+    TEST_CHECK(shape_get_nb_blocks(out) == 0);
+
+    Transform *root = shape_get_root_transform(out);
+    TEST_ASSERT(transform_get_children_count(root) == 2);
+
+    ColorPalette *palette = shape_get_palette(out);
+    TEST_CHECK(color_palette_get_count(palette) == 2);
+
+    size_t nbBlocks = 0;
+    DoublyLinkedListNode *n = transform_get_children_iterator(root);
+    while (n != NULL) {
+        Shape *child = (Shape *)transform_get_ptr(
+            (Transform *)doubly_linked_list_node_pointer(n));
+        TEST_ASSERT(child != NULL);
+        TEST_CHECK(shape_get_palette(child) == palette);
+        nbBlocks += shape_get_nb_blocks(child);
+        n = doubly_linked_list_node_next(n);
+    }
+    TEST_CHECK(nbBlocks == 2 * 2 * 2 + 3 * 3 * 3);
+
+    shape_release(src[0]);
+    shape_release(src[1]);
+    shape_release(out);
+    color_atlas_free(atlas);
+}
+
+static size_t _test_serialization_vox_write_uint32(uint8_t *cursor, const uint32_t v) {
+    cursor[0] = (uint8_t)(v & 0xFF);
+    cursor[1] = (uint8_t)((v >> 8) & 0xFF);
+    cursor[2] = (uint8_t)((v >> 16) & 0xFF);
+    cursor[3] = (uint8_t)((v >> 24) & 0xFF);
+    return 4;
+}
+
+static size_t _test_serialization_vox_write_chunk_header(uint8_t *cursor,
+                                                         const char *id,
+                                                         const uint32_t contentBytes,
+                                                         const uint32_t childrenBytes) {
+    memcpy(cursor, id, 4);
+    size_t n = 4;
+    n += _test_serialization_vox_write_uint32(cursor + n, contentBytes);
+    n += _test_serialization_vox_write_uint32(cursor + n, childrenBytes);
+    return n;
+}
+
+// several models without scene graph nodes can't be placed, loading fails instead of dropping
+// all models but the first one
+void test_serialization_vox_load_models_without_scene_graph(void) {
+    // header, MAIN, then 2 x (SIZE + XYZI with 1 voxel)
+    const uint32_t modelBytes = (12 + 12) + (12 + 8);
+    uint8_t buf[8 + 12 + 2 * (12 + 12 + 12 + 8)];
+    size_t n = 0;
+    memcpy(buf, "VOX ", 4);
+    n += 4;
+    n += _test_serialization_vox_write_uint32(buf + n, 150);
+    n += _test_serialization_vox_write_chunk_header(buf + n, "MAIN", 0, 2 * modelBytes);
+    for (int i = 0; i < 2; ++i) {
+        n += _test_serialization_vox_write_chunk_header(buf + n, "SIZE", 12, 0);
+        n += _test_serialization_vox_write_uint32(buf + n, 1);
+        n += _test_serialization_vox_write_uint32(buf + n, 1);
+        n += _test_serialization_vox_write_uint32(buf + n, 1);
+        n += _test_serialization_vox_write_chunk_header(buf + n, "XYZI", 8, 0);
+        n += _test_serialization_vox_write_uint32(buf + n, 1);
+        const uint8_t voxel[4] = {0, 0, 0, 1};
+        memcpy(buf + n, voxel, 4);
+        n += 4;
+    }
+    TEST_ASSERT(n == sizeof(buf));
+
+    ColorAtlas *atlas = color_atlas_new();
+    Stream *s = stream_new_buffer_read((char *)buf, n);
+    Shape *out = NULL;
+    TEST_CHECK(serialization_vox_load(s, &out, true, atlas) == pack_chunk_found);
+    TEST_CHECK(out == NULL);
+
+    stream_free(s);
+    color_atlas_free(atlas);
+}
@@ -177,6 +177,45 @@ void test_shape_make_copy(void) {
     shape_free((Shape *const)copy);
 }
 
+// check that chunks shared between a shape and its copy are copied on first write
+void test_shape_make_copy_shared_chunks(void) {
+    Shape *src = shape_make_2(true);
+    ColorAtlas *atlas = color_atlas_new();
+    shape_set_palette(src, color_palette_new(atlas), false);
+    shape_add_block(src, 1, 0, 0, 0, true);
+    shape_add_block(src, 1, 1, 0, 0, true);
+    shape_add_block(src, 1, CHUNK_SIZE, 0, 0, true);
+    shape_apply_current_transaction(src, true);
+
+    Shape *copy = shape_make_copy(src);
+    Chunk *c = NULL;
+    shape_get_chunk_and_coordinates(copy, coords3_zero, &c, NULL, NULL);
+    TEST_ASSERT(c != NULL);
+    TEST_CHECK(chunk_is_shared(c));
+
+    // write on copy
+    TEST_CHECK(shape_remove_block(copy, 0, 0, 0));
+    TEST_CHECK(chunk_is_shared(c) == false);
+    TEST_CHECK(shape_get_block(copy, 0, 0, 0)->colorIndex == SHAPE_COLOR_INDEX_AIR_BLOCK);
+    TEST_CHECK(block_is_solid(shape_get_block(src, 0, 0, 0)));
+
+    // write on origin, in the chunk that is still shared
+    shape_get_chunk_and_coordinates(copy, (SHAPE_COORDS_INT3_T){CHUNK_SIZE, 0, 0}, &c, NULL, NULL);
+    TEST_ASSERT(c != NULL);
+    TEST_CHECK(chunk_is_shared(c));
+    const SHAPE_COLOR_INDEX_INT_T color = shape_get_block(src, CHUNK_SIZE, 0, 0)->colorIndex;
+    TEST_CHECK(shape_paint_block(src, color + 1, CHUNK_SIZE, 0, 0));
+    TEST_CHECK(chunk_is_shared(c) == false);
+    TEST_CHECK(shape_get_block(src, CHUNK_SIZE, 0, 0)->colorIndex == color + 1);
+    TEST_CHECK(shape_get_block(copy, CHUNK_SIZE, 0, 0)->colorIndex == color);
+
+    shape_release(src);
+    TEST_CHECK(shape_get_nb_blocks(copy) == 2);
+    TEST_CHECK(block_is_solid(shape_get_block(copy, 1, 0, 0)));
+    shape_release(copy);
+    color_atlas_free(atlas);
+}
+
 // check that we can retain a shape
 void test_shape_retain(void) {
     Shape *s = shape_make();
@@ -206,9 +245,10 @@ void test_shape_release(void) {
 // check for coherent id
 void test_shape_get_id(void) {
     const Shape *s = shape_make();
-    const uint16_t id = shape_get_id(s);
+    const TransformID id = shape_get_id(s);
 
-    TEST_CHECK(id < 1000);
+    TEST_CHECK(id != TRANSFORM_ID_NONE);
+    TEST_CHECK(transform_get_by_id(id) == shape_get_root_transform(s));
 
     shape_free((Shape *const)s);
 }
@@ -551,3 +591,119 @@ void test_shape_addblock_3(void) {
     shape_free((Shape *const)sh);
     scene_free(sc);
 }
+
+// fills a box spanning several chunks, then carves & paints it using bulk edits
+void test_shape_bulk_edit(void) {
+    Shape *sh = shape_make_2(true);
+    ColorAtlas *atlas = color_atlas_new();
+    TEST_ASSERT(atlas != NULL);
+    shape_set_palette(sh, color_palette_new(atlas), false);
+    SHAPE_COLOR_INDEX_INT_T COLOR1, COLOR2;
+    {
+        ColorPalette *palette = shape_get_palette(sh);
+        const RGBAColor color1 = {.r = 1, .g = 1, .b = 1, .a = 255};
+        const RGBAColor color2 = {.r = 2, .g = 2, .b = 2, .a = 255};
+        TEST_ASSERT(color_palette_check_and_add_color(palette, color1, &COLOR1, false));
+        TEST_ASSERT(color_palette_check_and_add_color(palette, color2, &COLOR2, false));
+    }
+    int3 size;
+
+    // 20x20x20 box across 8 chunks
+    size_t changed = shape_bulk_edit_box(sh,
+                                         NULL,
+                                         (SHAPE_COORDS_INT3_T){0, 0, 0},
+                                         (SHAPE_COORDS_INT3_T){19, 19, 19},
+                                         COLOR1,
+                                         SHAPE_BULK_EDIT_ADD);
+    TEST_CHECK(changed == 8000);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 8000);
+    TEST_CHECK(shape_get_nb_chunks(sh) == 8);
+    shape_get_bounding_box_size(sh, &size);
+    TEST_CHECK(size.x == 20 && size.y == 20 && size.z == 20);
+
+    // adding again in the same area changes nothing
+    changed = shape_bulk_edit_box(sh,
+                                  NULL,
+                                  (SHAPE_COORDS_INT3_T){0, 0, 0},
+                                  (SHAPE_COORDS_INT3_T){3, 3, 3},
+                                  COLOR2,
+                                  SHAPE_BULK_EDIT_ADD);
+    TEST_CHECK(changed == 0);
+
+    // remove one block only, at the center of the box
+    changed = shape_bulk_edit_sphere(sh,
+                                     NULL,
+                                     (SHAPE_COORDS_INT3_T){8, 8, 8},
+                                     0.5f,
+                                     0,
+                                     SHAPE_BULK_EDIT_REMOVE);
+    TEST_CHECK(changed == 1);
+    TEST_CHECK(block_is_solid(shape_get_block(sh, 8, 8, 8)) == false);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 7999);
+
+    // paint a list of blocks, including an empty one that must be skipped
+    const SHAPE_COORDS_INT3_T coords[3] = {{0, 0, 0}, {8, 8, 8}, {19, 19, 19}};
+    changed = shape_bulk_edit_blocks(sh, NULL, coords, NULL, 3, COLOR2, SHAPE_BULK_EDIT_PAINT);
+    TEST_CHECK(changed == 2);
+    TEST_CHECK(shape_get_block(sh, 0, 0, 0)->colorIndex == COLOR2);
+    TEST_CHECK(shape_get_block(sh, 19, 19, 19)->colorIndex == COLOR2);
+    TEST_CHECK(color_palette_get_color_use_count(shape_get_palette(sh), COLOR2) == 2);
+    TEST_CHECK(color_palette_get_color_use_count(shape_get_palette(sh), COLOR1) == 7997);
+
+    // removing a face of the box shrinks bounding box
+    changed = shape_bulk_edit_box(sh,
+                                  NULL,
+                                  (SHAPE_COORDS_INT3_T){0, 0, 0},
+                                  (SHAPE_COORDS_INT3_T){19, 19, 0},
+                                  0,
+                                  SHAPE_BULK_EDIT_REMOVE);
+    TEST_CHECK(changed == 400);
+    shape_get_bounding_box_size(sh, &size);
+    TEST_CHECK(size.x == 20 && size.y == 20 && size.z == 19);
+
+    shape_free(sh);
+    color_atlas_free(atlas);
+}
+
+// bulk edits are recorded in history and can be undone/redone
+void test_shape_bulk_edit_history(void) {
+    Shape *sh = shape_make_2(true);
+    ColorAtlas *atlas = color_atlas_new();
+    TEST_ASSERT(atlas != NULL);
+    shape_set_palette(sh, color_palette_new(atlas), false);
+    shape_history_setEnabled(sh, true);
+
+    shape_bulk_edit_box(sh,
+                        NULL,
+                        (SHAPE_COORDS_INT3_T){0, 0, 0},
+                        (SHAPE_COORDS_INT3_T){31, 0, 0},
+                        1,
+                        SHAPE_BULK_EDIT_ADD);
+    shape_bulk_edit_box(sh,
+                        NULL,
+                        (SHAPE_COORDS_INT3_T){0, 0, 0},
+                        (SHAPE_COORDS_INT3_T){15, 0, 0},
+                        2,
+                        SHAPE_BULK_EDIT_REPLACE);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 32);
+    TEST_CHECK(shape_get_block(sh, 0, 0, 0)->colorIndex == 2);
+
+    TEST_CHECK(shape_history_canUndo(sh));
+    shape_history_undo(sh);
+    TEST_CHECK(shape_get_block(sh, 0, 0, 0)->colorIndex == 1);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 32);
+
+    shape_history_undo(sh);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 0);
+    TEST_CHECK(shape_history_canUndo(sh) == false);
+
+    TEST_CHECK(shape_history_canRedo(sh));
+    shape_history_redo(sh);
+    shape_history_redo(sh);
+    TEST_CHECK(shape_get_nb_blocks(sh) == 32);
+    TEST_CHECK(shape_get_block(sh, 15, 0, 0)->colorIndex == 2);
+    TEST_CHECK(shape_get_block(sh, 16, 0, 0)->colorIndex == 1);
+
+    shape_free(sh);
+    color_atlas_free(atlas);
+}
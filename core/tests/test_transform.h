@@ -263,3 +263,131 @@ void test_transform_flush(void) {
     transform_release(c);
     transform_release(p);
 }
+
+// check that a batch refresh only recomputes dirty subtrees, and matches per-transform refresh
+void test_transform_refresh_hierarchy(void) {
+    Transform *root = transform_new(HierarchyTransform);
+    Transform *a = transform_new(HierarchyTransform);
+    Transform *b = transform_new(HierarchyTransform);
+    Transform *a1 = transform_new(HierarchyTransform);
+    Transform *a2 = transform_new(HierarchyTransform);
+    transform_set_parent(a, root, false);
+    transform_set_parent(b, root, false);
+    transform_set_parent(a1, a, false);
+    transform_set_parent(a2, a1, false);
+
+    transform_set_local_position(root, 1.0f, 0.0f, 0.0f);
+    transform_set_local_position(a, 0.0f, 2.0f, 0.0f);
+    transform_set_local_rotation_euler(a, 0.0f, PI_F * 0.5f, 0.0f);
+    transform_set_local_scale(a1, 2.0f, 2.0f, 2.0f);
+    transform_set_local_position(a2, 0.0f, 0.0f, 3.0f);
+
+    TEST_CHECK(transform_refresh_hierarchy(root, false) == 5);
+    TEST_CHECK(transform_refresh_hierarchy(root, false) == 0);
+
+    // a2 world position: root + a (rotated 90° around Y) applied to a1 scaled local position
+    const float3 expected = {7.0f, 2.0f, 0.0f};
+    const Matrix4x4 *ltw = transform_get_ltw(a2);
+    const float3 pos = {ltw->x4y1, ltw->x4y2, ltw->x4y3};
+    TEST_CHECK(float3_isEqual(&pos, &expected, EPSILON_ZERO));
+    TEST_CHECK(float3_isEqual(transform_get_position(a2, false), &expected, EPSILON_ZERO));
+
+    Matrix4x4 wtl = *ltw;
+    matrix4x4_op_invert(&wtl);
+    const float *w1 = (const float *)&wtl, *w2 = (const float *)transform_get_wtl(a2);
+    for (int i = 0; i < 16; ++i) {
+        TEST_CHECK(float_isEqual(w1[i], w2[i], EPSILON_ZERO));
+    }
+
+    // only a's subtree is refreshed
+    transform_set_local_position(a, 0.0f, 5.0f, 0.0f);
+    TEST_CHECK(transform_refresh_hierarchy(root, false) == 3);
+    TEST_CHECK(float_isEqual(transform_get_position(a2, false)->y, 5.0f, EPSILON_ZERO));
+
+    // up-to-date transform with dirty children, eg. after an intra-frame refresh
+    transform_set_local_position(a1, 1.0f, 0.0f, 0.0f);
+    transform_refresh(a1, false, true);
+    TEST_CHECK(transform_refresh_hierarchy(root, false) == 2);
+
+    transform_release(a2);
+    transform_release(a1);
+    transform_release(b);
+    transform_release(a);
+    transform_release(root);
+}
+
+// check that flagged children are listed in flagging order, and that clean ones aren't listed
+void test_transform_branch_dirty(void) {
+    Transform *root = transform_new(HierarchyTransform);
+    Transform *other = transform_new(HierarchyTransform);
+    Transform *children[100];
+    for (int i = 0; i < 100; ++i) {
+        children[i] = transform_new(PointTransform);
+        transform_set_parent(children[i], root, false);
+        transform_release(children[i]); // owned by root
+    }
+    transform_refresh_hierarchy(root, false);
+    for (int i = 0; i < 100; ++i) {
+        transform_reset_branch_dirty(children[i]);
+    }
+    transform_reset_branch_dirty(root);
+    TEST_CHECK(transform_get_first_branch_dirty_child(root) == NULL);
+
+    transform_set_local_position(children[42], 1.0f, 0.0f, 0.0f);
+    transform_set_branch_dirty(children[7]);
+    transform_set_local_position(children[42], 2.0f, 0.0f, 0.0f);
+    TEST_CHECK(transform_is_branch_dirty(root));
+    TEST_CHECK(transform_get_first_branch_dirty_child(root) == children[42]);
+    TEST_CHECK(transform_get_next_branch_dirty_sibling(children[42]) == children[7]);
+    TEST_CHECK(transform_get_next_branch_dirty_sibling(children[7]) == NULL);
+
+    // flagged branch follows its transform to a new parent
+    transform_set_parent(children[42], other, false);
+    TEST_CHECK(transform_get_first_branch_dirty_child(root) == children[7]);
+    TEST_CHECK(transform_get_first_branch_dirty_child(other) == children[42]);
+    TEST_CHECK(transform_is_branch_dirty(other));
+
+    transform_reset_branch_dirty(children[7]);
+    TEST_CHECK(transform_get_first_branch_dirty_child(root) == NULL);
+
+    transform_release(other);
+    transform_release(root);
+}
+
+// check that IDs are O(1) lookups, that stale IDs are detected, and that more than 65,535
+// transforms can exist at once
+void test_transform_id(void) {
+    Transform *t = transform_new(HierarchyTransform);
+    TEST_ASSERT(t != NULL);
+    const TransformID id = transform_get_id(t);
+    TEST_CHECK(id != TRANSFORM_ID_NONE);
+    TEST_CHECK(transform_get_by_id(id) == t);
+    TEST_CHECK(transform_get_by_id(TRANSFORM_ID_NONE) == NULL);
+
+    transform_release(t);
+    TEST_CHECK(transform_get_by_id(id) == NULL);
+
+    // slot is reused, with a new generation
+    t = transform_new(HierarchyTransform);
+    TEST_CHECK(transform_get_id(t) != id);
+    TEST_CHECK(transform_get_by_id(id) == NULL);
+    TEST_CHECK(transform_get_by_id(transform_get_id(t)) == t);
+    transform_release(t);
+
+    const size_t count = 70000;
+    Transform **transforms = (Transform **)malloc(count * sizeof(Transform *));
+    TEST_ASSERT(transforms != NULL);
+    for (size_t i = 0; i < count; ++i) {
+        transforms[i] = transform_new(HierarchyTransform);
+        TEST_ASSERT(transforms[i] != NULL);
+    }
+    bool valid = true;
+    for (size_t i = 0; i < count; ++i) {
+        valid = valid && transform_get_by_id(transform_get_id(transforms[i])) == transforms[i];
+    }
+    TEST_CHECK(valid);
+    for (size_t i = 0; i < count; ++i) {
+        transform_release(transforms[i]);
+    }
+    free(transforms);
+}
@@ -11,11 +11,12 @@
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
+#if defined(__VX_PLATFORM_WINDOWS)
+#include <windows.h>
+#endif
 
 #include "cclog.h"
 #include "config.h"
-#include "filo_list_uint16.h"
-#include "mutex.h"
 #include "quad.h"
 #include "scene.h"
 #include "utils.h"
@@ -46,6 +47,9 @@
 #define TRANSFORM_FLAG_ANIMATIONS 8
 // helper to debug a specific transform
 #define TRANSFORM_FLAG_DEBUG 16
+// this transform or any of its descendants changed, or needs to be visited by next scene refresh ;
+// always set on all ancestors of a flagged transform
+#define TRANSFORM_FLAG_BRANCH 32
 
 #if DEBUG_TRANSFORM
 static int debug_transform_refresh_calls = 0;
@@ -55,14 +59,28 @@ struct _Transform {
 
     // local-to-world and world-to-local matrices for the children of this Transform
     // changing any transformation will flag these matrices dirty
-    Matrix4x4 *ltw;
-    Matrix4x4 *wtl;
-    Matrix4x4 *mtx;
+    // note: matrices & rotations are stored inline, everything read or written by a refresh is
+    // contiguous, and starts on a 16-bytes boundary
+    Matrix4x4 ltw;
+    Matrix4x4 wtl;
+    Matrix4x4 mtx;
+
+    // SET any LOCAL or WORLD transformation will flag as dirty its counterpart & the matrices, and
+    // unflag itself
+    Quaternion localRotation; /* 20 bytes */
+    Quaternion rotation;      /* 20 bytes */
+    float3 localPosition;
+    float3 position;
+    float3 localScale;
 
     // transforms hierarchy
     Transform *parent; // self is retained for hierarchy ref count when parent is set
     size_t childrenCount;
     DoublyLinkedList *children; // here for recursion down hierarchy & for helpers
+    // children w/ a flagged branch, in flagging order, so that clean children are never scanned
+    Transform *branchFirst, *branchLast;
+    // links in parent's list of flagged children, set while TRANSFORM_FLAG_BRANCH is on
+    Transform *branchPrev, *branchNext;
 
     // defined if the transform is part of the physics simulation
     RigidBody *rigidBody;
@@ -82,48 +100,166 @@ struct _Transform {
     // if managed, transform_destroyed_callback is called w/ this ptr as parameter
     void *managed;
 
-    // SET any LOCAL or WORLD transformation will flag as dirty its counterpart & the matrices, and
-    // unflag itself
-    Quaternion *localRotation;
-    Quaternion *rotation;
-    float3 localPosition;
-    float3 position;
-    float3 localScale; /* + 4 bytes here */
-
     // optionally set a type to this transform
     TransformType type; /* 4 bytes */
 
     float shadowDecalSize; /* 4 bytes */
 
+    TransformID id; /* 4 bytes */
+
     // Transforms are managed with reference counting.
     uint16_t refCount; /* 2 bytes */
 
-    uint16_t id; /* 2 bytes */
-
     // dirty flag per transformation type, use the TRANSFORM_* defines
     // GET a dirty transformation will refresh what is necessary to compute it
     uint8_t dirty; /* 1 byte */
 
     uint8_t flags; /* 1 byte */
-
-    char pad[6];
 };
 
-static Mutex *_IDMutex = NULL;
-static uint16_t _nextID = 1;
-static FiloListUInt16 *_availableIDs = NULL;
+#define TRANSFORM_BATCH_INITIAL_CAPACITY 256
+
+// transforms gathered for a hierarchy refresh, ordered by depth ; per-node data is kept in
+// separate arrays, streamed through by the refresh pass
+typedef struct {
+    Transform **nodes;
+    uint8_t *dirty; // whether each node's ltw changes, its children must follow
+    uint32_t count, capacity;
+} _TransformBatch;
+
+// IDs are made of a slot index (lower bits) and the generation of that slot, incremented each time
+// the ID is recycled so that stale IDs can be detected. Slots are allocated by segments, which are
+// never freed nor moved, lookup by ID is 2 indirections.
+#define TRANSFORM_ID_INDEX_BITS 20
+#define TRANSFORM_ID_INDEX_MASK ((1u << TRANSFORM_ID_INDEX_BITS) - 1)
+#define TRANSFORM_ID_GENERATION_MASK ((1u << (32 - TRANSFORM_ID_INDEX_BITS)) - 1)
+#define TRANSFORM_ID_SEGMENT_BITS 10
+#define TRANSFORM_ID_SEGMENT_SIZE (1u << TRANSFORM_ID_SEGMENT_BITS)
+#define TRANSFORM_ID_NB_SEGMENTS (1u << (TRANSFORM_ID_INDEX_BITS - TRANSFORM_ID_SEGMENT_BITS))
+
+typedef struct {
+    Transform *ptr;      // NULL if ID isn't in use, or transform was freed and ID not recycled yet
+    uint32_t generation; // current generation, only IDs w/ this generation are valid
+    uint32_t nextFree;   // next slot index in free list, 0 for none
+} _TransformSlot;
+
+#if defined(__VX_PLATFORM_WINDOWS)
+
+static inline uint32_t _atomic_load_uint32(uint32_t *p) {
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)p, 0, 0);
+}
+static inline void _atomic_store_uint32(uint32_t *p, const uint32_t v) {
+    InterlockedExchange((volatile LONG *)p, (LONG)v);
+}
+static inline uint32_t _atomic_fetch_add_uint32(uint32_t *p, const uint32_t v) {
+    return (uint32_t)InterlockedExchangeAdd((volatile LONG *)p, (LONG)v);
+}
+static inline bool _atomic_compare_exchange_uint32(uint32_t *p,
+                                                   const uint32_t expected,
+                                                   const uint32_t desired) {
+    return (uint32_t)InterlockedCompareExchange((volatile LONG *)p, (LONG)desired, (LONG)expected) ==
+           expected;
+}
+static inline uint64_t _atomic_load_uint64(uint64_t *p) {
+    return (uint64_t)InterlockedCompareExchange64((volatile LONG64 *)p, 0, 0);
+}
+/// on failure, expected is set to current value
+static inline bool _atomic_compare_exchange_uint64(uint64_t *p,
+                                                   uint64_t *expected,
+                                                   const uint64_t desired) {
+    const uint64_t prev = (uint64_t)
+        InterlockedCompareExchange64((volatile LONG64 *)p, (LONG64)desired, (LONG64)*expected);
+    if (prev == *expected) {
+        return true;
+    }
+    *expected = prev;
+    return false;
+}
+static inline void *_atomic_load_ptr(void **p) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)p, NULL, NULL);
+}
+static inline void _atomic_store_ptr(void **p, void *v) {
+    InterlockedExchangePointer((PVOID volatile *)p, v);
+}
+static inline bool _atomic_compare_exchange_ptr(void **p, void *expected, void *desired) {
+    return InterlockedCompareExchangePointer((PVOID volatile *)p, desired, expected) == expected;
+}
+
+#else // non-Windows platforms, GCC/Clang builtins
+
+static inline uint32_t _atomic_load_uint32(uint32_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void _atomic_store_uint32(uint32_t *p, const uint32_t v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline uint32_t _atomic_fetch_add_uint32(uint32_t *p, const uint32_t v) {
+    return __atomic_fetch_add(p, v, __ATOMIC_ACQ_REL);
+}
+static inline bool _atomic_compare_exchange_uint32(uint32_t *p,
+                                                   uint32_t expected,
+                                                   const uint32_t desired) {
+    return __atomic_compare_exchange_n(p,
+                                       &expected,
+                                       desired,
+                                       false,
+                                       __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+static inline uint64_t _atomic_load_uint64(uint64_t *p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+/// on failure, expected is set to current value
+static inline bool _atomic_compare_exchange_uint64(uint64_t *p,
+                                                   uint64_t *expected,
+                                                   const uint64_t desired) {
+    return __atomic_compare_exchange_n(p,
+                                       expected,
+                                       desired,
+                                       false,
+                                       __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+static inline void *_atomic_load_ptr(void **p) {
+    return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+static inline void _atomic_store_ptr(void **p, void *v) {
+    __atomic_store_n(p, v, __ATOMIC_RELEASE);
+}
+static inline bool _atomic_compare_exchange_ptr(void **p, void *expected, void *desired) {
+    return __atomic_compare_exchange_n(p,
+                                       &expected,
+                                       desired,
+                                       false,
+                                       __ATOMIC_ACQ_REL,
+                                       __ATOMIC_ACQUIRE);
+}
+
+#endif // defined(__VX_PLATFORM_WINDOWS)
+
+// slot 0 is never used, so that TRANSFORM_ID_NONE is never valid
+static _TransformSlot *_slotSegments[TRANSFORM_ID_NB_SEGMENTS] = {NULL};
+static uint32_t _nextSlotIndex = 1;
+
+// free list of recycled slots, lock-free stack: head slot index in lower 32 bits, incremented
+// tag in upper 32 bits so that a head popped & pushed back concurrently can't be mistaken (ABA)
+static uint64_t _freeSlots = 0;
 
 static pointer_transform_destroyed_func transform_destroyed_callback = NULL;
 
 // MARK: - Private functions' prototypes -
 
-static uint16_t _transform_get_valid_id(void);
-static void _transform_recycle_id(const uint16_t id);
+static TransformID _transform_get_valid_id(Transform *t);
+static void _transform_recycle_id(const TransformID id);
+static _TransformSlot *_transform_get_slot(const uint32_t index);
 static void _transform_set_dirty(Transform *const t, const uint8_t flag, bool keepCache);
 static void _transform_reset_dirty(Transform *const t, const uint8_t flag);
 static bool _transform_get_dirty(Transform *const t, const uint8_t flag);
 static void _transform_toggle_flag(Transform *const t, const uint8_t flag, const bool toggle);
 static bool _transform_get_flag(Transform *const t, const uint8_t flag);
+static void _transform_flag_branch(Transform *t);
+static void _transform_link_branch(Transform *t);
+static void _transform_unlink_branch(Transform *t);
 static bool _transform_check_and_refresh_parents(Transform *const t);
 static void _transform_refresh_local_position(Transform *t);
 static void _transform_refresh_position(Transform *t);
@@ -162,6 +298,8 @@ static void _transform_utils_box_to_aabox_full(Transform *t,
                                                Box *aab,
                                                const float3 *offset,
                                                SquarifyType squarify);
+static bool _transform_batch_reserve(_TransformBatch *b, uint32_t capacity);
+static void _transform_batch_free(_TransformBatch *b);
 static void _transform_free(Transform *const t);
 
 // MARK: - Lifecycle -
@@ -172,19 +310,27 @@ Transform *transform_new(TransformType type) {
         return NULL;
     }
 
-    t->id = _transform_get_valid_id();
+    t->id = _transform_get_valid_id(t);
+    if (t->id == TRANSFORM_ID_NONE) {
+        free(t);
+        return NULL;
+    }
     t->refCount = 1;
-    t->ltw = matrix4x4_new_identity();
-    t->wtl = matrix4x4_new_identity();
-    t->mtx = matrix4x4_new_identity();
-    t->localRotation = quaternion_new_identity();
-    t->rotation = quaternion_new_identity();
+    t->ltw = matrix4x4_identity;
+    t->wtl = matrix4x4_identity;
+    t->mtx = matrix4x4_identity;
+    t->localRotation = quaternion_identity;
+    t->rotation = quaternion_identity;
     float3_set_zero(&t->localPosition);
     float3_set_zero(&t->position);
     float3_set_one(&t->localScale);
     t->parent = NULL;
     t->childrenCount = 0;
     t->children = doubly_linked_list_new();
+    t->branchFirst = NULL;
+    t->branchLast = NULL;
+    t->branchPrev = NULL;
+    t->branchNext = NULL;
     t->dirty = TRANSFORM_DIRTY_NONE;
     t->flags = TRANSFORM_FLAG_ANIMATIONS;
     t->ptr = NULL;
@@ -207,20 +353,29 @@ Transform *transform_new_with_ptr(TransformType type, void *ptr, pointer_free_fu
 }
 
 void transform_init_ID_thread_safety(void) {
-    if (_IDMutex != NULL) {
-        cclog_error("transform: thread safety initialized more than once");
-        return;
-    }
-    _IDMutex = mutex_new();
-    if (_IDMutex == NULL) {
-        cclog_error("transform: failed to init thread safety");
-    }
+    // IDs allocation is lock-free, nothing to initialize
 }
 
-uint16_t transform_get_id(const Transform *t) {
+TransformID transform_get_id(const Transform *t) {
     return t->id;
 }
 
+Transform *transform_get_by_id(const TransformID id) {
+    const uint32_t index = id & TRANSFORM_ID_INDEX_MASK;
+    const uint32_t generation = id >> TRANSFORM_ID_INDEX_BITS;
+    if (index == 0) {
+        return NULL;
+    }
+    _TransformSlot *slot = _transform_get_slot(index);
+    if (slot == NULL || _atomic_load_uint32(&slot->generation) != generation) {
+        return NULL;
+    }
+    Transform *t = (Transform *)_atomic_load_ptr((void **)&slot->ptr);
+
+    // ID may have been recycled & reused in the meantime
+    return _atomic_load_uint32(&slot->generation) == generation ? t : NULL;
+}
+
 bool transform_retain(Transform *const t) {
     if (t->refCount < UINT16_MAX) {
         ++(t->refCount);
@@ -243,11 +398,11 @@ bool transform_release(Transform *t) {
 }
 
 void transform_flush(Transform *t) {
-    matrix4x4_set_scale(t->ltw, 1.0f);
-    matrix4x4_set_scale(t->wtl, 1.0f);
-    matrix4x4_set_scale(t->mtx, 1.0f);
-    quaternion_set_identity(t->localRotation);
-    quaternion_set_identity(t->rotation);
+    matrix4x4_set_scale(&t->ltw, 1.0f);
+    matrix4x4_set_scale(&t->wtl, 1.0f);
+    matrix4x4_set_scale(&t->mtx, 1.0f);
+    quaternion_set_identity(&t->localRotation);
+    quaternion_set_identity(&t->rotation);
     float3_set_zero(&t->localPosition);
     float3_set_zero(&t->position);
     float3_set_one(&t->localScale);
@@ -297,10 +452,101 @@ void transform_refresh(Transform *t, bool hierarchyDirty, bool refreshParents) {
     _transform_refresh_matrices(t, hierarchyDirty);
 }
 
+size_t transform_refresh_hierarchy(Transform *root, bool hierarchyDirty) {
+    if (root == NULL) {
+        return 0;
+    }
+
+    _TransformBatch batch = {NULL, NULL, 0, 0};
+    if (_transform_batch_reserve(&batch, TRANSFORM_BATCH_INITIAL_CAPACITY) == false) {
+        _transform_batch_free(&batch);
+        return 0;
+    }
+
+    // (1) gather hierarchy breadth-first, transforms are ordered by depth. All children of a dirty
+    // transform are gathered, otherwise only flagged branches may contain dirty transforms
+    batch.nodes[0] = root;
+    batch.dirty[0] = hierarchyDirty ? 1 : 0;
+    batch.count = 1;
+
+    DoublyLinkedListNode *n;
+    Transform *t, *child;
+    uint32_t required;
+    bool dirty;
+    for (uint32_t i = 0; i < batch.count; ++i) {
+        t = batch.nodes[i];
+        dirty = batch.dirty[i] != 0 ||
+                _transform_get_dirty(t, TRANSFORM_DIRTY_MTX | TRANSFORM_DIRTY_CHILDREN);
+        batch.dirty[i] = dirty ? 1 : 0;
+
+        required = batch.count + (uint32_t)t->childrenCount;
+        if (_transform_batch_reserve(&batch, required) == false) {
+            _transform_batch_free(&batch);
+            return 0;
+        }
+        if (dirty) {
+            n = doubly_linked_list_first(t->children);
+            while (n != NULL) {
+                batch.nodes[batch.count] = (Transform *)doubly_linked_list_node_pointer(n);
+                batch.dirty[batch.count] = 1;
+                ++batch.count;
+                n = doubly_linked_list_node_next(n);
+            }
+        } else {
+            child = t->branchFirst;
+            while (child != NULL) {
+                batch.nodes[batch.count] = child;
+                batch.dirty[batch.count] = 0;
+                ++batch.count;
+                child = child->branchNext;
+            }
+        }
+    }
+
+    // (2) one linear pass, parents are always refreshed before their children. A refreshed
+    // transform dirties its children hierarchy, as transform_set_children_dirty would
+    size_t refreshed = 0;
+    for (uint32_t i = 0; i < batch.count; ++i) {
+        t = batch.nodes[i];
+        if (batch.dirty[i] != 0) {
+            _transform_refresh_local_position(t);
+            _transform_refresh_local_rotation(t);
+            _transform_refresh_matrices(t, true);
+            ++refreshed;
+        }
+        _transform_reset_dirty(t, TRANSFORM_DIRTY_CHILDREN);
+    }
+
+    _transform_batch_free(&batch);
+
+    return refreshed;
+}
+
 void transform_set_children_dirty(Transform *t) {
     _transform_set_dirty(t, TRANSFORM_DIRTY_CHILDREN, false);
 }
 
+void transform_set_branch_dirty(Transform *t) {
+    _transform_flag_branch(t);
+}
+
+void transform_reset_branch_dirty(Transform *t) {
+    _transform_unlink_branch(t);
+    _transform_toggle_flag(t, TRANSFORM_FLAG_BRANCH, false);
+}
+
+bool transform_is_branch_dirty(Transform *t) {
+    return _transform_get_flag(t, TRANSFORM_FLAG_BRANCH);
+}
+
+Transform *transform_get_first_branch_dirty_child(Transform *t) {
+    return t->branchFirst;
+}
+
+Transform *transform_get_next_branch_dirty_sibling(Transform *t) {
+    return t->branchNext;
+}
+
 void transform_reset_children_dirty(Transform *t) {
     _transform_reset_dirty(t, TRANSFORM_DIRTY_CHILDREN);
 }
@@ -355,6 +601,7 @@ bool transform_ensure_rigidbody(Transform *t,
     bool isNew = false;
     if (t->rigidBody == NULL) {
         t->rigidBody = rigidbody_new(mode, groups, collidesWith);
+        rigidbody_set_transform(t->rigidBody, t);
         isNew = true;
     } else {
         rigidbody_set_simulation_mode(t->rigidBody, mode);
@@ -374,6 +621,7 @@ bool transform_ensure_rigidbody_copy(Transform *t, const Transform *other) {
 
     if (t->rigidBody == NULL) {
         t->rigidBody = rigidbody_new_copy(other->rigidBody);
+        rigidbody_set_transform(t->rigidBody, t);
     } else {
         rigidbody_set_collider(t->rigidBody, rigidbody_get_collider(other->rigidBody), false);
         rigidbody_set_constant_acceleration(t->rigidBody,
@@ -487,6 +735,11 @@ bool transform_set_parent(Transform *t, Transform *parent, bool keepWorld) {
     t->parent = parent;
     doubly_linked_list_push_last(parent->children, t);
     parent->childrenCount++;
+
+    // t was flagged as dirty, before being attached to its new branch
+    _transform_link_branch(t);
+    _transform_flag_branch(parent);
+
     return true;
 }
 
@@ -648,7 +901,7 @@ void transform_get_lossy_scale(Transform *t, float3 *scale, const bool refreshPa
         hierarchyDirty = _transform_check_and_refresh_parents(t);
     }
     _transform_refresh_matrices(t, hierarchyDirty);
-    matrix4x4_get_scaleXYZ(t->ltw, scale);
+    matrix4x4_get_scaleXYZ(&t->ltw, scale);
 }
 
 // MARK: - Position -
@@ -710,9 +963,9 @@ const float3 *transform_get_position(Transform *t, const bool refreshParents) {
 
 void transform_set_local_rotation(Transform *t, Quaternion *q) {
     if (_transform_get_dirty(t, TRANSFORM_DIRTY_LOCAL_ROT) ||
-        quaternion_is_equal(t->localRotation, q, EPSILON_ZERO_TRANSFORM_RAD) == false) {
+        quaternion_is_equal(&t->localRotation, q, EPSILON_ZERO_TRANSFORM_RAD) == false) {
 
-        quaternion_set(t->localRotation, q);
+        quaternion_set(&t->localRotation, q);
         _transform_set_dirty(t, TRANSFORM_DIRTY_ROT | TRANSFORM_DIRTY_MTX, false);
         if (rigidbody_is_rotation_dependent(t->rigidBody)) {
             _transform_set_dirty(t, TRANSFORM_DIRTY_PHYSICS, false);
@@ -740,9 +993,9 @@ void transform_set_local_rotation_euler_vec(Transform *t, const float3 *euler) {
 
 void transform_set_rotation(Transform *t, Quaternion *q) {
     if (_transform_get_dirty(t, TRANSFORM_DIRTY_ROT) ||
-        quaternion_is_equal(t->rotation, q, EPSILON_ZERO_TRANSFORM_RAD) == false) {
+        quaternion_is_equal(&t->rotation, q, EPSILON_ZERO_TRANSFORM_RAD) == false) {
 
-        quaternion_set(t->rotation, q);
+        quaternion_set(&t->rotation, q);
         _transform_set_dirty(t, TRANSFORM_DIRTY_LOCAL_ROT | TRANSFORM_DIRTY_MTX, false);
         if (rigidbody_is_rotation_dependent(t->rigidBody)) {
             _transform_set_dirty(t, TRANSFORM_DIRTY_PHYSICS, false);
@@ -770,7 +1023,7 @@ void transform_set_rotation_euler_vec(Transform *t, const float3 *euler) {
 
 Quaternion *transform_get_local_rotation(Transform *t) {
     _transform_refresh_local_rotation(t);
-    return t->localRotation;
+    return &t->localRotation;
 }
 
 void transform_get_local_rotation_euler(Transform *t, float3 *euler) {
@@ -779,7 +1032,7 @@ void transform_get_local_rotation_euler(Transform *t, float3 *euler) {
 
 Quaternion *transform_get_rotation(Transform *t) {
     _transform_refresh_rotation(t);
-    return t->rotation;
+    return &t->rotation;
 }
 
 void transform_get_rotation_euler(Transform *t, float3 *euler) {
@@ -790,19 +1043,19 @@ void transform_get_rotation_euler(Transform *t, float3 *euler) {
 
 void transform_get_forward(Transform *t, float3 *forward, const bool refreshParents) {
     transform_refresh(t, false, refreshParents); // refresh ltw for intra-frame calculations
-    *forward = (float3){t->ltw->x3y1, t->ltw->x3y2, t->ltw->x3y3};
+    *forward = (float3){t->ltw.x3y1, t->ltw.x3y2, t->ltw.x3y3};
     float3_normalize(forward);
 }
 
 void transform_get_right(Transform *t, float3 *right, const bool refreshParents) {
     transform_refresh(t, false, refreshParents); // refresh ltw for intra-frame calculations
-    *right = (float3){t->ltw->x1y1, t->ltw->x1y2, t->ltw->x1y3};
+    *right = (float3){t->ltw.x1y1, t->ltw.x1y2, t->ltw.x1y3};
     float3_normalize(right);
 }
 
 void transform_get_up(Transform *t, float3 *up, const bool refreshParents) {
     transform_refresh(t, false, refreshParents); // refresh ltw for intra-frame calculations
-    *up = (float3){t->ltw->x2y1, t->ltw->x2y2, t->ltw->x2y3};
+    *up = (float3){t->ltw.x2y1, t->ltw.x2y2, t->ltw.x2y3};
     float3_normalize(up);
 }
 
@@ -863,15 +1116,15 @@ void transform_set_up_vec(Transform *const t, const float3 *const up) {
 // MARK: - Matrices -
 
 const Matrix4x4 *transform_get_ltw(Transform *t) {
-    return t->ltw;
+    return &t->ltw;
 }
 
 const Matrix4x4 *transform_get_wtl(Transform *t) {
-    return t->wtl;
+    return &t->wtl;
 }
 
 const Matrix4x4 *transform_get_mtx(Transform *t) {
-    return t->mtx;
+    return &t->mtx;
 }
 
 /// MARK: - Utils -
@@ -916,19 +1169,19 @@ void transform_utils_compute_SRT(Matrix4x4 *mtx,
 }
 
 void transform_utils_position_ltw(Transform *t, const float3 *pos, float3 *result) {
-    matrix4x4_op_multiply_vec_point(result, pos, t->ltw);
+    matrix4x4_op_multiply_vec_point(result, pos, &t->ltw);
 }
 
 void transform_utils_position_wtl(Transform *t, const float3 *pos, float3 *result) {
-    matrix4x4_op_multiply_vec_point(result, pos, t->wtl);
+    matrix4x4_op_multiply_vec_point(result, pos, &t->wtl);
 }
 
 void transform_utils_vector_ltw(Transform *t, const float3 *pos, float3 *result) {
-    matrix4x4_op_multiply_vec_vector(result, pos, t->ltw);
+    matrix4x4_op_multiply_vec_vector(result, pos, &t->ltw);
 }
 
 void transform_utils_vector_wtl(Transform *t, const float3 *pos, float3 *result) {
-    matrix4x4_op_multiply_vec_vector(result, pos, t->wtl);
+    matrix4x4_op_multiply_vec_vector(result, pos, &t->wtl);
 }
 
 void transform_utils_rotation_ltw(Transform *t, Quaternion *q, Quaternion *result) {
@@ -941,7 +1194,7 @@ void transform_utils_rotation_euler_ltw(Transform *t, const float3 *rot, float3
     transform_get_rotation_euler(t, result);
     float3_op_add(result, rot);
 #elif TRANSFORM_ROTATION_HELPERS_MODE == 1
-    Matrix4x4 *ltwRotMtx = matrix4x4_new_rotation(t->ltw);
+    Matrix4x4 *ltwRotMtx = matrix4x4_new_rotation(&t->ltw);
     Matrix4x4 *rotMtx = matrix4x4_new_from_euler_zyx(rot->x, rot->y, rot->z);
     matrix4x4_op_multiply_2(ltwRotMtx, rotMtx);
     matrix4x4_get_euler(rotMtx, result);
@@ -968,7 +1221,7 @@ void transform_utils_rotation_euler_wtl(Transform *t, const float3 *rot, float3
     transform_get_rotation_euler(t, result);
     float3_op_substract(result, rot);
 #elif TRANSFORM_ROTATION_HELPERS_MODE == 1
-    Matrix4x4 *wtlRotMtx = matrix4x4_new_rotation(t->wtl);
+    Matrix4x4 *wtlRotMtx = matrix4x4_new_rotation(&t->wtl);
     Matrix4x4 *rotMtx = matrix4x4_new_from_euler_zyx(rot->x, rot->y, rot->z);
     matrix4x4_op_multiply_2(wtlRotMtx, rotMtx);
     matrix4x4_get_euler(rotMtx, result);
@@ -997,7 +1250,7 @@ void transform_utils_rotate_euler(Transform *t, const float3 *rot, float3 *resul
     }
     float3_op_add(result, rot);
 #elif TRANSFORM_ROTATION_HELPERS_MODE == 1
-    Matrix4x4 *baseMtx = isLocal ? matrix4x4_new_rotation(t->ltw) : matrix4x4_new_rotation(t->mtx);
+    Matrix4x4 *baseMtx = isLocal ? matrix4x4_new_rotation(&t->ltw) : matrix4x4_new_rotation(&t->mtx);
     Matrix4x4 *rotMtx = matrix4x4_new_from_euler_zyx(rot->x, rot->y, rot->z);
     matrix4x4_op_multiply_2(baseMtx, rotMtx);
     matrix4x4_get_euler(rotMtx, result);
@@ -1093,28 +1346,28 @@ Shape *transform_utils_get_shape(Transform *t) {
 }
 
 void transform_utils_get_model_ltw(const Transform *t, Matrix4x4 *out) {
-    *out = *t->ltw;
+    *out = t->ltw;
 
     const TransformType type = transform_get_type(t);
 
     if (type == ShapeTransform || type == MeshTransform) {
         const float3 pivot = type == ShapeTransform ? shape_get_pivot((Shape *)t->ptr) :
                              mesh_get_pivot((Mesh *)t->ptr);
-        out->x4y1 -= t->ltw->x1y1 * pivot.x + t->ltw->x2y1 * pivot.y + t->ltw->x3y1 * pivot.z;
-        out->x4y2 -= t->ltw->x1y2 * pivot.x + t->ltw->x2y2 * pivot.y + t->ltw->x3y2 * pivot.z;
-        out->x4y3 -= t->ltw->x1y3 * pivot.x + t->ltw->x2y3 * pivot.y + t->ltw->x3y3 * pivot.z;
+        out->x4y1 -= t->ltw.x1y1 * pivot.x + t->ltw.x2y1 * pivot.y + t->ltw.x3y1 * pivot.z;
+        out->x4y2 -= t->ltw.x1y2 * pivot.x + t->ltw.x2y2 * pivot.y + t->ltw.x3y2 * pivot.z;
+        out->x4y3 -= t->ltw.x1y3 * pivot.x + t->ltw.x2y3 * pivot.y + t->ltw.x3y3 * pivot.z;
     } else if (type == QuadTransform) {
         const Quad *q = (Quad *)t->ptr;
         const float anchorX = quad_get_anchor_x(q) * quad_get_width(q);
         const float anchorY = quad_get_anchor_y(q) * quad_get_height(q);
-        out->x4y1 -= t->ltw->x1y1 * anchorX + t->ltw->x2y1 * anchorY;
-        out->x4y2 -= t->ltw->x1y2 * anchorX + t->ltw->x2y2 * anchorY;
-        out->x4y3 -= t->ltw->x1y3 * anchorX + t->ltw->x2y3 * anchorY;
+        out->x4y1 -= t->ltw.x1y1 * anchorX + t->ltw.x2y1 * anchorY;
+        out->x4y2 -= t->ltw.x1y2 * anchorX + t->ltw.x2y2 * anchorY;
+        out->x4y3 -= t->ltw.x1y3 * anchorX + t->ltw.x2y3 * anchorY;
     }
 }
 
 void transform_utils_get_model_wtl(const Transform *t, Matrix4x4 *out) {
-    *out = *t->wtl;
+    *out = t->wtl;
 
     const TransformType type = transform_get_type(t);
 
@@ -1195,7 +1448,7 @@ void transform_utils_box_fit_recurse(Transform *t,
             }
 
             Matrix4x4 child_mtx = mtx;
-            matrix4x4_op_multiply(&child_mtx, child->mtx);
+            matrix4x4_op_multiply(&child_mtx, &child->mtx);
 
             const Box model = type == ShapeTransform ? shape_get_model_aabb((Shape *)child->ptr) :
                               *mesh_get_model_aabb((Mesh *)child->ptr);
@@ -1227,7 +1480,7 @@ void transform_utils_set_mtx(Transform *t, const Matrix4x4 *mtx) {
     float3 scale; matrix4x4_get_scaleXYZ(mtx, &scale);
     transform_set_local_scale_vec(t, &scale);
 
-    *t->mtx = *mtx;
+    t->mtx = *mtx;
     _transform_reset_dirty(t, TRANSFORM_DIRTY_MTX);
 }
 
@@ -1264,32 +1517,95 @@ void transform_set_shadow_decal(Transform *t, float size) {
     t->shadowDecalSize = size;
 }
 
-void transform_recycle_id(const uint16_t id) {
-    // NOTE: We could probably expose a version that doesn't use the mutex lock
-    // for managers that recycle IDs while clearly accounting for thread context.
+void transform_recycle_id(const TransformID id) {
     _transform_recycle_id(id);
 }
 
 // MARK: - Private functions -
 
-static uint16_t _transform_get_valid_id(void) {
-    uint16_t resultId = 0;
-    mutex_lock(_IDMutex);
-    if (_availableIDs == NULL || filo_list_uint16_pop(_availableIDs, &resultId) == false) {
-        resultId = _nextID;
-        _nextID += 1;
+static TransformID _transform_get_valid_id(Transform *t) {
+    // pop a recycled slot
+    uint32_t index;
+    _TransformSlot *slot;
+    uint64_t head = _atomic_load_uint64(&_freeSlots), next;
+    while (true) {
+        index = (uint32_t)head;
+        if (index == 0) {
+            break;
+        }
+        // if slot was popped concurrently, its nextFree may be stale but the tag has changed too
+        slot = _transform_get_slot(index);
+        next = (((head >> 32) + 1) << 32) | _atomic_load_uint32(&slot->nextFree);
+        if (_atomic_compare_exchange_uint64(&_freeSlots, &head, next)) {
+            break;
+        }
+    }
+
+    // or a new one
+    if (index == 0) {
+        index = _atomic_fetch_add_uint32(&_nextSlotIndex, 1);
+        if (index > TRANSFORM_ID_INDEX_MASK) {
+            cclog_error("transform: maximum number of transforms reached (%u)",
+                        TRANSFORM_ID_INDEX_MASK);
+            return TRANSFORM_ID_NONE;
+        }
+
+        const uint32_t segment = index >> TRANSFORM_ID_SEGMENT_BITS;
+        if (_atomic_load_ptr((void **)&_slotSegments[segment]) == NULL) {
+            _TransformSlot *slots = (_TransformSlot *)calloc(TRANSFORM_ID_SEGMENT_SIZE,
+                                                             sizeof(_TransformSlot));
+            if (slots == NULL) {
+                return TRANSFORM_ID_NONE;
+            }
+            // another thread may have allocated the segment first
+            if (_atomic_compare_exchange_ptr((void **)&_slotSegments[segment], NULL, slots) ==
+                false) {
+                free(slots);
+            }
+        }
+    }
+
+    slot = _transform_get_slot(index);
+    if (slot == NULL) {
+        return TRANSFORM_ID_NONE;
     }
-    mutex_unlock(_IDMutex);
-    return resultId;
+    _atomic_store_ptr((void **)&slot->ptr, t);
+    return (_atomic_load_uint32(&slot->generation) << TRANSFORM_ID_INDEX_BITS) | index;
 }
 
-static void _transform_recycle_id(const uint16_t id) {
-    mutex_lock(_IDMutex);
-    if (_availableIDs == NULL) {
-        _availableIDs = filo_list_uint16_new();
+static void _transform_recycle_id(const TransformID id) {
+    const uint32_t index = id & TRANSFORM_ID_INDEX_MASK;
+    const uint32_t generation = id >> TRANSFORM_ID_INDEX_BITS;
+    _TransformSlot *slot = index != 0 ? _transform_get_slot(index) : NULL;
+    if (slot == NULL) {
+        cclog_error("transform: can't recycle invalid ID %u", id);
+        return;
     }
-    filo_list_uint16_push(_availableIDs, id);
-    mutex_unlock(_IDMutex);
+
+    // stale IDs become invalid from here, and a same ID can't be recycled twice
+    if (_atomic_compare_exchange_uint32(&slot->generation,
+                                        generation,
+                                        (generation + 1) & TRANSFORM_ID_GENERATION_MASK) == false) {
+        cclog_error("transform: ID %u recycled more than once", id);
+        return;
+    }
+    _atomic_store_ptr((void **)&slot->ptr, NULL);
+
+    // push slot to free list
+    uint64_t head = _atomic_load_uint64(&_freeSlots), next;
+    do {
+        _atomic_store_uint32(&slot->nextFree, (uint32_t)head);
+        next = (((head >> 32) + 1) << 32) | index;
+    } while (_atomic_compare_exchange_uint64(&_freeSlots, &head, next) == false);
+}
+
+static _TransformSlot *_transform_get_slot(const uint32_t index) {
+    if (index > TRANSFORM_ID_INDEX_MASK) {
+        return NULL;
+    }
+    _TransformSlot *slots = (_TransformSlot *)_atomic_load_ptr(
+        (void **)&_slotSegments[index >> TRANSFORM_ID_SEGMENT_BITS]);
+    return slots != NULL ? &slots[index & (TRANSFORM_ID_SEGMENT_SIZE - 1)] : NULL;
 }
 
 static void _transform_set_dirty(Transform *const t, const uint8_t flag, bool keepCache) {
@@ -1319,6 +1635,7 @@ static void _transform_set_dirty(Transform *const t, const uint8_t flag, bool ke
     } else {
         t->dirty |= (flag | TRANSFORM_DIRTY_CACHE);
     }
+    _transform_flag_branch(t);
 }
 
 static void _transform_reset_dirty(Transform *const t, const uint8_t flag) {
@@ -1341,6 +1658,49 @@ static bool _transform_get_flag(Transform *const t, const uint8_t flag) {
     return (t->flags & flag) != 0;
 }
 
+/// flags transform & its ancestors, up to the first one already flagged
+static void _transform_flag_branch(Transform *t) {
+    while (t != NULL && _transform_get_flag(t, TRANSFORM_FLAG_BRANCH) == false) {
+        _transform_toggle_flag(t, TRANSFORM_FLAG_BRANCH, true);
+        _transform_link_branch(t);
+        t = t->parent;
+    }
+}
+
+/// appends flagged transform to its parent's list of flagged children
+static void _transform_link_branch(Transform *t) {
+    if (t->parent == NULL || _transform_get_flag(t, TRANSFORM_FLAG_BRANCH) == false) {
+        return;
+    }
+    t->branchPrev = t->parent->branchLast;
+    t->branchNext = NULL;
+    if (t->parent->branchLast != NULL) {
+        t->parent->branchLast->branchNext = t;
+    } else {
+        t->parent->branchFirst = t;
+    }
+    t->parent->branchLast = t;
+}
+
+/// removes flagged transform from its parent's list of flagged children
+static void _transform_unlink_branch(Transform *t) {
+    if (t->parent == NULL || _transform_get_flag(t, TRANSFORM_FLAG_BRANCH) == false) {
+        return;
+    }
+    if (t->branchPrev != NULL) {
+        t->branchPrev->branchNext = t->branchNext;
+    } else {
+        t->parent->branchFirst = t->branchNext;
+    }
+    if (t->branchNext != NULL) {
+        t->branchNext->branchPrev = t->branchPrev;
+    } else {
+        t->parent->branchLast = t->branchPrev;
+    }
+    t->branchPrev = NULL;
+    t->branchNext = NULL;
+}
+
 /// refreshes parents hierarchy if necessary, for up-to-date parent transformation
 /// @returns true if any of the ancestors' mtx was refreshed
 static bool _transform_check_and_refresh_parents(Transform *const t) {
@@ -1369,7 +1729,7 @@ static bool _transform_check_and_refresh_parents(Transform *const t) {
 static void _transform_refresh_local_position(Transform *t) {
     if (_transform_get_dirty(t, TRANSFORM_DIRTY_LOCAL_POS)) {
         if (t->parent != NULL) {
-            matrix4x4_op_multiply_vec_point(&t->localPosition, &t->position, t->parent->wtl);
+            matrix4x4_op_multiply_vec_point(&t->localPosition, &t->position, &t->parent->wtl);
         } else {
             float3_copy(&t->localPosition, &t->position);
         }
@@ -1384,9 +1744,9 @@ static void _transform_refresh_position(Transform *t) {
     if (_transform_get_dirty(t, TRANSFORM_DIRTY_POS)) {
         if (t->parent != NULL) {
             if (_transform_get_dirty(t, TRANSFORM_DIRTY_MTX)) {
-                matrix4x4_op_multiply_vec_point(&t->position, &t->localPosition, t->parent->ltw);
+                matrix4x4_op_multiply_vec_point(&t->position, &t->localPosition, &t->parent->ltw);
             } else {
-                float3_set(&t->position, t->ltw->x4y1, t->ltw->x4y2, t->ltw->x4y3);
+                float3_set(&t->position, t->ltw.x4y1, t->ltw.x4y2, t->ltw.x4y3);
             }
         } else {
             float3_copy(&t->position, &t->localPosition);
@@ -1406,12 +1766,12 @@ static void _transform_refresh_local_rotation(Transform *t) {
                 Quaternion qwtl;
                 quaternion_set(&qwtl, parentRot);
                 quaternion_op_inverse(&qwtl);
-                *t->localRotation = quaternion_op_mult(&qwtl, t->rotation);
+                t->localRotation = quaternion_op_mult(&qwtl, &t->rotation);
             } else {
-                quaternion_set(t->localRotation, t->rotation);
+                quaternion_set(&t->localRotation, &t->rotation);
             }
         } else {
-            quaternion_set(t->localRotation, t->rotation);
+            quaternion_set(&t->localRotation, &t->rotation);
         }
         _transform_reset_dirty(t, TRANSFORM_DIRTY_LOCAL_ROT);
     }
@@ -1424,12 +1784,12 @@ static void _transform_refresh_rotation(Transform *t) {
         if (t->parent != NULL) {
             Quaternion *parentRot = transform_get_rotation(t->parent);
             if (quaternion_is_zero(parentRot, EPSILON_ZERO_TRANSFORM_RAD) == false) {
-                *t->rotation = quaternion_op_mult(parentRot, t->localRotation);
+                t->rotation = quaternion_op_mult(parentRot, &t->localRotation);
             } else {
-                quaternion_set(t->rotation, t->localRotation);
+                quaternion_set(&t->rotation, &t->localRotation);
             }
         } else {
-            quaternion_set(t->rotation, t->localRotation);
+            quaternion_set(&t->rotation, &t->localRotation);
         }
         _transform_reset_dirty(t, TRANSFORM_DIRTY_ROT);
     }
@@ -1441,7 +1801,7 @@ static void _transform_refresh_matrices(Transform *t, bool hierarchyDirty) {
 
     if (dirty) {
         /// compute local mtx
-        transform_utils_compute_SRT(t->mtx, &t->localScale, t->localRotation, &t->localPosition);
+        transform_utils_compute_SRT(&t->mtx, &t->localScale, &t->localRotation, &t->localPosition);
 
         _transform_reset_dirty(t, TRANSFORM_DIRTY_MTX);
 
@@ -1451,13 +1811,21 @@ static void _transform_refresh_matrices(Transform *t, bool hierarchyDirty) {
     }
 
     if (dirty || hierarchyDirty) {
-        /// refreshes ltw & wtl
-        matrix4x4_copy(t->ltw, t->mtx);
-        if (t->parent != NULL) {
-            matrix4x4_op_multiply_2(t->parent->ltw, t->ltw);
+        /// refreshes ltw & wtl, mtx is affine unless set with transform_utils_set_mtx
+        if (t->parent == NULL) {
+            t->ltw = t->mtx;
+        } else if (matrix4x4_is_affine(&t->mtx) && matrix4x4_is_affine(&t->parent->ltw)) {
+            matrix4x4_op_multiply_affine(&t->parent->ltw, &t->mtx, &t->ltw);
+        } else {
+            t->ltw = t->mtx;
+            matrix4x4_op_multiply_2(&t->parent->ltw, &t->ltw);
+        }
+        if (matrix4x4_is_affine(&t->ltw)) {
+            matrix4x4_op_invert_affine(&t->ltw, &t->wtl);
+        } else {
+            t->wtl = t->ltw;
+            matrix4x4_op_invert(&t->wtl);
         }
-        matrix4x4_copy(t->wtl, t->ltw);
-        matrix4x4_op_invert(t->wtl);
 
         if (hierarchyDirty) {
             // parent ltw changed, any world transformations may have changed from the ancestors
@@ -1534,6 +1902,8 @@ static bool _transform_remove_parent(Transform *t, const bool keepWorld, const b
 
     _transform_set_all_dirty(t, keepWorld);
 
+    _transform_unlink_branch(t);
+
     if (reciprocal) {
         DoublyLinkedListNode *it = doubly_linked_list_first(t->parent->children);
         Transform *child = NULL;
@@ -1582,7 +1952,7 @@ static void _transform_utils_box_to_aabox_lossy(Transform *t,
                                                 const float3 *offset,
                                                 SquarifyType squarify) {
     float3 scale;
-    matrix4x4_get_scaleXYZ(t->ltw, &scale);
+    matrix4x4_get_scaleXYZ(&t->ltw, &scale);
     box_to_aabox_no_rot(b,
                         aab,
                         transform_get_position(t, false),
@@ -1690,12 +2060,44 @@ static void _transform_utils_box_to_aabox_full(Transform *t,
 
 #pragma clang diagnostic pop
 
+static bool _transform_batch_reserve(_TransformBatch *b, uint32_t capacity) {
+    if (capacity <= b->capacity) {
+        return true;
+    }
+    uint32_t newCapacity = b->capacity > 0 ? b->capacity : TRANSFORM_BATCH_INITIAL_CAPACITY;
+    while (newCapacity < capacity) {
+        newCapacity *= 2;
+    }
+
+    Transform **nodes = (Transform **)realloc(b->nodes, newCapacity * sizeof(Transform *));
+    if (nodes == NULL) {
+        return false;
+    }
+    b->nodes = nodes;
+    uint8_t *dirty = (uint8_t *)realloc(b->dirty, newCapacity * sizeof(uint8_t));
+    if (dirty == NULL) {
+        return false;
+    }
+    b->dirty = dirty;
+
+    b->capacity = newCapacity;
+    return true;
+}
+
+static void _transform_batch_free(_TransformBatch *b) {
+    free(b->nodes);
+    free(b->dirty);
+}
+
 static void _transform_free(Transform *const t) {
     if (t == NULL) {
         return;
     }
 
     if (t->managed != NULL && transform_destroyed_callback != NULL) {
+        // ID can't be looked up anymore, but remains reserved until recycled by the manager
+        _TransformSlot *slot = _transform_get_slot(t->id & TRANSFORM_ID_INDEX_MASK);
+        _atomic_store_ptr((void **)&slot->ptr, NULL);
         transform_destroyed_callback(t->id, t->managed);
     } else {
         // Only recycle transform ID if transform destruction isn't managed.
@@ -1726,13 +2128,6 @@ static void _transform_free(Transform *const t) {
     _transform_remove_from_hierarchy(t, true);
     doubly_linked_list_free(t->children);
 
-    matrix4x4_free(t->ltw);
-    matrix4x4_free(t->wtl);
-    matrix4x4_free(t->mtx);
-
-    quaternion_free(t->localRotation);
-    quaternion_free(t->rotation);
-
     weakptr_invalidate(t->wptr);
     free(t);
 }
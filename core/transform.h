@@ -73,14 +73,23 @@ typedef enum {
 
 typedef bool (*pointer_transform_recurse_func)(Transform *t, void *ptr);
 typedef bool (*pointer_transform_recurse_depth_func)(Transform *t, void *ptr, uint32_t depth);
-typedef void (*pointer_transform_destroyed_func)(const uint16_t id, void *managed);
+/// Transform IDs are unique among live transforms, and stay invalid once the transform is released,
+/// until the same slot was reused 4096 times. Up to 1,048,575 transforms can exist at once.
+typedef uint32_t TransformID;
+#define TRANSFORM_ID_NONE 0
+
+typedef void (*pointer_transform_destroyed_func)(const TransformID id, void *managed);
 typedef Transform **Transform_Array;
 
 /// MARK: - Lifecycle -
 Transform *transform_new(TransformType type);
 Transform *transform_new_with_ptr(TransformType type, void *ptr, pointer_free_function ptrFreeFn);
+/// IDs allocation is lock-free, this does nothing anymore
 void transform_init_ID_thread_safety(void);
-uint16_t transform_get_id(const Transform *t);
+TransformID transform_get_id(const Transform *t);
+/// O(1) lookup, returns NULL if ID is stale or invalid.
+/// Returned transform isn't retained, caller must ensure it isn't released concurrently.
+Transform *transform_get_by_id(const TransformID id);
 /// Increases ref count and returns false if the retain count can't be increased
 bool transform_retain(Transform *const t);
 uint16_t transform_retain_count(const Transform *const t);
@@ -92,8 +101,23 @@ Weakptr *transform_get_weakptr(Transform *t);
 Weakptr *transform_get_and_retain_weakptr(Transform *t);
 bool transform_is_hierarchy_dirty(Transform *t);
 void transform_refresh(Transform *t, bool hierarchyDirty, bool refreshParents);
+/// Refreshes the hierarchy under root (included) as one batch: transforms are gathered by depth
+/// into contiguous arrays, then dirty subtrees are refreshed in one linear pass, parents first.
+/// Clean branches (see transform_is_branch_dirty) are not gathered.
+/// Children dirty flags are consumed, same result as calling transform_refresh top-first while
+/// propagating transform_set_children_dirty.
+/// @returns number of transforms whose ltw/wtl matrices were recomputed
+size_t transform_refresh_hierarchy(Transform *root, bool hierarchyDirty);
 void transform_set_children_dirty(Transform *t);
 void transform_reset_children_dirty(Transform *t);
+/// A branch is flagged along w/ all its ancestors whenever a transform is set dirty, or explicitly
+/// if it needs to be visited by next scene refresh. Flags are reset by scene refresh only
+void transform_set_branch_dirty(Transform *t);
+void transform_reset_branch_dirty(Transform *t);
+bool transform_is_branch_dirty(Transform *t);
+/// Children w/ a flagged branch are listed in flagging order, clean children aren't visited
+Transform *transform_get_first_branch_dirty_child(Transform *t);
+Transform *transform_get_next_branch_dirty_sibling(Transform *t);
 void transform_reset_any_dirty(Transform *t);
 /// set, but not reset by transform, can be used internally by higher types as custom flag
 bool transform_is_any_dirty(Transform *t);
@@ -243,7 +267,9 @@ bool transform_is_animations_enabled(Transform *const t);
 float transform_get_shadow_decal(Transform *t);
 void transform_set_shadow_decal(Transform *t, float size);
 
-void transform_recycle_id(const uint16_t id);
+/// For managed transforms only (see transform_set_destroy_callback), makes ID available again once
+/// manager is done with it
+void transform_recycle_id(const TransformID id);
 
 /// MARK: - Debug -
 #if DEBUG_TRANSFORM
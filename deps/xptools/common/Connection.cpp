@@ -8,15 +8,67 @@
 #include "Connection.hpp"
 
 // C++
+#include <atomic>
 #include <chrono>
 #include <cstring>
 
+#include <zlib.h>
+
 #include "vxlog.h"
 
 #define PAYLOAD_DIFF_NOT_POSSIBLE UINT32_MAX
+#define PAYLOAD_DEFAULT_COMPRESSION_THRESHOLD 128
+// received payloads announcing bigger uncompressed content are rejected
+#define PAYLOAD_MAX_UNCOMPRESSED_SIZE (64 * 1024 * 1024)
 
 using namespace vx;
 
+//
+// Compression
+//
+
+static std::atomic<size_t> compressionThreshold(PAYLOAD_DEFAULT_COMPRESSION_THRESHOLD);
+
+static std::mutex compressionDictionaryMutex;
+static std::shared_ptr<const std::string> compressionDictionary;
+
+static struct {
+    std::atomic<uint64_t> compressed;
+    std::atomic<uint64_t> skipped;
+    std::atomic<uint64_t> bytesIn;
+    std::atomic<uint64_t> bytesOut;
+    std::atomic<uint64_t> compressionTimeUs;
+    std::atomic<uint64_t> decompressed;
+    std::atomic<uint64_t> decompressionTimeUs;
+} compressionStats;
+
+// zlib streams are kept per thread and reset between payloads,
+// their state is allocated only once
+struct ZStreams {
+    z_stream deflater;
+    z_stream inflater;
+    bool deflaterReady;
+    bool inflaterReady;
+
+    ZStreams() : deflaterReady(false), inflaterReady(false) {}
+    ~ZStreams() {
+        if (deflaterReady) { deflateEnd(&deflater); }
+        if (inflaterReady) { inflateEnd(&inflater); }
+    }
+};
+
+static thread_local ZStreams zStreams;
+
+static std::shared_ptr<const std::string> getCompressionDictionary() {
+    const std::lock_guard<std::mutex> lock(compressionDictionaryMutex);
+    return compressionDictionary;
+}
+
+static uint64_t elapsedUs(const std::chrono::steady_clock::time_point& start) {
+    using namespace std::chrono;
+    return static_cast<uint64_t>(duration_cast<microseconds>(steady_clock::now() - start).count());
+}
+
 //
 // Payload
 //
@@ -32,13 +84,42 @@ uint16_t Connection::Payload::_getNextID() {
 }
 
 Connection::Payload_SharedPtr Connection::Payload::create(char *content, size_t len, uint8_t includes) {
-    return Payload_SharedPtr(new Payload(content, len, includes));
+    PayloadBuffer *buffer = nullptr;
+    if (content != nullptr) {
+        buffer = PayloadBuffer::adopt(content, len);
+        if (buffer == nullptr) {
+            return nullptr;
+        }
+    }
+    return Payload_SharedPtr(new Payload(buffer, content, len, includes));
+}
+
+Connection::Payload_SharedPtr Connection::Payload::create(size_t len, uint8_t includes) {
+    PayloadBuffer *buffer = PayloadBuffer::acquire(len);
+    if (buffer == nullptr) {
+        return nullptr;
+    }
+    Payload *p = new Payload(buffer, buffer->data(), len, includes);
+
+    // content isn't written yet, but we already know if it's too small to be compressed
+    if ((includes & Includes::Compressed) && len < compressionThreshold) {
+        p->_includes &= ~Includes::Compressed;
+        p->_compressionDone = true;
+        compressionStats.skipped.fetch_add(1);
+    }
+
+    // travel history changes until written, metadata is serialized when writing,
+    // same for compressed payloads as metadata then goes with compressed content
+    if ((p->_includes & (Includes::TravelHistory | Includes::Compressed)) == 0 &&
+        p->metadataSize() <= buffer->headroom()) {
+        p->_metadata = p->_content - p->metadataSize();
+        p->_writeMetadata(p->_metadata);
+    }
+    return Payload_SharedPtr(p);
 }
 
 Connection::Payload_SharedPtr Connection::Payload::createDummy() {
-    size_t len = 1;
-    char *content = static_cast<char*>(malloc(len));
-    return Payload_SharedPtr(new Payload(content, len, Includes::None));
+    return create(1, Includes::None);
 }
 
 Connection::Payload_SharedPtr Connection::Payload::decode(char *bytes, size_t len) {
@@ -46,11 +127,26 @@ Connection::Payload_SharedPtr Connection::Payload::decode(char *bytes, size_t le
     if (bytes == nullptr) return nullptr;
     if (len < 1) return nullptr;
     
+    PayloadBuffer *buffer = PayloadBuffer::adopt(bytes, len);
+    if (buffer == nullptr) return nullptr;
+    
+    Payload_SharedPtr p = decode(buffer, len);
+    buffer->release();
+    return p;
+}
+
+Connection::Payload_SharedPtr Connection::Payload::decode(PayloadBuffer *buffer, size_t len) {
+    
+    if (buffer == nullptr) return nullptr;
+    if (len < 1) return nullptr;
+    
     Payload *p = new Payload();
     
-    p->_decoded = bytes;
+    buffer->retain();
+    p->_buffer = buffer;
     p->_decodedLen = len;
-    char *cursor = p->_decoded;
+    char *bytes = buffer->data();
+    char *cursor = bytes;
     
     memcpy(&p->_includes, cursor, sizeof(uint8_t));
     cursor += sizeof(uint8_t);
@@ -65,6 +161,11 @@ Connection::Payload_SharedPtr Connection::Payload::decode(char *bytes, size_t le
         cursor += sizeof(uint64_t);
     }
     
+    if (p->_includes & Includes::Compressed) {
+        memcpy(&p->_uncompressedLen, cursor, sizeof(uint32_t));
+        cursor += sizeof(uint32_t);
+    }
+    
     if (p->_includes & Includes::TravelHistory) {
         
         p->_steps = std::vector<Step>();
@@ -92,12 +193,21 @@ Connection::Payload_SharedPtr Connection::Payload::decode(char *bytes, size_t le
             
             p->_steps.push_back(s);
         }
+    } else {
+        // decoded metadata is what would be serialized to write the payload again
+        p->_metadata = bytes;
+        p->_metadataSizeCache = static_cast<size_t>(cursor - bytes);
     }
     
     // content starts where cursor is
     p->_content = cursor;
     p->_len = len - static_cast<size_t>(cursor - bytes);
 
+    if ((p->_includes & Includes::Compressed) && p->_decompress() == false) {
+        delete p;
+        return nullptr;
+    }
+
     return Payload_SharedPtr(p);
 }
 
@@ -113,29 +223,61 @@ Connection::Payload_SharedPtr Connection::Payload::copy(const Payload_SharedPtr&
     copy->_createdAt = p->_createdAt;
     copy->_id = p->_id;
     
-    if (p->_content == nullptr) {
-        copy->_content = nullptr;
-        copy->_len = 0;
-    } else {
-        copy->_content = static_cast<char*>(malloc(p->_len));
-        copy->_len = p->_len;
-        memcpy(copy->_content, p->_content, copy->_len);
+    // content bytes are shared
+    if (p->_buffer != nullptr) {
+        p->_buffer->retain();
     }
+    copy->_buffer = p->_buffer;
+    copy->_content = p->_content;
+    copy->_len = p->_len;
+    copy->_decodedLen = p->_decodedLen;
+    copy->_uncompressedLen = p->_uncompressedLen;
+    copy->_compressionDone = p->_compressionDone;
     
     if (copy->_includes & Includes::TravelHistory) {
         copy->_steps = p->_steps;
+    } else if (p->_metadata != nullptr && p->_metadataBuffer == nullptr) {
+        // metadata within shared buffer is the same for the copy (same ID & creation time)
+        copy->_metadata = p->_metadata;
+        copy->_metadataSizeCache = p->_metadataSizeCache;
     }
     
     return Payload_SharedPtr(copy);
 }
 
-Connection::Payload::Payload(char* bytes, size_t len, uint8_t includes) {
+void Connection::Payload::setCompressionThreshold(size_t bytes) {
+    compressionThreshold = bytes;
+}
+
+void Connection::Payload::setCompressionDictionary(const std::string& dictionary) {
+    std::shared_ptr<const std::string> d = dictionary.empty() ? nullptr : std::make_shared<const std::string>(dictionary);
+    const std::lock_guard<std::mutex> lock(compressionDictionaryMutex);
+    compressionDictionary = d;
+}
+
+Connection::Payload::CompressionStats Connection::Payload::getCompressionStats() {
+    CompressionStats stats;
+    stats.compressed = compressionStats.compressed;
+    stats.skipped = compressionStats.skipped;
+    stats.bytesIn = compressionStats.bytesIn;
+    stats.bytesOut = compressionStats.bytesOut;
+    stats.compressionTimeUs = compressionStats.compressionTimeUs;
+    stats.decompressed = compressionStats.decompressed;
+    stats.decompressionTimeUs = compressionStats.decompressionTimeUs;
+    return stats;
+}
+
+Connection::Payload::Payload(PayloadBuffer *buffer, char *content, size_t len, uint8_t includes) {
     _includes = includes;
-    _content = bytes;
-    _decoded = nullptr;
+    _buffer = buffer;
+    _content = content;
+    _decodedLen = 0;
+    _uncompressedLen = 0;
+    _compressionDone = false;
     _len = len;
     _metadataSizeCache = 0;
     _metadata = nullptr;
+    _metadataBuffer = nullptr;
     _createdAt = 0;
     _id = 0;
     
@@ -155,79 +297,239 @@ Connection::Payload::Payload(char* bytes, size_t len, uint8_t includes) {
 
 bool Connection::Payload::createMetadataIfNull() {
     if (_metadata == nullptr) { // serialize metadata
-        char *cursor = nullptr;
-        
-        _metadata = static_cast<char*>(malloc(metadataSize()));
-        
-        cursor = _metadata;
-        
-        memcpy(cursor, &_includes, sizeof(uint8_t));
-        cursor += sizeof(uint8_t);
-        
-        if (_includes & Includes::PayloadID) {
-            memcpy(cursor, &_id, sizeof(IDType));
-            cursor += sizeof(IDType);
+        if ((_includes & Includes::Compressed) && _compressionDone == false) {
+            _compress();
+            if (_metadata != nullptr) { // written in place
+                return true;
+            }
+        }
+        _metadataBuffer = PayloadBuffer::acquire(metadataSize());
+        if (_metadataBuffer == nullptr) {
+            return false;
         }
+        _metadata = _metadataBuffer->data();
+        return _writeMetadata(_metadata);
+    }
+    return true;
+}
+
+bool Connection::Payload::_writeMetadata(char *dst) {
+    char *cursor = dst;
+    
+    memcpy(cursor, &_includes, sizeof(uint8_t));
+    cursor += sizeof(uint8_t);
+    
+    if (_includes & Includes::PayloadID) {
+        memcpy(cursor, &_id, sizeof(IDType));
+        cursor += sizeof(IDType);
+    }
+    
+    if (_includes & Includes::CreatedAt) {
+        memcpy(cursor, &_createdAt, sizeof(uint64_t));
+        cursor += sizeof(uint64_t);
+    }
+    
+    if (_includes & Includes::Compressed) {
+        memcpy(cursor, &_uncompressedLen, sizeof(uint32_t));
+        cursor += sizeof(uint32_t);
+    }
+    
+    if (_includes & Includes::TravelHistory) {
         
-        if (_includes & Includes::CreatedAt) {
-            memcpy(cursor, &_createdAt, sizeof(uint64_t));
-            cursor += sizeof(uint64_t);
+        if (_steps.size() > 255) {
+            vxlog_error("Too many Payload steps");
+            return false;
         }
         
-        if (_includes & Includes::TravelHistory) {
-            
-            if (_steps.size() > 255) {
-                vxlog_error("Too many Payload steps");
-                return false;
-            }
-            
-            const uint8_t steps = static_cast<uint8_t>(_steps.size());
-            memcpy(cursor, &steps, sizeof(uint8_t));
+        const uint8_t steps = static_cast<uint8_t>(_steps.size());
+        memcpy(cursor, &steps, sizeof(uint8_t));
+        cursor += sizeof(uint8_t);
+        
+        uint8_t nameLen = 0;
+        for (Step step : _steps) {
+            nameLen = static_cast<uint8_t>(step.name.length());
+            memcpy(cursor, &nameLen, sizeof(uint8_t));
             cursor += sizeof(uint8_t);
             
-            uint8_t nameLen = 0;
-            for (Step step : _steps) {
-                nameLen = static_cast<uint8_t>(step.name.length());
-                memcpy(cursor, &nameLen, sizeof(uint8_t));
-                cursor += sizeof(uint8_t);
-                
-                memcpy(cursor, step.name.c_str(), nameLen);
-                cursor += nameLen;
-                
-                memcpy(cursor, &step.diff, sizeof(uint32_t));
-                cursor += sizeof(uint32_t);
+            memcpy(cursor, step.name.c_str(), nameLen);
+            cursor += nameLen;
+            
+            memcpy(cursor, &step.diff, sizeof(uint32_t));
+            cursor += sizeof(uint32_t);
+        }
+    }
+    return true;
+}
+
+void Connection::Payload::_compress() {
+    _compressionDone = true;
+
+    if (_content == nullptr || _len < compressionThreshold || _len > UINT32_MAX) {
+        _includes &= ~Includes::Compressed;
+        _metadataSizeCache = 0;
+        compressionStats.skipped.fetch_add(1);
+        return;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ZStreams& z = zStreams;
+    int result = Z_OK;
+    if (z.deflaterReady == false) {
+        memset(&z.deflater, 0, sizeof(z_stream));
+        result = deflateInit(&z.deflater, Z_BEST_SPEED);
+        z.deflaterReady = result == Z_OK;
+    } else {
+        result = deflateReset(&z.deflater);
+    }
+
+    const std::shared_ptr<const std::string> dictionary = getCompressionDictionary();
+    if (result == Z_OK && dictionary != nullptr) {
+        result = deflateSetDictionary(&z.deflater,
+                                      reinterpret_cast<const Bytef *>(dictionary->data()),
+                                      static_cast<uInt>(dictionary->size()));
+    }
+
+    // output is limited to content size - 1, compression fails if not worth it
+    PayloadBuffer *buffer = result == Z_OK ? PayloadBuffer::acquire(_len) : nullptr;
+    if (buffer != nullptr) {
+        z.deflater.next_in = reinterpret_cast<Bytef *>(_content);
+        z.deflater.avail_in = static_cast<uInt>(_len);
+        z.deflater.next_out = reinterpret_cast<Bytef *>(buffer->data());
+        z.deflater.avail_out = static_cast<uInt>(_len - 1);
+        result = deflate(&z.deflater, Z_FINISH);
+    }
+
+    if (buffer == nullptr || result != Z_STREAM_END) {
+        if (result != Z_OK && result != Z_BUF_ERROR) {
+            vxlog_error("Connection::Payload - compression error (%d)", result);
+        }
+        if (buffer != nullptr) {
+            buffer->release();
+        }
+        _includes &= ~Includes::Compressed;
+        _metadataSizeCache = 0;
+        compressionStats.skipped.fetch_add(1);
+        compressionStats.compressionTimeUs.fetch_add(elapsedUs(start));
+        return;
+    }
+
+    const size_t compressedLen = static_cast<size_t>(z.deflater.total_out);
+    compressionStats.compressed.fetch_add(1);
+    compressionStats.bytesIn.fetch_add(_len);
+    compressionStats.bytesOut.fetch_add(compressedLen);
+    compressionStats.compressionTimeUs.fetch_add(elapsedUs(start));
+
+    _uncompressedLen = static_cast<uint32_t>(_len);
+    if (_buffer != nullptr) {
+        _buffer->release();
+    }
+    _buffer = buffer;
+    _content = buffer->data();
+    _len = compressedLen;
+    _decodedLen = 0;
+    _metadataSizeCache = 0;
+
+    // new buffer isn't shared yet, metadata can go in its headroom
+    if ((_includes & Includes::TravelHistory) == 0 && metadataSize() <= buffer->headroom()) {
+        _metadata = _content - metadataSize();
+        _writeMetadata(_metadata);
+    }
+}
+
+bool Connection::Payload::_decompress() {
+    if (_uncompressedLen > PAYLOAD_MAX_UNCOMPRESSED_SIZE) {
+        vxlog_error("Connection::Payload - uncompressed content too big (%u)", _uncompressedLen);
+        return false;
+    }
+
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+    ZStreams& z = zStreams;
+    int result = Z_OK;
+    if (z.inflaterReady == false) {
+        memset(&z.inflater, 0, sizeof(z_stream));
+        result = inflateInit(&z.inflater);
+        z.inflaterReady = result == Z_OK;
+    } else {
+        result = inflateReset(&z.inflater);
+    }
+
+    PayloadBuffer *buffer = result == Z_OK ? PayloadBuffer::acquire(_uncompressedLen) : nullptr;
+    if (buffer == nullptr) {
+        vxlog_error("Connection::Payload - can't decompress (%d)", result);
+        return false;
+    }
+
+    z.inflater.next_in = reinterpret_cast<Bytef *>(_content);
+    z.inflater.avail_in = static_cast<uInt>(_len);
+    z.inflater.next_out = reinterpret_cast<Bytef *>(buffer->data());
+    z.inflater.avail_out = static_cast<uInt>(_uncompressedLen);
+    result = inflate(&z.inflater, Z_FINISH);
+
+    if (result == Z_NEED_DICT) {
+        const std::shared_ptr<const std::string> dictionary = getCompressionDictionary();
+        if (dictionary != nullptr) {
+            result = inflateSetDictionary(&z.inflater,
+                                          reinterpret_cast<const Bytef *>(dictionary->data()),
+                                          static_cast<uInt>(dictionary->size()));
+            if (result == Z_OK) {
+                result = inflate(&z.inflater, Z_FINISH);
             }
         }
     }
+
+    if (result != Z_STREAM_END || z.inflater.total_out != _uncompressedLen) {
+        vxlog_error("Connection::Payload - decompression error (%d)", result);
+        buffer->release();
+        return false;
+    }
+
+    if (_buffer != nullptr) {
+        _buffer->release();
+    }
+    _buffer = buffer;
+    _content = buffer->data();
+    _len = _uncompressedLen;
+    _decodedLen = 0;
+    // decoded metadata doesn't match content anymore,
+    // it's serialized again (and content compressed) if payload gets written
+    _metadata = nullptr;
+    _metadataSizeCache = 0;
+    _compressionDone = false;
+
+    compressionStats.decompressed.fetch_add(1);
+    compressionStats.decompressionTimeUs.fetch_add(elapsedUs(start));
     return true;
 }
 
 Connection::Payload::Payload() {
     _includes = Includes::None;
+    _buffer = nullptr;
     _content = nullptr;
-    _decoded = nullptr;
+    _decodedLen = 0;
+    _uncompressedLen = 0;
+    _compressionDone = false;
     _len = 0;
     _metadataSizeCache = 0;
     _metadata = nullptr;
+    _metadataBuffer = nullptr;
     _createdAt = 0;
     _id = 0;
 }
 
 Connection::Payload::~Payload() {
-    if (_content != nullptr) {
-        if (_decoded != nullptr) {
-            free(_decoded);
-            _decoded = nullptr;
-        } else {
-            free(_content);
-        }
-        _content = nullptr;
+    if (_buffer != nullptr) {
+        _buffer->release();
+        _buffer = nullptr;
     }
+    _content = nullptr;
     _len = 0;
-    if (_metadata != nullptr) {
-        free(_metadata);
-        _metadata = nullptr;
+    if (_metadataBuffer != nullptr) {
+        _metadataBuffer->release();
+        _metadataBuffer = nullptr;
     }
+    _metadata = nullptr;
 }
 
 void Connection::Payload::step(const std::string &name) {
@@ -311,6 +613,10 @@ size_t Connection::Payload::metadataSize() {
         _metadataSizeCache += sizeof(uint64_t);
     }
     
+    if (_includes & Includes::Compressed) {
+        _metadataSizeCache += sizeof(uint32_t);
+    }
+    
     if (_includes & Includes::TravelHistory) {
         _metadataSizeCache += sizeof(uint8_t); // nb steps
         for (Step step : _steps) {
@@ -328,5 +634,8 @@ size_t Connection::Payload::totalSize() {
 }
 
 std::string Connection::Payload::getRawBytes() {
-    return std::string(_decoded, _decodedLen);
+    if (_buffer == nullptr || _decodedLen == 0) {
+        return std::string();
+    }
+    return std::string(_buffer->data(), _decodedLen);
 }
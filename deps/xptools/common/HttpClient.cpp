@@ -18,6 +18,7 @@
 #include "vxlog.h"
 #include "strings.hpp"
 #include "filesystem.hpp"
+#include "OperationQueue.hpp"
 
 #include "BZMD5.hpp"
 #include "cJSON.h"
@@ -212,6 +213,8 @@ HttpRequest_SharedPtr HttpClient::Delete(const std::string &url,
 void HttpClient::run_unit_tests() {
     run_unit_tests_parse_url();
     run_unit_tests_get_url();
+    run_unit_tests_memory_cache();
+    run_unit_tests_coalesced_response();
 }
 
 // --------------------------------------------------
@@ -321,19 +324,115 @@ void HttpClient::run_unit_tests_get_url() {
     assert(req->getStatus() == HttpRequest::Status::WAITING);
 }
 
+// Makes sure in-memory cache tier evicts least recently used entries
+void HttpClient::run_unit_tests_memory_cache() {
+    HttpClient& client = HttpClient::shared();
+    CacheShard& shard = client._getCacheShard("https://api.cu.bzh/test");
+    const std::lock_guard<std::mutex> lock(shard.lock);
+    const size_t capacity = client._memoryCacheShardCapacity.load(std::memory_order_relaxed);
+
+    // entries in a clean shard, each taking a third of its capacity
+    std::list<CacheEntry_SharedPtr> lru;
+    lru.swap(shard.lru);
+    std::unordered_map<std::string, std::list<CacheEntry_SharedPtr>::iterator> entries;
+    entries.swap(shard.entries);
+    const size_t bytes = shard.bytes;
+    shard.bytes = 0;
+
+    std::shared_ptr<CacheEntry> entry[4];
+    for (int i = 0; i < 4; ++i) {
+        entry[i] = std::make_shared<CacheEntry>();
+        entry[i]->url = "https://api.cu.bzh/test/" + std::to_string(i);
+        entry[i]->body = std::string(capacity / 3 - sizeof(CacheEntry) - entry[i]->url.size(), 'x');
+    }
+
+    assert(client._memoryCachePut(shard, entry[0], true));
+    assert(client._memoryCachePut(shard, entry[1], true));
+    assert(client._memoryCachePut(shard, entry[2], true));
+    assert(client._memoryCacheGet(shard, entry[0]->url) == entry[0]);
+
+    // 1 is the least recently used
+    assert(client._memoryCachePut(shard, entry[3], true));
+    assert(client._memoryCacheGet(shard, entry[1]->url) == nullptr);
+    assert(client._memoryCacheGet(shard, entry[0]->url) == entry[0]);
+    assert(shard.entries.size() == 3);
+    assert(shard.bytes <= capacity);
+
+    // restore shard
+    shard.lru.swap(lru);
+    shard.entries.swap(entries);
+    shard.bytes = bytes;
+}
+
+// Makes sure coalesced requests get the response body even if leader's callback consumes it
+void HttpClient::run_unit_tests_coalesced_response() {
+#if !defined(__VX_PLATFORM_WASM) // callbacks are dispatched asynchronously on wasm
+    HttpClient& client = HttpClient::shared();
+    URL url = URL::make("https://api.cu.bzh/test/coalesced");
+
+    std::string leaderBody;
+    HttpRequest_SharedPtr leader = HttpRequest::make(VX_HTTPMETHOD_GET, url.host(), url.port(),
+                                                     url.path(), url.queryParams(), true);
+    leader->setCallback([&leaderBody](HttpRequest_SharedPtr req) {
+        req->getResponse().readBytes(leaderBody);
+    });
+
+    std::string followerBody;
+    uint16_t followerStatusCode = 0;
+    HttpRequest_SharedPtr follower = HttpRequest::make(VX_HTTPMETHOD_GET, url.host(), url.port(),
+                                                       url.path(), url.queryParams(), true);
+    follower->setCallback([&followerBody, &followerStatusCode](HttpRequest_SharedPtr req) {
+        req->getResponse().readBytes(followerBody);
+        followerStatusCode = req->getResponse().getStatusCode();
+    });
+
+    {
+        const std::lock_guard<std::mutex> lock(client._schedulerLock);
+        CoalescedRequests& c = client._coalescedRequests[leader->constructURLString()];
+        c.leader = leader;
+        c.followers.push_back(follower);
+    }
+
+    // error status code, not to store the response in cache
+    HttpResponse& response = leader->getResponse();
+    response.setSuccess(true);
+    response.setStatusCode(404);
+    response.appendBytes("not found");
+    response.setDownloadComplete(true);
+    leader->setStatus(HttpRequest::Status::DONE);
+    leader->callCallback();
+
+    assert(leaderBody == "not found");
+    assert(followerBody == "not found");
+    assert(followerStatusCode == 404);
+    assert(follower->getStatus() == HttpRequest::Status::DONE);
+#endif
+}
+
 HttpClient::HttpClient() :
-_cacheMutex(),
-_callbackMiddleware(nullptr) {}
+_schedulerLock(),
+_hosts(),
+_requestsInFlight(),
+_coalescedRequests(),
+_maxConcurrentRequestsPerHost(VX_HTTP_MAX_CONCURRENT_REQUESTS_PER_HOST),
+_memoryCacheShardCapacity(VX_HTTP_CACHE_MEMORY_CAPACITY / VX_HTTP_CACHE_NB_SHARDS),
+_cacheMemoryHits(0),
+_cacheDiskHits(0),
+_cacheMisses(0),
+_cacheEvictions(0),
+_cachePendingDiskWrites(0),
+_callbackMiddleware(nullptr) {
+    for (CacheShard& shard : _cacheShards) {
+        shard.bytes = 0;
+    }
+}
 
-bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
+void HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
     // For now, there is no caching for streamed HTTP responses
     if (req->getOpts().getStreamResponse()) {
-        return false; // was not cached
+        return; // not cached
     }
 
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
-    bool ok = false;
-
     HttpResponse& response = req->getResponse();
     const HttpHeaders& responseHeaders = response.getHeaders();
 
@@ -341,7 +440,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
     const uint16_t statusCode = response.getStatusCode();
     if (statusCode < 200 || statusCode >= 400) {
         // status code represents an error, don't cache response
-        return false;
+        return;
     }
 
     // parse HTTP response headers related to caching
@@ -355,26 +454,436 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
             if (directive.rfind(prefix, 0) == 0) {
                 directive.erase(0, prefix.length());
                 if (vx::str::toUInt32(directive, maxAge) == false) {
-                    return false;
+                    return;
                 }
             }
         }
     }
 
-    std::string etag = "";
+    std::shared_ptr<CacheEntry> entry = std::make_shared<CacheEntry>();
+
     const bool etagFound = responseHeaders.find("etag") != responseHeaders.end();
     if (etagFound) {
-        etag = responseHeaders.at("etag");
+        entry->etag = responseHeaders.at("etag");
+    }
+
+    // HTTP response body
+    if (response.readAllBytes(entry->body) == false) {
+        return;
+    }
+
+    // TODO: used cached URL, do not reconstruct URL here
+    entry->url = req->constructURLString();
+    entry->creationTime = static_cast<uint32_t>(vx::device::timestampApple());
+    entry->maxAge = maxAge;
+    entry->statusCode = statusCode;
+    entry->headers = responseHeaders;
+
+    CacheShard& shard = _getCacheShard(entry->url);
+    {
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        _memoryCachePut(shard, entry, true);
+    }
+
+    // disk writes are done in order on a serial queue,
+    // a removal dispatched later for the same URL can't be overridden
+    _cachePendingDiskWrites.fetch_add(1);
+    const CacheEntry_SharedPtr constEntry = entry;
+    OperationQueue::getSlowBackground()->dispatch([this, &shard, constEntry]() {
+        {
+            const std::lock_guard<std::mutex> fileLock(shard.fileLock);
+            _cacheWriteFile(*constEntry);
+        }
+        _cachePendingDiskWrites.fetch_sub(1);
+    });
+}
+
+#if !defined(__VX_PLATFORM_WASM)
+
+HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_SharedPtr req) {
+    CacheMatch result;
+
+    if (req == nullptr) {
+        return result;
+    }
+
+    if (req->getStatus() != HttpRequest::Status::WAITING) {
+        return result;
+    }
+
+    // TODO: used cached URL, do not reconstruct URL here
+    const std::string requestURL = req->constructURLString();
+
+    CacheShard& shard = _getCacheShard(requestURL);
+    CacheEntry_SharedPtr entry = nullptr;
+    {
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        entry = _memoryCacheGet(shard, requestURL);
+    }
+
+    if (entry != nullptr) {
+        _cacheMemoryHits.fetch_add(1);
+    } else {
+        std::shared_ptr<CacheEntry> diskEntry = std::make_shared<CacheEntry>();
+        bool found;
+        {
+            const std::lock_guard<std::mutex> fileLock(shard.fileLock);
+            found = _cacheReadFile(requestURL, *diskEntry);
+        }
+        if (found == false) {
+            _cacheMisses.fetch_add(1);
+            return result;
+        }
+        _cacheDiskHits.fetch_add(1);
+        entry = diskEntry;
+
+        // a response may have been cached in the meantime, it's more recent
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        _memoryCachePut(shard, entry, false);
+    }
+
+    result.didFindCache = true;
+
+    if (entry->etag.empty() == false) {
+        req->setOneHeader("If-None-Match", entry->etag);
+    }
+
+    // check cache is not expired
+    const uint32_t currentTime = static_cast<uint32_t>(vx::device::timestampApple());
+    result.isStillFresh = currentTime < (entry->creationTime + entry->maxAge);
+
+    req->setCachedResponse(true, entry->statusCode, entry->headers, entry->body);
+
+    return result;
+}
+
+void HttpClient::removeCachedResponseForRequest(HttpRequest_SharedPtr req) {
+    if (req == nullptr) {
+        return;
     }
 
+    // if (req->getStatus() != HttpRequest::Status::DONE) {
+    //     return false;
+    // }
+
     // TODO: used cached URL, do not reconstruct URL here
     const std::string requestURL = req->constructURLString();
 
+    CacheShard& shard = _getCacheShard(requestURL);
+    {
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        _memoryCacheRemove(shard, requestURL);
+    }
+
+    //vxlog_debug("❌ REMOVE HTTP CACHE: %s", requestURL.c_str());
+
+    // same queue as writes, so that a pending write can't recreate the file
+    OperationQueue::getSlowBackground()->dispatch([&shard, requestURL]() {
+        const std::lock_guard<std::mutex> fileLock(shard.fileLock);
+        vx::fs::removeStorageFileOrDirectory(_cacheFilePath(requestURL));
+    });
+}
+
+#endif // !defined(__VX_PLATFORM_WASM)
+
+void HttpClient::setMemoryCacheCapacity(size_t bytes) {
+    // read without shard locks, a store racing with it is at worst applied on next insert
+    const size_t capacity = bytes / VX_HTTP_CACHE_NB_SHARDS;
+    _memoryCacheShardCapacity.store(capacity, std::memory_order_relaxed);
+
+    for (CacheShard& shard : _cacheShards) {
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        while (shard.bytes > capacity) {
+            _memoryCacheRemove(shard, shard.lru.back()->url);
+            _cacheEvictions.fetch_add(1);
+        }
+    }
+}
+
+void HttpClient::setMaxConcurrentRequestsPerHost(size_t n) {
+    std::vector<HttpRequest_SharedPtr> toSend;
+    {
+        const std::lock_guard<std::mutex> lock(_schedulerLock);
+        _maxConcurrentRequestsPerHost = n > 0 ? n : 1;
+
+        // more slots may be available now
+        for (auto& kv : _hosts) {
+            HostQueue& host = kv.second;
+            for (std::deque<HttpRequest_SharedPtr>& waiting : host.waiting) {
+                while (host.inFlight < _maxConcurrentRequestsPerHost && waiting.empty() == false) {
+                    HttpRequest_SharedPtr req = waiting.front();
+                    waiting.pop_front();
+                    host.inFlight += 1;
+                    _requestsInFlight.insert(req.get());
+                    toSend.push_back(req);
+                }
+            }
+        }
+    }
+    _send(toSend);
+}
+
+void HttpClient::_schedule(HttpRequest_SharedPtr req) {
+    req->_queuedAt = std::chrono::steady_clock::now();
+
+    std::vector<HttpRequest_SharedPtr> toSend;
+    {
+        const std::lock_guard<std::mutex> lock(_schedulerLock);
+
+        if (req->getMethod() == VX_HTTPMETHOD_GET && req->getOpts().getStreamResponse() == false) {
+            const std::string url = req->constructURLString();
+            auto it = _coalescedRequests.find(url);
+            if (it == _coalescedRequests.end()) {
+                CoalescedRequests& c = _coalescedRequests[url];
+                c.leader = req;
+            } else if (it->second.leader->getHeaders() == req->getHeaders() &&
+                       it->second.leader->getOpts().getForceCacheRevalidate() == req->getOpts().getForceCacheRevalidate()) {
+                it->second.followers.push_back(req);
+                return;
+            }
+        }
+
+        _startOrQueue(req, toSend);
+    }
+    _send(toSend);
+}
+
+std::vector<HttpRequest_SharedPtr> HttpClient::_takeFollowers(HttpRequest_SharedPtr req) {
+    std::vector<HttpRequest_SharedPtr> followers;
+    if (req->_coalesced || req->getMethod() != VX_HTTPMETHOD_GET) {
+        return followers;
+    }
+    {
+        const std::lock_guard<std::mutex> lock(_schedulerLock);
+
+        auto it = _coalescedRequests.find(req->constructURLString());
+        if (it != _coalescedRequests.end() && it->second.leader == req) {
+            followers.swap(it->second.followers);
+            _coalescedRequests.erase(it);
+        }
+    }
+
+    if (followers.empty()) {
+        return followers;
+    }
+
+    // followers get a copy of the response
+    HttpResponse& response = req->getResponse();
+    std::string bytes;
+    response.readAllBytes(bytes);
+
+    for (HttpRequest_SharedPtr& f : followers) {
+        f->_coalesced = true;
+        f->_sentAt = req->_sentAt > f->_queuedAt ? req->_sentAt : f->_queuedAt;
+
+        HttpResponse& r = f->getResponse();
+        r.setSuccess(response.getSuccess());
+        r.setStatusCode(response.getStatusCode());
+        r.setHeaders(response.getHeaders());
+        r.appendBytes(bytes);
+        r.setUseLocalCache(response.getUseLocalCache());
+        r.setDownloadComplete(response.getDownloadComplete());
+        f->setStatus(response.getSuccess() ? HttpRequest::Status::DONE : HttpRequest::Status::FAILED);
+    }
+    return followers;
+}
+
+void HttpClient::_requestDidFinish(HttpRequest_SharedPtr req,
+                                   const std::vector<HttpRequest_SharedPtr>& followers) {
+    std::vector<HttpRequest_SharedPtr> toSend;
+    {
+        const std::lock_guard<std::mutex> lock(_schedulerLock);
+        _releaseSlot(req.get(), toSend);
+    }
+    _send(toSend);
+
+    for (const HttpRequest_SharedPtr& f : followers) {
+        f->callCallback();
+    }
+}
+
+void HttpClient::_requestDidCancel(HttpRequest_SharedPtr req) {
+    std::vector<HttpRequest_SharedPtr> toSend;
+    {
+        const std::lock_guard<std::mutex> lock(_schedulerLock);
+
+        _releaseSlot(req.get(), toSend);
+
+        // remove from waiting requests
+        auto host = _hosts.find(_hostKey(*req));
+        if (host != _hosts.end()) {
+            for (std::deque<HttpRequest_SharedPtr>& waiting : host->second.waiting) {
+                for (auto it = waiting.begin(); it != waiting.end(); ++it) {
+                    if (*it == req) {
+                        waiting.erase(it);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (req->getMethod() == VX_HTTPMETHOD_GET) {
+            auto it = _coalescedRequests.find(req->constructURLString());
+            if (it != _coalescedRequests.end()) {
+                CoalescedRequests& c = it->second;
+                if (c.leader == req) {
+                    if (c.followers.empty()) {
+                        _coalescedRequests.erase(it);
+                    } else {
+                        // first follower is sent instead
+                        c.leader = c.followers.front();
+                        c.followers.erase(c.followers.begin());
+                        _startOrQueue(c.leader, toSend);
+                    }
+                } else {
+                    for (auto f = c.followers.begin(); f != c.followers.end(); ++f) {
+                        if (*f == req) {
+                            c.followers.erase(f);
+                            break;
+                        }
+                    }
+                }
+            }
+        }
+    }
+    _send(toSend);
+}
+
+void HttpClient::_startOrQueue(const HttpRequest_SharedPtr& req,
+                               std::vector<HttpRequest_SharedPtr>& toSend) {
+    HostQueue& host = _hosts[_hostKey(*req)];
+    if (host.inFlight < _maxConcurrentRequestsPerHost) {
+        host.inFlight += 1;
+        _requestsInFlight.insert(req.get());
+        toSend.push_back(req);
+    } else {
+        host.waiting[static_cast<size_t>(req->getOpts().getPriority())].push_back(req);
+    }
+}
+
+void HttpClient::_releaseSlot(HttpRequest *req, std::vector<HttpRequest_SharedPtr>& toSend) {
+    if (_requestsInFlight.erase(req) == 0) {
+        return; // not holding a slot
+    }
+
+    auto it = _hosts.find(_hostKey(*req));
+    if (it == _hosts.end()) {
+        return;
+    }
+    HostQueue& host = it->second;
+    host.inFlight -= 1;
+
+    // highest priority first
+    for (std::deque<HttpRequest_SharedPtr>& waiting : host.waiting) {
+        while (host.inFlight < _maxConcurrentRequestsPerHost && waiting.empty() == false) {
+            HttpRequest_SharedPtr next = waiting.front();
+            waiting.pop_front();
+            host.inFlight += 1;
+            _requestsInFlight.insert(next.get());
+            toSend.push_back(next);
+        }
+    }
+
+    if (host.inFlight == 0) {
+        _hosts.erase(it);
+    }
+}
+
+void HttpClient::_send(const std::vector<HttpRequest_SharedPtr>& toSend) {
+    for (const HttpRequest_SharedPtr& req : toSend) {
+        req->_sentAt = std::chrono::steady_clock::now();
+        req->_sendAsync();
+    }
+}
+
+std::string HttpClient::_hostKey(const HttpRequest& req) {
+    return req.getHost() + ":" + std::to_string(req.getPort());
+}
+
+HttpClient::CacheStats HttpClient::getCacheStats() {
+    CacheStats stats;
+    stats.memoryHits = _cacheMemoryHits;
+    stats.diskHits = _cacheDiskHits;
+    stats.misses = _cacheMisses;
+    stats.evictions = _cacheEvictions;
+    stats.pendingDiskWrites = _cachePendingDiskWrites;
+    stats.memoryEntries = 0;
+    stats.memoryBytes = 0;
+    for (CacheShard& shard : _cacheShards) {
+        const std::lock_guard<std::mutex> lock(shard.lock);
+        stats.memoryEntries += shard.entries.size();
+        stats.memoryBytes += shard.bytes;
+    }
+    return stats;
+}
+
+size_t HttpClient::CacheEntry::size() const {
+    size_t s = sizeof(CacheEntry) + url.size() + etag.size() + body.size();
+    for (const auto& kv : headers) {
+        s += kv.first.size() + kv.second.size();
+    }
+    return s;
+}
+
+HttpClient::CacheShard& HttpClient::_getCacheShard(const std::string& url) {
+    return _cacheShards[std::hash<std::string>()(url) % VX_HTTP_CACHE_NB_SHARDS];
+}
+
+HttpClient::CacheEntry_SharedPtr HttpClient::_memoryCacheGet(CacheShard& shard,
+                                                             const std::string& url) {
+    auto it = shard.entries.find(url);
+    if (it == shard.entries.end()) {
+        return nullptr;
+    }
+    shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+    return *(it->second);
+}
+
+bool HttpClient::_memoryCachePut(CacheShard& shard, const CacheEntry_SharedPtr& entry, bool replace) {
+    auto it = shard.entries.find(entry->url);
+    if (it != shard.entries.end()) {
+        if (replace == false) {
+            return true;
+        }
+        _memoryCacheRemove(shard, entry->url);
+    }
+
+    const size_t size = entry->size();
+    const size_t capacity = _memoryCacheShardCapacity.load(std::memory_order_relaxed);
+    if (size > capacity) {
+        return false;
+    }
+
+    while (shard.bytes + size > capacity) {
+        _memoryCacheRemove(shard, shard.lru.back()->url);
+        _cacheEvictions.fetch_add(1);
+    }
+
+    shard.lru.push_front(entry);
+    shard.entries[entry->url] = shard.lru.begin();
+    shard.bytes += size;
+    return true;
+}
+
+void HttpClient::_memoryCacheRemove(CacheShard& shard, const std::string& url) {
+    auto it = shard.entries.find(url);
+    if (it == shard.entries.end()) {
+        return;
+    }
+    shard.bytes -= (*(it->second))->size();
+    shard.lru.erase(it->second);
+    shard.entries.erase(it);
+}
+
+std::string HttpClient::_cacheFilePath(const std::string& url) {
     // generate hash from URL
-    const std::string urlHash = md5(requestURL);
+    return std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + md5(url);
+}
 
-    // open cache file in storage
-    const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
+bool HttpClient::_cacheWriteFile(const CacheEntry& entry) {
+    bool ok = false;
+
+    const std::string filepath = _cacheFilePath(entry.url);
 
     // creates file is not present, truncate it otherwise
     FILE* fd = vx::fs::openStorageFile(filepath, "wb");
@@ -392,7 +901,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // etag
     {
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, etag, fd);
+        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, entry.etag, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -400,8 +909,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // file creation time
     {
-        const uint32_t creationTime = static_cast<uint32_t>(vx::device::timestampApple());
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, creationTime, fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, entry.creationTime, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -409,7 +917,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // max-age value
     {
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, maxAge, fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, entry.maxAge, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -417,7 +925,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // request URL
     {
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_URL, requestURL, fd);
+        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_URL, entry.url, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -425,7 +933,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP status
     {
-        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, response.getStatusCode(), fd);
+        ok = _cacheWriteUint32Chunk(VX_HTTP_CACHE_CHUNK_STATUSCODE, entry.statusCode, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -433,7 +941,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP response headers
     {
-        ok = _cacheWriteMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, responseHeaders, fd);
+        ok = _cacheWriteMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, entry.headers, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -441,12 +949,7 @@ bool HttpClient::cacheHttpResponse(HttpRequest_SharedPtr req) {
 
     // HTTP response body
     {
-        std::string allBytes;
-        ok = response.readAllBytes(allBytes);
-        if (ok == false) {
-            goto return_false;
-        }
-        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_BODY, allBytes, fd);
+        ok = _cacheWriteStringChunk(VX_HTTP_CACHE_CHUNK_BODY, entry.body, fd);
         if (ok == false) {
             goto return_false;
         }
@@ -462,48 +965,26 @@ return_false:
     return false;
 }
 
-#if !defined(__VX_PLATFORM_WASM)
-
-HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_SharedPtr req) {
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
-
+bool HttpClient::_cacheReadFile(const std::string& url, CacheEntry& entry) {
     bool ok = false;
-    CacheMatch result;
-
-    if (req == nullptr) {
-        return result;
-    }
-
-    if (req->getStatus() != HttpRequest::Status::WAITING) {
-        return result;
-    }
-
-    // TODO: used cached URL, do not reconstruct URL here
-    const std::string requestURL = req->constructURLString();
-
-    // generate hash from URL
-    const std::string urlHash = md5(requestURL);
 
-    // open cache file in storage
-    const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
+    const std::string filepath = _cacheFilePath(url);
 
     // check cache file exists
     {
         bool isDir = false;
         const bool exists = vx::fs::storageFileExists(filepath, isDir);
         if (exists == false || isDir) {
-            return result;
+            return false;
         }
     }
 
     // open cache file
     FILE *fd = vx::fs::openStorageFile(filepath);
     if (fd == nullptr) {
-        return result;
+        return false;
     }
 
-    result.didFindCache = true;
-
     // skip header
     {
         fseek(fd, VX_HTTP_CACHE_MAGICBYTES_LEN, SEEK_SET);
@@ -520,42 +1001,32 @@ HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_Share
     }
 
     if (fileFormatVersion > 1) {
-        std::string etag;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, etag, fd);
+        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_ETAG, entry.etag, fd);
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
-        if (etag.empty() == false) {
-            req->setOneHeader("If-None-Match", etag);
-        }
     } else {
         // ignore & delete old cache
         goto return_cache_not_found_and_delete_cache;
     }
 
-    // check cache is not expired
+    // expiration
     {
-        uint32_t cacheCreationTime = 0;
-        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, cacheCreationTime, fd);
+        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_CREATIONTIME, entry.creationTime, fd);
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
 
-        uint32_t maxAge = 0;
-        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, maxAge, fd);
+        ok = _cacheReadUint32Chunk(VX_HTTP_CACHE_CHUNK_MAXAGE, entry.maxAge, fd);
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
-
-        const uint32_t currentTime = static_cast<uint32_t>(vx::device::timestampApple());
-        result.isStillFresh = currentTime < (cacheCreationTime + maxAge);
     }
 
     // read cache content
     {
-        std::string url;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_URL, url, fd);
-        if (ok == false || url != requestURL) {
+        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_URL, entry.url, fd);
+        if (ok == false || entry.url != url) {
             goto return_cache_not_found_and_delete_cache;
         }
 
@@ -564,61 +1035,28 @@ HttpClient::CacheMatch HttpClient::getCachedResponseForRequest(HttpRequest_Share
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
+        entry.statusCode = static_cast<uint16_t>(statusCode);
 
-        HttpHeaders headers;
-        ok = _cacheReadMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, headers, fd);
+        ok = _cacheReadMapStringStringChunk(VX_HTTP_CACHE_CHUNK_HEADERS, entry.headers, fd);
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
 
-        std::string body;
-        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_BODY, body, fd);
+        ok = _cacheReadStringChunk(VX_HTTP_CACHE_CHUNK_BODY, entry.body, fd);
         if (ok == false) {
             goto return_cache_not_found_and_delete_cache;
         }
-
-        req->setCachedResponse(true, static_cast<uint16_t>(statusCode), std::move(headers), body);
     }
 
     fclose(fd);
-    return result;
+    return true;
 
 return_cache_not_found_and_delete_cache:
     fclose(fd);
     vx::fs::removeStorageFileOrDirectory(filepath);
-    result.didFindCache = false;
-    result.isStillFresh = false;
-    return result;
-}
-
-bool HttpClient::removeCachedResponseForRequest(HttpRequest_SharedPtr req) {
-    const std::lock_guard<std::mutex> lock(this->_cacheMutex);
-
-    if (req == nullptr) {
-        return false;
-    }
-
-    // if (req->getStatus() != HttpRequest::Status::DONE) {
-    //     return false;
-    // }
-
-    // TODO: used cached URL, do not reconstruct URL here
-    const std::string requestURL = req->constructURLString();
-
-    // generate hash from URL
-    const std::string urlHash = md5(requestURL);
-
-    // open cache file in storage
-    const std::string filepath = std::string(VX_HTTP_CACHE_DIR_NAME) + "/" + urlHash;
-
-    //vxlog_debug("❌ REMOVE HTTP CACHE: %s", filepath.c_str());
-
-    const bool ok = vx::fs::removeStorageFileOrDirectory(filepath);
-    return ok;
+    return false;
 }
 
-#endif // !defined(__VX_PLATFORM_WASM)
-
 bool HttpClient::_cacheWriteFileHeader(const uint8_t fileFormatVersion,
                                        const uint8_t compressionMethod,
                                        FILE * const fd) {
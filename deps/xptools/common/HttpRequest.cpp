@@ -62,10 +62,23 @@ bool HttpRequest::callCallback() {
         vxlog_warning("HttpRequest callback is being called more than one time!");
         return false;
     }
+
+    // streamed responses trigger the callback several times
+    const bool finished = strongSelf->getOpts().getStreamResponse() == false ||
+                          strongSelf->getResponse().getDownloadComplete() ||
+                          strongSelf->getResponse().getSuccess() == false;
+    if (finished && strongSelf->_finished) {
+        return false;
+    }
     strongSelf->_callbackCalled = true;
+    if (finished) {
+        strongSelf->_finished = true;
+        // transfer time doesn't include callback execution
+        strongSelf->_finishedAt = std::chrono::steady_clock::now();
+    }
 
 #if defined(__VX_PLATFORM_WASM)
-    vx::OperationQueue::getMain()->dispatch([strongSelf](){
+    vx::OperationQueue::getMain()->dispatch([strongSelf, finished](){
 #endif
 
         // call response middleware
@@ -100,16 +113,27 @@ bool HttpRequest::callCallback() {
 
         // Store response in cache (if conditions are met)
         // optim possible: if it was a 304, we don't need to update the response bytes in the cache
-        const bool ok = vx::HttpClient::shared().cacheHttpResponse(strongSelf);
-        if (ok) {
-            // vxlog_debug("HTTP response cached : %s", strongSelf->constructURLString().c_str());
+        // coalesced requests share the response of a request that already cached it
+        if (strongSelf->_coalesced == false) {
+            vx::HttpClient::shared().cacheHttpResponse(strongSelf);
         }
 #endif
 
+        // coalesced requests get their copy of the response before the callback can consume it
+        std::vector<HttpRequest_SharedPtr> followers;
+        if (finished) {
+            followers = HttpClient::shared()._takeFollowers(strongSelf);
+        }
+
         if (strongSelf->_callback != nullptr) {
             strongSelf->_callback(strongSelf);
         }
 
+        if (finished) {
+            // frees connection slot, sends next request
+            HttpClient::shared()._requestDidFinish(strongSelf, followers);
+        }
+
 #if defined(__VX_PLATFORM_WASM)
     });
 #endif
@@ -175,6 +199,8 @@ void HttpRequest::sendAsync() {
             cacheMatch.isStillFresh &&
             this->_opts.getForceCacheRevalidate() == false) {
             // use cached response
+            strongSelf->_queuedAt = std::chrono::steady_clock::now();
+            strongSelf->_sentAt = strongSelf->_queuedAt;
             strongSelf->_useCachedResponse();
             // apply cachedResponse to response
             // call request callback
@@ -191,7 +217,8 @@ void HttpRequest::sendAsync() {
     // update status
     strongSelf->setStatus(HttpRequest::Status::PROCESSING);
 
-    strongSelf->_sendAsync();
+    // sent right away, or when a slot is available for the host
+    HttpClient::shared()._schedule(strongSelf);
 }
 
 #if defined(__VX_PLATFORM_WASM)
@@ -264,6 +291,9 @@ void HttpRequest::cancel() {
                 return;
         }
 
+        // request may be waiting for a slot, or holding one
+        HttpClient::shared()._requestDidCancel(strongSelf);
+
         strongSelf->_cancel();
 
 #if defined(__VX_PLATFORM_WASM)
@@ -275,6 +305,20 @@ HttpResponse& HttpRequest::getResponse() {
     return this->_response;
 }
 
+std::chrono::microseconds HttpRequest::getQueueWaitTime() const {
+    if (_sentAt == std::chrono::steady_clock::time_point()) {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(_sentAt - _queuedAt);
+}
+
+std::chrono::microseconds HttpRequest::getTransferTime() const {
+    if (_finishedAt == std::chrono::steady_clock::time_point()) {
+        return std::chrono::microseconds(0);
+    }
+    return std::chrono::duration_cast<std::chrono::microseconds>(_finishedAt - _sentAt);
+}
+
 void HttpRequest::setCachedResponse(const bool success,
                                     const uint16_t statusCode,
                                     const std::unordered_map<std::string, std::string>& headers,
@@ -414,11 +458,16 @@ _bodyBytes(),
 _written(0),
 _callback(nullptr),
 _callbackCalled(false),
+_finished(false),
 _response(),
 _cachedResponse(),
 _statusMutex(),
 _status(Status::WAITING),
 _creationTime(std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch())),
+_queuedAt(),
+_sentAt(),
+_finishedAt(),
+_coalesced(false),
 _cache_pathAndQuery(),
 _platformObject(nullptr) {}
 
@@ -8,6 +8,7 @@
 #include "OperationQueue.hpp"
 
 #include <queue>
+#include <vector>
 
 #ifdef __VX_SINGLE_THREAD
 #define LOCK_GUARD
@@ -20,21 +21,22 @@
 #define UNLOCK lock.unlock();
 #endif
 
-#define MAX_OPERATIONS_PER_CYCLE 10
-#define SLEEP_TIME_BETWEEN_CYCLES 16 // in ms
+// Operations run by an async queue before giving its pool worker back,
+// so that other queues and tasks of same priority are not starved.
+#define MAX_OPERATIONS_PER_TASK 64
 
 using namespace vx;
 
 OperationQueue *OperationQueue::getMain() {
     if (_mainQueue == nullptr) {
-        _mainQueue = new OperationQueue(Type::sync);
+        _mainQueue = new OperationQueue(Type::sync, ThreadPool::Priority::high);
     }
     return _mainQueue;
 }
 
 OperationQueue *OperationQueue::getServerMain() {
     if (_serverMainQueue == nullptr) {
-        _serverMainQueue = new OperationQueue(Type::sync);
+        _serverMainQueue = new OperationQueue(Type::sync, ThreadPool::Priority::high);
     }
     return _serverMainQueue;
 }
@@ -44,7 +46,7 @@ OperationQueue *OperationQueue::getBackground() {
     return _mainQueue;
 #else
     if (_backgroundQueue == nullptr) {
-        _backgroundQueue = new OperationQueue(Type::async);
+        _backgroundQueue = new OperationQueue(Type::async, ThreadPool::Priority::high);
     }
     return _backgroundQueue;
 #endif
@@ -55,20 +57,23 @@ OperationQueue *OperationQueue::getSlowBackground() {
     return _mainQueue;
 #else
     if (_slowBackgroundQueue == nullptr) {
-        _slowBackgroundQueue = new OperationQueue(Type::async);
+        _slowBackgroundQueue = new OperationQueue(Type::async, ThreadPool::Priority::low);
     }
     return _slowBackgroundQueue;
 #endif
 }
 
-OperationQueue::OperationQueue(Type type) :
+OperationQueue::OperationQueue(Type type, ThreadPool::Priority priority) :
 _queue(),
-_queueScheduled() {
+_queueScheduled(),
+_executed(0),
+_totalLatencyUs(0),
+_maxLatencyUs(0) {
     _type = type;
+    _priority = priority;
     _state = State::idle;
 #ifndef __VX_SINGLE_THREAD
-    // create a thread object that doesn't represent an execution thread
-    _thread = std::thread();
+    _wakeUpHandle = TimerQueue::invalidHandle;
 #endif
 }
 
@@ -78,97 +83,85 @@ OperationQueue::~OperationQueue() {
 
 /// dispatch and copy
 void OperationQueue::dispatch(const fp_t& op) {
+    Operation o;
+    o.fn = op;
+    o.dispatchedAt = std::chrono::steady_clock::now();
     {
         LOCK_GUARD
-        _queue.push_back(op);
+        _queue.push_back(std::move(o));
     }
-    this->startThreadIfNeeded();
+    this->runInBackgroundIfNeeded();
 }
 
 /// dispatch and move
 void OperationQueue::dispatch(fp_t&& op) {
+    Operation o;
+    o.fn = std::move(op);
+    o.dispatchedAt = std::chrono::steady_clock::now();
     {
         LOCK_GUARD
-        _queue.push_back(std::move(op));
+        _queue.push_back(std::move(o));
     }
-    this->startThreadIfNeeded();
+    this->runInBackgroundIfNeeded();
 }
 
 /// dispatch (in front of queue) and copy
 void OperationQueue::dispatchFirst(const fp_t& op) {
+    Operation o;
+    o.fn = op;
+    o.dispatchedAt = std::chrono::steady_clock::now();
     {
         LOCK_GUARD
-        _queue.push_front(op);
+        _queue.push_front(std::move(o));
     }
-    this->startThreadIfNeeded();
+    this->runInBackgroundIfNeeded();
 }
 
 /// dispatch (in front of queue) and move
 void OperationQueue::dispatchFirst(fp_t&& op) {
+    Operation o;
+    o.fn = std::move(op);
+    o.dispatchedAt = std::chrono::steady_clock::now();
     {
         LOCK_GUARD
-        _queue.push_front(std::move(op));
+        _queue.push_front(std::move(o));
     }
-    this->startThreadIfNeeded();
+    this->runInBackgroundIfNeeded();
 }
 
-void OperationQueue::schedule(const fp_t& op, int64_t ms) {
-    if (ms < 0) {
-        // cannot schedule in the past
-        return;
-    }
-    {
-        LOCK_GUARD
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        std::chrono::system_clock::time_point scheduled_tp = now + std::chrono::milliseconds(ms);
-        _queueScheduled[scheduled_tp] = op;
-    }
-    this->startThreadIfNeeded();
+TimerQueue::Handle OperationQueue::schedule(const fp_t& op, int64_t ms) {
+    return this->_schedule(fp_t(op), ms);
 }
 
-void OperationQueue::schedule(const fp_t&& op, int64_t ms) {
-    if (ms < 0) {
-        // cannot schedule in the past
-        return;
-    }
+TimerQueue::Handle OperationQueue::schedule(const fp_t&& op, int64_t ms) {
+    return this->_schedule(fp_t(op), ms);
+}
+
+bool OperationQueue::cancelScheduled(TimerQueue::Handle handle) {
+    LOCK_GUARD
+    return _queueScheduled.cancel(handle);
+}
+
+void OperationQueue::callFirstDispatchedBlocks(size_t n) {
+    // all due scheduled operations are called, in one batch
+    std::vector<fp_t> due;
     {
         LOCK_GUARD
-        std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-        std::chrono::system_clock::time_point scheduled_tp = now + std::chrono::milliseconds(ms);
-        _queueScheduled[scheduled_tp] = std::move(op);
+        _queueScheduled.popDue(TimerQueue::Clock::now(), due);
+    }
+    // called without lock, op() could need to add something in the queue
+    for (fp_t& op : due) {
+        op();
     }
-    this->startThreadIfNeeded();
-}
 
-void OperationQueue::callFirstDispatchedBlocks(size_t n) {
-    bool skipScheduled = false;
     while (n > 0) {
         LOCK
 
-        if (skipScheduled == false && _queueScheduled.empty() == false) {
-            std::chrono::system_clock::time_point now = std::chrono::system_clock::now();
-            std::pair<std::chrono::system_clock::time_point,fp_t> entry = *(_queueScheduled.begin());
-            if (entry.first <= now) {
-                fp_t op = entry.second;
-                _queueScheduled.erase(_queueScheduled.begin());
-                // unlock before calling op()
-                // because op() could need to add something in the queue
-                UNLOCK
-                op();
-                
-                --n;
-                continue;
-            } else {
-                skipScheduled = true; // other scheduled ops are for a later time
-            }
-        }
-        
         if (_queue.empty()) {
             UNLOCK
             break;
         } else {
-            fp_t op = std::move(_queue.front());
-            _queue.pop_front();
+            fp_t op = _popFirst();
             // unlock before calling op()
             // because op() could need to add something in the queue
             UNLOCK
@@ -179,6 +172,16 @@ void OperationQueue::callFirstDispatchedBlocks(size_t n) {
     }
 }
 
+OperationQueue::Metrics OperationQueue::getMetrics() const {
+    LOCK_GUARD
+    Metrics metrics;
+    metrics.depth = _queue.size();
+    metrics.executed = _executed;
+    metrics.totalLatencyUs = _totalLatencyUs;
+    metrics.maxLatencyUs = _maxLatencyUs;
+    return metrics;
+}
+
 // MARK: - private -
 
 ///
@@ -194,73 +197,113 @@ OperationQueue *OperationQueue::_backgroundQueue = nullptr;
 OperationQueue *OperationQueue::_slowBackgroundQueue = nullptr;
 
 ///
-void OperationQueue::startThreadIfNeeded() {
+OperationQueue::fp_t OperationQueue::_popFirst() {
+    Operation o = std::move(_queue.front());
+    _queue.pop_front();
+
+    const uint64_t latency = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                              o.dispatchedAt).count());
+    ++_executed;
+    _totalLatencyUs += latency;
+    if (latency > _maxLatencyUs) {
+        _maxLatencyUs = latency;
+    }
+    return std::move(o.fn);
+}
+
+///
+TimerQueue::Handle OperationQueue::_schedule(fp_t&& op, int64_t ms) {
+    if (ms < 0) {
+        // cannot schedule in the past
+        return TimerQueue::invalidHandle;
+    }
+    LOCK_GUARD
+    const TimerQueue::Handle handle = _queueScheduled.add(std::move(op),
+                                                          TimerQueue::Clock::now() +
+                                                          std::chrono::milliseconds(ms));
+#ifndef __VX_SINGLE_THREAD
+    if (_type == Type::async) {
+        _armScheduledWakeUp();
+    }
+#endif
+    return handle;
+}
+
+///
+void OperationQueue::runInBackgroundIfNeeded() {
 #ifdef __VX_SINGLE_THREAD
     return;
 #else
     if (_type != Type::async) {
-        return; // only async operation queues can have a thread
+        return; // only async operation queues run in background
     }
-    LOCK_GUARD
-    if (_state != State::runningInBackground) {
-        _state = State::runningInBackground;
-        if (_thread.joinable()) {
-            _thread.join();
+    {
+        LOCK_GUARD
+        if (_state == State::runningInBackground) {
+            return; // operation will be picked by running task
         }
-        _thread = std::thread(&OperationQueue::threadFunction, this);
-    } // else thread is already running
+        _state = State::runningInBackground;
+    }
+    ThreadPool::shared().submit([this]() { this->_runOperations(); }, _priority);
 #endif
 }
 
 #ifndef __VX_SINGLE_THREAD
-void OperationQueue::threadFunction() {
-    std::unique_lock<std::mutex> locker(_lock, std::defer_lock);
-    std::chrono::system_clock::time_point now;
-    std::queue<fp_t> operations;
-    std::map<std::chrono::system_clock::time_point,fp_t>::iterator itScheduled;
-    std::pair<std::chrono::system_clock::time_point,fp_t> opScheduled;
-    fp_t op;
-    int n;
-
-    while (true) {
-        n = 0;
-        locker.lock();
-
-        if (_queue.empty() && _queueScheduled.empty()) {
+void OperationQueue::_runOperations() {
+    for (int n = 0; n < MAX_OPERATIONS_PER_TASK; ++n) {
+        LOCK
+        if (_queue.empty()) {
             _state = State::idle;
-            locker.unlock();
-            break;
+            return;
         }
+        fp_t op = _popFirst();
+        // unlock before calling op()
+        // because op() could need to add something in the queue
+        UNLOCK
+        op();
+    }
+    // remaining operations run in a new task, queued behind other tasks of same priority
+    ThreadPool::shared().submit([this]() { this->_runOperations(); }, _priority);
+}
 
-        if (_queueScheduled.empty() == false) {
-            // TODO: _queueScheduled -> std::list<std::pair<uint64_t,fp_t>>
-            now = std::chrono::system_clock::now();
-            itScheduled = _queueScheduled.begin();
-
-            opScheduled = *(itScheduled);
-
-            if (opScheduled.first <= now) {
-                operations.push(opScheduled.second);
-                ++n;
-                _queueScheduled.erase(itScheduled);
-            }
-        }
-        
-        while (_queue.empty() == false && n < MAX_OPERATIONS_PER_CYCLE) {
-            operations.push(_queue.front());
-            ++n;
-            _queue.pop_front();
+void OperationQueue::_armScheduledWakeUp() {
+    TimerQueue::Clock::time_point next;
+    if (_queueScheduled.getNextDue(next) == false) {
+        return;
+    }
+    if (_wakeUpHandle != TimerQueue::invalidHandle) {
+        if (_wakeUpDue <= next) {
+            return; // planned wake up comes first
         }
+        ThreadPool::shared().cancel(_wakeUpHandle);
+    }
+    _wakeUpDue = next;
+    _wakeUpHandle = ThreadPool::shared().submitAt([this]() { this->_dispatchDueScheduled(); },
+                                                  _priority,
+                                                  next);
+}
 
-        locker.unlock();
-
-        while (operations.empty() == false) {
-            op = operations.front();
-            operations.pop();
-            op();
+void OperationQueue::_dispatchDueScheduled() {
+    std::vector<fp_t> due;
+    {
+        LOCK_GUARD
+        _wakeUpHandle = TimerQueue::invalidHandle;
+
+        // all due operations are dispatched in one batch,
+        // to run after already dispatched ones
+        const TimerQueue::Clock::time_point now = TimerQueue::Clock::now();
+        _queueScheduled.popDue(now, due);
+        for (fp_t& op : due) {
+            Operation o;
+            o.fn = std::move(op);
+            o.dispatchedAt = now;
+            _queue.push_back(std::move(o));
         }
-
-        std::this_thread::sleep_for(std::chrono::milliseconds(SLEEP_TIME_BETWEEN_CYCLES));
+        _armScheduledWakeUp();
+    }
+    if (due.empty() == false) {
+        this->runInBackgroundIfNeeded();
     }
 }
 #endif
@@ -0,0 +1,176 @@
+//
+//  PayloadBuffer.cpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "PayloadBuffer.hpp"
+
+// C++
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <new>
+#include <vector>
+
+#define POOL_MIN_CAPACITY_SHIFT 6 // 64 bytes
+#define POOL_NB_SIZE_CLASSES 11 // up to 64KB
+#define POOL_MAX_BUFFERS_PER_CLASS 256
+
+using namespace vx;
+
+const size_t PayloadBuffer::headroomSize;
+
+namespace {
+
+struct Pool {
+    std::mutex mutex;
+    std::vector<void *> freeLists[POOL_NB_SIZE_CLASSES];
+};
+
+Pool& pool() {
+    // never destroyed, buffers can be released after static destructors run
+    static Pool *p = new Pool();
+    return *p;
+}
+
+std::atomic<uint64_t> nbAllocations(0);
+std::atomic<uint64_t> nbReuses(0);
+std::atomic<uint64_t> nbPooled(0);
+
+// returns -1 if capacity is too large to be pooled
+int sizeClassForCapacity(size_t capacity) {
+    for (int i = 0; i < POOL_NB_SIZE_CLASSES; ++i) {
+        if (capacity <= (static_cast<size_t>(1) << (POOL_MIN_CAPACITY_SHIFT + i))) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+size_t capacityForSizeClass(int sizeClass) {
+    return static_cast<size_t>(1) << (POOL_MIN_CAPACITY_SHIFT + sizeClass);
+}
+
+}
+
+PayloadBuffer *PayloadBuffer::acquire(size_t capacity) {
+    const int sizeClass = sizeClassForCapacity(capacity);
+    void *memory = nullptr;
+
+    if (sizeClass >= 0) {
+        capacity = capacityForSizeClass(sizeClass);
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        std::vector<void *>& freeList = p.freeLists[sizeClass];
+        if (freeList.empty() == false) {
+            memory = freeList.back();
+            freeList.pop_back();
+            --nbPooled;
+            ++nbReuses;
+        }
+    }
+
+    if (memory == nullptr) {
+        memory = malloc(sizeof(PayloadBuffer) + headroomSize + capacity);
+        if (memory == nullptr) {
+            return nullptr;
+        }
+        ++nbAllocations;
+    }
+
+    PayloadBuffer *b = new (memory) PayloadBuffer();
+    b->_sizeClass = sizeClass;
+    b->_capacity = capacity;
+    b->_headroom = headroomSize;
+    b->_data = static_cast<char *>(memory) + sizeof(PayloadBuffer) + headroomSize;
+    return b;
+}
+
+PayloadBuffer *PayloadBuffer::adopt(char *bytes, size_t len) {
+    void *memory = malloc(sizeof(PayloadBuffer));
+    if (memory == nullptr) {
+        free(bytes);
+        return nullptr;
+    }
+    ++nbAllocations;
+
+    PayloadBuffer *b = new (memory) PayloadBuffer();
+    b->_capacity = len;
+    b->_data = bytes;
+    b->_adopted = bytes;
+    return b;
+}
+
+bool PayloadBuffer::append(PayloadBuffer *&buffer, size_t& len, const char *bytes, size_t n) {
+    if (buffer == nullptr || len + n > buffer->capacity()) {
+        // grow geometrically, messages often come in several fragments
+        size_t capacity = buffer != nullptr ? buffer->capacity() * 2 : n;
+        if (capacity < len + n) {
+            capacity = len + n;
+        }
+        PayloadBuffer *larger = acquire(capacity);
+        if (larger == nullptr) {
+            return false;
+        }
+        if (buffer != nullptr) {
+            memcpy(larger->data(), buffer->data(), len);
+            buffer->release();
+        }
+        buffer = larger;
+    }
+    memcpy(buffer->data() + len, bytes, n);
+    len += n;
+    return true;
+}
+
+PayloadBuffer::PoolStats PayloadBuffer::getPoolStats() {
+    PoolStats stats;
+    stats.allocations = nbAllocations;
+    stats.reuses = nbReuses;
+    stats.pooled = nbPooled;
+    return stats;
+}
+
+void PayloadBuffer::retain() {
+    _refs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void PayloadBuffer::release() {
+    if (_refs.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+        return;
+    }
+
+    const int sizeClass = _sizeClass;
+    this->~PayloadBuffer();
+
+    if (sizeClass >= 0) {
+        Pool& p = pool();
+        std::lock_guard<std::mutex> lock(p.mutex);
+        std::vector<void *>& freeList = p.freeLists[sizeClass];
+        if (freeList.size() < POOL_MAX_BUFFERS_PER_CLASS) {
+            freeList.push_back(this);
+            ++nbPooled;
+            return;
+        }
+    }
+    free(this);
+}
+
+// MARK: - private -
+
+PayloadBuffer::PayloadBuffer() :
+_refs(1),
+_sizeClass(-1),
+_capacity(0),
+_headroom(0),
+_data(nullptr),
+_adopted(nullptr) {}
+
+PayloadBuffer::~PayloadBuffer() {
+    if (_adopted != nullptr) {
+        free(_adopted);
+        _adopted = nullptr;
+    }
+}
@@ -0,0 +1,263 @@
+//
+//  ThreadPool.cpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "ThreadPool.hpp"
+
+#ifndef __VX_SINGLE_THREAD
+
+// C++
+#include <functional>
+#include <utility>
+
+using namespace vx;
+
+/// index of the pool worker running on current thread, SIZE_MAX for other threads
+static thread_local size_t currentWorker = SIZE_MAX;
+static thread_local const ThreadPool *currentPool = nullptr;
+
+ThreadPool& ThreadPool::shared() {
+    static ThreadPool *sharedInstance = new ThreadPool(0);
+    return *sharedInstance;
+}
+
+ThreadPool::ThreadPool(size_t nbWorkers) :
+_workers(),
+_pending(0),
+_nextWorker(0),
+_stopping(false),
+_sleepLock(),
+_wakeUp(),
+_delayed(),
+_delayedLock(),
+_delayedChanged(),
+_timerThread() {
+    if (nbWorkers == 0) {
+        nbWorkers = std::thread::hardware_concurrency();
+        if (nbWorkers == 0) {
+            nbWorkers = 2; // not computable
+        }
+    }
+
+    for (size_t p = 0; p < NB_PRIORITIES; ++p) {
+        _metrics[p].queued = 0;
+        _metrics[p].executed = 0;
+        _metrics[p].stolen = 0;
+        _metrics[p].totalLatencyUs = 0;
+        _metrics[p].maxLatencyUs = 0;
+    }
+
+    // all workers exist before starting threads, as they steal from each other
+    for (size_t i = 0; i < nbWorkers; ++i) {
+        _workers.push_back(std::unique_ptr<Worker>(new Worker()));
+    }
+    for (size_t i = 0; i < nbWorkers; ++i) {
+        _workers[i]->thread = std::thread(&ThreadPool::_workerFunction, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> sleepLocker(_sleepLock);
+        std::lock_guard<std::mutex> delayedLocker(_delayedLock);
+        _stopping = true;
+    }
+    _wakeUp.notify_all();
+    _delayedChanged.notify_all();
+
+    for (std::unique_ptr<Worker>& w : _workers) {
+        if (w->thread.joinable()) {
+            w->thread.join();
+        }
+    }
+    if (_timerThread.joinable()) {
+        _timerThread.join();
+    }
+}
+
+void ThreadPool::submit(fp_t&& task, Priority priority) {
+    Task t;
+    t.fn = std::move(task);
+    t.submittedAt = std::chrono::steady_clock::now();
+    _push(std::move(t), static_cast<size_t>(priority));
+}
+
+TimerQueue::Handle ThreadPool::submitAfter(fp_t&& task, Priority priority, int64_t ms) {
+    return submitAt(std::move(task),
+                    priority,
+                    TimerQueue::Clock::now() + std::chrono::milliseconds(ms));
+}
+
+TimerQueue::Handle ThreadPool::submitAt(fp_t&& task,
+                                        Priority priority,
+                                        TimerQueue::Clock::time_point due) {
+    if (due <= TimerQueue::Clock::now()) {
+        submit(std::move(task), priority);
+        return TimerQueue::invalidHandle;
+    }
+    // timer callback submits the task
+    fp_t submitTask = std::bind([this, priority](fp_t& t) { this->submit(std::move(t), priority); },
+                                std::move(task));
+    TimerQueue::Handle handle;
+    bool wakeTimer;
+    {
+        std::lock_guard<std::mutex> locker(_delayedLock);
+        if (_stopping) {
+            return TimerQueue::invalidHandle;
+        }
+        TimerQueue::Clock::time_point next;
+        wakeTimer = _delayed.getNextDue(next) == false || due < next;
+        handle = _delayed.add(std::move(submitTask), due);
+        if (_timerThread.joinable() == false) {
+            _timerThread = std::thread(&ThreadPool::_timerFunction, this);
+        }
+    }
+    if (wakeTimer) {
+        _delayedChanged.notify_one();
+    }
+    return handle;
+}
+
+bool ThreadPool::cancel(TimerQueue::Handle handle) {
+    std::lock_guard<std::mutex> locker(_delayedLock);
+    return _delayed.cancel(handle);
+}
+
+size_t ThreadPool::getNbWorkers() const {
+    return _workers.size();
+}
+
+ThreadPool::Metrics ThreadPool::getMetrics(Priority priority) const {
+    const PriorityMetrics& m = _metrics[static_cast<size_t>(priority)];
+    Metrics metrics;
+    metrics.queued = m.queued;
+    metrics.executed = m.executed;
+    metrics.stolen = m.stolen;
+    metrics.totalLatencyUs = m.totalLatencyUs;
+    metrics.maxLatencyUs = m.maxLatencyUs;
+    return metrics;
+}
+
+// MARK: - private -
+
+void ThreadPool::_push(Task&& task, size_t priority) {
+    // counters are incremented first so that they can't go below 0 when a worker
+    // pops the task right away. A worker woken up before the push just yields and retries.
+    _metrics[priority].queued.fetch_add(1);
+    {
+        // taking the lock makes sure a worker can't miss the notification
+        // between checking `_pending` and going to sleep
+        std::lock_guard<std::mutex> locker(_sleepLock);
+        _pending.fetch_add(1);
+    }
+
+    // keep tasks submitted by a worker local to that worker, others are spread
+    const size_t index = currentPool == this ? currentWorker
+                                             : _nextWorker.fetch_add(1) % _workers.size();
+    {
+        Worker& w = *_workers[index];
+        std::lock_guard<std::mutex> locker(w.lock);
+        w.queues[priority].push_back(std::move(task));
+    }
+    _wakeUp.notify_one();
+}
+
+bool ThreadPool::_pop(size_t index, Task& task, size_t& priority) {
+    const size_t nbWorkers = _workers.size();
+    for (priority = 0; priority < NB_PRIORITIES; ++priority) {
+        // own tasks first, oldest first
+        {
+            Worker& w = *_workers[index];
+            std::lock_guard<std::mutex> locker(w.lock);
+            std::deque<Task>& q = w.queues[priority];
+            if (q.empty() == false) {
+                task = std::move(q.front());
+                q.pop_front();
+                return true;
+            }
+        }
+        // then steal newest tasks from other workers, least likely to be picked by owner soon
+        for (size_t i = 1; i < nbWorkers; ++i) {
+            Worker& w = *_workers[(index + i) % nbWorkers];
+            std::lock_guard<std::mutex> locker(w.lock);
+            std::deque<Task>& q = w.queues[priority];
+            if (q.empty() == false) {
+                task = std::move(q.back());
+                q.pop_back();
+                _metrics[priority].stolen.fetch_add(1);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::_workerFunction(size_t index) {
+    currentWorker = index;
+    currentPool = this;
+
+    Task task;
+    size_t priority;
+
+    while (true) {
+        {
+            std::unique_lock<std::mutex> locker(_sleepLock);
+            _wakeUp.wait(locker, [this]() { return _pending > 0 || _stopping; });
+            if (_stopping) {
+                return;
+            }
+        }
+
+        if (_pop(index, task, priority) == false) {
+            // another worker got it first, or task is being pushed
+            std::this_thread::yield();
+            continue;
+        }
+        _pending.fetch_sub(1);
+
+        PriorityMetrics& m = _metrics[priority];
+        m.queued.fetch_sub(1);
+        const uint64_t latency = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() -
+                                                                  task.submittedAt).count());
+        m.totalLatencyUs.fetch_add(latency);
+        uint64_t max = m.maxLatencyUs;
+        while (latency > max && m.maxLatencyUs.compare_exchange_weak(max, latency) == false) {}
+
+        task.fn();
+        task.fn = nullptr; // release captures before sleeping
+        m.executed.fetch_add(1);
+    }
+}
+
+void ThreadPool::_timerFunction() {
+    std::unique_lock<std::mutex> locker(_delayedLock);
+    std::vector<fp_t> due;
+    TimerQueue::Clock::time_point next;
+
+    while (_stopping == false) {
+        if (_delayed.getNextDue(next) == false) {
+            _delayedChanged.wait(locker);
+            continue;
+        }
+        if (TimerQueue::Clock::now() < next) {
+            _delayedChanged.wait_until(locker, next);
+            continue;
+        }
+
+        // all due tasks are submitted in one batch, outside of lock
+        // as tasks may schedule other tasks
+        _delayed.popDue(TimerQueue::Clock::now(), due);
+        locker.unlock();
+        for (fp_t& submitTask : due) {
+            submitTask();
+        }
+        due.clear();
+        locker.lock();
+    }
+}
+
+#endif
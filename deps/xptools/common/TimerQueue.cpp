@@ -0,0 +1,91 @@
+//
+//  TimerQueue.cpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#include "TimerQueue.hpp"
+
+// C++
+#include <algorithm>
+
+// Cancelled entries are removed from the heap when they outnumber pending ones
+// (plus this margin), keeping memory and heap depth bounded under heavy cancellation.
+#define CANCELLED_ENTRIES_MARGIN 64
+
+using namespace vx;
+
+const TimerQueue::Handle TimerQueue::invalidHandle;
+
+TimerQueue::TimerQueue() :
+_heap(),
+_callbacks(),
+_nextHandle(invalidHandle + 1) {}
+
+TimerQueue::Handle TimerQueue::add(fp_t&& fn, Clock::time_point due) {
+    const Handle handle = _nextHandle++;
+    Entry e;
+    e.due = due;
+    e.handle = handle;
+    _heap.push_back(e);
+    std::push_heap(_heap.begin(), _heap.end(), Later());
+    _callbacks[handle] = std::move(fn);
+    return handle;
+}
+
+bool TimerQueue::cancel(Handle handle) {
+    if (_callbacks.erase(handle) == 0) {
+        return false;
+    }
+    if (_heap.size() > 2 * _callbacks.size() + CANCELLED_ENTRIES_MARGIN) {
+        _heap.erase(std::remove_if(_heap.begin(), _heap.end(), [this](const Entry& e) {
+            return _callbacks.find(e.handle) == _callbacks.end();
+        }), _heap.end());
+        std::make_heap(_heap.begin(), _heap.end(), Later());
+    }
+    return true;
+}
+
+size_t TimerQueue::popDue(Clock::time_point now, std::vector<fp_t>& out) {
+    size_t n = 0;
+    while (_heap.empty() == false && _heap.front().due <= now) {
+        const Handle handle = _heap.front().handle;
+        std::pop_heap(_heap.begin(), _heap.end(), Later());
+        _heap.pop_back();
+
+        std::unordered_map<Handle, fp_t>::iterator it = _callbacks.find(handle);
+        if (it != _callbacks.end()) {
+            out.push_back(std::move(it->second));
+            _callbacks.erase(it);
+            ++n;
+        }
+    }
+    return n;
+}
+
+bool TimerQueue::getNextDue(Clock::time_point& due) {
+    _dropCancelledTop();
+    if (_heap.empty()) {
+        return false;
+    }
+    due = _heap.front().due;
+    return true;
+}
+
+size_t TimerQueue::size() const {
+    return _callbacks.size();
+}
+
+bool TimerQueue::empty() const {
+    return _callbacks.empty();
+}
+
+// MARK: - private -
+
+void TimerQueue::_dropCancelledTop() {
+    while (_heap.empty() == false && _callbacks.find(_heap.front().handle) == _callbacks.end()) {
+        std::pop_heap(_heap.begin(), _heap.end(), Later());
+        _heap.pop_back();
+    }
+}
@@ -52,7 +52,8 @@ _wsi(nullptr),
 #if defined(__VX_USE_LIBWEBSOCKETS) || defined(__VX_PLATFORM_WASM)
 _wsiMutex(),
 #endif
-_receivedBytesBuffer(),
+_receivedBytesBuffer(nullptr),
+_receivedBytesLen(0),
 _isWriting(false),
 _isWritingMutex(),
 _payloadsToWrite(),
@@ -64,6 +65,7 @@ _platformObject(nullptr) {
 
 WSConnection::~WSConnection() {
     _destroy();
+    _clearReceivedBytes();
 }
 
 Connection::Status WSConnection::getStatus() {
@@ -158,7 +160,7 @@ void WSConnection::reset() {
     _payloadBeingWritten = nullptr;
     _written = 0;
 
-    _receivedBytesBuffer.clear();
+    _clearReceivedBytes();
 
 #if defined(__VX_USE_LIBWEBSOCKETS)
     setWsi(nullptr);
@@ -375,28 +377,32 @@ void WSConnection::receivedBytes(char *bytes,
                                  const bool isFinalFragment) {
     // append received bytes
     if (len > 0) {
-        _receivedBytesBuffer.append(bytes, len);
+        if (PayloadBuffer::append(_receivedBytesBuffer, _receivedBytesLen, bytes, len) == false) {
+            vxlog_error("[WSConnection::receivedBytes] dropped bytes");
+        }
     }
 
     if (isFinalFragment) {
         // notify delegate
         std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
-        if (delegate != nullptr) {
-            char *bytesBuf = reinterpret_cast<char*>(malloc(_receivedBytesBuffer.size()));
-            if (bytesBuf != nullptr) {
-                memcpy(bytesBuf, _receivedBytesBuffer.c_str(), _receivedBytesBuffer.size());
-
-                Payload_SharedPtr pld = Payload::decode(bytesBuf, _receivedBytesBuffer.size());
-
+        if (delegate != nullptr && _receivedBytesBuffer != nullptr) {
+            // payload content points within received bytes, no copy
+            Payload_SharedPtr pld = Payload::decode(_receivedBytesBuffer, _receivedBytesLen);
+            if (pld != nullptr) {
                 pld->step("WSConnection::receivedBytes");
-
                 delegate->connectionDidReceive(*this, pld);
-            } else {
-                vxlog_error("[WSConnection::receivedBytes] dropped bytes");
             }
         }
-        _receivedBytesBuffer.clear();
+        _clearReceivedBytes();
+    }
+}
+
+void WSConnection::_clearReceivedBytes() {
+    if (_receivedBytesBuffer != nullptr) {
+        _receivedBytesBuffer->release();
+        _receivedBytesBuffer = nullptr;
     }
+    _receivedBytesLen = 0;
 }
 
 void WSConnection::setIsWriting(const bool isWriting) {
@@ -465,8 +471,8 @@ size_t WSConnection::write(char *buf, size_t len, bool& isFirstFragment, bool& p
     toWrite = payload->contentSize() - contentWritten;
     if (toWrite > (len-n)) { toWrite = (len-n); } // (len-n) is the current "write capacity"
 
-    // NOTE: we could compress (using zlib deflate) when size is big enough (>~42 bytes?)
-    // https://stackoverflow.com/a/63699295
+    // NOTE: content is already compressed here for payloads including
+    // Payload::Includes::Compressed (see Payload::createMetadataIfNull)
     memcpy(cursor, payload->getContent() + contentWritten, toWrite);
     n += toWrite;
     _written += toWrite;
@@ -83,6 +83,16 @@ _tlsCertificate(tlsCertificate),
 _tlsPrivateKey(tlsPrivateKey),
 _delegate(nullptr),
 _activeConnections(),
+_scheduledWrites(),
+_scheduledWritesBuffer(),
+_nbConnections(0),
+_nbPendingWrites(0),
+_bytesWritten(0),
+_bytesReceived(0),
+_statsMutex(),
+_statsTime(std::chrono::steady_clock::now()),
+_statsBytesWritten(0),
+_statsBytesReceived(0),
 _lws_context(nullptr),
 _contextMutex(),
 _lws_pvo_wsserver(),
@@ -233,7 +243,14 @@ WSServerConnection_SharedPtr* WSServer::createNewConnection(WSBackend wsi) {
     }
 
     // add new connection to the collection of active connections
+    _activeConnections.erase(std::remove_if(_activeConnections.begin(),
+                                            _activeConnections.end(),
+                                            [](const WSServerConnection_WeakPtr& ptr) {
+        return ptr.expired();
+    }), _activeConnections.end());
     _activeConnections.push_back(WSServerConnection_WeakPtr(*conn));
+    newConnPtr->setWeakSelf(*conn);
+    ++_nbConnections;
 
     return conn;
 }
@@ -243,6 +260,7 @@ void WSServer::scheduleWrite(WSServerConnection* conn) {
         vxlog_error("[WSServer::scheduleWrite] connection is NULL");
         return;
     }
+    ++_nbPendingWrites;
 
     // if this connection is already writing, we don't need to trigger the
     // lws "writable" callback.
@@ -250,6 +268,12 @@ void WSServer::scheduleWrite(WSServerConnection* conn) {
         return;
     }
 
+    // already scheduled, LWS thread didn't pick it up yet
+    if (conn->markScheduledForWrite() == false) {
+        return;
+    }
+    _scheduledWrites.push(conn->getWeakSelf());
+
     //
     lws* wsi = conn->getWsi();
     if (wsi == nullptr) {
@@ -262,6 +286,41 @@ void WSServer::scheduleWrite(WSServerConnection* conn) {
     }
 }
 
+void WSServer::processScheduledWrites() {
+    _scheduledWritesBuffer.clear();
+    _scheduledWrites.popAll(_scheduledWritesBuffer);
+
+    for (const WSServerConnection_WeakPtr& weak : _scheduledWritesBuffer) {
+        WSServerConnection_SharedPtr conn = weak.lock();
+        if (conn == nullptr) { continue; }
+        // cleared before checking for payloads: a payload pushed from now on schedules again
+        conn->clearScheduledForWrite();
+        if (conn->isWriting() == false && conn->doneWriting() == false) {
+            conn->setIsWriting(true);
+            // request additional write callback
+            lws_callback_on_writable(conn->getWsi());
+        }
+    }
+    _scheduledWritesBuffer.clear();
+}
+
+void WSServer::didWrite(const size_t bytes, const bool payloadDone) {
+    _bytesWritten += bytes;
+    if (payloadDone) {
+        --_nbPendingWrites;
+    }
+}
+
+void WSServer::didReceive(const size_t bytes) {
+    _bytesReceived += bytes;
+}
+
+void WSServer::didCloseConnection(WSServerConnection* conn) {
+    // payloads that will never be written
+    _nbPendingWrites -= conn->getNbPayloadsToWrite();
+    --_nbConnections;
+}
+
 std::mutex& WSServer::getContextMutex() {
     return _contextMutex;
 }
@@ -270,6 +329,29 @@ std::vector<WSServerConnection_WeakPtr>& WSServer::getActiveConnections() {
     return _activeConnections;
 }
 
+WSServer::Stats WSServer::getStats() {
+    Stats stats;
+    stats.connections = _nbConnections;
+    stats.pendingWrites = _nbPendingWrites;
+    stats.bytesWritten = _bytesWritten;
+    stats.bytesReceived = _bytesReceived;
+
+    std::lock_guard<std::mutex> lock(_statsMutex);
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    const double seconds = std::chrono::duration<double>(now - _statsTime).count();
+    if (seconds > 0.0) {
+        stats.bytesWrittenPerSecond = static_cast<double>(stats.bytesWritten - _statsBytesWritten) / seconds;
+        stats.bytesReceivedPerSecond = static_cast<double>(stats.bytesReceived - _statsBytesReceived) / seconds;
+    } else {
+        stats.bytesWrittenPerSecond = 0.0;
+        stats.bytesReceivedPerSecond = 0.0;
+    }
+    _statsTime = now;
+    _statsBytesWritten = stats.bytesWritten;
+    _statsBytesReceived = stats.bytesReceived;
+    return stats;
+}
+
 // --------------------------------------------------
 //
 // MARK: - Private -
@@ -404,24 +486,8 @@ static int lws_callback(struct lws *wsi,
         case LWS_CALLBACK_EVENT_WAIT_CANCELLED: {
 
             if (vhd != nullptr && vhd->wsserver != nullptr) {
-                std::vector<WSServerConnection_WeakPtr>& conns = vhd->wsserver->getActiveConnections();
-                std::vector<WSServerConnection_WeakPtr>::iterator it;
-
-                // remove expired weak pointers
-                conns.erase(std::remove_if(conns.begin(), conns.end(), [](WSServerConnection_WeakPtr ptr){
-                    return ptr.expired();
-                }), conns.end());
-
-                // loop over active connections and call `lws_callback_on_writable` if necessary
-                for (it = conns.begin(); it != conns.end(); it++) {
-                    WSServerConnection_SharedPtr strong = (*it).lock();
-                    if (strong == nullptr) { continue; }
-                    if (strong->doneWriting() == false) {
-                        strong->setIsWriting(true);
-                        // request additional write callback
-                        lws_callback_on_writable(strong->getWsi());
-                    }
-                }
+                // only visit connections that pushed payloads since last wake up
+                vhd->wsserver->processScheduledWrites();
             }
             break;
         }
@@ -480,6 +546,7 @@ static int lws_callback(struct lws *wsi,
             const bool isFinalFragment = lws_is_final_fragment(wsi) != 0;
 
             if (conn != nullptr) {
+                vhd->wsserver->didReceive(len);
                 conn->receivedBytes(reinterpret_cast<char*>(in), len, isFinalFragment);
             } else {
                 vxlog_error("LWS_CALLBACK_RECEIVE : conn is NULL");
@@ -530,6 +597,7 @@ static int lws_callback(struct lws *wsi,
                         // Error, connection is dead.
                         return 1;
                     }
+                    vhd->wsserver->didWrite(len_to_write, partial == false && len_to_write > 0);
 
                     if (conn->doneWriting() == false) {
                         std::lock_guard<std::mutex> lock(vhd->wsserver->getContextMutex());
@@ -537,6 +605,13 @@ static int lws_callback(struct lws *wsi,
                         assert(conn->isWriting() == true);
                     } else {
                         conn->setIsWriting(false);
+                        // a payload pushed before setIsWriting(false) didn't schedule a write,
+                        // as connection was writing
+                        if (conn->doneWriting() == false) {
+                            conn->setIsWriting(true);
+                            std::lock_guard<std::mutex> lock(vhd->wsserver->getContextMutex());
+                            lws_callback_on_writable(wsi);
+                        }
                     }
                 }
             } else {
@@ -547,6 +622,7 @@ static int lws_callback(struct lws *wsi,
         case LWS_CALLBACK_CLOSED: {
             // vxlog_debug("[WSServer] LWS_CALLBACK_CLOSED");
             if (conn != nullptr) {
+                vhd->wsserver->didCloseConnection(conn.get());
                 conn->close();
                 // delete the WSServerConnection_SharedPtr
                 delete reinterpret_cast<WSServerConnection_SharedPtr*>(user);
@@ -28,12 +28,18 @@ _server(parentServer),
 _payloadsToWrite(),
 _status(Connection::Status::IDLE),
 _statusMutex(),
-_receivedBytesBuffer(),
+_receivedBytesBuffer(nullptr),
+_receivedBytesLen(0),
 _isWriting(false),
 _isWritingMutex(),
-_written(0) {}
+_written(0),
+_weakSelf(),
+_scheduledForWrite(false),
+_nbPayloadsToWrite(0) {}
 
-WSServerConnection::~WSServerConnection() {}
+WSServerConnection::~WSServerConnection() {
+    _clearReceivedBytes();
+}
 
 // --------------------------------------------------
 // "Connection" interface implementation
@@ -119,29 +125,34 @@ void WSServerConnection::receivedBytes(char *bytes,
                                        const bool isFinalFragment) {
     // append received bytes
     if (len > 0) {
-        _receivedBytesBuffer.append(bytes, len);
+        if (PayloadBuffer::append(_receivedBytesBuffer, _receivedBytesLen, bytes, len) == false) {
+            vxlog_error("[WSServerConnection::receivedBytes] dropped bytes");
+        }
     }
 
     if (isFinalFragment) {
         // notify delegate
         std::shared_ptr<ConnectionDelegate> delegate = getDelegate().lock();
-        if (delegate != nullptr) {
-            char *bytes = reinterpret_cast<char*>(malloc(_receivedBytesBuffer.size()));
-            if (bytes != nullptr) {
-                memcpy(bytes, _receivedBytesBuffer.c_str(), _receivedBytesBuffer.size());
-                Payload_SharedPtr pld = Payload::decode(bytes, _receivedBytesBuffer.size());
-
+        if (delegate != nullptr && _receivedBytesBuffer != nullptr) {
+            // payload content points within received bytes, no copy
+            Payload_SharedPtr pld = Payload::decode(_receivedBytesBuffer, _receivedBytesLen);
+            if (pld != nullptr) {
                 pld->step("WSServerConnection::receivedBytes");
-
                 delegate->connectionDidReceive(*this, pld);
-            } else {
-                vxlog_error("[WSConnection::receivedBytes] dropped bytes");
             }
         }
-        _receivedBytesBuffer.clear();
+        _clearReceivedBytes();
     }
 }
 
+void WSServerConnection::_clearReceivedBytes() {
+    if (_receivedBytesBuffer != nullptr) {
+        _receivedBytesBuffer->release();
+        _receivedBytesBuffer = nullptr;
+    }
+    _receivedBytesLen = 0;
+}
+
 void WSServerConnection::setIsWriting(const bool isWriting) {
     std::lock_guard<std::mutex> lock(_isWritingMutex);
     _isWriting = isWriting;
@@ -152,6 +163,26 @@ bool WSServerConnection::isWriting() {
     return _isWriting;
 }
 
+void WSServerConnection::setWeakSelf(const WSServerConnection_WeakPtr& weakSelf) {
+    _weakSelf = weakSelf;
+}
+
+WSServerConnection_WeakPtr WSServerConnection::getWeakSelf() {
+    return _weakSelf;
+}
+
+bool WSServerConnection::markScheduledForWrite() {
+    return _scheduledForWrite.exchange(true) == false;
+}
+
+void WSServerConnection::clearScheduledForWrite() {
+    _scheduledForWrite = false;
+}
+
+size_t WSServerConnection::getNbPayloadsToWrite() {
+    return _nbPayloadsToWrite;
+}
+
 // --------------------------------------------------
 // MARK: - Payload Writer -
 // --------------------------------------------------
@@ -162,6 +193,7 @@ Connection::Payload_SharedPtr WSServerConnection::_getPayloadToWrite() {
     if (_payloadBeingWritten != nullptr &&
         _written == _payloadBeingWritten->totalSize()) {
         _payloadBeingWritten = nullptr;
+        --_nbPayloadsToWrite;
     }
 
     if (_payloadBeingWritten == nullptr) {
@@ -185,6 +217,7 @@ void WSServerConnection::pushPayloadToWrite(const Payload_SharedPtr& p) {
 
     // push Payload to channel
     // they will be read by LWS callback
+    ++_nbPayloadsToWrite;
     _payloadsToWrite.push(p);
 
     // notify WSServer that some bytes are waiting to be written
@@ -239,8 +272,8 @@ size_t WSServerConnection::write(char *buf, size_t len, bool& isFirstFragment, b
     toWrite = payload->contentSize() - contentWritten;
     if (toWrite > (len-n)) { toWrite = (len-n); } // (len-n) is the current "write capacity"
 
-    // NOTE: we could compress (using zlib deflate) when size is big enough (>~42 bytes?)
-    // https://stackoverflow.com/a/63699295
+    // NOTE: content is already compressed here for payloads including
+    // Payload::Includes::Compressed (see Payload::createMetadataIfNull)
     memcpy(cursor, payload->getContent() + contentWritten, toWrite);
     n += toWrite;
     _written += toWrite;
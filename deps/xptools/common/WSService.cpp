@@ -494,6 +494,12 @@ void WSService::_serviceThreadFunction() {
             lws* wsi = lws_client_connect_via_info(&connectInfo);
             if (wsi == nullptr) {
                 vxlog_error("HttpRequest failed %s", httpReq->getPath().c_str());
+                // lws may already have failed the request w/ LWS_CALLBACK_CLIENT_CONNECTION_ERROR,
+                // otherwise final callback frees the request's slot in HttpClient
+                if (httpReq->isFinished() == false) {
+                    httpReq->getResponse().setSuccess(false);
+                    httpReq->callCallback();
+                }
                 // continue to pop following http requests
                 // they may also fail instantly (if there's no network for example)
                 // not using `continue` could mean getting stuck on lws_service call
@@ -926,7 +932,7 @@ int lws_callback_http(struct lws *wsi,
         case LWS_CALLBACK_CLIENT_CONNECTION_ERROR: {
             WSSERVICE_DEBUG_LOG("🌎 callback : LWS_CALLBACK_CLIENT_CONNECTION_ERROR");
             // failure without even managing to connect to the server
-            if (req != nullptr) {
+            if (req != nullptr && req->isFinished() == false) {
                 req->getResponse().setSuccess(false);
                 req->callCallback();
             }
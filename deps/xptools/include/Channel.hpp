@@ -8,75 +8,206 @@
 #pragma once
 
 // C++
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <mutex>
-#include <queue>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "Macros.h"
 
 namespace vx {
 
-/// simple-duplex channel
+/// Unbounded multi-producer single-consumer channel.
+/// Messages are linked nodes of an intrusive MPSC queue: a push is one allocation,
+/// one atomic exchange and one store, producers never wait for each other or for
+/// the consumer. Consumer side calls (pop, popAll, popWait, clear) are serialized by a
+/// flag that is never contended with a single consumer thread.
+/// A message pushed while another producer is between its exchange and its store
+/// becomes visible once that producer completes its push.
 template <typename T>
 class Channel final {
 
 public:
-    
+
     Channel();
     ~Channel();
-    
+
     ///
     void push(T msg);
-    
+
     ///
     void pushMove(T&& msg);
 
     /// Returns true when a message has been popped
     bool pop(T& msgRef);
-    
+
+    /// Moves all available messages at the end of `msgs`.
+    /// Returns number of popped messages.
+    size_t popAll(std::vector<T>& msgs);
+
+    /// Waits until a message can be popped, or `timeout` expires.
+    /// Returns true when a message has been popped
+    bool popWait(T& msgRef, std::chrono::milliseconds timeout);
+
     void clear();
-    
+
 private:
-    
-    std::mutex _mutex;
-    std::queue<T> _queue;
-    
+
+    VX_DISALLOW_COPY_AND_ASSIGN(Channel)
+
+    ///
+    struct Node {
+        Node() : next(nullptr), msg() {}
+        explicit Node(T&& m) : next(nullptr), msg(std::move(m)) {}
+        std::atomic<Node*> next;
+        T msg;
+    };
+
+    ///
+    void _push(Node *n);
+
+    /// Consumer flag must be held
+    bool _pop(T& msgRef);
+
+    ///
+    void _lockConsumer();
+    void _unlockConsumer();
+
+    /// last pushed node, producers side
+    std::atomic<Node*> _head;
+
+    /// node preceding first message (its msg has already been popped), consumer side
+    std::atomic<Node*> _tail;
+
+    ///
+    std::atomic_flag _consumerFlag;
+
+    /// set while consumer is blocked in popWait
+    std::atomic<bool> _waiting;
+    std::mutex _waitMutex;
+    std::condition_variable _waitCV;
 };
 
 // Full definition must be available here for template classes
 
 template <typename T>
 Channel<T>::Channel() :
-_mutex(),
-_queue() {}
+_head(nullptr),
+_tail(nullptr),
+_waiting(false),
+_waitMutex(),
+_waitCV() {
+    _consumerFlag.clear();
+    Node *stub = new Node();
+    _head = stub;
+    _tail = stub;
+}
 
 template <typename T>
-Channel<T>::~Channel() {}
+Channel<T>::~Channel() {
+    clear();
+    delete _tail.load();
+}
 
 template <typename T>
 void Channel<T>::push(T msg) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    _queue.push(msg);
+    _push(new Node(std::move(msg)));
 }
 
 template <typename T>
 void Channel<T>::pushMove(T&& msg) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    _queue.push(std::move(msg));
+    _push(new Node(std::move(msg)));
 }
 
 template <typename T>
 bool Channel<T>::pop(T& msgRef) {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    if (_queue.empty()) { return false; }
-    msgRef = _queue.front();
-    _queue.pop();
-    return true;
+    _lockConsumer();
+    const bool popped = _pop(msgRef);
+    _unlockConsumer();
+    return popped;
+}
+
+template <typename T>
+size_t Channel<T>::popAll(std::vector<T>& msgs) {
+    size_t n = 0;
+    T msg;
+    _lockConsumer();
+    while (_pop(msg)) {
+        msgs.push_back(std::move(msg));
+        ++n;
+    }
+    _unlockConsumer();
+    return n;
+}
+
+template <typename T>
+bool Channel<T>::popWait(T& msgRef, std::chrono::milliseconds timeout) {
+    const std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+                                                           timeout;
+    while (true) {
+        if (pop(msgRef)) {
+            return true;
+        }
+        std::unique_lock<std::mutex> locker(_waitMutex);
+        // producers check `_waiting` after linking their node: either they see it set
+        // and notify, or the predicate sees their node
+        _waiting = true;
+        const bool available = _waitCV.wait_until(locker, deadline, [this]() {
+            return _head.load() != _tail.load();
+        });
+        _waiting = false;
+        if (available == false) {
+            return pop(msgRef);
+        }
+    }
 }
 
 template <typename T>
 void Channel<T>::clear() {
-    const std::lock_guard<std::mutex> locker(_mutex);
-    std::queue<T> empty;
-    std::swap( _queue, empty );
+    T msg;
+    _lockConsumer();
+    while (_pop(msg)) {}
+    _unlockConsumer();
 }
 
+template <typename T>
+void Channel<T>::_push(Node *n) {
+    Node *prev = _head.exchange(n);
+    prev->next.store(n, std::memory_order_release);
+    if (_waiting) {
+        std::lock_guard<std::mutex> locker(_waitMutex);
+        _waitCV.notify_one();
+    }
+}
+
+template <typename T>
+bool Channel<T>::_pop(T& msgRef) {
+    Node *tail = _tail.load(std::memory_order_relaxed);
+    Node *next = tail->next.load(std::memory_order_acquire);
+    if (next == nullptr) {
+        return false;
+    }
+    // `next` becomes the new stub
+    msgRef = std::move(next->msg);
+    next->msg = T();
+    _tail.store(next, std::memory_order_relaxed);
+    delete tail;
+    return true;
+}
+
+template <typename T>
+void Channel<T>::_lockConsumer() {
+    while (_consumerFlag.test_and_set(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
+}
+
+template <typename T>
+void Channel<T>::_unlockConsumer() {
+    _consumerFlag.clear(std::memory_order_release);
+}
 
 } // namespace vx
@@ -15,6 +15,7 @@
 #include <mutex>
 
 #include "Channel.hpp"
+#include "PayloadBuffer.hpp"
 
 namespace vx {
 
@@ -47,7 +48,27 @@ public:
             PayloadID = 1,
             CreatedAt = 2,
             TravelHistory = 4,
+            // Content is deflated when written, if big enough (see setCompressionThreshold)
+            // and if it actually gets smaller. Decoded payloads are inflated on reception,
+            // receivers always get uncompressed content.
+            Compressed = 8,
         } Includes;
+
+        ///
+        typedef struct {
+            // payloads deflated when written
+            uint64_t compressed;
+            // payloads including Compressed, sent uncompressed
+            // (below threshold or not smaller once deflated)
+            uint64_t skipped;
+            // content bytes of compressed payloads, before and after compression
+            uint64_t bytesIn;
+            uint64_t bytesOut;
+            uint64_t compressionTimeUs;
+            // received payloads inflated
+            uint64_t decompressed;
+            uint64_t decompressionTimeUs;
+        } CompressionStats;
         
         typedef struct Step {
             std::string name; // step name (max size: 255)
@@ -60,19 +81,45 @@ public:
             char pad[4];
         } Step;
         
+        // Takes ownership of malloc'd content.
+        // Metadata is serialized in a separate buffer when writing.
         static Payload_SharedPtr create(char *content, size_t len, uint8_t includes = Includes::None);
+        // Creates a payload with `len` content bytes, to be written with getContent(),
+        // in a pooled buffer. Without TravelHistory, metadata is serialized in place,
+        // right before content: no other allocation is needed to write the payload.
+        static Payload_SharedPtr create(size_t len, uint8_t includes = Includes::None);
         // creates a one byte payload that's not even supposed to be sent
         // used to trigger a meant to fail write operation, in order to close the connection.
         static Payload_SharedPtr createDummy();
+        // Takes ownership of malloc'd bytes, content points within them.
         static Payload_SharedPtr decode(char *bytes, size_t len);
+        // Content points within buffer's bytes, buffer is retained.
+        static Payload_SharedPtr decode(PayloadBuffer *buffer, size_t len);
+        // Returned payload shares content bytes with `p`, nothing is copied.
+        // Payloads are never modified once written, so the same payload can also be
+        // pushed to several connections. A copy is only needed for each connection
+        // to have its own travel history.
         static Payload_SharedPtr copy(const Payload_SharedPtr& p);
+
+        // Payloads including Compressed with content smaller than `bytes` are sent uncompressed.
+        // Default: 128 bytes.
+        static void setCompressionThreshold(size_t bytes);
+
+        // Preset dictionary used to deflate and inflate content, both peers must use
+        // the same one. Should contain byte sequences frequently found in payloads.
+        // Empty by default.
+        static void setCompressionDictionary(const std::string& dictionary);
+
+        // Counters since process start, for all payloads
+        static CompressionStats getCompressionStats();
         
         ~Payload();
         
         // Returns start of _content
+        // Content must not be modified once payload is pushed or copied.
         char* getContent();
         
-        // Returns start of _content
+        // Returns start of _metadata, NULL until createMetadataIfNull is called
         char* getMetadata();
         
         // Adds a step in the travel history for debug
@@ -93,14 +140,17 @@ public:
         // metadata size + content size
         size_t totalSize();
         
-        // serializes _metadata if NULL
+        // serializes _metadata if NULL,
+        // compressing content first if Compressed is included.
         // returns true on success, false otherwise
         bool createMetadataIfNull();
 
+        // Received bytes, empty for payloads that were not decoded or were inflated
         std::string getRawBytes();
 
     private:
-        Payload(char* bytes, size_t len, uint8_t includes = Includes::None);
+        // takes buffer reference
+        Payload(PayloadBuffer *buffer, char *content, size_t len, uint8_t includes = Includes::None);
         Payload();
         
         // Returns next Payload ID (thread safe)
@@ -109,28 +159,45 @@ public:
         static uint16_t _nextID;
         static std::mutex _nextIDMutex;
         
+        // Serializes metadata at given address
+        bool _writeMetadata(char *dst);
+
+        // Replaces content with deflated content, or removes Compressed from
+        // includes if not worth it (or on error). Metadata is then written in place
+        // when possible.
+        void _compress();
+
+        // Replaces content with inflated content, returns false on error
+        bool _decompress();
+
         // Cache to avoid re-computing header size
         // set to 0 to invalid
         size_t _metadataSizeCache;
         
         // _metadata when Payload is created
-        // Set on first write call.
+        // Set on first write call, or at creation when written in place.
+        // Points within _buffer's headroom when written in place,
+        // within _metadataBuffer otherwise.
         char *_metadata;
-        
-        // Content bytes
+
+        // Separate metadata bytes, when not written in place
+        PayloadBuffer *_metadataBuffer;
+
+        // Content bytes, within _buffer
         char *_content;
         size_t _len;
-        
-        // When decoding a Payload, _content
-        // can be found within decoded bytes.
-        // To avoid a realloc, when decoding,
-        // we make _content point to where it starts
-        // within _decoded.
-        // When destroying a Payload, _decoded should
-        // be freed if not NULL instead of _content.
-        char *_decoded;
+
+        // Holds content, shared (refcounted) between copies.
+        // When decoding a Payload, _content can be found
+        // within decoded bytes, _buffer then holds them all.
+        PayloadBuffer *_buffer;
         size_t _decodedLen;
 
+        // Only used when including Compressed
+        uint32_t _uncompressedLen;
+        // true once content has been compressed or found not worth compressing
+        bool _compressionDone;
+
         // Only used when including CreatedAt
         uint64_t _createdAt; // ms timestamp
         
@@ -147,6 +214,7 @@ public:
         // METADATA
         //   _id (IDType) (optional)
         //   _createdAd (uint64_t) (optional)
+        //   _uncompressedLen (uint32_t) (optional)
         //   nbSteps (uint8_t)
         //   nbSteps x (uint8_t + name_len + uint32_t)
         // CONTENT BYTES
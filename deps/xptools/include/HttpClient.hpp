@@ -9,16 +9,29 @@
 #pragma once
 
 // C++
+#include <atomic>
+#include <deque>
+#include <list>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <unordered_map>
 #include <unordered_set>
+#include <vector>
 
 // xptools
 #include "HttpRequest.hpp"
 #include "URL.hpp"
 
 #define VX_HTTP_CACHE_DIR_NAME "http_cache"
+// in-memory cache tier is split in shards, each with its own lock (picked by URL hash)
+#define VX_HTTP_CACHE_NB_SHARDS 16
+// default in-memory cache tier capacity (in bytes), for all shards
+#define VX_HTTP_CACHE_MEMORY_CAPACITY (32 * 1024 * 1024)
+// default maximum number of requests sent at the same time to a given host
+#define VX_HTTP_MAX_CONCURRENT_REQUESTS_PER_HOST 6
+// number of HttpRequestOpts::Priority values
+#define VX_HTTP_NB_PRIORITIES 3
 
 // HTTP status codes
 #define HTTP_OK 200
@@ -27,6 +40,10 @@
 namespace vx {
 
 /// singleton
+/// Requests are sent when a slot is available for their host (host:port), waiting
+/// requests are sent by priority (see HttpRequestOpts::Priority), then in order.
+/// A GET request identical to one in flight (same URL & headers) is not sent,
+/// it gets a copy of that request's response.
 class HttpClient final {
 
     // --------------------------------------------------
@@ -44,6 +61,23 @@ public:
         bool isStillFresh;
     };
 
+    ///
+    struct CacheStats {
+        /// lookups served from memory
+        uint64_t memoryHits;
+        /// lookups served from disk (entry then kept in memory)
+        uint64_t diskHits;
+        /// lookups that found no valid cached response
+        uint64_t misses;
+        /// entries dropped from memory to stay within capacity
+        uint64_t evictions;
+        /// disk writes queued, not done yet
+        uint64_t pendingDiskWrites;
+        /// current in-memory tier content
+        size_t memoryEntries;
+        size_t memoryBytes;
+    };
+
     ///
     static std::unordered_map<std::string, std::string> noHeaders;
 
@@ -138,19 +172,30 @@ public:
                                  const bool &sendNow,
                                  HttpRequestCallback callback);
 
-    /// Store HTTP response in cache
-    bool cacheHttpResponse(HttpRequest_SharedPtr req);
+    /// Store HTTP response in cache, if cacheable.
+    /// Response is kept in memory right away, written to disk on a background queue.
+    void cacheHttpResponse(HttpRequest_SharedPtr req);
 
 #if !defined(__VX_PLATFORM_WASM)
 
-    /// Retrieve cached response
+    /// Retrieve cached response, from memory, or from disk if not in memory
     CacheMatch getCachedResponseForRequest(HttpRequest_SharedPtr req);
 
-    /// Remove cached response from cache
-    bool removeCachedResponseForRequest(HttpRequest_SharedPtr req);
+    /// Remove cached response from cache (file removed on background queue)
+    void removeCachedResponseForRequest(HttpRequest_SharedPtr req);
 
 #endif
 
+    /// Sets maximum size (in bytes) of responses kept in memory, 0 to disable the memory tier.
+    /// Responses bigger than capacity / VX_HTTP_CACHE_NB_SHARDS are only cached on disk.
+    void setMemoryCacheCapacity(size_t bytes);
+
+    ///
+    CacheStats getCacheStats();
+
+    /// Maximum number of requests sent at the same time to a given host (host:port)
+    void setMaxConcurrentRequestsPerHost(size_t n);
+
     static void run_unit_tests();
 
     // --------------------------------------------------
@@ -172,9 +217,131 @@ private:
                                        const bool& sendNow,
                                        HttpRequestCallback callback);
 
+    // Request scheduling
+
+    /// notifies HttpClient when requests are sent, finished or cancelled
+    friend class HttpRequest;
+
+    /// Requests sent to, or waiting for, a given host
+    struct HostQueue {
+        size_t inFlight;
+        std::deque<HttpRequest_SharedPtr> waiting[VX_HTTP_NB_PRIORITIES];
+    };
+
+    /// GET requests waiting for `leader`'s response
+    struct CoalescedRequests {
+        HttpRequest_SharedPtr leader;
+        std::vector<HttpRequest_SharedPtr> followers;
+    };
+
+    /// Called by HttpRequest::sendAsync
+    void _schedule(HttpRequest_SharedPtr req);
+
+    /// Called by HttpRequest before its last callback is called.
+    /// Returns requests coalesced with `req`, with a copy of its response.
+    std::vector<HttpRequest_SharedPtr> _takeFollowers(HttpRequest_SharedPtr req);
+
+    /// Called by HttpRequest once its last callback has been called,
+    /// with followers returned by _takeFollowers.
+    void _requestDidFinish(HttpRequest_SharedPtr req,
+                           const std::vector<HttpRequest_SharedPtr>& followers);
+
+    /// Called by HttpRequest::cancel
+    void _requestDidCancel(HttpRequest_SharedPtr req);
+
+    /// Scheduler lock must be held.
+    /// Takes a slot for request (adding it to `toSend`) or queues it.
+    void _startOrQueue(const HttpRequest_SharedPtr& req, std::vector<HttpRequest_SharedPtr>& toSend);
+
+    /// Scheduler lock must be held.
+    /// Frees request's slot, waiting requests that can be sent are added to `toSend`.
+    void _releaseSlot(HttpRequest *req, std::vector<HttpRequest_SharedPtr>& toSend);
+
+    /// Sends requests, outside of scheduler lock
+    static void _send(const std::vector<HttpRequest_SharedPtr>& toSend);
+
+    ///
+    static std::string _hostKey(const HttpRequest& req);
+
+    ///
+    std::mutex _schedulerLock;
+
+    /// by host key
+    std::unordered_map<std::string, HostQueue> _hosts;
+
+    /// requests holding a slot
+    std::unordered_set<HttpRequest *> _requestsInFlight;
+
+    /// by URL
+    std::unordered_map<std::string, CoalescedRequests> _coalescedRequests;
+
+    ///
+    size_t _maxConcurrentRequestsPerHost;
+
     // HTTP Caching
 
-    std::mutex _cacheMutex;
+    /// Parsed cached response
+    struct CacheEntry {
+        std::string url;
+        std::string etag;
+        uint32_t creationTime; // seconds since 2001/01/01
+        uint32_t maxAge; // seconds
+        uint16_t statusCode;
+        HttpHeaders headers;
+        std::string body;
+
+        /// approximate memory footprint
+        size_t size() const;
+    };
+    typedef std::shared_ptr<const CacheEntry> CacheEntry_SharedPtr;
+
+    /// Cache entries of URLs with same hash modulo VX_HTTP_CACHE_NB_SHARDS
+    struct CacheShard {
+        /// protects in-memory entries
+        std::mutex lock;
+        /// most recently used first
+        std::list<CacheEntry_SharedPtr> lru;
+        /// by URL
+        std::unordered_map<std::string, std::list<CacheEntry_SharedPtr>::iterator> entries;
+        size_t bytes;
+        /// serializes reads & writes of this shard's cache files,
+        /// so that a lookup never reads a file being written
+        std::mutex fileLock;
+    };
+
+    ///
+    CacheShard& _getCacheShard(const std::string& url);
+
+    /// Returns entry & moves it to front of LRU, nullptr if not in memory
+    CacheEntry_SharedPtr _memoryCacheGet(CacheShard& shard, const std::string& url);
+
+    /// Inserts or replaces entry, evicting least recently used ones if needed.
+    /// Returns false if entry is too big to be kept in memory.
+    bool _memoryCachePut(CacheShard& shard, const CacheEntry_SharedPtr& entry, bool replace);
+
+    ///
+    void _memoryCacheRemove(CacheShard& shard, const std::string& url);
+
+    /// Shard file lock must be held
+    static bool _cacheWriteFile(const CacheEntry& entry);
+
+    /// Shard file lock must be held, removes invalid or outdated files
+    static bool _cacheReadFile(const std::string& url, CacheEntry& entry);
+
+    ///
+    static std::string _cacheFilePath(const std::string& url);
+
+    ///
+    CacheShard _cacheShards[VX_HTTP_CACHE_NB_SHARDS];
+
+    /// per shard, read outside shard locks (relaxed, no ordering needed)
+    std::atomic<size_t> _memoryCacheShardCapacity;
+
+    std::atomic<uint64_t> _cacheMemoryHits;
+    std::atomic<uint64_t> _cacheDiskHits;
+    std::atomic<uint64_t> _cacheMisses;
+    std::atomic<uint64_t> _cacheEvictions;
+    std::atomic<uint64_t> _cachePendingDiskWrites;
 
     CallbackMiddleware _callbackMiddleware;
 
@@ -200,6 +367,8 @@ private:
     // Unit tests
     static void run_unit_tests_parse_url();
     static void run_unit_tests_get_url();
+    static void run_unit_tests_memory_cache();
+    static void run_unit_tests_coalesced_response();
 };
 
 }
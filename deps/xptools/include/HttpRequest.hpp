@@ -9,6 +9,7 @@
 #pragma once
 
 // C++
+#include <chrono>
 #include <functional>
 #include <string>
 #include <thread>
@@ -98,9 +99,13 @@ public:
     /// LWS service thread is not slowed down.
     void setCallback(HttpRequestCallback callback);
 
-    ///
+    /// Returns false if the callback could not be called. The final call (response complete,
+    /// or failure) is delivered only once, see isFinished.
     bool callCallback();
 
+    /// whether the final callback has been delivered
+    inline bool isFinished() const { return _finished; }
+
     inline const std::string& getMethod() const { return _method; }
     inline const std::string& getHost() const { return _host; }
     inline const std::string& getPath() const { return _path; }
@@ -152,11 +157,20 @@ public:
 
     inline std::chrono::milliseconds getCreationTime() { return _creationTime; }
 
+    /// Time spent waiting for a connection slot (see HttpClient), 0 until sent
+    std::chrono::microseconds getQueueWaitTime() const;
+
+    /// Time between sending request and getting its full response, 0 until then
+    std::chrono::microseconds getTransferTime() const;
+
     /// generate URL string
     std::string constructURLString();
 
 private:
 
+    /// schedules requests
+    friend class HttpClient;
+
 #if defined(__VX_PLATFORM_WASM)
     static std::stack<HttpRequest_SharedPtr> _requestsWaiting;
     static std::unordered_set<HttpRequest_SharedPtr> _requestsFlying;
@@ -211,6 +225,9 @@ private:
     /// indicates whether the callback has been called
     bool _callbackCalled;
 
+    /// indicates whether the final callback has been called
+    bool _finished;
+
     /// HttpResponse
     HttpResponse _response;
 
@@ -224,6 +241,14 @@ private:
     /// Request creation timestamp (ms)
     std::chrono::milliseconds _creationTime;
 
+    /// set by HttpClient when request is scheduled & sent, and right before the final callback
+    std::chrono::steady_clock::time_point _queuedAt;
+    std::chrono::steady_clock::time_point _sentAt;
+    std::chrono::steady_clock::time_point _finishedAt;
+
+    /// response copied from an identical in-flight request (see HttpClient)
+    bool _coalesced;
+
     // cached values
     std::string _cache_pathAndQuery;
 
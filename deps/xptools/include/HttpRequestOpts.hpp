@@ -15,28 +15,39 @@ public:
 
     static HttpRequestOpts defaults;
 
+    /// Order in which requests waiting for a connection slot are sent (see HttpClient)
+    enum class Priority {
+        interactive = 0, // UI & API calls, user is waiting for them
+        normal = 1,
+        prefetch = 2, // assets that may be needed later
+    };
+
     inline HttpRequestOpts() :
     _forceCacheRevalidate(false),
     _sendNow(true),
-    _streamResponse(false) {}
+    _streamResponse(false),
+    _priority(Priority::normal) {}
 
     // accessors
 
     inline bool getForceCacheRevalidate() const { return _forceCacheRevalidate; }
     inline bool getSendNow() const { return _sendNow; }
     inline bool getStreamResponse() const { return _streamResponse; }
+    inline Priority getPriority() const { return _priority; }
 
     // modifiers
 
     inline void setForceCacheRevalidate(const bool& value) { _forceCacheRevalidate = value; }
     inline void setSendNow(const bool& value) { _sendNow = value; }
     inline void setStreamResponse(const bool& value) { _streamResponse = value; }
+    inline void setPriority(const Priority& value) { _priority = value; }
 
 private:
 
     bool _forceCacheRevalidate;
     bool _sendNow;
     bool _streamResponse;
+    Priority _priority;
 };
 
 } // namespace vx
@@ -10,15 +10,18 @@
 // C++
 #include <future>
 #include <queue>
-#include <map>
 #include <chrono>
 
 // xptools
 #include "Macros.h"
+#include "ThreadPool.hpp"
+#include "TimerQueue.hpp"
 
 namespace vx {
 
-///
+/// Sync queues run operations when `callFirstDispatchedBlocks` is called (main thread loop).
+/// Async queues run operations on the shared ThreadPool, one at a time and in dispatch order:
+/// a single pool task is submitted while the queue has pending operations.
 class OperationQueue final {
       
 public:
@@ -37,6 +40,17 @@ public:
 
     ///
     typedef std::function<void(void)> fp_t;
+
+    ///
+    struct Metrics {
+        /// dispatched operations not started yet (scheduled ones not included)
+        size_t depth;
+        /// operations executed since queue creation
+        uint64_t executed;
+        /// time between dispatch and execution start, in microseconds
+        uint64_t totalLatencyUs;
+        uint64_t maxLatencyUs;
+    };
     
     ///
     static OperationQueue *getMain();
@@ -44,10 +58,10 @@ public:
     ///
     static OperationQueue *getServerMain();
     
-    ///
+    /// Async queue, high priority on the shared ThreadPool
     static OperationQueue *getBackground();
 
-    ///
+    /// Async queue, low priority on the shared ThreadPool
     static OperationQueue *getSlowBackground();
     
     /// Destructor
@@ -60,10 +74,16 @@ public:
     void dispatch(fp_t&& op);
     
     /// dispatch and copy, to be triggered in `ms` milliseconds
-    void schedule(const fp_t& op, int64_t ms);
+    /// Returns a handle to cancel the operation, invalid if `ms` is negative.
+    TimerQueue::Handle schedule(const fp_t& op, int64_t ms);
     
     /// dispatch and move, to be triggered in `ms` milliseconds
-    void schedule(const fp_t&& op, int64_t ms);
+    /// Returns a handle to cancel the operation, invalid if `ms` is negative.
+    TimerQueue::Handle schedule(const fp_t&& op, int64_t ms);
+
+    /// Cancels scheduled operation if not triggered yet.
+    /// Returns false if operation already triggered or was cancelled.
+    bool cancelScheduled(TimerQueue::Handle handle);
     
     /// dispatch (in front of queue) and copy
     void dispatchFirst(const fp_t& op);
@@ -71,8 +91,11 @@ public:
     /// dispatch (in front of queue) and move
     void dispatchFirst(fp_t&& op);
     
-    /// Calls n first blocks to dispatch
+    /// Calls all due scheduled blocks, then n first blocks to dispatch
     void callFirstDispatchedBlocks(size_t n);
+
+    ///
+    Metrics getMetrics() const;
     
             
 protected:
@@ -94,29 +117,59 @@ private:
     ///
     static OperationQueue *_slowBackgroundQueue;
 
+    ///
+    struct Operation {
+        fp_t fn;
+        std::chrono::steady_clock::time_point dispatchedAt;
+    };
+
     /// Constructor
-    OperationQueue(Type type);
+    OperationQueue(Type type, ThreadPool::Priority priority);
     
     /// tasks queue
-    std::deque<fp_t> _queue;
+    std::deque<Operation> _queue;
     
     /// scheduled tasks queue
-    std::map<std::chrono::system_clock::time_point,fp_t> _queueScheduled;
+    TimerQueue _queueScheduled;
     
     /// queue type
     Type _type;
     
+    /// priority of async queue tasks in the shared ThreadPool
+    ThreadPool::Priority _priority;
+
     /// Indicates the current state of the queue.
-    /// This is used for managing the background thread
-    /// of certain queues.
+    /// Async queues are running in background while a pool task is
+    /// submitted to run their operations.
     State _state;
 
-    void startThreadIfNeeded();
+    ///
+    uint64_t _executed;
+    uint64_t _totalLatencyUs;
+    uint64_t _maxLatencyUs;
+
+    /// pops first operation, updating metrics, lock must be held
+    fp_t _popFirst();
+
+    ///
+    TimerQueue::Handle _schedule(fp_t&& op, int64_t ms);
+
+    void runInBackgroundIfNeeded();
 #ifndef __VX_SINGLE_THREAD
-    std::mutex _lock;
-    std::thread _thread;
+    mutable std::mutex _lock;
+
+    /// Async queues: pool timer dispatching due scheduled operations
+    TimerQueue::Handle _wakeUpHandle;
+    TimerQueue::Clock::time_point _wakeUpDue;
+
+    /// Runs queued operations, in pool task
+    void _runOperations();
+
+    /// Makes sure a pool timer fires for next scheduled operation, lock must be held
+    void _armScheduledWakeUp();
 
-    void threadFunction();
+    /// Dispatches all due scheduled operations, in pool timer task
+    void _dispatchDueScheduled();
 #endif
 };
 
@@ -0,0 +1,100 @@
+//
+//  PayloadBuffer.hpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+// xptools
+#include "Macros.h"
+
+namespace vx {
+
+/// Reference counted byte buffer backing Connection::Payload.
+/// Pooled buffers come from per size class free lists (64 bytes to 64KB) and
+/// go back there when released, larger ones are allocated and freed directly.
+/// Pooled buffers reserve a headroom before their data, for payloads to write
+/// metadata in place, right before content.
+/// Buffer and bytes are a single allocation.
+class PayloadBuffer final {
+
+public:
+
+    ///
+    struct PoolStats {
+        /// buffers allocated with malloc
+        uint64_t allocations;
+        /// buffers taken from free lists
+        uint64_t reuses;
+        /// buffers currently in free lists
+        uint64_t pooled;
+    };
+
+    /// Fits fixed size metadata (includes + ID + createdAt)
+    static const size_t headroomSize = 16;
+
+    /// Returns buffer with at least `capacity` bytes after headroom, with a reference count of 1.
+    /// Returns nullptr if memory could not be allocated.
+    static PayloadBuffer *acquire(size_t capacity);
+
+    /// Wraps malloc'd `bytes` (freed with last reference), without headroom.
+    /// Returns nullptr if memory could not be allocated, `bytes` are freed in that case.
+    static PayloadBuffer *adopt(char *bytes, size_t len);
+
+    /// Appends bytes at `buffer->data() + len`, replacing `buffer` by a larger one if needed
+    /// (previous content is copied). `buffer` can be nullptr, it must not be shared.
+    /// Returns false if memory could not be allocated.
+    static bool append(PayloadBuffer *&buffer, size_t& len, const char *bytes, size_t n);
+
+    ///
+    static PoolStats getPoolStats();
+
+    ///
+    void retain();
+
+    /// Returns buffer to pool (or frees it) when last reference is released
+    void release();
+
+    /// Start of usable bytes
+    inline char *data() { return _data; }
+
+    ///
+    inline size_t capacity() const { return _capacity; }
+
+    /// Bytes available right before `data()`
+    inline size_t headroom() const { return _headroom; }
+
+private:
+
+    VX_DISALLOW_COPY_AND_ASSIGN(PayloadBuffer)
+
+    PayloadBuffer();
+    ~PayloadBuffer();
+
+    ///
+    std::atomic<uint32_t> _refs;
+
+    /// size class index, or -1 if not pooled
+    int _sizeClass;
+
+    ///
+    size_t _capacity;
+
+    ///
+    size_t _headroom;
+
+    /// inline bytes (after headroom) for pooled buffers, malloc'd bytes for adopted ones
+    char *_data;
+
+    /// bytes to free with last reference, for adopted buffers
+    char *_adopted;
+};
+
+}
@@ -0,0 +1,165 @@
+//
+//  ThreadPool.hpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// xptools
+#include "Macros.h"
+#include "TimerQueue.hpp"
+
+namespace vx {
+
+/// Fixed set of worker threads, each owning a task deque per priority.
+/// Tasks submitted from a worker go to that worker's deque, other tasks are spread
+/// round-robin. Idle workers steal from other workers before going to sleep on a
+/// condition variable, so there's no polling: a submitted task wakes a worker right away.
+/// High priority tasks are always picked before low priority ones.
+/// Tasks may run concurrently and in any order, see OperationQueue for serial execution.
+class ThreadPool final {
+
+public:
+
+    ///
+    enum class Priority {
+        high = 0,
+        low = 1
+    };
+
+    ///
+    typedef std::function<void(void)> fp_t;
+
+    ///
+    struct Metrics {
+        /// tasks submitted but not started yet
+        size_t queued;
+        /// tasks executed since pool creation
+        uint64_t executed;
+        /// tasks executed by a worker that stole them from another worker
+        uint64_t stolen;
+        /// time between submission and execution start, in microseconds
+        uint64_t totalLatencyUs;
+        uint64_t maxLatencyUs;
+    };
+
+    /// Shared pool, one worker per hardware thread.
+    /// Never destroyed, workers live until process exits.
+    static ThreadPool& shared();
+
+    /// Starts `nbWorkers` threads, or one per hardware thread if 0.
+    explicit ThreadPool(size_t nbWorkers);
+
+    /// Waits for running tasks to finish, queued tasks are dropped.
+    ~ThreadPool();
+
+    ///
+    void submit(fp_t&& task, Priority priority);
+
+    /// Submits task once `ms` milliseconds elapsed.
+    /// Returned handle can be used to cancel it until then.
+    TimerQueue::Handle submitAfter(fp_t&& task, Priority priority, int64_t ms);
+
+    /// Submits task at given time, right away if already passed (returning invalid handle).
+    TimerQueue::Handle submitAt(fp_t&& task, Priority priority, TimerQueue::Clock::time_point due);
+
+    /// Returns false if task was already submitted or cancelled
+    bool cancel(TimerQueue::Handle handle);
+
+    ///
+    size_t getNbWorkers() const;
+
+    ///
+    Metrics getMetrics(Priority priority) const;
+
+private:
+
+    VX_DISALLOW_COPY_AND_ASSIGN(ThreadPool)
+
+    ///
+    static const size_t NB_PRIORITIES = 2;
+
+    ///
+    struct Task {
+        fp_t fn;
+        std::chrono::steady_clock::time_point submittedAt;
+    };
+
+    ///
+    struct Worker {
+        std::mutex lock;
+        std::deque<Task> queues[NB_PRIORITIES];
+        std::thread thread;
+    };
+
+    ///
+    struct PriorityMetrics {
+        std::atomic<size_t> queued;
+        std::atomic<uint64_t> executed;
+        std::atomic<uint64_t> stolen;
+        std::atomic<uint64_t> totalLatencyUs;
+        std::atomic<uint64_t> maxLatencyUs;
+    };
+
+    ///
+    void _push(Task&& task, size_t priority);
+
+    /// Pops from worker `index`, stealing from others if empty.
+    /// Returns false if no task could be found.
+    bool _pop(size_t index, Task& task, size_t& priority);
+
+    ///
+    void _workerFunction(size_t index);
+
+    ///
+    void _timerFunction();
+
+    ///
+    std::vector<std::unique_ptr<Worker>> _workers;
+
+    ///
+    PriorityMetrics _metrics[NB_PRIORITIES];
+
+    /// total number of queued tasks, workers sleep while 0
+    std::atomic<size_t> _pending;
+
+    ///
+    std::atomic<size_t> _nextWorker;
+
+    ///
+    std::atomic<bool> _stopping;
+
+    /// protects sleeping state, for `_wakeUp`
+    std::mutex _sleepLock;
+
+    ///
+    std::condition_variable _wakeUp;
+
+    /// delayed tasks, submitted by timer thread when due
+    TimerQueue _delayed;
+
+    ///
+    std::mutex _delayedLock;
+
+    ///
+    std::condition_variable _delayedChanged;
+
+    /// started with first delayed task
+    std::thread _timerThread;
+};
+
+}
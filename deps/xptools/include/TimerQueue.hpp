@@ -0,0 +1,96 @@
+//
+//  TimerQueue.hpp
+//  xptools
+//
+//  Created by agent on 18/10/2026.
+//
+
+#pragma once
+
+// C++
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <unordered_map>
+#include <vector>
+
+// xptools
+#include "Macros.h"
+
+namespace vx {
+
+/// Pending timers, ordered by due time on the monotonic clock.
+/// Timers live in a binary min-heap of (due time, handle) pairs, callbacks are stored apart,
+/// indexed by handle. Cancelling a timer only removes its callback, heap entry is skipped
+/// when reaching the top (or dropped when too many cancelled entries accumulate).
+/// Timers with the same due time fire in insertion order.
+/// Not thread safe, owner is responsible for locking.
+class TimerQueue final {
+
+public:
+
+    ///
+    typedef std::function<void(void)> fp_t;
+
+    ///
+    typedef std::chrono::steady_clock Clock;
+
+    /// Identifies a timer, to cancel it. Never reused.
+    typedef uint64_t Handle;
+
+    ///
+    static const Handle invalidHandle = 0;
+
+    ///
+    TimerQueue();
+
+    ///
+    Handle add(fp_t&& fn, Clock::time_point due);
+
+    /// Returns false if timer already fired or was cancelled
+    bool cancel(Handle handle);
+
+    /// Moves callbacks of all timers due at `now` to `out`, in due order.
+    /// Returns number of callbacks added.
+    size_t popDue(Clock::time_point now, std::vector<fp_t>& out);
+
+    /// Returns false if there's no pending timer
+    bool getNextDue(Clock::time_point& due);
+
+    /// Number of pending timers
+    size_t size() const;
+
+    ///
+    bool empty() const;
+
+private:
+
+    VX_DISALLOW_COPY_AND_ASSIGN(TimerQueue)
+
+    ///
+    struct Entry {
+        Clock::time_point due;
+        Handle handle;
+    };
+
+    /// std heap functions build max-heaps, this puts earliest timer on top
+    struct Later {
+        bool operator()(const Entry& a, const Entry& b) const {
+            return a.due > b.due || (a.due == b.due && a.handle > b.handle);
+        }
+    };
+
+    /// Pops cancelled timers from heap top
+    void _dropCancelledTop();
+
+    ///
+    std::vector<Entry> _heap;
+
+    /// callbacks of pending timers
+    std::unordered_map<Handle, fp_t> _callbacks;
+
+    ///
+    Handle _nextHandle;
+};
+
+}
@@ -152,8 +152,12 @@ private:
     std::mutex _wsiMutex;
 #endif
 
-    /// buffer for received bytes
-    std::string _receivedBytesBuffer;
+    /// buffer for received bytes, decoded payload content points within it
+    PayloadBuffer *_receivedBytesBuffer;
+    size_t _receivedBytesLen;
+
+    ///
+    void _clearReceivedBytes();
 
     /// `true` means "not currently writing
     bool _isWriting;
@@ -9,6 +9,8 @@
 #pragma once
 
 // C++
+#include <atomic>
+#include <chrono>
 #include <cstdint>
 #include <string>
 #include <unordered_map>
@@ -23,6 +25,7 @@
 #endif
 
 // xptools
+#include "Channel.hpp"
 #include "WSTypes.hpp"
 #include "WSServerConnection.hpp"
 
@@ -46,6 +49,20 @@ private:
 ///
 class WSServer final {
 public:
+
+    ///
+    struct Stats {
+        /// open connections
+        size_t connections;
+        /// payloads pushed to connections and not completely written yet
+        size_t pendingWrites;
+        /// totals since server creation
+        uint64_t bytesWritten;
+        uint64_t bytesReceived;
+        /// averages since previous getStats call (or server creation)
+        double bytesWrittenPerSecond;
+        double bytesReceivedPerSecond;
+    };
         
     WSServer(const uint16_t listenPort,
              const bool secure,
@@ -68,14 +85,31 @@ public:
     /// should be used only by LWS callback function
     WSServerConnection_SharedPtr* createNewConnection(WSBackend wsi);
     
-    ///
+    /// Called by connections when a payload is pushed.
+    /// Connection is added to the write schedule (once, until the LWS thread picks it up).
     void scheduleWrite(WSServerConnection* conn);
+
+    /// should be used only by LWS callback function,
+    /// requests writable callbacks for scheduled connections with payloads to write.
+    void processScheduledWrites();
+
+    /// should be used only by LWS callback function
+    void didWrite(const size_t bytes, const bool payloadDone);
+
+    /// should be used only by LWS callback function
+    void didReceive(const size_t bytes);
+
+    /// should be used only by LWS callback function
+    void didCloseConnection(WSServerConnection* conn);
     
     ///
     std::mutex& getContextMutex();
     
     ///
     std::vector<WSServerConnection_WeakPtr>& getActiveConnections();
+
+    /// Can be called from any thread
+    Stats getStats();
     
 private:
     
@@ -102,8 +136,26 @@ private:
     ///
     WSServerDelegate* _delegate;
     
-    /// active connections
+    /// active connections, expired ones are removed when adding new ones
     std::vector<WSServerConnection_WeakPtr> _activeConnections;
+
+    /// connections that pushed payloads since last LWS wake up
+    Channel<WSServerConnection_WeakPtr> _scheduledWrites;
+
+    /// reused by processScheduledWrites
+    std::vector<WSServerConnection_WeakPtr> _scheduledWritesBuffer;
+
+    ///
+    std::atomic<size_t> _nbConnections;
+    std::atomic<size_t> _nbPendingWrites;
+    std::atomic<uint64_t> _bytesWritten;
+    std::atomic<uint64_t> _bytesReceived;
+
+    /// previous getStats call, to compute rates
+    std::mutex _statsMutex;
+    std::chrono::steady_clock::time_point _statsTime;
+    uint64_t _statsBytesWritten;
+    uint64_t _statsBytesReceived;
     
     // LWS
     struct lws_context* _lws_context;
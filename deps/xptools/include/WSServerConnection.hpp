@@ -8,6 +8,9 @@
 
 #pragma once
 
+// C++
+#include <atomic>
+
 // xptools
 #include "WSTypes.hpp"
 #include "Connection.hpp"
@@ -60,6 +63,22 @@ public:
     
     ///
     bool isWriting();
+
+    /// Set by WSServer when creating the connection
+    void setWeakSelf(const WSServerConnection_WeakPtr& weakSelf);
+
+    ///
+    WSServerConnection_WeakPtr getWeakSelf();
+
+    /// Marks the connection as waiting in WSServer's write schedule.
+    /// Returns false if it was already marked.
+    bool markScheduledForWrite();
+
+    /// Called by WSServer when taking the connection out of its write schedule
+    void clearScheduledForWrite();
+
+    /// Payloads pushed and not completely written yet
+    size_t getNbPayloadsToWrite();
     
     // ------------------
     // CONNECTION WRITER
@@ -104,8 +123,12 @@ private:
     Status _status;
     std::mutex _statusMutex;
     
-    /// buffer for received bytes
-    std::string _receivedBytesBuffer;
+    /// buffer for received bytes, decoded payload content points within it
+    PayloadBuffer *_receivedBytesBuffer;
+    size_t _receivedBytesLen;
+
+    ///
+    void _clearReceivedBytes();
     
     /// `true` means currently writing
     bool _isWriting;
@@ -116,6 +139,15 @@ private:
     // Total bytes written for current Payload
     // (including header and metadata)
     size_t _written;
+
+    ///
+    WSServerConnection_WeakPtr _weakSelf;
+
+    /// `true` while in WSServer's write schedule
+    std::atomic<bool> _scheduledForWrite;
+
+    ///
+    std::atomic<size_t> _nbPayloadsToWrite;
 };
 
 #endif